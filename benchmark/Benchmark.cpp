@@ -1,6 +1,9 @@
 #include "Compiler.h"
 #include "Exception.h"
+#include "ParallelEvaluator.h"
 #include "Program.h"
+#include "ThreadPool.h"
+#include <chrono>
 #include <cmath>
 #include <format>
 #include <iostream>
@@ -50,104 +53,156 @@ static void printSection(StringView title) {
     std::cout << std::endl << "-- " << title << " " << std::string(120 - title.size(), '-') << std::endl;
 }
 
-static void test() {
+static Program compile(MathAccuracy accuracy) {
     Compiler compiler;
     compiler.addFunction("sin", &std::sin);
     compiler.addFunction("cos", &std::cos);
     compiler.addSourceScript(SOURCE);
+    compiler.setMathAccuracy(accuracy);
+    return compiler.compile();
+}
+
+static void printResult(const Program& program, ThreadPool& threadPool, const double r) {
+    const double phi          = double(PHI_STEPS - 1) * 2.0 * std::numbers::pi_v<double> / double(PHI_STEPS);
+    const double theta        = std::numbers::pi_v<double>;
+    const double points[4][3] = { { r, phi, theta }, // the differentials are calculated from the other points
+                                  { r + DIFF_STEP, phi, theta },
+                                  { r, phi + DIFF_STEP, theta },
+                                  { r, phi, theta + DIFF_STEP } };
 
-    Program                program      = compiler.compile();
-    const Program::Address rAddress     = program.getInputAddress("r");
-    const Program::Address phiAddress   = program.getInputAddress("phi");
-    const Program::Address thetaAddress = program.getInputAddress("theta");
-    Program::Address       resultAddress[4][4];
+    std::vector<String> outputs;
     for (int j = 0; j < 4; ++j) {
         for (int i = 0; i < 4; ++i) {
-            resultAddress[j][i] = program.getOutputAddress(std::format("g_{}{}", j, i));
+            outputs.push_back(std::format("g_{}{}", j, i));
         }
     }
+    Real               result[16][4];
+    std::vector<Real*> columns;
+    for (auto& column : result) {
+        columns.push_back(column);
+    }
+    ParallelEvaluator(program, threadPool)
+        .evaluate(ParallelEvaluator::Points{ .inputs = { "r", "phi", "theta" },
+                                             .values = { &points[0][0], std::size(points) * 3 } },
+                  outputs,
+                  columns);
 
-    std::atomic_int activeTasks;
-
-    const auto run = [&](const double r) {
-        Executable<Program::Vector>   executable = program.makeVectorExecutable();
-        std::vector<Program::Vector>& memory     = executable.memory();
-        Program::Vector               result[4][4];
-        memory[rAddress] = { r, r + DIFF_STEP, r, r };
-        for (int pi = 0; pi < PHI_STEPS; ++pi) {
-            const double phi   = double(pi) * 2.0 * std::numbers::pi_v<double> / double(PHI_STEPS);
-            memory[phiAddress] = { phi, phi, phi + DIFF_STEP, phi };
-            for (int ti = 0; ti < THETA_STEPS; ++ti) {
-                const double theta   = double(ti) * std::numbers::pi_v<double> / double(THETA_STEPS - 1);
-                memory[thetaAddress] = { theta, theta, theta, theta + DIFF_STEP };
-                executable.run();
-                for (int j = 0; j < 4; ++j) {
-                    for (int i = 0; i < 4; ++i) {
-                        result[j][i] = memory[resultAddress[j][i]];
-                    }
-                }
+    const auto printTensor = [&](StringView title, int point) {
+        std::cout << title << std::endl;
+        for (int j = 0; j < 4; ++j) {
+            for (int i = 0; i < 4; ++i) {
+                const double value = result[4 * j + i][point];
+                const double base  = result[4 * j + i][0];
+                std::cout << " " << std::format("{:10f}", point == 0 ? value : (value - base) / DIFF_STEP);
             }
+            std::cout << std::endl;
         }
-        if (--activeTasks == 0) {
-            // Print the very last calculated tensor (to prevent optimizing out the result).
-            std::cout << std::format("Last result [r = {:f}, phi -> 360deg, theta -> 180deg]:", r)
-                      << std::endl;
-            std::cout << "g" << std::endl;
-            for (int j = 0; j < 4; ++j) {
-                for (int i = 0; i < 4; ++i) {
-                    std::cout << " " << std::format("{:10f}", result[j][i][0]);
-                }
-                std::cout << std::endl;
-            }
-            std::cout << "dg/dr" << std::endl;
-            for (int j = 0; j < 4; ++j) {
-                for (int i = 0; i < 4; ++i) {
-                    std::cout << " "
-                              << std::format("{:10f}", (result[j][i][1] - result[j][i][0]) / DIFF_STEP);
-                }
-                std::cout << std::endl;
-            }
-            std::cout << "dg/dphi" << std::endl;
-            for (int j = 0; j < 4; ++j) {
-                for (int i = 0; i < 4; ++i) {
-                    std::cout << " "
-                              << std::format("{:10f}", (result[j][i][2] - result[j][i][0]) / DIFF_STEP);
+    };
+    std::cout << std::format("Last result [r = {:f}, phi -> 360deg, theta -> 180deg]:", r) << std::endl;
+    printTensor("g", 0);
+    printTensor("dg/dr", 1);
+    printTensor("dg/dphi", 2);
+    printTensor("dg/dtheta", 3);
+}
+
+static double measureSpeed(const Program& program, ThreadPool& threadPool, bool printResult) {
+    // Note: The amount of work is proportional to the number of the workers.
+    const size_t                  rSteps = Program::Vector::SIZE * (1 + 4 * threadPool.workerCount());
+    const ParallelEvaluator::Grid grid   = {
+        { .input = "r", .start = 0.0, .step = 10.0 / double(rSteps - 1), .count = rSteps },
+        { .input = "phi",
+          .start = 0.0,
+          .step  = 2.0 * std::numbers::pi_v<double> / double(PHI_STEPS),
+          .count = PHI_STEPS },
+        { .input = "theta",
+          .start = 0.0,
+          .step  = std::numbers::pi_v<double> / double(THETA_STEPS - 1),
+          .count = THETA_STEPS },
+    };
+    std::vector<String> outputs;
+    for (int j = 0; j < 4; ++j) {
+        for (int i = 0; i < 4; ++i) {
+            outputs.push_back(std::format("g_{}{}", j, i));
+        }
+    }
+
+    // Note: The outputs are only stored into the chunk buffers, i.e. the sink does nothing.
+    const auto start = std::chrono::steady_clock::now();
+    ParallelEvaluator(program, threadPool).evaluate(grid, outputs, [](const ParallelEvaluator::Chunk&) {});
+    const auto   stop    = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(stop - start).count();
+    if (printResult) {
+        ::printResult(program, threadPool, 10.0);
+    }
+    const auto tensorCount = int64_t(rSteps) * PHI_STEPS * THETA_STEPS;
+    return double(tensorCount) / seconds;
+}
+
+// Returns the maximum error of the program's outputs against the reference program.
+//
+// The error is relative for the values above 1 and absolute otherwise (the metric contains many terms which
+// cancel out, e.g. "1-r_s*r/SIGMA", so the relative error of the near-zero values is not representative).
+static double measureError(const Program& reference, const Program& program) {
+    static constexpr int R_SAMPLES     = 101;
+    static constexpr int PHI_SAMPLES   = 360;
+    static constexpr int THETA_SAMPLES = 181;
+
+    Executable<Program::Scalar> referenceExecutable = reference.makeScalarExecutable();
+    Executable<Program::Scalar> executable          = program.makeScalarExecutable();
+    const auto setInput = [](const Program& program, auto& executable, StringView name, double value) {
+        executable.memory()[program.getInputAddress(name)] = value;
+    };
+
+    double maxError = 0.0;
+    for (int ri = 1; ri < R_SAMPLES; ++ri) {
+        const double r = double(ri) * 10.0 / double(R_SAMPLES - 1);
+        for (int pi = 0; pi < PHI_SAMPLES; ++pi) {
+            const double phi = double(pi) * 2.0 * std::numbers::pi_v<double> / double(PHI_SAMPLES);
+            for (int ti = 0; ti < THETA_SAMPLES; ++ti) {
+                const double theta = double(ti) * std::numbers::pi_v<double> / double(THETA_SAMPLES - 1);
+                for (auto [p, e] : { std::pair{ &reference, &referenceExecutable },
+                                     std::pair{ &program, &executable } }) {
+                    setInput(*p, *e, "r", r);
+                    setInput(*p, *e, "phi", phi);
+                    setInput(*p, *e, "theta", theta);
+                    e->run();
                 }
-                std::cout << std::endl;
-            }
-            std::cout << "dg/dtheta" << std::endl;
-            for (int j = 0; j < 4; ++j) {
-                for (int i = 0; i < 4; ++i) {
-                    std::cout << " "
-                              << std::format("{:10f}", (result[j][i][3] - result[j][i][0]) / DIFF_STEP);
+                for (const auto& [name, address] : reference.outputs()) {
+                    const double expected = referenceExecutable.memory()[address];
+                    const double actual   = executable.memory()[program.getOutputAddress(name)];
+                    if (std::isfinite(expected)) { // skipping the singularities
+                        maxError = std::max(maxError,
+                                            std::abs(actual - expected) / std::max(1.0, std::abs(expected)));
+                    }
                 }
-                std::cout << std::endl;
             }
         }
+    }
+    return maxError;
+}
+
+static void test() {
+    static constexpr std::pair<MathAccuracy, StringView> ACCURACIES[] = {
+        { MathAccuracy::ULP_1, "ULP_1" },
+        { MathAccuracy::REL_1E6, "REL_1E6" },
+        { MathAccuracy::REL_1E3, "REL_1E3" },
     };
 
-    const unsigned rSteps = 1 + 4 * std::thread::hardware_concurrency();
-    const auto     start  = std::chrono::steady_clock::now();
-    {
-        std::vector<std::thread> threads; // poor man's thread pool
-        threads.reserve(rSteps);
-        activeTasks = rSteps + 1; // +1 to prevent the actual printout
-        for (unsigned ri = 0; ri < rSteps; ++ri) {
-            const double r = double(ri) * 10.0 / double(rSteps - 1);
-            threads.emplace_back(run, r);
+    ThreadPool    threadPool;
+    const Program reference = compile(MathAccuracy::ULP_1);
+    for (const auto& [accuracy, accuracyName] : ACCURACIES) {
+        const Program program = compile(accuracy);
+        const double  tensors = measureSpeed(program, threadPool, accuracy == MathAccuracy::ULP_1);
+        String        speed   = std::format("{}", int64_t(tensors));
+        for (StringPosition i = speed.size() - 3; i > 0 && i < speed.size(); i -= 3) {
+            speed.insert(i, "'");
         }
-        for (std::thread& thread : threads) {
-            thread.join();
-        }
-    }
-    const auto   stop    = std::chrono::steady_clock::now();
-    const double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(stop - start).count();
-    const auto   tensorCount = int64_t(Program::Vector::SIZE) * rSteps * PHI_STEPS * THETA_STEPS;
-    String       speed       = std::format("{}", int64_t(double(tensorCount) / seconds));
-    for (StringPosition i = speed.size() - 3; i > 0 && i < speed.size(); i -= 3) {
-        speed.insert(i, "'");
+        std::cout << std::format("[{:7}] Evaluation speed: {} tensors per second, max. error: {:.3g}.",
+                                 accuracyName,
+                                 speed,
+                                 measureError(reference, program))
+                  << std::endl;
     }
-    std::cout << "Evaluation speed: " << speed << " tensors per second." << std::endl;
 }
 
 int main() {
@@ -0,0 +1,146 @@
+#include "PerfCounters.h"
+#include <cstring>
+#include <format>
+#if defined(__linux__)
+#   include <linux/perf_event.h>
+#   include <sys/ioctl.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#   include <cerrno>
+#endif
+
+using namespace sixpack;
+
+#if defined(__linux__)
+
+namespace {
+
+    struct EventConfig {
+        uint32_t type;
+        uint64_t config;
+    };
+
+    /// Returns the configuration of a read miss event of the cache.
+    static constexpr uint64_t makeReadMissConfig(uint64_t cache) {
+        return cache | (uint64_t(PERF_COUNT_HW_CACHE_OP_READ) << 8) |
+               (uint64_t(PERF_COUNT_HW_CACHE_RESULT_MISS) << 16);
+    }
+
+    static constexpr std::array<EventConfig, PerfCounters::EVENT_COUNT> EVENT_CONFIGS = { {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, makeReadMissConfig(PERF_COUNT_HW_CACHE_L1D) },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+        { PERF_TYPE_HW_CACHE, makeReadMissConfig(PERF_COUNT_HW_CACHE_ITLB) },
+    } };
+
+    static int openCounter(const EventConfig& event) {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size           = sizeof(attributes);
+        attributes.type           = event.type;
+        attributes.config         = event.config;
+        attributes.disabled       = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv     = 1;
+        attributes.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // Note: The calling thread on any processor.
+        return int(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+    }
+
+} // anonymous namespace
+
+PerfCounters::PerfCounters() {
+    for (int i = 0; i < EVENT_COUNT; ++i) {
+        mDescriptors[i] = openCounter(EVENT_CONFIGS[i]);
+        if (mDescriptors[i] < 0 && mError.empty()) {
+            mError = std::format("{}: {}", getEventName(Event(i)), std::strerror(errno));
+        }
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (const int descriptor : mDescriptors) {
+        if (descriptor >= 0) {
+            close(descriptor);
+        }
+    }
+}
+
+void PerfCounters::start() {
+    for (const int descriptor : mDescriptors) {
+        if (descriptor >= 0) {
+            ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+            ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+PerfCounters::Counts PerfCounters::stop() {
+    for (const int descriptor : mDescriptors) {
+        if (descriptor >= 0) {
+            ioctl(descriptor, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    Counts counts;
+    for (int i = 0; i < EVENT_COUNT; ++i) {
+        uint64_t values[3]; // the count, the time enabled and the time running
+        if (mDescriptors[i] < 0 || read(mDescriptors[i], values, sizeof(values)) != sizeof(values)) {
+            continue;
+        }
+        // Note: The counter never scheduled (e.g. for lack of the hardware counters) is unavailable.
+        if (values[2] > 0) {
+            counts[i] = double(values[0]) * double(values[1]) / double(values[2]);
+        }
+    }
+    return counts;
+}
+
+#else
+
+PerfCounters::PerfCounters()
+    : mError("not supported on this platform") {
+    mDescriptors.fill(-1);
+}
+
+PerfCounters::~PerfCounters() = default;
+
+void PerfCounters::start() {}
+
+PerfCounters::Counts PerfCounters::stop() {
+    return {};
+}
+
+#endif
+
+bool PerfCounters::available() const {
+    for (const int descriptor : mDescriptors) {
+        if (descriptor >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+StringView PerfCounters::getEventName(Event event) {
+    switch (event) {
+    case CYCLES:
+        return "cycles";
+    case INSTRUCTIONS:
+        return "instructions";
+    case L1D_MISSES:
+        return "L1D misses";
+    case L2_MISSES:
+        return "L2 misses";
+    case LLC_MISSES:
+        return "LLC misses";
+    case BRANCH_MISSES:
+        return "branch misses";
+    case ITLB_MISSES:
+        return "iTLB misses";
+    default:
+        return "?";
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "Common.h"
+#include <array>
+#include <optional>
+
+/// The hardware performance counters of the calling thread, read through `perf_event_open` (Linux only).
+///
+/// Each counter is opened separately, i.e. those unavailable (e.g. in virtual machines, on other platforms,
+/// or if not permitted by `perf_event_paranoid`) read as empty, and the others are still counted. Only the
+/// user-space events are counted, and the counts are scaled if the counters were multiplexed.
+class PerfCounters {
+public:
+    enum Event {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,    ///< the L1 data cache read misses
+        L2_MISSES,     ///< the references to the last level cache (i.e. the L2 misses on Intel)
+        LLC_MISSES,    ///< the last level cache misses
+        BRANCH_MISSES, ///< the mispredicted branches
+        ITLB_MISSES,   ///< the instruction TLB misses
+        EVENT_COUNT
+    };
+
+    using Counts = std::array<std::optional<double>, EVENT_COUNT>;
+
+private:
+    std::array<int, EVENT_COUNT> mDescriptors;
+    sixpack::String              mError; // of the first counter failed to open
+
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&)            = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    static sixpack::StringView getEventName(Event event);
+
+    /// Returns whether any counter is available.
+    bool available() const;
+
+    /// Returns the reason of the first counter unavailable (empty if all are available).
+    const sixpack::String& error() const { return mError; }
+
+    /// Resets and starts the counters.
+    void start();
+
+    /// Stops the counters and reads their counts since `start`.
+    Counts stop();
+};
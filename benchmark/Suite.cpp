@@ -0,0 +1,845 @@
+#include "Compiler.h"
+#include "Exception.h"
+#include "ParallelEvaluator.h"
+#include "PerfCounters.h"
+#include "Program.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <thread>
+using namespace sixpack;
+
+static constexpr StringView USAGE = R"USAGE(Usage: sixpack-bench [options]
+
+Measures the evaluation speed of the workload scripts (*.sp) with the scalar, vector and parallel executables.
+
+All the inputs of the workloads are sampled within [0.5, 1.5]. Each measurement is repeated after a warmup;
+the speed is reported as the mean number of points per second with its 95% confidence interval.
+
+Options:
+  --workloads <dir>     The directory of the workload scripts (by default "workloads").
+  --filter <text>       Runs only the measurements whose id contains the text.
+  --points <count>      The number of the points per repetition (by default 262144; multiplied by the number
+                        of the workers for the parallel measurements).
+  --warmup <count>      The number of the discarded repetitions (by default 1).
+  --repetitions <count> The number of the measured repetitions (by default 10).
+  --threads <count>     The number of the workers of the parallel measurements (by default one per logical
+                        processor).
+  --json <file>         Writes the results as JSON (e.g. to be stored as a baseline).
+  --baseline <file>     Compares the results with the JSON results of a previous run; the exit code is 3 if
+                        any measurement is significantly slower.
+  --threshold <percent> The least change considered significant (by default 5).
+  --counters            Reads the hardware performance counters (Linux) during the single-threaded
+                        measurements, and reports the figures per point and the bound of the evaluation
+                        (dispatch, compute or memory).
+  --latency             Also measures the latency of the single-point evaluations (by the scalar executable
+                        and by the point executable), and reports its percentiles in nanoseconds.
+)USAGE";
+
+struct Options {
+    String   workloadDirectory = "workloads";
+    String   filter;
+    String   jsonFile;
+    String   baselineFile;
+    size_t   pointCount      = size_t(1) << 18;
+    size_t   warmupCount     = 1;
+    size_t   repetitionCount = 10;
+    unsigned threadCount     = std::max(std::thread::hardware_concurrency(), 1u);
+    double   threshold       = 0.05;
+    bool     counters        = false;
+    bool     latency         = false;
+};
+
+struct Workload {
+    String name;
+    String script;
+};
+
+/// The speed of the repetitions of a measurement, in points per second.
+struct Statistics {
+    double mean;
+    double standardDeviation;
+    double confidenceLow; // of the mean (95%)
+    double confidenceHigh;
+    double median;
+    double minimum;
+    double maximum;
+};
+
+/// The hardware counters of the repetitions of a measurement, per point.
+struct CounterFigures {
+    PerfCounters::Counts perPoint;
+    StringView           bound; // "dispatch", "compute" or "memory" (empty if unknown)
+};
+
+/// The latency of the single-point evaluations of a measurement, less the overhead of the clock.
+struct Latency {
+    String id; // "<workload>/<executable>-latency"
+    size_t sampleCount;
+    double p50; // nanoseconds
+    double p90;
+    double p99;
+    double maximum;
+};
+
+struct Result {
+    String                        id; // "<workload>/<executable>/<threads>"
+    String                        workload;
+    String                        executable;
+    unsigned                      threadCount;
+    size_t                        pointCount;
+    size_t                        repetitionCount;
+    Statistics                    speed;
+    std::optional<CounterFigures> counters;
+};
+
+static size_t parseCount(StringView option, StringView value, bool allowZero = false) {
+    size_t     count = 0;
+    const auto end   = value.data() + value.size();
+    if (const auto [pointer, error] = std::from_chars(value.data(), end, count);
+        error != std::errc() || pointer != end || (count == 0 && !allowZero)) {
+        throw Exception(std::format("Invalid value of {}: '{}'", option, value));
+    }
+    return count;
+}
+
+static Options parseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const StringView argument = argv[i];
+        if (argument == "--help") {
+            std::cout << USAGE;
+            std::exit(0);
+        }
+        if (argument == "--counters") {
+            options.counters = true;
+            continue;
+        }
+        if (argument == "--latency") {
+            options.latency = true;
+            continue;
+        }
+        if (i + 1 == argc) {
+            throw Exception(std::format("Missing value of {}", argument));
+        }
+        const StringView value = argv[++i];
+        if (argument == "--workloads") {
+            options.workloadDirectory = value;
+        } else if (argument == "--filter") {
+            options.filter = value;
+        } else if (argument == "--points") {
+            options.pointCount = parseCount(argument, value);
+        } else if (argument == "--warmup") {
+            options.warmupCount = parseCount(argument, value, true);
+        } else if (argument == "--repetitions") {
+            options.repetitionCount = parseCount(argument, value);
+        } else if (argument == "--threads") {
+            options.threadCount = unsigned(parseCount(argument, value));
+        } else if (argument == "--json") {
+            options.jsonFile = value;
+        } else if (argument == "--baseline") {
+            options.baselineFile = value;
+        } else if (argument == "--threshold") {
+            options.threshold = double(parseCount(argument, value, true)) / 100.0;
+        } else {
+            throw Exception(std::format("Unknown option '{}'", argument));
+        }
+    }
+    return options;
+}
+
+static String readFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw Exception(std::format("Cannot open '{}'", path.string()));
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+static std::vector<Workload> loadWorkloads(const std::filesystem::path& directory) {
+    std::vector<Workload> workloads;
+    std::error_code       error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".sp") {
+            workloads.push_back({ .name = entry.path().stem().string(), .script = readFile(entry.path()) });
+        }
+    }
+    if (error || workloads.empty()) {
+        throw Exception(std::format("No workloads found in '{}'", directory.string()));
+    }
+    std::sort(workloads.begin(), workloads.end(), [](const Workload& workload1, const Workload& workload2) {
+        return workload1.name < workload2.name;
+    });
+    return workloads;
+}
+
+static void addStandardFunctions(Compiler& compiler) {
+    // Note: The functions recognized by the compiler as intrinsics are identified by their addresses.
+    compiler.addFunction("sin", RealFunction(&std::sin));
+    compiler.addFunction("cos", RealFunction(&std::cos));
+    compiler.addFunction("tan", RealFunction(&std::tan));
+    compiler.addFunction("asin", RealFunction(&std::asin));
+    compiler.addFunction("acos", RealFunction(&std::acos));
+    compiler.addFunction("atan", RealFunction(&std::atan));
+    compiler.addFunction("exp", RealFunction(&std::exp));
+    compiler.addFunction("log", RealFunction(&std::log));
+    compiler.addFunction("sqrt", RealFunction(&std::sqrt));
+    compiler.addFunction("abs", RealFunction(&std::fabs));
+    compiler.addFunction("atan2", BinaryRealFunction(&std::atan2));
+    compiler.addFunction("hypot", BinaryRealFunction(&std::hypot));
+    compiler.addFunction("min", BinaryRealFunction(&std::fmin));
+    compiler.addFunction("max", BinaryRealFunction(&std::fmax));
+    compiler.addFunction("fmod", BinaryRealFunction(&std::fmod));
+    compiler.addFunction("copysign", BinaryRealFunction(&std::copysign));
+}
+
+/// Returns the 97.5% quantile of Student's t-distribution, i.e. for the two-sided 95% confidence interval.
+static double getStudentQuantile(size_t degreesOfFreedom) {
+    static constexpr double QUANTILES[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                            2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                            2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                            2.060,  2.056, 2.052, 2.048, 2.045, 2.042 };
+    if (degreesOfFreedom == 0) {
+        return 0.0; // a single repetition, i.e. no interval
+    }
+    return degreesOfFreedom <= std::size(QUANTILES) ? QUANTILES[degreesOfFreedom - 1] : 1.960;
+}
+
+static Statistics computeStatistics(std::vector<double> speeds) {
+    assert(!speeds.empty());
+    std::sort(speeds.begin(), speeds.end());
+    const size_t count = speeds.size();
+    double       sum   = 0.0;
+    for (double speed : speeds) {
+        sum += speed;
+    }
+    const double mean     = sum / double(count);
+    double       variance = 0.0;
+    for (double speed : speeds) {
+        variance += (speed - mean) * (speed - mean);
+    }
+    variance                  = count > 1 ? variance / double(count - 1) : 0.0;
+    const double deviation    = std::sqrt(variance);
+    const double halfInterval = getStudentQuantile(count - 1) * deviation / std::sqrt(double(count));
+    const double median = count % 2 ? speeds[count / 2] : 0.5 * (speeds[count / 2 - 1] + speeds[count / 2]);
+    return { .mean              = mean,
+             .standardDeviation = deviation,
+             .confidenceLow     = mean - halfInterval,
+             .confidenceHigh    = mean + halfInterval,
+             .median            = median,
+             .minimum           = speeds.front(),
+             .maximum           = speeds.back() };
+}
+
+/// The input points of a workload, stored column-wise.
+struct Inputs {
+    std::vector<String>            names;
+    std::vector<std::vector<Real>> columns;
+};
+
+static Inputs makeInputs(const Program& program, size_t pointCount) {
+    Inputs inputs;
+    for (const auto& [name, address] : program.inputs()) {
+        inputs.names.push_back(name);
+    }
+    std::sort(inputs.names.begin(), inputs.names.end());
+    for (size_t i = 0; i < inputs.names.size(); ++i) {
+        // Note: The points form a low-discrepancy (Kronecker) sequence, i.e. evenly spread, but not a grid.
+        static constexpr int PRIMES[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53 };
+        const double         step     = std::fmod(std::sqrt(double(PRIMES[i % std::size(PRIMES)])), 1.0);
+        auto&                column   = inputs.columns.emplace_back(pointCount);
+        for (size_t point = 0; point < pointCount; ++point) {
+            column[point] = 0.5 + std::fmod(double(point) * step, 1.0);
+        }
+    }
+    return inputs;
+}
+
+/// Evaluates the points with the executable of the given word, i.e. `Vector::SIZE` points per run if vector.
+///
+/// The last word of the vector executable may be partial; its spare lanes repeat the last point.
+template <typename TWord>
+static void evaluate(const Program& program, Executable<TWord>& executable, const Inputs& inputs) {
+    constexpr size_t LANES = std::is_same_v<TWord, Program::Scalar> ? 1 : Program::Vector::SIZE;
+
+    std::vector<Program::Address> addresses;
+    for (const String& name : inputs.names) {
+        addresses.push_back(program.getInputAddress(name));
+    }
+    const size_t pointCount = inputs.columns.empty() ? 0 : inputs.columns.front().size();
+    for (size_t first = 0; first < pointCount; first += LANES) {
+        for (size_t i = 0; i < addresses.size(); ++i) {
+            if constexpr (LANES == 1) {
+                executable.memory()[addresses[i]] = inputs.columns[i][first];
+            } else {
+                Program::Vector& word = executable.memory()[addresses[i]];
+                for (size_t lane = 0; lane < LANES; ++lane) {
+                    word[lane] = inputs.columns[i][std::min(first + lane, pointCount - 1)];
+                }
+            }
+        }
+        executable.run();
+    }
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double nanosecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// Measures the speed of the repetitions, optionally with the sums of their hardware counters.
+static Statistics measure(const Options&               options,
+                          size_t                       pointCount,
+                          const std::function<void()>& run,
+                          PerfCounters*                counters = nullptr,
+                          PerfCounters::Counts*        counts   = nullptr) {
+    for (size_t i = 0; i < options.warmupCount; ++i) {
+        run();
+    }
+    std::vector<double> speeds;
+    for (size_t i = 0; i < options.repetitionCount; ++i) {
+        // Note: The counters are read outside of the timed section.
+        if (counters) {
+            counters->start();
+        }
+        const auto start = std::chrono::steady_clock::now();
+        run();
+        speeds.push_back(double(pointCount) / secondsSince(start));
+        if (counters) {
+            const PerfCounters::Counts repetitionCounts = counters->stop();
+            for (int event = 0; event < PerfCounters::EVENT_COUNT; ++event) {
+                // Note: A counter is available only if available in all the repetitions.
+                std::optional<double>& count = (*counts)[event];
+                if (!repetitionCounts[event]) {
+                    count = std::nullopt;
+                } else if (i == 0 || count) {
+                    count = count.value_or(0.0) + *repetitionCounts[event];
+                }
+            }
+        }
+    }
+    return computeStatistics(std::move(speeds));
+}
+
+/// Classifies the evaluation by the dominant cost, roofline-style: the stalls on the caches beyond L1
+/// (memory-bound), the kernels too cheap to hide the calls between them or the mispredicted calls
+/// (dispatch-bound), or the arithmetic itself (compute-bound).
+///
+/// Note: The penalties are typical, i.e. the classification is a heuristic.
+static StringView classifyBound(const PerfCounters::Counts& perPoint, double kernelsPerPoint) {
+    static constexpr double L2_MISS_PENALTY     = 15.0;  // cycles
+    static constexpr double LLC_MISS_PENALTY    = 150.0; // cycles
+    static constexpr double BRANCH_MISS_PENALTY = 15.0;  // cycles
+    static constexpr double ITLB_MISS_PENALTY   = 20.0;  // cycles
+    static constexpr double DISPATCH_CYCLES     = 6.0;   // the least cycles per kernel hiding its call
+    static constexpr double DOMINANT_SHARE      = 0.3;
+
+    if (!perPoint[PerfCounters::CYCLES] || *perPoint[PerfCounters::CYCLES] <= 0.0) {
+        return {};
+    }
+    const double cycles       = *perPoint[PerfCounters::CYCLES];
+    const auto   getCount     = [&](PerfCounters::Event event) { return perPoint[event].value_or(0.0); };
+    const double memoryStalls = L2_MISS_PENALTY * getCount(PerfCounters::L2_MISSES) +
+                                LLC_MISS_PENALTY * getCount(PerfCounters::LLC_MISSES);
+    const double dispatchStalls = BRANCH_MISS_PENALTY * getCount(PerfCounters::BRANCH_MISSES) +
+                                  ITLB_MISS_PENALTY * getCount(PerfCounters::ITLB_MISSES);
+    if (memoryStalls >= DOMINANT_SHARE * cycles) {
+        return "memory";
+    }
+    if (dispatchStalls >= DOMINANT_SHARE * cycles || cycles < DISPATCH_CYCLES * kernelsPerPoint) {
+        return "dispatch";
+    }
+    return "compute";
+}
+
+static String formatCounters(const CounterFigures& figures) {
+    const auto formatCount = [&](PerfCounters::Event event, int precision) {
+        const std::optional<double>& count = figures.perPoint[event];
+        return count ? std::format("{:.{}f}", *count, precision) : String("-");
+    };
+    const std::optional<double>& cycles       = figures.perPoint[PerfCounters::CYCLES];
+    const std::optional<double>& instructions = figures.perPoint[PerfCounters::INSTRUCTIONS];
+    const String                 ipc          = cycles && instructions && *cycles > 0.0
+                                                    ? std::format("{:.2f}", *instructions / *cycles)
+                                                    : String("-");
+    return std::format("{} cycles, {} instructions (IPC {}), misses: L1D {}, L2 {}, LLC {}, branch {}, "
+                       "iTLB {} per point; {}-bound",
+                       formatCount(PerfCounters::CYCLES, 1),
+                       formatCount(PerfCounters::INSTRUCTIONS, 1),
+                       ipc,
+                       formatCount(PerfCounters::L1D_MISSES, 3),
+                       formatCount(PerfCounters::L2_MISSES, 3),
+                       formatCount(PerfCounters::LLC_MISSES, 4),
+                       formatCount(PerfCounters::BRANCH_MISSES, 3),
+                       formatCount(PerfCounters::ITLB_MISSES, 4),
+                       figures.bound.empty() ? "unknown" : figures.bound);
+}
+
+static Program compileWorkload(const Workload& workload) {
+    Compiler compiler;
+    addStandardFunctions(compiler);
+    compiler.addSourceScript(workload.script);
+    return compiler.compile();
+}
+
+static std::vector<Result> runWorkload(const Options&  options,
+                                       const Workload& workload,
+                                       const Program&  program,
+                                       PerfCounters*   counters) {
+    std::vector<String> outputs;
+    for (const auto& [name, address] : program.outputs()) {
+        outputs.push_back(name);
+    }
+
+    // Note: The kernels of the executables, i.e. the calls of the threaded code per point.
+    const double kernelCount = double(program.analyze().instructionCount);
+
+    std::vector<Result> results;
+    const auto          addResult =
+        [&](StringView executable, unsigned threadCount, size_t pointCount, size_t lanes, auto run) {
+            String id = std::format("{}/{}/{}", workload.name, executable, threadCount);
+            if (id.find(options.filter) == String::npos) {
+                return;
+            }
+            // Note: The counters are of the calling thread, i.e. only of the single-threaded measurements.
+            PerfCounters* const  measuredCounters = threadCount == 1 ? counters : nullptr;
+            PerfCounters::Counts counts;
+            const Statistics     speed = measure(options, pointCount, run, measuredCounters, &counts);
+            std::optional<CounterFigures> figures;
+            if (measuredCounters) {
+                const double pointTotal = double(pointCount) * double(options.repetitionCount);
+                figures.emplace();
+                for (int event = 0; event < PerfCounters::EVENT_COUNT; ++event) {
+                    if (counts[event]) {
+                        figures->perPoint[event] = *counts[event] / pointTotal;
+                    }
+                }
+                figures->bound = classifyBound(figures->perPoint, kernelCount / double(lanes));
+            }
+            std::cerr << std::format("{:40} {:>14.0f} points/s  (+/- {:.1f}%)",
+                                     id,
+                                     speed.mean,
+                                     100.0 * (speed.confidenceHigh - speed.mean) / speed.mean)
+                      << std::endl;
+            if (figures) {
+                std::cerr << std::format("{:40} {}", "", formatCounters(*figures)) << std::endl;
+            }
+            results.push_back({ .id              = std::move(id),
+                                .workload        = workload.name,
+                                .executable      = String(executable),
+                                .threadCount     = threadCount,
+                                .pointCount      = pointCount,
+                                .repetitionCount = options.repetitionCount,
+                                .speed           = speed,
+                                .counters        = std::move(figures) });
+        };
+
+    const Inputs inputs = makeInputs(program, options.pointCount);
+    {
+        Executable<Program::Scalar> executable = program.makeScalarExecutable();
+        addResult("scalar", 1, options.pointCount, 1, [&] { evaluate(program, executable, inputs); });
+    }
+    {
+        Executable<Program::Vector> executable = program.makeVectorExecutable();
+        addResult("vector", 1, options.pointCount, Program::Vector::SIZE, [&] {
+            evaluate(program, executable, inputs);
+        });
+    }
+    // Note: The work of the parallel measurements is proportional to the number of the workers.
+    std::vector<unsigned> threadCounts = { 1 };
+    if (options.threadCount > 1) {
+        threadCounts.push_back(options.threadCount);
+    }
+    for (const unsigned threadCount : threadCounts) {
+        ThreadPool                 threadPool(threadCount - 1);
+        const size_t               pointCount     = options.pointCount * threadCount;
+        const Inputs               parallelInputs = makeInputs(program, pointCount);
+        ParallelEvaluator::Columns columns{
+            .inputs = parallelInputs.names, .values = {}, .pointCount = pointCount, .strides = {}
+        };
+        for (const auto& column : parallelInputs.columns) {
+            columns.values.push_back(column.data());
+        }
+        const ParallelEvaluator evaluator(program, threadPool);
+        // Note: The outputs are only stored into the chunk buffers, i.e. the sink does nothing.
+        addResult("parallel", threadCount, pointCount, Program::Vector::SIZE, [&] {
+            evaluator.evaluate(columns, outputs, [](const ParallelEvaluator::Chunk&) {});
+        });
+    }
+    return results;
+}
+
+/// Measures the latency of evaluating each of the points (one at a time) by `evaluate(point)`.
+static Latency measureLatency(String id, size_t pointCount, const auto& evaluate) {
+    // Note: The overhead is the least time of an empty measurement, i.e. the evaluations never cost less.
+    double overhead = std::numeric_limits<double>::max();
+    for (int i = 0; i < 1000; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        overhead         = std::min(overhead, nanosecondsSince(start));
+    }
+    for (size_t point = 0; point < std::min<size_t>(pointCount, 1000); ++point) {
+        evaluate(point);
+    }
+    std::vector<double> samples(pointCount);
+    for (size_t point = 0; point < pointCount; ++point) {
+        const auto start = std::chrono::steady_clock::now();
+        evaluate(point);
+        samples[point] = std::max(nanosecondsSince(start) - overhead, 0.0);
+    }
+    std::sort(samples.begin(), samples.end());
+    const auto getPercentile = [&](double percentile) {
+        return samples[std::min(samples.size() - 1, size_t(percentile / 100.0 * double(samples.size())))];
+    };
+    Latency latency{ .id          = std::move(id),
+                     .sampleCount = pointCount,
+                     .p50         = getPercentile(50.0),
+                     .p90         = getPercentile(90.0),
+                     .p99         = getPercentile(99.0),
+                     .maximum     = samples.back() };
+    std::cerr << std::format("{:40} p50 {:>8.1f} ns  p90 {:>8.1f} ns  p99 {:>8.1f} ns  max {:>10.1f} ns",
+                             latency.id,
+                             latency.p50,
+                             latency.p90,
+                             latency.p99,
+                             latency.maximum)
+              << std::endl;
+    return latency;
+}
+
+/// Measures the latency of the single-point evaluations: by the scalar executable (the inputs and the
+/// outputs accessed by their addresses) and by the point executable.
+static std::vector<Latency> runLatencies(const Options&  options,
+                                         const Workload& workload,
+                                         const Program&  program) {
+    const Inputs        inputs = makeInputs(program, options.pointCount);
+    std::vector<String> outputs;
+    for (const auto& [name, address] : program.outputs()) {
+        outputs.push_back(name);
+    }
+    std::sort(outputs.begin(), outputs.end());
+
+    // Note: The inputs of each point are contiguous, as if received from a caller.
+    const size_t      inputCount = inputs.names.size();
+    std::vector<Real> points(options.pointCount * inputCount);
+    for (size_t point = 0; point < options.pointCount; ++point) {
+        for (size_t i = 0; i < inputCount; ++i) {
+            points[point * inputCount + i] = inputs.columns[i][point];
+        }
+    }
+    std::vector<Real> values(outputs.size());
+
+    std::vector<Latency> latencies;
+    const auto           addLatency = [&](StringView executable, const auto& evaluate) {
+        String id = std::format("{}/{}-latency", workload.name, executable);
+        if (id.find(options.filter) != String::npos) {
+            latencies.push_back(measureLatency(std::move(id), options.pointCount, evaluate));
+        }
+    };
+    {
+        Executable<Program::Scalar>   executable = program.makeScalarExecutable();
+        std::vector<Program::Address> inputAddresses;
+        std::vector<Program::Address> outputAddresses;
+        for (const String& name : inputs.names) {
+            inputAddresses.push_back(program.getInputAddress(name));
+        }
+        for (const String& name : outputs) {
+            outputAddresses.push_back(program.getOutputAddress(name));
+        }
+        addLatency("scalar", [&](size_t point) {
+            std::vector<Program::Scalar>& memory = executable.memory();
+            for (size_t i = 0; i < inputCount; ++i) {
+                memory[inputAddresses[i]] = points[point * inputCount + i];
+            }
+            executable.run();
+            for (size_t i = 0; i < outputAddresses.size(); ++i) {
+                values[i] = memory[outputAddresses[i]];
+            }
+        });
+    }
+    {
+        PointExecutable executable = program.makePointExecutable(inputs.names, outputs);
+        addLatency("point", [&](size_t point) {
+            executable.eval({ points.data() + point * inputCount, inputCount }, values);
+        });
+    }
+    return latencies;
+}
+
+static String escapeJson(StringView text) {
+    String escaped;
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+static void writeJson(const String&               path,
+                      const Options&              options,
+                      const std::vector<Result>&  results,
+                      const std::vector<Latency>& latencies) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw Exception(std::format("Cannot create '{}'", path));
+    }
+#if defined(__clang__)
+    const String compiler = std::format("Clang {}.{}", __clang_major__, __clang_minor__);
+#elif defined(__GNUC__)
+    const String compiler = std::format("GCC {}.{}", __GNUC__, __GNUC_MINOR__);
+#elif defined(_MSC_VER)
+    const String compiler = std::format("MSVC {}", _MSC_VER);
+#else
+    const String compiler = "unknown";
+#endif
+    file << "{\n";
+    file << std::format("  \"suite\": \"sixpack\",\n");
+    file << std::format("  \"compiler\": \"{}\",\n", escapeJson(compiler));
+    file << std::format("  \"hardwareThreads\": {},\n", std::thread::hardware_concurrency());
+    file << std::format("  \"warmup\": {},\n", options.warmupCount);
+    file << "  \"results\": [";
+    // Note: The counters of each result are stored as its (flat) fields, those unavailable are omitted.
+    static constexpr StringView COUNTER_FIELDS[PerfCounters::EVENT_COUNT] = {
+        "cyclesPerPoint",       "instructionsPerPoint", "l1dMissesPerPoint",  "l2MissesPerPoint",
+        "llcMissesPerPoint",    "branchMissesPerPoint", "itlbMissesPerPoint",
+    };
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        String        counterFields;
+        if (result.counters) {
+            for (int event = 0; event < PerfCounters::EVENT_COUNT; ++event) {
+                if (const auto& count = result.counters->perPoint[event]) {
+                    counterFields += std::format(", \"{}\": {:.6g}", COUNTER_FIELDS[event], *count);
+                }
+            }
+            if (!result.counters->bound.empty()) {
+                counterFields += std::format(", \"bound\": \"{}\"", result.counters->bound);
+            }
+        }
+        file << (i > 0 ? ",\n" : "\n");
+        file << std::format("    {{\"id\": \"{}\", \"workload\": \"{}\", \"executable\": \"{}\", "
+                            "\"threads\": {}, \"points\": {}, \"repetitions\": {}, \"mean\": {:.6g}, "
+                            "\"stddev\": {:.6g}, \"ci95Low\": {:.6g}, \"ci95High\": {:.6g}, "
+                            "\"median\": {:.6g}, \"min\": {:.6g}, \"max\": {:.6g}{}}}",
+                            escapeJson(result.id),
+                            escapeJson(result.workload),
+                            escapeJson(result.executable),
+                            result.threadCount,
+                            result.pointCount,
+                            result.repetitionCount,
+                            result.speed.mean,
+                            result.speed.standardDeviation,
+                            result.speed.confidenceLow,
+                            result.speed.confidenceHigh,
+                            result.speed.median,
+                            result.speed.minimum,
+                            result.speed.maximum,
+                            counterFields);
+    }
+    file << "\n  ],\n";
+    file << "  \"latencies\": [";
+    for (size_t i = 0; i < latencies.size(); ++i) {
+        const Latency& latency = latencies[i];
+        file << (i > 0 ? ",\n" : "\n");
+        file << std::format("    {{\"id\": \"{}\", \"samples\": {}, \"p50Ns\": {:.6g}, \"p90Ns\": {:.6g}, "
+                            "\"p99Ns\": {:.6g}, \"maxNs\": {:.6g}}}",
+                            escapeJson(latency.id),
+                            latency.sampleCount,
+                            latency.p50,
+                            latency.p90,
+                            latency.p99,
+                            latency.maximum);
+    }
+    file << "\n  ]\n}\n";
+    if (!file.flush()) {
+        throw Exception(std::format("Cannot write '{}'", path));
+    }
+}
+
+/// Reads the results written by `writeJson`, i.e. the flat objects of the "results" array.
+///
+/// \returns The numeric fields of each result, by the id.
+static std::map<String, std::map<String, double>> readJson(const String& path) {
+    const String text     = readFile(path);
+    size_t       position = text.find("\"results\"");
+    const auto   fail     = [&]() -> void {
+        throw Exception(std::format("Invalid results '{}' (at {})", path, position));
+    };
+    const auto skipSpaces = [&] {
+        while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position]))) {
+            ++position;
+        }
+    };
+    const auto expect = [&](char c) {
+        skipSpaces();
+        if (position >= text.size() || text[position] != c) {
+            fail();
+        }
+        ++position;
+    };
+    const auto readString = [&] {
+        expect('"');
+        String value;
+        while (position < text.size() && text[position] != '"') {
+            if (text[position] == '\\') {
+                ++position;
+            }
+            if (position < text.size()) {
+                value += text[position++];
+            }
+        }
+        expect('"');
+        return value;
+    };
+
+    if (position == String::npos) {
+        position = 0;
+        fail();
+    }
+    position += std::size("\"results\"") - 1;
+    expect(':');
+    expect('[');
+    std::map<String, std::map<String, double>> results;
+    skipSpaces();
+    while (position < text.size() && text[position] != ']') {
+        expect('{');
+        String                   id;
+        std::map<String, double> fields;
+        while (true) {
+            const String key = readString();
+            expect(':');
+            skipSpaces();
+            if (position < text.size() && text[position] == '"') {
+                const String value = readString();
+                if (key == "id") {
+                    id = value;
+                }
+            } else {
+                double     value = 0.0;
+                const auto end   = text.data() + text.size();
+                const auto [pointer, error] = std::from_chars(text.data() + position, end, value);
+                if (error != std::errc()) {
+                    fail();
+                }
+                position = size_t(pointer - text.data());
+                fields[key] = value;
+            }
+            skipSpaces();
+            if (position < text.size() && text[position] == ',') {
+                ++position;
+                continue;
+            }
+            expect('}');
+            break;
+        }
+        results[id] = std::move(fields);
+        skipSpaces();
+        if (position < text.size() && text[position] == ',') {
+            ++position;
+            skipSpaces();
+        }
+    }
+    expect(']');
+    return results;
+}
+
+/// Prints the changes against the baseline.
+///
+/// A change is significant if it exceeds the threshold and the confidence intervals do not overlap.
+///
+/// \returns Whether any measurement is significantly slower.
+static bool compareWithBaseline(const Options& options, const std::vector<Result>& results) {
+    const auto baseline    = readJson(options.baselineFile);
+    bool       hasSlowdown = false;
+    std::cout << std::format("{:40} {:>14} {:>14} {:>9}", "id", "baseline", "current", "change") << std::endl;
+    for (const Result& result : results) {
+        const auto baselineIt = baseline.find(result.id);
+        if (baselineIt == baseline.end() || !baselineIt->second.contains("mean")) {
+            std::cout << std::format("{:40} {:>14} {:>14.0f} {:>9}", result.id, "-", result.speed.mean, "new")
+                      << std::endl;
+            continue;
+        }
+        const auto&  fields   = baselineIt->second;
+        const double mean     = fields.at("mean");
+        const double low      = fields.contains("ci95Low") ? fields.at("ci95Low") : mean;
+        const double high     = fields.contains("ci95High") ? fields.at("ci95High") : mean;
+        const double change   = result.speed.mean / mean - 1.0;
+        const bool   overlaps = result.speed.confidenceLow <= high && low <= result.speed.confidenceHigh;
+        StringView   verdict;
+        if (std::abs(change) >= options.threshold && !overlaps) {
+            verdict     = change > 0.0 ? "faster" : "SLOWER";
+            hasSlowdown = hasSlowdown || change < 0.0;
+        }
+        std::cout << std::format("{:40} {:>14.0f} {:>14.0f} {:>+8.1f}% {}",
+                                 result.id,
+                                 mean,
+                                 result.speed.mean,
+                                 100.0 * change,
+                                 verdict)
+                  << std::endl;
+    }
+    return hasSlowdown;
+}
+
+static int run(const Options& options) {
+    std::optional<PerfCounters> counters;
+    if (options.counters) {
+        counters.emplace();
+        if (!counters->error().empty()) {
+            std::cerr << std::format("Warning: {} hardware counters unavailable ({}).",
+                                     counters->available() ? "Some" : "The",
+                                     counters->error())
+                      << std::endl;
+        }
+    }
+    std::vector<Result>  results;
+    std::vector<Latency> latencies;
+    for (const Workload& workload : loadWorkloads(options.workloadDirectory)) {
+        const Program program = compileWorkload(workload);
+        for (Result& result : runWorkload(options, workload, program, counters ? &*counters : nullptr)) {
+            results.push_back(std::move(result));
+        }
+        if (options.latency) {
+            for (Latency& latency : runLatencies(options, workload, program)) {
+                latencies.push_back(std::move(latency));
+            }
+        }
+    }
+    if (!options.jsonFile.empty()) {
+        writeJson(options.jsonFile, options, results, latencies);
+    }
+    if (!options.baselineFile.empty() && compareWithBaseline(options, results)) {
+        return 3;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        return run(parseOptions(argc, argv));
+    } catch (const ParseException& exception) {
+        std::cerr << std::format("Error: {} (at {}).", exception.message(), exception.where()) << std::endl;
+        return 1;
+    } catch (const Exception& exception) {
+        std::cerr << std::format("Error: {}.", exception.message()) << std::endl;
+        return 1;
+    }
+}
@@ -1,5 +1,6 @@
 #include "Asg.h"
 #include <algorithm>
+#include <cmath>
 #include <format>
 
 SIXPACK_NAMESPACE_BEGIN
@@ -18,22 +19,145 @@ int asg::Term::depth() const {
 StringView asg::Term::key() const {
     if (!mKey) {
         mKey = getKey();
+        // Note: The keys nest the keys of the subterms, i.e. they grow exponentially with the depth of the
+        //       subterms shared repeatedly (e.g. by the expression symbols using each other twice). The long
+        //       keys are therefore replaced by their 128-bit digest, keeping the keys of the parents short.
+        //       The digests may collide, see `isEquivalent`.
+        if (mKey->size() > MAX_KEY_SIZE) {
+            uint64_t forwardHash  = 0xCBF29CE484222325;
+            uint64_t backwardHash = 0x84222325CBF29CE4;
+            for (size_t i = 0; i < mKey->size(); ++i) {
+                forwardHash  = (forwardHash ^ uint8_t((*mKey)[i])) * 0x100000001B3;
+                backwardHash = (backwardHash ^ uint8_t((*mKey)[mKey->size() - 1 - i])) * 0x100000001B3;
+            }
+            mKey = std::format("#{:016x}{:016x}", forwardHash, backwardHash);
+        }
     }
     return *mKey;
 }
 
+bool asg::Term::isEquivalent(const Term& other) const {
+    if (this == &other) {
+        return true;
+    }
+    if (mKind != other.mKind || key() != other.key()) {
+        return false;
+    }
+    // Note: The keys nesting no digests are conclusive.
+    if (key().find('#') == StringView::npos) {
+        return true;
+    }
+
+    const auto isSame = [](const Term* t1, const Term* t2) { return t1->isEquivalent(*t2); };
+    // Note: The keys of the sequences and the group operations sort the keys of their terms; the terms are
+    //       therefore compared in that order.
+    const auto isSameUnordered = [&](std::vector<const Term*> terms, std::vector<const Term*> others) {
+        const auto byKey = [](const auto& t1, const auto& t2) { return t1->key() < t2->key(); };
+        std::stable_sort(terms.begin(), terms.end(), byKey);
+        std::stable_sort(others.begin(), others.end(), byKey);
+        return std::ranges::equal(terms, others, isSame);
+    };
+
+    switch (mKind) {
+    case Kind::SEQUENCE:
+        return isSameUnordered(as<Sequence>()->terms(), other.as<Sequence>()->terms());
+    case Kind::CONSTANT:
+        return as<Constant>()->value() == other.as<Constant>()->value();
+    case Kind::INPUT:
+        return as<Input>()->name() == other.as<Input>()->name();
+    case Kind::OUTPUT: {
+        const auto* output      = as<Output>();
+        const auto* otherOutput = other.as<Output>();
+        return output->name() == otherOutput->name() && isSame(output->term(), otherOutput->term());
+    }
+    case Kind::UNARY_FUNCTION: {
+        const auto* function      = as<UnaryFunction>();
+        const auto* otherFunction = other.as<UnaryFunction>();
+        return function->function() == otherFunction->function() &&
+               function->table() == otherFunction->table() &&
+               isSame(function->argument(), otherFunction->argument());
+    }
+    case Kind::BINARY_FUNCTION: {
+        const auto* function      = as<BinaryFunction>();
+        const auto* otherFunction = other.as<BinaryFunction>();
+        return function->function() == otherFunction->function() &&
+               isSame(function->firstArgument(), otherFunction->firstArgument()) &&
+               isSame(function->secondArgument(), otherFunction->secondArgument());
+    }
+    case Kind::COMPARISON: {
+        const auto* comparison      = as<Comparison>();
+        const auto* otherComparison = other.as<Comparison>();
+        return comparison->type() == otherComparison->type() &&
+               isSame(comparison->left(), otherComparison->left()) &&
+               isSame(comparison->right(), otherComparison->right());
+    }
+    case Kind::SELECTION: {
+        const auto* selection      = as<Selection>();
+        const auto* otherSelection = other.as<Selection>();
+        return isSame(selection->condition(), otherSelection->condition()) &&
+               isSame(selection->whenTrue(), otherSelection->whenTrue()) &&
+               isSame(selection->whenFalse(), otherSelection->whenFalse());
+    }
+    case Kind::ADDITION:
+    case Kind::MULTIPLICATION: {
+        const auto& operation      = static_cast<const GroupOperation&>(*this);
+        const auto& otherOperation = static_cast<const GroupOperation&>(other);
+        return operation.constantTerm()->value() == otherOperation.constantTerm()->value() &&
+               isSameUnordered(operation.positiveTerms(), otherOperation.positiveTerms()) &&
+               isSameUnordered(operation.negativeTerms(), otherOperation.negativeTerms());
+    }
+    case Kind::EXPONENTIATION: {
+        const auto* exponentiation      = as<Exponentiation>();
+        const auto* otherExponentiation = other.as<Exponentiation>();
+        return isSame(exponentiation->base(), otherExponentiation->base()) &&
+               isSame(exponentiation->exponent(), otherExponentiation->exponent());
+    }
+    case Kind::SQUARING:
+        return isSame(as<Squaring>()->base(), other.as<Squaring>()->base());
+    default:
+        assert(false);
+        return false;
+    }
+}
+
 bool asg::Term::canBeModified() const {
     return !mDepth && !mKey;
 }
 
+//============================================================================================================
+// Arena
+//============================================================================================================
+
+asg::Arena::~Arena() {
+    for (auto it = mTerms.rbegin(); it != mTerms.rend(); ++it) {
+        if (*it) {
+            (*it)->~Term();
+        }
+    }
+}
+
+void* asg::Arena::allocate(size_t size, size_t alignment) {
+    const size_t padding = size_t(-reinterpret_cast<uintptr_t>(mNext)) & (alignment - 1);
+    if (padding + size > mAvailable) {
+        // Note: The blocks are aligned to `std::max_align_t` (by `new`), i.e. need no padding.
+        mBlocks.push_back(std::make_unique_for_overwrite<std::byte[]>(BLOCK_SIZE));
+        mNext      = mBlocks.back().get();
+        mAvailable = BLOCK_SIZE;
+        return allocate(size, alignment);
+    }
+    void* const storage = mNext + padding;
+    mNext              += padding + size;
+    mAvailable         -= padding + size;
+    return storage;
+}
+
 //============================================================================================================
 // Sequence
 //============================================================================================================
 
-void asg::Sequence::addTerm(std::shared_ptr<const Term> term) {
-    assert(term);
+void asg::Sequence::addTerm(const Term* term) {
     assert(canBeModified());
-    mTerms.push_back(term);
+    mTerms.push_back(adopt(term));
 }
 
 std::optional<Real> asg::Sequence::evaluateConstant() const {
@@ -141,34 +265,128 @@ int asg::UnaryFunction::getDepth() const {
 }
 
 String asg::UnaryFunction::getKey() const {
-    return std::format("{:#x}({})", reinterpret_cast<uintptr_t>(mFunction), mArgument->key());
+    if (mTable) {
+        return std::format("{:#x}:{:#x}({})",
+                           reinterpret_cast<uintptr_t>(mFunction),
+                           reinterpret_cast<uintptr_t>(mTable.get()),
+                           mArgument->key());
+    } else {
+        return std::format("{:#x}({})", reinterpret_cast<uintptr_t>(mFunction), mArgument->key());
+    }
 }
 
 //============================================================================================================
-// GroupOperation
+// BinaryFunction
 //============================================================================================================
 
-asg::GroupOperation::GroupOperation(Real                        identity,
-                                    std::optional<Real>         nullElement,
-                                    std::shared_ptr<const Term> constantTerm)
-    : mIdentity(identity)
-    , mNullElement(nullElement)
-    , mConstantTerm(std::dynamic_pointer_cast<const Constant>(constantTerm)) {
-    if (!mConstantTerm) {
-        mConstantTerm = std::make_shared<Constant>(mIdentity);
+std::optional<Real> asg::BinaryFunction::evaluateConstant() const {
+    if (std::optional<Real> firstConstant = mFirstArgument->evaluateConstant()) {
+        if (std::optional<Real> secondConstant = mSecondArgument->evaluateConstant()) {
+            return mFunction(*firstConstant, *secondConstant);
+        }
     }
+    return std::nullopt;
 }
 
-void asg::GroupOperation::addPositiveTerm(std::shared_ptr<const Term> term) {
-    assert(term);
+void asg::BinaryFunction::accept(Visitor& visitor) const {
+    visitor.visit(*this);
+}
+
+int asg::BinaryFunction::getDepth() const {
+    return 1 + std::max(mFirstArgument->depth(), mSecondArgument->depth());
+}
+
+String asg::BinaryFunction::getKey() const {
+    return std::format("{:#x}({},{})",
+                       reinterpret_cast<uintptr_t>(mFunction),
+                       mFirstArgument->key(),
+                       mSecondArgument->key());
+}
+
+//============================================================================================================
+// Comparison
+//============================================================================================================
+
+bool asg::Comparison::apply(Real left, Real right) const {
+    switch (mType) {
+    // clang-format off
+    case Type::LESS:        return left <  right;
+    case Type::LESS_EQUALS: return left <= right;
+    case Type::EQUALS:      return left == right;
+    case Type::NOT_EQUALS:  return left != right;
+    // clang-format on
+    default:
+        assert(false);
+        return false;
+    }
+}
+
+std::optional<Real> asg::Comparison::evaluateConstant() const {
+    if (std::optional<Real> leftConstant = mLeft->evaluateConstant()) {
+        if (std::optional<Real> rightConstant = mRight->evaluateConstant()) {
+            return apply(*leftConstant, *rightConstant) ? 1.0 : 0.0;
+        }
+    }
+    return std::nullopt;
+}
+
+void asg::Comparison::accept(Visitor& visitor) const {
+    visitor.visit(*this);
+}
+
+int asg::Comparison::getDepth() const {
+    return 1 + std::max(mLeft->depth(), mRight->depth());
+}
+
+String asg::Comparison::getKey() const {
+    static constexpr StringView OPERATORS[] = { "<", "<=", "==", "!=" };
+    return std::format("({}){}({})", mLeft->key(), OPERATORS[int(mType)], mRight->key());
+}
+
+//============================================================================================================
+// Selection
+//============================================================================================================
+
+std::optional<Real> asg::Selection::evaluateConstant() const {
+    if (std::optional<Real> constantCondition = mCondition->evaluateConstant()) {
+        return (*constantCondition != 0.0 ? mWhenTrue : mWhenFalse)->evaluateConstant();
+    }
+    return std::nullopt;
+}
+
+void asg::Selection::accept(Visitor& visitor) const {
+    visitor.visit(*this);
+}
+
+int asg::Selection::getDepth() const {
+    return 1 + std::max({ mCondition->depth(), mWhenTrue->depth(), mWhenFalse->depth() });
+}
+
+String asg::Selection::getKey() const {
+    return std::format("if({},{},{})", mCondition->key(), mWhenTrue->key(), mWhenFalse->key());
+}
+
+//============================================================================================================
+// GroupOperation
+//============================================================================================================
+
+asg::GroupOperation::GroupOperation(Kind                kind,
+                                    Real                identity,
+                                    std::optional<Real> nullElement,
+                                    const Constant*     constantTerm)
+    : Term(kind)
+    , mIdentity(identity)
+    , mNullElement(nullElement)
+    , mConstantTerm(adopt(constantTerm)) {}
+
+void asg::GroupOperation::addPositiveTerm(const Term* term) {
     assert(canBeModified());
-    mPositiveTerms.push_back(std::move(term));
+    mPositiveTerms.push_back(adopt(term));
 }
 
-void asg::GroupOperation::addNegativeTerm(std::shared_ptr<const Term> term) {
-    assert(term);
+void asg::GroupOperation::addNegativeTerm(const Term* term) {
     assert(canBeModified());
-    mNegativeTerms.push_back(std::move(term));
+    mNegativeTerms.push_back(adopt(term));
 }
 
 std::optional<Real> asg::GroupOperation::evaluateConstant() const {
@@ -284,42 +502,56 @@ String asg::Squaring::getKey() const {
 // Transform
 //============================================================================================================
 
-std::shared_ptr<const asg::Term> asg::Transform::transform(const std::shared_ptr<const Term>& term) {
-
-    class TransformVisitor final : Visitor {
-        Transform&                  mSelf;
-        std::shared_ptr<const Term> mResult;
-
-        virtual void visit(const Sequence& term) override { mResult = mSelf.transformImpl(term); }
-        virtual void visit(const Constant& term) override { mResult = mSelf.transformImpl(term); }
-        virtual void visit(const Input& term) override { mResult = mSelf.transformImpl(term); }
-        virtual void visit(const Output& term) override { mResult = mSelf.transformImpl(term); }
-        virtual void visit(const UnaryFunction& term) override { mResult = mSelf.transformImpl(term); }
-        virtual void visit(const Addition& term) override { mResult = mSelf.transformImpl(term); }
-        virtual void visit(const Multiplication& term) override { mResult = mSelf.transformImpl(term); }
-        virtual void visit(const Exponentiation& term) override { mResult = mSelf.transformImpl(term); }
-        virtual void visit(const Squaring& term) override { mResult = mSelf.transformImpl(term); }
-
-    public:
-        explicit TransformVisitor(Transform& self)
-            : mSelf(self) {}
-
-        std::shared_ptr<const Term>&& visit(const Term& term) && {
-            term.accept(*this);
-            assert(mResult);
-            if (term.sourceNode() && !mResult->sourceNode()) {
-                const_cast<Term&>(*mResult).setSourceNode(term.sourceNode());
-            }
-            return std::move(mResult);
-        }
-    };
-
+const asg::Term* asg::Transform::transform(const Term* term) {
     assert(term);
     const auto termIt = mTransformedTerms.find(term);
     if (termIt != mTransformedTerms.end()) {
         return termIt->second;
     }
-    std::shared_ptr<const Term> transformedTerm = coalesceImpl(TransformVisitor(*this).visit(*term));
+    const Term* result = nullptr;
+    switch (term->kind()) {
+    case Term::Kind::SEQUENCE:
+        result = transformImpl(static_cast<const Sequence&>(*term));
+        break;
+    case Term::Kind::CONSTANT:
+        result = transformImpl(static_cast<const Constant&>(*term));
+        break;
+    case Term::Kind::INPUT:
+        result = transformImpl(static_cast<const Input&>(*term));
+        break;
+    case Term::Kind::OUTPUT:
+        result = transformImpl(static_cast<const Output&>(*term));
+        break;
+    case Term::Kind::UNARY_FUNCTION:
+        result = transformImpl(static_cast<const UnaryFunction&>(*term));
+        break;
+    case Term::Kind::BINARY_FUNCTION:
+        result = transformImpl(static_cast<const BinaryFunction&>(*term));
+        break;
+    case Term::Kind::COMPARISON:
+        result = transformImpl(static_cast<const Comparison&>(*term));
+        break;
+    case Term::Kind::SELECTION:
+        result = transformImpl(static_cast<const Selection&>(*term));
+        break;
+    case Term::Kind::ADDITION:
+        result = transformImpl(static_cast<const Addition&>(*term));
+        break;
+    case Term::Kind::MULTIPLICATION:
+        result = transformImpl(static_cast<const Multiplication&>(*term));
+        break;
+    case Term::Kind::EXPONENTIATION:
+        result = transformImpl(static_cast<const Exponentiation&>(*term));
+        break;
+    case Term::Kind::SQUARING:
+        result = transformImpl(static_cast<const Squaring&>(*term));
+        break;
+    }
+    assert(result);
+    if (term->sourceNode() && !result->sourceNode()) {
+        const_cast<Term&>(*result).setSourceNode(term->sourceNode());
+    }
+    const Term* const transformedTerm = coalesceImpl(result);
     mTransformedTerms.insert({ term, transformedTerm });
     return transformedTerm;
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "Common.h"
+#include <cstddef>
 #include <memory>
 #include <optional>
 #include <unordered_map>
@@ -10,6 +11,7 @@ SIXPACK_NAMESPACE_BEGIN
 namespace ast {
     class Node;
 }
+class FunctionTable;
 
 /// Abstract Semantic Graph (ASG)
 namespace asg {
@@ -17,17 +19,64 @@ namespace asg {
     class Visitor;
 
     /// The abstract base class of an ASG term.
-    class Term : public std::enable_shared_from_this<Term> {
+    ///
+    /// The terms are constructed in an `Arena` (see `Arena::make`) and refer to their subterms by plain
+    /// pointers, i.e. all the terms of a compilation live as long as its arena.
+    class Term {
+    public:
+        /// The concrete class of a term, i.e. the transforms and the code generation dispatch on the kind
+        /// rather than through RTTI.
+        enum class Kind : uint8_t {
+            SEQUENCE,
+            CONSTANT,
+            INPUT,
+            OUTPUT,
+            UNARY_FUNCTION,
+            BINARY_FUNCTION,
+            COMPARISON,
+            SELECTION,
+            ADDITION,
+            MULTIPLICATION,
+            EXPONENTIATION,
+            SQUARING
+        };
+
+    private:
         mutable std::optional<int>    mDepth;
         mutable std::optional<String> mKey;
-        const ast::Node*              mSourceNode = nullptr;
+        mutable uint32_t              mParentCount = 0;
+        const ast::Node*              mSourceNode  = nullptr;
+        const Kind                    mKind;
 
     public:
         virtual ~Term() = default;
 
+        Kind kind() const { return mKind; }
+
+        /// Returns the term as the given (final) class, or nullptr if of another kind.
+        template <typename T>
+        const T* as() const {
+            return mKind == T::KIND ? static_cast<const T*>(this) : nullptr;
+        }
+
+        /// The longest key kept verbatim; the longer ones are replaced by their digest (i.e. '#' and 32 hex
+        /// digits), which may collide, i.e. the equal digests are verified by `isEquivalent`.
+        static constexpr size_t MAX_KEY_SIZE = 1024;
+
         int        depth() const;
         StringView key() const;
 
+        /// Returns whether the terms are structurally equal. The equal keys are conclusive unless they
+        /// contain digests, which are confirmed by comparing the subterms (usually the same ones after
+        /// `Merge`).
+        bool isEquivalent(const Term& other) const;
+
+        /// Returns the number of the terms constructed on this one, i.e. whether the term is shared.
+        ///
+        /// Note: The terms are never destroyed before their arena, i.e. the count includes the parents
+        ///       discarded by the transforms. It is exact for the graphs built from the expressions.
+        uint32_t parentCount() const { return mParentCount; }
+
         const ast::Node* sourceNode() const { return mSourceNode; }
         void             setSourceNode(const ast::Node* sourceNode) { mSourceNode = sourceNode; }
 
@@ -36,18 +85,67 @@ namespace asg {
         virtual void accept(Visitor& visitor) const = 0;
 
     protected:
+        explicit Term(Kind kind)
+            : mKind(kind) {}
+
         virtual int    getDepth() const = 0;
         virtual String getKey() const   = 0;
         bool           canBeModified() const;
+
+        /// Counts the parent being constructed on the (subterm) term, which is returned.
+        template <typename T>
+        static const T* adopt(const T* term) {
+            assert(term);
+            ++term->mParentCount;
+            return term;
+        }
+    };
+
+    /// The storage of the terms of a compilation, i.e. with no allocation (nor reference counting) per term.
+    /// The terms are destroyed with the arena, i.e. they refer to their subterms by plain pointers.
+    class Arena {
+        static constexpr size_t BLOCK_SIZE = 16384;
+
+        std::vector<std::unique_ptr<std::byte[]>> mBlocks;
+        std::byte*                                mNext      = nullptr;
+        size_t                                    mAvailable = 0;
+        std::vector<Term*>                        mTerms; // in the order of their construction (to destroy)
+
+    public:
+        Arena() = default;
+        ~Arena();
+
+        Arena(const Arena&)            = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        /// Constructs a term in the arena.
+        template <typename T, typename... TArgs>
+        T* make(TArgs&&... args) {
+            static_assert(std::is_base_of_v<Term, T>);
+            static_assert(sizeof(T) <= BLOCK_SIZE && alignof(T) <= alignof(std::max_align_t));
+            void* const storage = allocate(sizeof(T), alignof(T));
+            mTerms.push_back(nullptr); // i.e. the term failing to construct is not destroyed
+            T* const term = new (storage) T(std::forward<TArgs>(args)...);
+            mTerms.back() = term;
+            return term;
+        }
+
+    private:
+        void* allocate(size_t size, size_t alignment);
     };
 
     class Sequence final : public Term {
-        std::vector<std::shared_ptr<const Term>> mTerms;
+        std::vector<const Term*> mTerms;
 
     public:
-        const std::vector<std::shared_ptr<const Term>>& terms() const { return mTerms; }
+        static constexpr Kind KIND = Kind::SEQUENCE;
+
+        Sequence()
+            : Term(KIND) {}
 
-        void addTerm(std::shared_ptr<const Term> term);
+        const std::vector<const Term*>& terms() const { return mTerms; }
+
+        void addTerm(const Term* term);
 
         virtual std::optional<Real> evaluateConstant() const override;
 
@@ -65,8 +163,11 @@ namespace asg {
         const Real mValue;
 
     public:
+        static constexpr Kind KIND = Kind::CONSTANT;
+
         explicit Constant(Real value)
-            : mValue(value == 0.0 ? 0.0 : value) {} // convert -0 to +0
+            : Term(KIND)
+            , mValue(value == 0.0 ? 0.0 : value) {} // convert -0 to +0
 
         Real value() const { return mValue; }
 
@@ -83,8 +184,11 @@ namespace asg {
         const String mName;
 
     public:
+        static constexpr Kind KIND = Kind::INPUT;
+
         explicit Input(StringView name)
-            : mName(name) {}
+            : Term(KIND)
+            , mName(name) {}
 
         StringView name() const { return mName; }
 
@@ -98,16 +202,19 @@ namespace asg {
     };
 
     class Output final : public Term {
-        const String                mName;
-        std::shared_ptr<const Term> mTerm;
+        const String mName;
+        const Term*  mTerm;
 
     public:
-        Output(StringView name, std::shared_ptr<const Term> term)
-            : mName(std::move(name))
-            , mTerm(std::move(term)) {}
+        static constexpr Kind KIND = Kind::OUTPUT;
+
+        Output(StringView name, const Term* term)
+            : Term(KIND)
+            , mName(std::move(name))
+            , mTerm(adopt(term)) {}
 
-        StringView                         name() const { return mName; }
-        const std::shared_ptr<const Term>& term() const { return mTerm; }
+        StringView  name() const { return mName; }
+        const Term* term() const { return mTerm; }
 
         virtual std::optional<Real> evaluateConstant() const override;
 
@@ -119,19 +226,131 @@ namespace asg {
     };
 
     class UnaryFunction final : public Term {
-        const RealFunction                mFunction;
-        const std::shared_ptr<const Term> mArgument;
+        const RealFunction                         mFunction;
+        const Term*                                mArgument;
+        const BatchFunction                        mBatchFunction;
+        const std::shared_ptr<const FunctionTable> mTable;
 
     public:
-        explicit UnaryFunction(RealFunction function, std::shared_ptr<const Term> argument)
-            : mFunction(function)
-            , mArgument(std::move(argument)) {
+        static constexpr Kind KIND = Kind::UNARY_FUNCTION;
+
+        /// Note: The batch function and the table (both optional) are alternative implementations of the
+        ///       function; the batch function is therefore not part of the term's key.
+        explicit UnaryFunction(RealFunction                         function,
+                               const Term*                          argument,
+                               BatchFunction                        batchFunction = nullptr,
+                               std::shared_ptr<const FunctionTable> table         = {})
+            : Term(KIND)
+            , mFunction(function)
+            , mArgument(adopt(argument))
+            , mBatchFunction(batchFunction)
+            , mTable(std::move(table)) {
+            assert(mFunction);
+        }
+
+        RealFunction                                function() const { return mFunction; }
+        const Term*                                 argument() const { return mArgument; }
+        BatchFunction                               batchFunction() const { return mBatchFunction; }
+        const std::shared_ptr<const FunctionTable>& table() const { return mTable; }
+
+        virtual std::optional<Real> evaluateConstant() const override;
+
+        virtual void accept(Visitor& visitor) const override;
+
+    private:
+        virtual int    getDepth() const override;
+        virtual String getKey() const override;
+    };
+
+    class BinaryFunction final : public Term {
+        const BinaryRealFunction mFunction;
+        const Term*              mFirstArgument;
+        const Term*              mSecondArgument;
+
+    public:
+        static constexpr Kind KIND = Kind::BINARY_FUNCTION;
+
+        BinaryFunction(BinaryRealFunction function, const Term* firstArgument, const Term* secondArgument)
+            : Term(KIND)
+            , mFunction(function)
+            , mFirstArgument(adopt(firstArgument))
+            , mSecondArgument(adopt(secondArgument)) {
             assert(mFunction);
-            assert(mArgument);
         }
 
-        RealFunction                       function() const { return mFunction; }
-        const std::shared_ptr<const Term>& argument() const { return mArgument; }
+        BinaryRealFunction function() const { return mFunction; }
+        const Term*        firstArgument() const { return mFirstArgument; }
+        const Term*        secondArgument() const { return mSecondArgument; }
+
+        virtual std::optional<Real> evaluateConstant() const override;
+
+        virtual void accept(Visitor& visitor) const override;
+
+    private:
+        virtual int    getDepth() const override;
+        virtual String getKey() const override;
+    };
+
+    // Conditional Operations
+    //========================================================================================================
+
+    /// The comparison of two terms evaluating to `1` (true) or `0` (false).
+    class Comparison final : public Term {
+    public:
+        enum class Type {
+            LESS,        // left <  right
+            LESS_EQUALS, // left <= right
+            EQUALS,      // left == right
+            NOT_EQUALS   // left != right
+        };
+
+    private:
+        const Type  mType;
+        const Term* mLeft;
+        const Term* mRight;
+
+    public:
+        static constexpr Kind KIND = Kind::COMPARISON;
+
+        Comparison(Type type, const Term* left, const Term* right)
+            : Term(KIND)
+            , mType(type)
+            , mLeft(adopt(left))
+            , mRight(adopt(right)) {}
+
+        Type        type() const { return mType; }
+        const Term* left() const { return mLeft; }
+        const Term* right() const { return mRight; }
+
+        bool apply(Real left, Real right) const;
+
+        virtual std::optional<Real> evaluateConstant() const override;
+
+        virtual void accept(Visitor& visitor) const override;
+
+    private:
+        virtual int    getDepth() const override;
+        virtual String getKey() const override;
+    };
+
+    /// The selection of one of two terms by a condition, any non-zero value (including NaN) being true.
+    class Selection final : public Term {
+        const Term* mCondition;
+        const Term* mWhenTrue;
+        const Term* mWhenFalse;
+
+    public:
+        static constexpr Kind KIND = Kind::SELECTION;
+
+        Selection(const Term* condition, const Term* whenTrue, const Term* whenFalse)
+            : Term(KIND)
+            , mCondition(adopt(condition))
+            , mWhenTrue(adopt(whenTrue))
+            , mWhenFalse(adopt(whenFalse)) {}
+
+        const Term* condition() const { return mCondition; }
+        const Term* whenTrue() const { return mWhenTrue; }
+        const Term* whenFalse() const { return mWhenFalse; }
 
         virtual std::optional<Real> evaluateConstant() const override;
 
@@ -149,22 +368,23 @@ namespace asg {
         const Real                mIdentity;
         const std::optional<Real> mNullElement;
 
-        std::shared_ptr<const Constant>          mConstantTerm;
-        std::vector<std::shared_ptr<const Term>> mPositiveTerms;
-        std::vector<std::shared_ptr<const Term>> mNegativeTerms;
+        const Constant*          mConstantTerm;
+        std::vector<const Term*> mPositiveTerms;
+        std::vector<const Term*> mNegativeTerms;
 
     protected:
-        GroupOperation(Real                        identity,
-                       std::optional<Real>         nullElement,
-                       std::shared_ptr<const Term> constantTerm = {});
+        GroupOperation(Kind                kind,
+                       Real                identity,
+                       std::optional<Real> nullElement,
+                       const Constant*     constantTerm);
 
     public:
-        const std::shared_ptr<const Constant>&          constantTerm() const { return mConstantTerm; }
-        const std::vector<std::shared_ptr<const Term>>& positiveTerms() const { return mPositiveTerms; }
-        const std::vector<std::shared_ptr<const Term>>& negativeTerms() const { return mNegativeTerms; }
+        const Constant*                 constantTerm() const { return mConstantTerm; }
+        const std::vector<const Term*>& positiveTerms() const { return mPositiveTerms; }
+        const std::vector<const Term*>& negativeTerms() const { return mNegativeTerms; }
 
-        void addPositiveTerm(std::shared_ptr<const Term> term);
-        void addNegativeTerm(std::shared_ptr<const Term> term);
+        void addPositiveTerm(const Term* term);
+        void addNegativeTerm(const Term* term);
 
         Real                       identity() const { return mIdentity; }
         const std::optional<Real>& nullElement() const { return mNullElement; }
@@ -182,8 +402,10 @@ namespace asg {
 
     class Addition final : public GroupOperation {
     public:
-        explicit Addition(std::shared_ptr<const Term> constantTerm = {})
-            : GroupOperation(0.0, std::nullopt, std::move(constantTerm)) {}
+        static constexpr Kind KIND = Kind::ADDITION;
+
+        explicit Addition(const Constant* constantTerm)
+            : GroupOperation(KIND, 0.0, std::nullopt, constantTerm) {}
 
         virtual void accept(Visitor& visitor) const override;
 
@@ -194,8 +416,10 @@ namespace asg {
 
     class Multiplication final : public GroupOperation {
     public:
-        explicit Multiplication(std::shared_ptr<const Term> constantTerm = {})
-            : GroupOperation(1.0, 0.0, std::move(constantTerm)) {}
+        static constexpr Kind KIND = Kind::MULTIPLICATION;
+
+        explicit Multiplication(const Constant* constantTerm)
+            : GroupOperation(KIND, 1.0, 0.0, constantTerm) {}
 
         virtual void accept(Visitor& visitor) const override;
 
@@ -208,16 +432,19 @@ namespace asg {
     //========================================================================================================
 
     class Exponentiation final : public Term {
-        std::shared_ptr<const Term> mBase;
-        std::shared_ptr<const Term> mExponent;
+        const Term* mBase;
+        const Term* mExponent;
 
     public:
-        Exponentiation(std::shared_ptr<const Term> base, std::shared_ptr<const Term> exponent)
-            : mBase(std::move(base))
-            , mExponent(std::move(exponent)) {}
+        static constexpr Kind KIND = Kind::EXPONENTIATION;
 
-        const std::shared_ptr<const Term>& base() const { return mBase; }
-        const std::shared_ptr<const Term>& exponent() const { return mExponent; }
+        Exponentiation(const Term* base, const Term* exponent)
+            : Term(KIND)
+            , mBase(adopt(base))
+            , mExponent(adopt(exponent)) {}
+
+        const Term* base() const { return mBase; }
+        const Term* exponent() const { return mExponent; }
 
         virtual std::optional<Real> evaluateConstant() const override;
 
@@ -229,13 +456,16 @@ namespace asg {
     };
 
     class Squaring final : public Term {
-        std::shared_ptr<const Term> mBase;
+        const Term* mBase;
 
     public:
-        explicit Squaring(std::shared_ptr<const Term> base)
-            : mBase(std::move(base)) {}
+        static constexpr Kind KIND = Kind::SQUARING;
+
+        explicit Squaring(const Term* base)
+            : Term(KIND)
+            , mBase(adopt(base)) {}
 
-        const std::shared_ptr<const Term>& base() const { return mBase; }
+        const Term* base() const { return mBase; }
 
         virtual std::optional<Real> evaluateConstant() const override;
 
@@ -258,6 +488,9 @@ namespace asg {
         virtual void visit(const Input& term)          = 0;
         virtual void visit(const Output& term)         = 0;
         virtual void visit(const UnaryFunction& term)  = 0;
+        virtual void visit(const BinaryFunction& term) = 0;
+        virtual void visit(const Comparison& term)     = 0;
+        virtual void visit(const Selection& term)      = 0;
         virtual void visit(const Addition& term)       = 0;
         virtual void visit(const Multiplication& term) = 0;
         virtual void visit(const Exponentiation& term) = 0;
@@ -265,23 +498,34 @@ namespace asg {
     };
 
     class Transform {
-        std::unordered_map<std::shared_ptr<const Term>, std::shared_ptr<const Term>> mTransformedTerms;
+        Arena&                                       mArena;
+        std::unordered_map<const Term*, const Term*> mTransformedTerms;
 
     public:
-        std::shared_ptr<const Term> transform(const std::shared_ptr<const Term>& term);
+        /// The transformed terms are constructed in the arena (usually the one of the original terms).
+        explicit Transform(Arena& arena)
+            : mArena(arena) {}
+
+        const Term* transform(const Term* term);
+
+    protected:
+        Arena& arena() const { return mArena; }
 
     private:
-        virtual std::shared_ptr<const Term> transformImpl(const Sequence& term)       = 0;
-        virtual std::shared_ptr<const Term> transformImpl(const Constant& term)       = 0;
-        virtual std::shared_ptr<const Term> transformImpl(const Input& term)          = 0;
-        virtual std::shared_ptr<const Term> transformImpl(const Output& term)         = 0;
-        virtual std::shared_ptr<const Term> transformImpl(const UnaryFunction& term)  = 0;
-        virtual std::shared_ptr<const Term> transformImpl(const Addition& term)       = 0;
-        virtual std::shared_ptr<const Term> transformImpl(const Multiplication& term) = 0;
-        virtual std::shared_ptr<const Term> transformImpl(const Exponentiation& term) = 0;
-        virtual std::shared_ptr<const Term> transformImpl(const Squaring& term)       = 0;
-
-        virtual std::shared_ptr<const Term> coalesceImpl(std::shared_ptr<const Term> term) = 0;
+        virtual const Term* transformImpl(const Sequence& term)       = 0;
+        virtual const Term* transformImpl(const Constant& term)       = 0;
+        virtual const Term* transformImpl(const Input& term)          = 0;
+        virtual const Term* transformImpl(const Output& term)         = 0;
+        virtual const Term* transformImpl(const UnaryFunction& term)  = 0;
+        virtual const Term* transformImpl(const BinaryFunction& term) = 0;
+        virtual const Term* transformImpl(const Comparison& term)     = 0;
+        virtual const Term* transformImpl(const Selection& term)      = 0;
+        virtual const Term* transformImpl(const Addition& term)       = 0;
+        virtual const Term* transformImpl(const Multiplication& term) = 0;
+        virtual const Term* transformImpl(const Exponentiation& term) = 0;
+        virtual const Term* transformImpl(const Squaring& term)       = 0;
+
+        virtual const Term* coalesceImpl(const Term* term) = 0;
     };
 
 } // namespace asg
@@ -1,6 +1,7 @@
 #pragma once
 #include "Asg.h"
 #include <algorithm>
+#include <cmath>
 #include <unordered_set>
 
 SIXPACK_NAMESPACE_BEGIN
@@ -13,28 +14,43 @@ namespace asg {
 
     class Identity : public Transform {
     protected:
-        std::shared_ptr<const Term> transformImpl(const Sequence& term) {
-            auto transformed = std::make_shared<Sequence>();
+        const Term* transformImpl(const Sequence& term) {
+            auto* transformed = arena().make<Sequence>();
             for (const auto& t : term.terms()) {
                 transformed->addTerm(transform(t));
             }
             return transformed;
         }
 
-        std::shared_ptr<const Term> transformImpl(const Constant& term) { return term.shared_from_this(); }
+        const Term* transformImpl(const Constant& term) { return &term; }
 
-        std::shared_ptr<const Term> transformImpl(const Input& term) { return term.shared_from_this(); }
+        const Term* transformImpl(const Input& term) { return &term; }
 
-        std::shared_ptr<const Term> transformImpl(const Output& term) {
-            return std::make_shared<Output>(term.name(), transform(term.term()));
+        const Term* transformImpl(const Output& term) {
+            return arena().make<Output>(term.name(), transform(term.term()));
         }
 
-        std::shared_ptr<const Term> transformImpl(const UnaryFunction& term) {
-            return std::make_shared<UnaryFunction>(term.function(), transform(term.argument()));
+        const Term* transformImpl(const UnaryFunction& term) {
+            return arena().make<UnaryFunction>(
+                term.function(), transform(term.argument()), term.batchFunction(), term.table());
         }
 
-        std::shared_ptr<const Term> transformImpl(const Addition& term) {
-            auto transformed = std::make_shared<Addition>(transform(term.constantTerm()));
+        const Term* transformImpl(const BinaryFunction& term) {
+            return arena().make<BinaryFunction>(
+                term.function(), transform(term.firstArgument()), transform(term.secondArgument()));
+        }
+
+        const Term* transformImpl(const Comparison& term) {
+            return arena().make<Comparison>(term.type(), transform(term.left()), transform(term.right()));
+        }
+
+        const Term* transformImpl(const Selection& term) {
+            return arena().make<Selection>(
+                transform(term.condition()), transform(term.whenTrue()), transform(term.whenFalse()));
+        }
+
+        const Term* transformImpl(const Addition& term) {
+            auto* transformed = arena().make<Addition>(transformConstant(*term.constantTerm()));
             for (const auto& t : term.positiveTerms()) {
                 transformed->addPositiveTerm(transform(t));
             }
@@ -44,8 +60,8 @@ namespace asg {
             return transformed;
         }
 
-        std::shared_ptr<const Term> transformImpl(const Multiplication& term) {
-            auto transformed = std::make_shared<Multiplication>(transform(term.constantTerm()));
+        const Term* transformImpl(const Multiplication& term) {
+            auto* transformed = arena().make<Multiplication>(transformConstant(*term.constantTerm()));
             for (const auto& t : term.positiveTerms()) {
                 transformed->addPositiveTerm(transform(t));
             }
@@ -55,29 +71,53 @@ namespace asg {
             return transformed;
         }
 
-        std::shared_ptr<const Term> transformImpl(const Exponentiation& term) {
-            return std::make_shared<Exponentiation>(transform(term.base()), transform(term.exponent()));
+        const Term* transformImpl(const Exponentiation& term) {
+            return arena().make<Exponentiation>(transform(term.base()), transform(term.exponent()));
         }
 
-        std::shared_ptr<const Term> transformImpl(const Squaring& term) {
-            return std::make_shared<Squaring>(transform(term.base()));
+        const Term* transformImpl(const Squaring& term) {
+            return arena().make<Squaring>(transform(term.base()));
         }
 
-        std::shared_ptr<const Term> coalesceImpl(std::shared_ptr<const Term> term) { return term; }
+        const Term* coalesceImpl(const Term* term) { return term; }
+
+        /// Transforms the constant (term) of a group operation, i.e. the transforms keep the constants.
+        const Constant* transformConstant(const Constant& constant) {
+            const auto* transformed = transform(&constant)->as<Constant>();
+            assert(transformed);
+            return transformed;
+        }
+
+    public:
+        using Transform::Transform;
     };
 
     class Merge : public Identity {
-        std::unordered_map<StringView, std::weak_ptr<const Term>> mTerms;
+        std::unordered_map<StringView, const Term*> mTerms;
+        uint64_t                                    mLookupCount = 0;
+        uint64_t                                    mHitCount    = 0;
+
+    public:
+        using Identity::Identity;
+
+        /// The number of the coalesced terms, and of those replaced by an equal term merged before.
+        uint64_t lookupCount() const { return mLookupCount; }
+        uint64_t hitCount() const { return mHitCount; }
 
     protected:
-        std::shared_ptr<const Term> coalesceImpl(std::shared_ptr<const Term> term) {
-            std::weak_ptr<const Term>& cachedTerm = mTerms[term->key()];
-            auto                       uniqueTerm = cachedTerm.lock();
+        const Term* coalesceImpl(const Term* term) {
+            const Term*& uniqueTerm = mTerms[term->key()];
+            ++mLookupCount;
             if (!uniqueTerm) {
-                uniqueTerm = std::move(term);
-                cachedTerm = uniqueTerm;
-            } else if (!uniqueTerm->sourceNode() && term->sourceNode()) {
-                const_cast<Term&>(*uniqueTerm).setSourceNode(term->sourceNode());
+                uniqueTerm = term;
+            } else if (!uniqueTerm->isEquivalent(*term)) {
+                // Note: The digests of the long keys collide (most improbably), the term is kept unmerged.
+                return term;
+            } else {
+                ++mHitCount;
+                if (!uniqueTerm->sourceNode() && term->sourceNode()) {
+                    const_cast<Term&>(*uniqueTerm).setSourceNode(term->sourceNode());
+                }
             }
             return uniqueTerm;
         }
@@ -92,7 +132,7 @@ namespace asg {
 
     protected:
         template <typename T>
-        std::shared_ptr<const Term> transformNext(const T& term) {
+        const Term* transformNext(const T& term) {
             return TTransform::transformImpl(term);
         }
 
@@ -103,13 +143,13 @@ namespace asg {
     template <typename TTransform>
     class ConstEvaluated : public TransformOperator<TTransform> {
     protected:
-        std::shared_ptr<const Term> coalesceImpl(std::shared_ptr<const Term> term) {
+        const Term* coalesceImpl(const Term* term) {
             if (std::optional<double> constantValue = term->evaluateConstant()) {
-                auto constant = std::make_shared<Constant>(*constantValue);
+                auto* constant = this->arena().template make<Constant>(*constantValue);
                 constant->setSourceNode(term->sourceNode());
-                term = std::move(constant);
+                term = constant;
             }
-            return TTransform::coalesceImpl(std::move(term));
+            return TTransform::coalesceImpl(term);
         }
 
     public:
@@ -120,45 +160,46 @@ namespace asg {
     class Grouped : public TransformOperator<TTransform> {
 
         template <typename TOperation>
-        std::shared_ptr<const Term> groupTerms(const TOperation& operation) {
+        const Term* groupTerms(const TOperation& operation) {
             const auto appendTerms = [](auto& to, const auto& from) {
                 to.insert(to.end(), from.begin(), from.end());
             };
 
-            Real                                     constantValue = operation.constantTerm()->value();
-            std::vector<std::shared_ptr<const Term>> positiveTerms;
-            std::vector<std::shared_ptr<const Term>> negativeTerms;
+            Real                     constantValue = operation.constantTerm()->value();
+            std::vector<const Term*> positiveTerms;
+            std::vector<const Term*> negativeTerms;
             for (const auto& term : operation.positiveTerms()) {
-                auto transformedTerm = this->transform(term);
-                if (const auto* constant = dynamic_cast<const Constant*>(transformedTerm.get())) {
+                const Term* transformedTerm = this->transform(term);
+                if (const auto* constant = transformedTerm->as<Constant>()) {
                     constantValue = operation.apply(constantValue, constant->value());
-                } else if (const auto* sibling = dynamic_cast<const TOperation*>(transformedTerm.get())) {
+                } else if (const auto* sibling = transformedTerm->as<TOperation>()) {
                     constantValue = operation.apply(constantValue, sibling->constantTerm()->value());
                     appendTerms(positiveTerms, sibling->positiveTerms());
                     appendTerms(negativeTerms, sibling->negativeTerms());
                 } else {
-                    positiveTerms.push_back(std::move(transformedTerm));
+                    positiveTerms.push_back(transformedTerm);
                 }
             }
             for (const auto& term : operation.negativeTerms()) {
-                auto transformedTerm = this->transform(term);
-                if (const auto* constant = dynamic_cast<const Constant*>(transformedTerm.get())) {
+                const Term* transformedTerm = this->transform(term);
+                if (const auto* constant = transformedTerm->as<Constant>()) {
                     constantValue = operation.applyInverse(constantValue, constant->value());
-                } else if (const auto* sibling = dynamic_cast<const TOperation*>(transformedTerm.get())) {
+                } else if (const auto* sibling = transformedTerm->as<TOperation>()) {
                     constantValue = operation.applyInverse(constantValue, sibling->constantTerm()->value());
                     appendTerms(positiveTerms, sibling->negativeTerms());
                     appendTerms(negativeTerms, sibling->positiveTerms());
                 } else {
-                    negativeTerms.push_back(std::move(transformedTerm));
+                    negativeTerms.push_back(transformedTerm);
                 }
             }
-            auto grouped =
-                std::make_shared<TOperation>(this->transform(std::make_shared<Constant>(constantValue)));
-            for (auto& term : positiveTerms) {
-                grouped->addPositiveTerm(std::move(term));
+            auto& arena   = this->arena();
+            auto* grouped = arena.template make<TOperation>(
+                this->transformConstant(*arena.template make<Constant>(constantValue)));
+            for (const Term* term : positiveTerms) {
+                grouped->addPositiveTerm(term);
             }
-            for (auto& term : negativeTerms) {
-                grouped->addNegativeTerm(std::move(term));
+            for (const Term* term : negativeTerms) {
+                grouped->addNegativeTerm(term);
             }
             return this->transformNext(*grouped);
         }
@@ -166,28 +207,28 @@ namespace asg {
     protected:
         using TTransform::transformImpl;
 
-        std::shared_ptr<const Term> transformImpl(const Sequence& term) {
+        const Term* transformImpl(const Sequence& term) {
             // Expand nested sequences: (a,b),(c,d) -> a,b,c,d
-            auto transformed = std::make_shared<Sequence>();
+            auto* transformed = this->arena().template make<Sequence>();
             for (const auto& t : term.terms()) {
-                auto transformedTerm = this->transform(t);
-                if (const auto* sequence = dynamic_cast<const Sequence*>(t.get())) {
+                const Term* transformedTerm = this->transform(t);
+                if (const auto* sequence = t->as<Sequence>()) {
                     for (const auto& nestedTerm : sequence->terms()) {
                         transformed->addTerm(nestedTerm);
                     }
                 } else {
-                    transformed->addTerm(std::move(transformedTerm));
+                    transformed->addTerm(transformedTerm);
                 }
             }
             return this->transformNext(*transformed);
         }
 
-        std::shared_ptr<const Term> transformImpl(const Addition& term) {
+        const Term* transformImpl(const Addition& term) {
             // Group terms and constants: (a+2)-(c-(3+b)) -> 5+a+b-c
             return groupTerms(term);
         }
 
-        std::shared_ptr<const Term> transformImpl(const Multiplication& term) {
+        const Term* transformImpl(const Multiplication& term) {
             // Group terms and constants: (a*2)/(c/(3*b)) -> 5*a*b/c
             return groupTerms(term);
         }
@@ -200,12 +241,12 @@ namespace asg {
     class Reduced : public TransformOperator<TTransform> {
 
         template <typename TOperation>
-        std::shared_ptr<const Term> reduceGroupTerms(const TOperation& operation, const auto& fuseOperator) {
+        const Term* reduceGroupTerms(const TOperation& operation, const auto& fuseOperator) {
             // Null element constant -> null element.
             if (operation.constantTerm()->value() == operation.nullElement()) {
                 return this->transform(operation.constantTerm());
             }
-            std::unordered_map<std::shared_ptr<const Term>, int> terms;
+            std::unordered_map<const Term*, int> terms;
             for (const auto& term : operation.positiveTerms()) {
                 const auto transformedTerm = this->transform(term);
                 ++terms[transformedTerm];
@@ -222,14 +263,14 @@ namespace asg {
                 operation.constantTerm()->value() == operation.identity()) {
                 return terms.begin()->first;
             }
-            std::vector<std::shared_ptr<const Term>> positiveTerms;
-            std::vector<std::shared_ptr<const Term>> negativeTerms;
+            std::vector<const Term*> positiveTerms;
+            std::vector<const Term*> negativeTerms;
             for (const auto& [term, weight] : terms) {
                 const int count  = std::abs(weight);
                 auto&     output = weight > 0 ? positiveTerms : negativeTerms;
                 if (count > 1) {
-                    if (auto fusedTerm = fuseOperator(term, count)) {
-                        output.push_back(this->transform(std::move(fusedTerm)));
+                    if (const Term* fusedTerm = fuseOperator(term, count)) {
+                        output.push_back(this->transform(fusedTerm));
                         continue;
                     }
                 }
@@ -246,12 +287,13 @@ namespace asg {
                 return t1->key().size() == t2->key().size() ? t1->key() < t2->key()
                                                             : t1->key().size() < t2->key().size();
             });
-            auto reduced = std::make_shared<TOperation>(this->transform(operation.constantTerm()));
-            for (auto& t : positiveTerms) {
-                reduced->addPositiveTerm(std::move(t));
+            auto* reduced =
+                this->arena().template make<TOperation>(this->transformConstant(*operation.constantTerm()));
+            for (const Term* t : positiveTerms) {
+                reduced->addPositiveTerm(t);
             }
-            for (auto& t : negativeTerms) {
-                reduced->addNegativeTerm(std::move(t));
+            for (const Term* t : negativeTerms) {
+                reduced->addNegativeTerm(t);
             }
             return this->transformNext(*reduced);
         }
@@ -259,57 +301,56 @@ namespace asg {
     protected:
         using TTransform::transformImpl;
 
-        std::shared_ptr<const Term> transformImpl(const Sequence& term) {
+        const Term* transformImpl(const Sequence& term) {
             // Remove duplicate terms from the sequence.
-            auto                            transformed = std::make_shared<Sequence>();
+            auto*                           transformed = this->arena().template make<Sequence>();
             std::unordered_set<const Term*> uniqueTerms;
             for (const auto& t : term.terms()) {
-                auto transformedTerm = this->transform(t);
-                if (uniqueTerms.insert(transformedTerm.get()).second) {
-                    transformed->addTerm(std::move(transformedTerm));
+                const Term* transformedTerm = this->transform(t);
+                if (uniqueTerms.insert(transformedTerm).second) {
+                    transformed->addTerm(transformedTerm);
                 }
             }
             return this->transformNext(*transformed);
         }
 
-        std::shared_ptr<const Term> transformImpl(const Addition& term) {
+        const Term* transformImpl(const Addition& term) {
             // Reduce identity:     0+a -> a
             // Eliminate terms:     a+b-a -> b
             // Fuse repeated terms: n-times +a ->  n*a
             //                      n-times -a -> -n*a
-            return reduceGroupTerms(term, [](const auto& term, int count) {
-                auto product = std::make_shared<Multiplication>(std::make_shared<Constant>(count));
+            auto& arena = this->arena();
+            return reduceGroupTerms(term, [&arena](const Term* term, int count) {
+                auto* product = arena.template make<Multiplication>(arena.template make<Constant>(count));
                 product->addPositiveTerm(term);
-                return std::move(product);
+                return product;
             });
         }
 
-        std::shared_ptr<const Term> transformImpl(const Multiplication& term) {
-            const auto inverseConstant = [this](const std::shared_ptr<const Constant>& constant) {
-                return this->transform(std::make_shared<Constant>(-constant->value()));
+        const Term* transformImpl(const Multiplication& term) {
+            auto&      arena           = this->arena();
+            const auto inverseConstant = [this, &arena](const Constant& constant) {
+                return this->transformConstant(*arena.template make<Constant>(-constant.value()));
             };
 
             // Transform negative constant to additive inverse: -K*x*(a-b)*(c+d) -> K*x*(b-a)*(c+d)
             if (term.constantTerm()->value() < 0) {
-                std::vector<std::shared_ptr<const Term>> positiveTerms;
-                std::vector<std::shared_ptr<const Term>> negativeTerms;
-                for (const auto& t : term.positiveTerms()) {
-                    positiveTerms.push_back(t);
-                }
-                for (const auto& t : term.negativeTerms()) {
-                    negativeTerms.push_back(t);
-                }
-                std::shared_ptr<const Term>* candidate    = nullptr;
-                static constexpr int         UNIQUE_COUNT = 2; // one for our vector and one for actual owner
-                for (auto& t : positiveTerms) {
-                    if (dynamic_cast<const Addition*>(t.get()) && t.use_count() == UNIQUE_COUNT) {
+                std::vector<const Term*> positiveTerms = term.positiveTerms();
+                std::vector<const Term*> negativeTerms = term.negativeTerms();
+                // Note: Only a sum used by this product alone is inverted, i.e. not one shared by other terms.
+                const auto isUnshared = [](const Term* t) {
+                    return t->as<Addition>() && t->parentCount() == 1;
+                };
+                const Term** candidate = nullptr;
+                for (const Term*& t : positiveTerms) {
+                    if (isUnshared(t)) {
                         candidate = &t;
                         break;
                     }
                 }
                 if (!candidate) {
-                    for (auto& t : negativeTerms) {
-                        if (dynamic_cast<const Addition*>(t.get()) && t.use_count() == UNIQUE_COUNT) {
+                    for (const Term*& t : negativeTerms) {
+                        if (isUnshared(t)) {
                             candidate = &t;
                             break;
                         }
@@ -317,19 +358,20 @@ namespace asg {
                 }
                 if (candidate) {
                     const auto& sum     = static_cast<const Addition&>(**candidate);
-                    auto        inverse = std::make_shared<Addition>(inverseConstant(sum.constantTerm()));
-                    for (const auto& t : sum.positiveTerms()) {
+                    auto*       inverse = arena.template make<Addition>(inverseConstant(*sum.constantTerm()));
+                    for (const Term* t : sum.positiveTerms()) {
                         inverse->addNegativeTerm(t);
                     }
-                    for (const auto& t : sum.negativeTerms()) {
+                    for (const Term* t : sum.negativeTerms()) {
                         inverse->addPositiveTerm(t);
                     }
-                    *candidate       = this->transform(inverse);
-                    auto transformed = std::make_shared<Multiplication>(inverseConstant(term.constantTerm()));
-                    for (const auto& t : positiveTerms) {
+                    *candidate        = this->transform(inverse);
+                    auto* transformed =
+                        arena.template make<Multiplication>(inverseConstant(*term.constantTerm()));
+                    for (const Term* t : positiveTerms) {
                         transformed->addPositiveTerm(t);
                     }
-                    for (const auto& t : negativeTerms) {
+                    for (const Term* t : negativeTerms) {
                         transformed->addNegativeTerm(t);
                     }
                     return transformImpl(*transformed); // recursion
@@ -341,16 +383,34 @@ namespace asg {
             // Eliminate terms:     a*b/a -> b
             // Fuse repeated terms: n-times *a -> a^n
             //                      n-times /a -> a^-n
-            return reduceGroupTerms(term, [](const auto& term, int count) {
-                return std::make_shared<Exponentiation>(term, std::make_shared<Constant>(count));
+            return reduceGroupTerms(term, [&arena](const Term* term, int count) {
+                return arena.template make<Exponentiation>(term, arena.template make<Constant>(count));
             });
         }
 
-        std::shared_ptr<const Term> transformImpl(const Exponentiation& term) {
+        const Term* transformImpl(const Selection& term) {
+            // Constant condition:  if(1,a,b) -> a
+            //                      if(0,a,b) -> b
+            const Term* condition = this->transform(term.condition());
+            if (std::optional<Real> constantCondition = condition->evaluateConstant()) {
+                return this->transform(*constantCondition != 0.0 ? term.whenTrue() : term.whenFalse());
+            }
+            // Identical branches:  if(c,a,a) -> a
+            const Term* whenTrue  = this->transform(term.whenTrue());
+            const Term* whenFalse = this->transform(term.whenFalse());
+            if (whenTrue == whenFalse) {
+                return whenTrue;
+            }
+            return this->transformNext(
+                *this->arena().template make<Selection>(condition, whenTrue, whenFalse));
+        }
+
+        const Term* transformImpl(const Exponentiation& term) {
             // Exponent expansion by recursive squaring: x^7 -> ((x*x)*(x*x))*(x*x)*x
-            const auto squaredExponentiation = [](const auto& base, const int exponent) {
-                auto result  = std::make_shared<Multiplication>();
-                auto current = base;
+            auto&      arena                 = this->arena();
+            const auto squaredExponentiation = [&arena](const Term* base, const int exponent) {
+                auto*       result  = arena.template make<Multiplication>(arena.template make<Constant>(1.0));
+                const Term* current = base;
                 for (int bits = std::abs(exponent); bits > 0; bits /= 2) {
                     if (bits & 1) {
                         if (exponent > 0) {
@@ -360,7 +420,7 @@ namespace asg {
                         }
                     }
                     if (bits > 0) {
-                        current = std::make_shared<Squaring>(std::move(current));
+                        current = arena.template make<Squaring>(current);
                     }
                 }
                 return result;
@@ -391,39 +451,40 @@ namespace asg {
     protected:
         using TTransform::transformImpl;
 
-        std::shared_ptr<const Term> transformImpl(const Input& term) {
-            return this->transformNext(*std::make_shared<Input>(rename(term.name())));
+        const Term* transformImpl(const Input& term) {
+            return this->transformNext(*this->arena().template make<Input>(rename(term.name())));
         }
 
-        std::shared_ptr<const Term> transformImpl(const Output& term) {
-            return this->transformNext(*std::make_shared<Output>(rename(term.name()), term.term()));
+        const Term* transformImpl(const Output& term) {
+            return this->transformNext(
+                *this->arena().template make<Output>(rename(term.name()), term.term()));
         }
 
     public:
-        using TransformOperator<TTransform>::TransformOperator;
-
-        explicit Renamed(std::unordered_map<String, String> renames)
-            : mRenames(std::move(renames)) {}
+        Renamed(Arena& arena, std::unordered_map<String, String> renames)
+            : TransformOperator<TTransform>(arena)
+            , mRenames(std::move(renames)) {}
     };
 
     template <typename TTransform>
     class TrigonometricIdentities : public TransformOperator<TTransform> {
-        std::unordered_map<std::shared_ptr<const Term>, std::shared_ptr<const Term>> mSquaredSines;
-        std::unordered_map<std::shared_ptr<const Term>, std::shared_ptr<const Term>> mSquaredCosines;
+        std::unordered_map<const Term*, const Term*> mSquaredSines;
+        std::unordered_map<const Term*, const Term*> mSquaredCosines;
 
     protected:
         using TTransform::transformImpl;
 
-        std::shared_ptr<const Term> transformImpl(const Squaring& term) {
-            if (const auto* function = dynamic_cast<const UnaryFunction*>(term.base().get())) {
+        const Term* transformImpl(const Squaring& term) {
+            auto& arena = this->arena();
+            if (const auto* function = term.base()->as<UnaryFunction>()) {
                 if (function->function() == RealFunction(&std::sin)) {
                     const auto squaredCosIt = mSquaredCosines.find(function->argument());
                     if (squaredCosIt != mSquaredCosines.end()) {
-                        const auto diff = std::make_shared<Addition>(std::make_shared<Constant>(1));
+                        auto* diff = arena.template make<Addition>(arena.template make<Constant>(1));
                         diff->addNegativeTerm(squaredCosIt->second);
                         return this->transformNext(*diff);
                     } else {
-                        const auto transformed = this->transformNext(term);
+                        const Term* transformed = this->transformNext(term);
                         mSquaredSines.insert({ function->argument(), transformed });
                         return transformed;
                     }
@@ -431,11 +492,11 @@ namespace asg {
                 if (function->function() == RealFunction(&std::cos)) {
                     const auto squaredSinIt = mSquaredSines.find(function->argument());
                     if (squaredSinIt != mSquaredSines.end()) {
-                        const auto diff = std::make_shared<Addition>(std::make_shared<Constant>(1));
+                        auto* diff = arena.template make<Addition>(arena.template make<Constant>(1));
                         diff->addNegativeTerm(squaredSinIt->second);
                         return this->transformNext(*diff);
                     } else {
-                        const auto transformed = this->transformNext(term);
+                        const Term* transformed = this->transformNext(term);
                         mSquaredCosines.insert({ function->argument(), transformed });
                         return transformed;
                     }
@@ -2,6 +2,29 @@
 
 SIXPACK_NAMESPACE_BEGIN
 
+ast::Arena::~Arena() {
+    for (auto it = mNodes.rbegin(); it != mNodes.rend(); ++it) {
+        if (*it) {
+            (*it)->~Node();
+        }
+    }
+}
+
+void* ast::Arena::allocate(size_t size, size_t alignment) {
+    const size_t padding = size_t(-reinterpret_cast<uintptr_t>(mNext)) & (alignment - 1);
+    if (padding + size > mAvailable) {
+        // Note: The blocks are aligned to `std::max_align_t` (by `new`), i.e. need no padding.
+        mBlocks.push_back(std::make_unique_for_overwrite<std::byte[]>(BLOCK_SIZE));
+        mNext      = mBlocks.back().get();
+        mAvailable = BLOCK_SIZE;
+        return allocate(size, alignment);
+    }
+    void* const storage = mNext + padding;
+    mNext              += padding + size;
+    mAvailable         -= padding + size;
+    return storage;
+}
+
 void ast::NiladicNode::accept(Visitor& visitor) const {
     visitor.visit(*this);
 }
@@ -14,6 +37,10 @@ void ast::DyadicNode::accept(Visitor& visitor) const {
     visitor.visit(*this);
 }
 
+void ast::TriadicNode::accept(Visitor& visitor) const {
+    visitor.visit(*this);
+}
+
 void ast::Literal::accept(Visitor& visitor) const {
     visitor.visit(*this);
 }
@@ -30,8 +57,16 @@ void ast::UnaryOperator::accept(Visitor& visitor) const {
     visitor.visit(*this);
 }
 
+void ast::BinaryFunction::accept(Visitor& visitor) const {
+    visitor.visit(*this);
+}
+
 void ast::BinaryOperator::accept(Visitor& visitor) const {
     visitor.visit(*this);
 }
 
+void ast::Conditional::accept(Visitor& visitor) const {
+    visitor.visit(*this);
+}
+
 SIXPACK_NAMESPACE_END
@@ -1,11 +1,16 @@
 #pragma once
 #include "Common.h"
+#include <algorithm>
 #include <array>
+#include <cstddef>
 #include <memory>
 #include <span>
+#include <type_traits>
+#include <vector>
 
 SIXPACK_NAMESPACE_BEGIN
 
+class BinaryFunctionSymbol;
 class FunctionSymbol;
 class ValueSymbol;
 
@@ -28,28 +33,61 @@ namespace ast {
         void setInnerSourceView(StringView innerSourceView) { mInnerSourceView = innerSourceView; }
         void setOuterSourceView(StringView outerSourceView) { mOuterSourceView = outerSourceView; }
 
-        virtual std::span<const std::unique_ptr<Node>> children() const = 0;
+        virtual std::span<const Node* const> children() const = 0;
 
         virtual void accept(Visitor& visitor) const = 0;
     };
 
+    /// The storage of the nodes of a tree, i.e. with no allocation per node. The nodes are destroyed with the
+    /// arena, i.e. they refer to their children by plain pointers.
+    class Arena {
+        static constexpr size_t BLOCK_SIZE = 4096;
+
+        std::vector<std::unique_ptr<std::byte[]>> mBlocks;
+        std::byte*                                mNext      = nullptr;
+        size_t                                    mAvailable = 0;
+        std::vector<Node*>                        mNodes; // in the order of their construction (to destroy)
+
+    public:
+        Arena() = default;
+        ~Arena();
+
+        Arena(const Arena&)            = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        /// Constructs a node in the arena.
+        template <typename T, typename... TArgs>
+        T* make(TArgs&&... args) {
+            static_assert(std::is_base_of_v<Node, T>);
+            static_assert(sizeof(T) <= BLOCK_SIZE && alignof(T) <= alignof(std::max_align_t));
+            void* const storage = allocate(sizeof(T), alignof(T));
+            mNodes.push_back(nullptr); // i.e. the node failing to construct is not destroyed
+            T* const node = new (storage) T(std::forward<TArgs>(args)...);
+            mNodes.back() = node;
+            return node;
+        }
+
+    private:
+        void* allocate(size_t size, size_t alignment);
+    };
+
     // Node Valence Categories
     //========================================================================================================
 
     /// The base class of an invariadic AST node, i.e. a node with a fixed valency (number of children).
     template <int TValency>
     class InvariadicNode : public Node {
-        const std::array<std::unique_ptr<Node>, TValency> mChildren;
+        const std::array<const Node*, TValency> mChildren;
 
     public:
         template <typename... TChildren>
-        InvariadicNode(TChildren&&... children)
-            : mChildren{ std::forward<TChildren>(children)... } {
+        InvariadicNode(TChildren... children)
+            : mChildren{ children... } {
             static_assert(sizeof...(TChildren) == TValency);
-            assert(std::find(mChildren.begin(), mChildren.end(), std::unique_ptr<Node>{}) == mChildren.end());
+            assert(std::find(mChildren.begin(), mChildren.end(), nullptr) == mChildren.end());
         }
 
-        virtual std::span<const std::unique_ptr<Node>> children() const override final { return mChildren; }
+        virtual std::span<const Node* const> children() const override final { return mChildren; }
     };
 
     /// A 0-adic AST node, i.e. a leaf.
@@ -61,8 +99,8 @@ namespace ast {
     /// A 1-adic AST node, e.g. an unary operator or a 1-argument function.
     class MonadicNode : public InvariadicNode<1> {
     public:
-        explicit MonadicNode(std::unique_ptr<Node> child)
-            : InvariadicNode<1>(std::move(child)) {}
+        explicit MonadicNode(const Node* child)
+            : InvariadicNode<1>(child) {}
 
         virtual void accept(Visitor& visitor) const override;
     };
@@ -70,8 +108,17 @@ namespace ast {
     /// A 2-adic AST node, e.g. a binary operator.
     class DyadicNode : public InvariadicNode<2> {
     public:
-        DyadicNode(std::unique_ptr<Node> child1, std::unique_ptr<Node> child2)
-            : InvariadicNode<2>(std::move(child1), std::move(child2)) {}
+        DyadicNode(const Node* child1, const Node* child2)
+            : InvariadicNode<2>(child1, child2) {}
+
+        virtual void accept(Visitor& visitor) const override;
+    };
+
+    /// A 3-adic AST node, e.g. a conditional.
+    class TriadicNode : public InvariadicNode<3> {
+    public:
+        TriadicNode(const Node* child1, const Node* child2, const Node* child3)
+            : InvariadicNode<3>(child1, child2, child3) {}
 
         virtual void accept(Visitor& visitor) const override;
     };
@@ -115,8 +162,8 @@ namespace ast {
         const std::shared_ptr<FunctionSymbol> mFunctionSymbol;
 
     public:
-        UnaryFunction(std::shared_ptr<FunctionSymbol> functionSymbol, std::unique_ptr<Node> argument)
-            : MonadicNode(std::move(argument))
+        UnaryFunction(std::shared_ptr<FunctionSymbol> functionSymbol, const Node* argument)
+            : MonadicNode(argument)
             , mFunctionSymbol(std::move(functionSymbol)) {
             assert(mFunctionSymbol);
         }
@@ -139,8 +186,8 @@ namespace ast {
         const Type mType;
 
     public:
-        UnaryOperator(Type type, std::unique_ptr<Node> operand)
-            : MonadicNode(std::move(operand))
+        UnaryOperator(Type type, const Node* operand)
+            : MonadicNode(operand)
             , mType(type) {}
 
         Type        type() const { return mType; }
@@ -152,23 +199,49 @@ namespace ast {
     // Dyadic Nodes
     //========================================================================================================
 
+    /// The AST node representing a call to a binary (named) function.
+    class BinaryFunction final : public DyadicNode {
+        const std::shared_ptr<BinaryFunctionSymbol> mFunctionSymbol;
+
+    public:
+        BinaryFunction(std::shared_ptr<BinaryFunctionSymbol> functionSymbol,
+                       const Node*                           firstArgument,
+                       const Node*                           secondArgument)
+            : DyadicNode(firstArgument, secondArgument)
+            , mFunctionSymbol(std::move(functionSymbol)) {
+            assert(mFunctionSymbol);
+        }
+
+        const BinaryFunctionSymbol& functionSymbol() const { return *mFunctionSymbol; }
+        const Node&                 firstArgument() const { return *children()[0]; }
+        const Node&                 secondArgument() const { return *children()[1]; }
+
+        virtual void accept(Visitor& visitor) const override;
+    };
+
     /// The AST node representing a binary operator.
     class BinaryOperator : public DyadicNode {
     public:
         enum class Type {
-            PLUS,     ///< The plus operator `X+Y` (i.e. the addition).
-            MINUS,    ///< The minus operator `X-Y` (i.e. the subtraction).
-            ASTERISK, ///< The asterisk operator `X*Y` (i.e. the multiplication).
-            SLASH,    ///< The slash operator `X/Y` (i.e. the division).
-            CARET     ///< The caret operator `X^Y` (i.e. the exponentiation).
+            PLUS,           ///< The plus operator `X+Y` (i.e. the addition).
+            MINUS,          ///< The minus operator `X-Y` (i.e. the subtraction).
+            ASTERISK,       ///< The asterisk operator `X*Y` (i.e. the multiplication).
+            SLASH,          ///< The slash operator `X/Y` (i.e. the division).
+            CARET,          ///< The caret operator `X^Y` (i.e. the exponentiation).
+            LESS,           ///< The less-than operator `X<Y`.
+            LESS_EQUALS,    ///< The less-than-or-equal operator `X<=Y`.
+            GREATER,        ///< The greater-than operator `X>Y`.
+            GREATER_EQUALS, ///< The greater-than-or-equal operator `X>=Y`.
+            DOUBLE_EQUALS,  ///< The equality operator `X==Y`.
+            NOT_EQUALS      ///< The inequality operator `X!=Y`.
         };
 
     private:
         const Type mType;
 
     public:
-        BinaryOperator(Type type, std::unique_ptr<Node> leftOperand, std::unique_ptr<Node> rightOperand)
-            : DyadicNode(std::move(leftOperand), std::move(rightOperand))
+        BinaryOperator(Type type, const Node* leftOperand, const Node* rightOperand)
+            : DyadicNode(leftOperand, rightOperand)
             , mType(type) {}
 
         Type        type() const { return mType; }
@@ -178,6 +251,22 @@ namespace ast {
         virtual void accept(Visitor& visitor) const override;
     };
 
+    // Triadic Nodes
+    //========================================================================================================
+
+    /// The AST node representing a conditional `if(C, X, Y)`, i.e. `X` if `C` is non-zero, `Y` otherwise.
+    class Conditional final : public TriadicNode {
+    public:
+        Conditional(const Node* condition, const Node* whenTrue, const Node* whenFalse)
+            : TriadicNode(condition, whenTrue, whenFalse) {}
+
+        const Node& condition() const { return *children()[0]; }
+        const Node& whenTrue() const { return *children()[1]; }
+        const Node& whenFalse() const { return *children()[2]; }
+
+        virtual void accept(Visitor& visitor) const override;
+    };
+
     // Visitor
     //========================================================================================================
 
@@ -199,7 +288,12 @@ namespace ast {
 
         // Dyadic Nodes
         virtual void visit(const DyadicNode& node) { visit(static_cast<const Node&>(node)); }
+        virtual void visit(const BinaryFunction& node) { visit(static_cast<const DyadicNode&>(node)); }
         virtual void visit(const BinaryOperator& node) { visit(static_cast<const DyadicNode&>(node)); }
+
+        // Triadic Nodes
+        virtual void visit(const TriadicNode& node) { visit(static_cast<const Node&>(node)); }
+        virtual void visit(const Conditional& node) { visit(static_cast<const TriadicNode&>(node)); }
     };
 
 } // namespace ast
@@ -0,0 +1,130 @@
+#include "ColumnarBatch.h"
+#include "Exception.h"
+#include <algorithm>
+#include <cstring>
+#include <format>
+
+SIXPACK_NAMESPACE_BEGIN
+
+namespace {
+
+    static size_t alignUp(size_t size) {
+        return (size + ColumnarBatch::ALIGNMENT - 1) / ColumnarBatch::ALIGNMENT * ColumnarBatch::ALIGNMENT;
+    }
+
+} // anonymous namespace
+
+ColumnarBatch::ColumnarBatch(std::span<const std::byte> buffer)
+    : mData(buffer.data())
+    , mWritableData(nullptr)
+    , mSize(buffer.size()) {
+    validate();
+}
+
+ColumnarBatch::ColumnarBatch(std::span<std::byte> buffer)
+    : mData(buffer.data())
+    , mWritableData(buffer.data())
+    , mSize(buffer.size()) {
+    validate();
+}
+
+size_t ColumnarBatch::computeSize(size_t columnCount, size_t rowCount) {
+    return sizeof(Header) + columnCount * (sizeof(ColumnDescriptor) + alignUp(rowCount * sizeof(Real)));
+}
+
+ColumnarBatch ColumnarBatch::format(std::span<std::byte>       buffer,
+                                    const std::vector<String>& names,
+                                    size_t                     rowCount) {
+    if (reinterpret_cast<uintptr_t>(buffer.data()) % ALIGNMENT != 0) {
+        throw Exception("The batch buffer is not aligned");
+    }
+    if (buffer.size() < computeSize(names.size(), rowCount)) {
+        throw Exception(std::format("The batch buffer is too small ({} bytes, {} needed)",
+                                    buffer.size(),
+                                    computeSize(names.size(), rowCount)));
+    }
+    Header& header = *reinterpret_cast<Header*>(buffer.data());
+    header         = {};
+    std::copy_n(MAGIC, sizeof(MAGIC), header.magic);
+    header.version       = VERSION;
+    header.byteOrderMark = BYTE_ORDER_MARK;
+    header.columnCount   = names.size();
+    header.rowCount      = rowCount;
+    header.columnStride  = alignUp(rowCount * sizeof(Real));
+
+    auto* const  descriptors = reinterpret_cast<ColumnDescriptor*>(buffer.data() + sizeof(Header));
+    const size_t dataOffset  = sizeof(Header) + names.size() * sizeof(ColumnDescriptor);
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i].empty() || names[i].size() > MAX_NAME_LENGTH) {
+            throw Exception(std::format("Invalid column name '{}'", names[i]));
+        }
+        if (std::find(names.begin(), names.begin() + i, names[i]) != names.begin() + i) {
+            throw Exception(std::format("Duplicate column '{}'", names[i]));
+        }
+        descriptors[i] = {};
+        std::copy_n(names[i].data(), names[i].size(), descriptors[i].name);
+        descriptors[i].offset = dataOffset + i * header.columnStride;
+    }
+    return ColumnarBatch(buffer);
+}
+
+ptrdiff_t ColumnarBatch::findColumn(StringView name) const {
+    for (size_t i = 0; i < columnCount(); ++i) {
+        if (columnName(i) == name) {
+            return ptrdiff_t(i);
+        }
+    }
+    return -1;
+}
+
+const Real* ColumnarBatch::column(size_t column) const {
+    assert(column < columnCount());
+    return reinterpret_cast<const Real*>(mData + descriptors()[column].offset);
+}
+
+Real* ColumnarBatch::writableColumn(size_t column) const {
+    assert(column < columnCount());
+    return mWritableData ? reinterpret_cast<Real*>(mWritableData + descriptors()[column].offset) : nullptr;
+}
+
+const ColumnarBatch::ColumnDescriptor* ColumnarBatch::descriptors() const {
+    return reinterpret_cast<const ColumnDescriptor*>(mData + sizeof(Header));
+}
+
+void ColumnarBatch::validate() const {
+    if (mSize < sizeof(Header) || std::memcmp(header().magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw Exception("Not a columnar batch");
+    }
+    if (header().version != VERSION || header().byteOrderMark != BYTE_ORDER_MARK) {
+        throw Exception(std::format("Unsupported columnar batch (version {}, byte order {:#x})",
+                                    header().version,
+                                    header().byteOrderMark));
+    }
+    if (reinterpret_cast<uintptr_t>(mData) % ALIGNMENT != 0) {
+        throw Exception("The columnar batch is not aligned");
+    }
+    const uint64_t columnCount = header().columnCount;
+    const uint64_t columnBytes = header().rowCount * sizeof(Real);
+    if (columnCount > (mSize - sizeof(Header)) / sizeof(ColumnDescriptor) ||
+        header().rowCount > mSize / sizeof(Real)) {
+        throw Exception("The columnar batch is truncated");
+    }
+    if (header().columnStride < columnBytes || header().columnStride % ALIGNMENT != 0) {
+        throw Exception("The columnar batch is corrupted");
+    }
+    // Note: The columns must follow the descriptors at the stride, i.e. a wrong column count (or stride) is
+    //       detected even if the batch is long enough.
+    const uint64_t dataOffset = sizeof(Header) + columnCount * sizeof(ColumnDescriptor);
+    for (size_t i = 0; i < columnCount; ++i) {
+        const ColumnDescriptor& descriptor = descriptors()[i];
+        if (std::memchr(descriptor.name, 0, sizeof(descriptor.name)) == nullptr ||
+            descriptor.offset != dataOffset + i * header().columnStride) {
+            throw Exception("The columnar batch is corrupted");
+        }
+        if (descriptor.offset > mSize || mSize - descriptor.offset < columnBytes) {
+            throw Exception(std::format("The column '{}' is out of the batch", columnName(i)));
+        }
+    }
+}
+
+SIXPACK_NAMESPACE_END
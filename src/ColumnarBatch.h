@@ -0,0 +1,94 @@
+#pragma once
+#include "Common.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+SIXPACK_NAMESPACE_BEGIN
+
+/// A view of a self-describing columnar batch of points, e.g. the inputs or the outputs of a program.
+///
+/// The batch is a single contiguous buffer, usable in place (e.g. when mapped from a file):
+///
+///     Header             64 bytes
+///     ColumnDescriptor   64 bytes per column
+///     columns            `rowCount` doubles per column, each column aligned to 64 bytes
+///
+/// All the values are stored in the native byte order; the header records it by the `BYTE_ORDER_MARK`.
+class ColumnarBatch {
+public:
+    static constexpr char     MAGIC[8]        = { 'S', 'I', 'X', 'P', 'A', 'C', 'K', 'B' };
+    static constexpr uint32_t VERSION         = 1;
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static constexpr size_t   ALIGNMENT       = 64;
+    static constexpr size_t   MAX_NAME_LENGTH = 47;
+
+    struct Header {
+        char     magic[8];
+        uint32_t version;
+        uint32_t byteOrderMark;
+        uint64_t columnCount;
+        uint64_t rowCount;
+        uint64_t columnStride; // the distance between the columns, in bytes
+        uint8_t  reserved[24];
+    };
+    static_assert(sizeof(Header) == ALIGNMENT);
+
+    struct ColumnDescriptor {
+        char     name[MAX_NAME_LENGTH + 1]; // zero-terminated
+        uint64_t offset;                    // of the first value, from the start of the batch
+        uint8_t  reserved[8];
+    };
+    static_assert(sizeof(ColumnDescriptor) == ALIGNMENT);
+
+private:
+    const std::byte* mData;
+    std::byte*       mWritableData; // nullptr for the read-only batches
+    size_t           mSize;
+
+public:
+    /// Makes a read-only view of the batch.
+    ///
+    /// \throws Exception if the buffer does not hold a valid batch.
+    explicit ColumnarBatch(std::span<const std::byte> buffer);
+
+    /// Makes a writable view of the batch.
+    ///
+    /// \throws Exception if the buffer does not hold a valid batch.
+    explicit ColumnarBatch(std::span<std::byte> buffer);
+
+    /// Returns the size of the batch of the given dimensions, in bytes.
+    static size_t computeSize(size_t columnCount, size_t rowCount);
+
+    /// Formats an empty batch (i.e. the header and the column descriptors) into the buffer, which must be
+    /// aligned to `ALIGNMENT` and at least `computeSize` bytes long. The values are left untouched.
+    ///
+    /// \throws Exception if any of the names is too long or duplicate, or if the buffer is not suitable.
+    static ColumnarBatch format(std::span<std::byte>       buffer,
+                                const std::vector<String>& names,
+                                size_t                     rowCount);
+
+    size_t size() const { return mSize; }
+    size_t rowCount() const { return size_t(header().rowCount); }
+    size_t columnCount() const { return size_t(header().columnCount); }
+
+    StringView columnName(size_t column) const { return descriptors()[column].name; }
+
+    /// Returns the index of the named column, or -1 if not present.
+    ptrdiff_t findColumn(StringView name) const;
+
+    /// Returns the values of the column (`rowCount` contiguous doubles).
+    const Real* column(size_t column) const;
+
+    /// Returns the writable values of the column (nullptr for the read-only batches).
+    Real* writableColumn(size_t column) const;
+
+private:
+    const Header&           header() const { return *reinterpret_cast<const Header*>(mData); }
+    const ColumnDescriptor* descriptors() const;
+
+    void validate() const;
+};
+
+SIXPACK_NAMESPACE_END
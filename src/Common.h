@@ -24,7 +24,22 @@ using String         = std::string;
 using StringView     = std::basic_string_view<String::value_type>;
 using StringPosition = String::size_type;
 
-using Real         = double;
-using RealFunction = Real (*)(Real);
+using Real               = double;
+using RealFunction       = Real (*)(Real);
+using BinaryRealFunction = Real (*)(Real, Real);
+using BatchFunction      = void (*)(const Real* input, Real* output, size_t count);
+
+/// A closed interval of real numbers.
+struct Interval {
+    Real lower;
+    Real upper;
+};
+
+/// The accuracy of the intrinsic transcendental functions (`sin`, `cos`, `exp`, `log`, `pow`).
+enum class MathAccuracy {
+    ULP_1,   ///< Full precision (i.e. the standard library functions).
+    REL_1E6, ///< Polynomial approximations with the relative error below 1e-6.
+    REL_1E3  ///< Polynomial approximations with the relative error below 1e-3.
+};
 
 SIXPACK_NAMESPACE_END
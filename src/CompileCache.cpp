@@ -0,0 +1,78 @@
+#include "CompileCache.h"
+#include "Compiler.h"
+#include "Program.h"
+#include <algorithm>
+
+SIXPACK_NAMESPACE_BEGIN
+
+CompileCache::CompileCache(size_t capacity)
+    : mCapacity(std::max<size_t>(capacity, 1)) {}
+
+std::shared_ptr<const Program> CompileCache::compile(const Compiler& compiler) {
+    // Note: The functions are identified by address, i.e. the same names bound to other functions differ.
+    //       The key is the whole input of the fingerprint, i.e. the hits need no further verification.
+    String key = compiler.fingerprintInput(true);
+
+    std::promise<std::shared_ptr<const Program>> promise;
+    uint64_t                                     ticket;
+    {
+        std::unique_lock lock(mMutex);
+        if (const auto it = mIndex.find(key); it != mIndex.end()) {
+            mEntries.splice(mEntries.begin(), mEntries, it->second);
+            ++mStatistics.hits;
+            const SharedProgram program = it->second->program;
+            lock.unlock();
+            return program.get();
+        }
+        ++mStatistics.misses;
+        ticket = mNextTicket++;
+        mEntries.push_front(
+            { .key = std::move(key), .ticket = ticket, .program = promise.get_future().share() });
+        mIndex.insert({ mEntries.front().key, mEntries.begin() });
+        evictLocked();
+    }
+
+    // Note: The compilation runs unlocked, i.e. the other programs are served (and compiled) meanwhile.
+    try {
+        auto program = std::make_shared<const Program>(compiler.compile());
+        promise.set_value(program);
+        return program;
+    } catch (...) {
+        {
+            std::lock_guard lock(mMutex);
+            const auto      it = std::find_if(mEntries.begin(), mEntries.end(), [&](const Entry& entry) {
+                return entry.ticket == ticket;
+            });
+            if (it != mEntries.end()) {
+                mIndex.erase(it->key);
+                mEntries.erase(it);
+            }
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+}
+
+CompileCache::Statistics CompileCache::statistics() const {
+    std::lock_guard lock(mMutex);
+    Statistics      statistics = mStatistics;
+    statistics.size            = mEntries.size();
+    return statistics;
+}
+
+void CompileCache::clear() {
+    std::lock_guard lock(mMutex);
+    mIndex.clear();
+    mEntries.clear();
+}
+
+void CompileCache::evictLocked() {
+    while (mEntries.size() > mCapacity) {
+        // Note: The waiters of an evicted compilation in progress hold its future, i.e. are still served.
+        mIndex.erase(mEntries.back().key);
+        mEntries.pop_back();
+        ++mStatistics.evictions;
+    }
+}
+
+SIXPACK_NAMESPACE_END
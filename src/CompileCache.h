@@ -0,0 +1,75 @@
+#pragma once
+#include "Common.h"
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+SIXPACK_NAMESPACE_BEGIN
+
+class Compiler;
+class Program;
+
+/// An in-process cache of the compiled programs, keyed by the canonical forms of the compilers (i.e. the
+/// inputs of their fingerprints, free of collisions).
+///
+/// The compilation is skipped for the compilers equivalent to those of the cached programs, i.e. with the
+/// same scripts (up to the whitespace), parameters, function bindings (by address) and options. The least
+/// recently used programs are evicted beyond the capacity.
+///
+/// The cache is thread-safe. The concurrent requests of the same program are compiled once, i.e. the later
+/// ones wait for the first one (single-flight).
+class CompileCache {
+public:
+    struct Statistics {
+        uint64_t hits;      ///< including the requests waiting for a compilation in progress
+        uint64_t misses;    ///< i.e. the compilations
+        uint64_t evictions;
+        size_t   size;
+    };
+
+private:
+    using SharedProgram = std::shared_future<std::shared_ptr<const Program>>;
+
+    struct Entry {
+        String        key;    // `Compiler::fingerprintInput`
+        uint64_t      ticket; // distinguishes the entries of the same key, e.g. after an eviction
+        SharedProgram program;
+    };
+
+    const size_t mCapacity;
+
+    mutable std::mutex                                         mMutex;
+    std::list<Entry>                                           mEntries; // the most recently used first
+    std::unordered_map<StringView, std::list<Entry>::iterator> mIndex;   // by the key (held by the entry)
+    uint64_t                                                   mNextTicket = 0;
+    Statistics                                                 mStatistics{};
+
+public:
+    /// \param[in] capacity The maximum number of the cached programs (at least 1).
+    explicit CompileCache(size_t capacity = 64);
+
+    CompileCache(const CompileCache&)            = delete;
+    CompileCache& operator=(const CompileCache&) = delete;
+
+    size_t capacity() const { return mCapacity; }
+
+    /// Returns the cached program of the equivalent compiler, or compiles and caches it.
+    ///
+    /// Note: The failed compilations are not cached, i.e. the exception is thrown to all the requests waiting
+    ///       for the compilation, and the next request compiles again.
+    ///
+    /// \throws CompileException if the program cannot be compiled.
+    std::shared_ptr<const Program> compile(const Compiler& compiler);
+
+    Statistics statistics() const;
+
+    /// Removes all the programs (the compilations in progress are completed, but not cached).
+    void clear();
+
+private:
+    void evictLocked();
+};
+
+SIXPACK_NAMESPACE_END
@@ -2,10 +2,16 @@
 #include "AsgTransforms.h"
 #include "Ast.h"
 #include "Exception.h"
+#include "FunctionTable.h"
 #include "Parser.h"
 #include "Program.h"
 #include "Symbols.h"
+#include "Tokenizer.h"
 #include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <format>
 #include <unordered_set>
 
@@ -18,38 +24,46 @@ namespace {
     //========================================================================================================
 
     class GraphBuilder final : ast::Visitor {
-        std::vector<std::shared_ptr<asg::Term>>   mTerms;
-        std::vector<std::shared_ptr<asg::Output>> mOutputs;
+        asg::Arena&               mArena;
+        std::vector<asg::Term*>   mTerms;
+        std::vector<asg::Output*> mOutputs;
+
+        // The terms of the expression symbols, built once and shared by all their uses (i.e. the graph is
+        // linear in the size of the script, even with the symbols used repeatedly by other symbols).
+        std::unordered_map<const ExpressionSymbol*, asg::Term*> mExpressionTerms;
 
     public:
+        explicit GraphBuilder(asg::Arena& arena)
+            : mArena(arena) {}
+
         void addOutput(StringView name, const Expression& expression) {
             assert(mTerms.empty());
             expression.visitAst(*this);
             assert(mTerms.size() == 1);
-            mOutputs.push_back(std::make_shared<asg::Output>(name, popTerm()));
+            mOutputs.push_back(mArena.make<asg::Output>(name, popTerm()));
         }
 
-        std::shared_ptr<asg::Term> makeGraph() const {
-            auto root = std::make_shared<asg::Sequence>();
-            for (const auto& output : mOutputs) {
+        const asg::Term* makeGraph() const {
+            auto* root = mArena.make<asg::Sequence>();
+            for (const auto* output : mOutputs) {
                 root->addTerm(output);
             }
             return root;
         }
 
     private:
-        void pushTerm(std::shared_ptr<asg::Term> term) {
+        void pushTerm(asg::Term* term) {
             assert(term);
-            mTerms.push_back(std::move(term));
+            mTerms.push_back(term);
         }
 
-        const std::shared_ptr<asg::Term>& lastTerm() const {
+        asg::Term* lastTerm() const {
             assert(!mTerms.empty());
             return mTerms.back();
         }
 
-        std::shared_ptr<asg::Term> popTerm() {
-            std::shared_ptr<asg::Term> term = lastTerm();
+        asg::Term* popTerm() {
+            asg::Term* term = lastTerm();
             mTerms.pop_back();
             return term;
         }
@@ -59,18 +73,28 @@ namespace {
         virtual void visit(const ast::Node& node) override { throw Exception("Unhandled node category."); }
 
         virtual void visit(const ast::Literal& node) override {
-            pushTerm(std::make_shared<asg::Constant>(node.value()));
+            pushTerm(mArena.make<asg::Constant>(node.value()));
         }
 
         virtual void visit(const ast::Value& node) override {
-            if (const auto* constant = dynamic_cast<const ConstantSymbol*>(&node.valueSymbol())) {
-                pushTerm(std::make_shared<asg::Constant>(constant->value()));
-            } else if (const auto* parameter = dynamic_cast<const ParameterSymbol*>(&node.valueSymbol())) {
-                pushTerm(std::make_shared<asg::Constant>(parameter->value()));
-            } else if (const auto* variable = dynamic_cast<const VariableSymbol*>(&node.valueSymbol())) {
-                pushTerm(std::make_shared<asg::Input>(variable->name()));
-            } else if (const auto* expression = dynamic_cast<const ExpressionSymbol*>(&node.valueSymbol())) {
-                expression->expression().visitAst(*this);
+            const ValueSymbol& symbol = node.valueSymbol();
+            if (const auto* constant = symbol.as<ConstantSymbol>()) {
+                pushTerm(mArena.make<asg::Constant>(constant->value()));
+            } else if (const auto* parameter = symbol.as<ParameterSymbol>()) {
+                pushTerm(mArena.make<asg::Constant>(parameter->value()));
+            } else if (const auto* variable = symbol.as<VariableSymbol>()) {
+                pushTerm(mArena.make<asg::Input>(variable->name()));
+            } else if (const auto* expression = symbol.as<ExpressionSymbol>()) {
+                // Note: The term is shared by all the uses of the symbol, i.e. it keeps the source node of
+                //       its expression rather than of any use.
+                asg::Term*& term = mExpressionTerms[expression];
+                if (!term) {
+                    expression->expression().visitAst(*this);
+                    term = lastTerm();
+                } else {
+                    pushTerm(term);
+                }
+                return;
             } else {
                 throw Exception("Unhandled value symbol type.");
             }
@@ -79,23 +103,36 @@ namespace {
 
         virtual void visit(const ast::UnaryFunction& node) override {
             node.argument().accept(*this);
-            std::shared_ptr<asg::Term> term = popTerm();
-            pushTerm(std::make_shared<asg::UnaryFunction>(node.functionSymbol().function(), std::move(term)));
+            asg::Term*            term     = popTerm();
+            const FunctionSymbol& function = node.functionSymbol();
+            pushTerm(mArena.make<asg::UnaryFunction>(
+                function.function(), term, function.batchFunction(), function.table()));
+            lastTerm()->setSourceNode(&node);
+        }
+
+        virtual void visit(const ast::BinaryFunction& node) override {
+            node.firstArgument().accept(*this);
+            node.secondArgument().accept(*this);
+            asg::Term* secondTerm = popTerm();
+            asg::Term* firstTerm  = popTerm();
+            pushTerm(
+                mArena.make<asg::BinaryFunction>(node.functionSymbol().function(), firstTerm, secondTerm));
             lastTerm()->setSourceNode(&node);
         }
 
         virtual void visit(const ast::UnaryOperator& node) override {
             node.operand().accept(*this);
-            std::shared_ptr<asg::Term> term = popTerm();
+            asg::Term* term = popTerm();
             switch (node.type()) {
             case ast::UnaryOperator::Type::PLUS:
+                // Note: The operand's term (possibly shared) is kept with its own source node.
                 pushTerm(term);
-                break;
+                return;
             case ast::UnaryOperator::Type::MINUS: {
                 // Note: Let's represent the negation as "-1*x" rather than as "0-x".
-                auto negation = std::make_shared<asg::Multiplication>(std::make_shared<asg::Constant>(-1.0));
-                negation->addPositiveTerm(std::move(term));
-                pushTerm(std::move(negation));
+                auto* negation = mArena.make<asg::Multiplication>(mArena.make<asg::Constant>(-1.0));
+                negation->addPositiveTerm(term);
+                pushTerm(negation);
             } break;
             default:
                 throw Exception("Unhandled unary operator type.");
@@ -106,43 +143,129 @@ namespace {
         virtual void visit(const ast::BinaryOperator& node) override {
             node.leftOperand().accept(*this);
             node.rightOperand().accept(*this);
-            std::shared_ptr<asg::Term> rightTerm = popTerm();
-            std::shared_ptr<asg::Term> leftTerm  = popTerm();
+            asg::Term* rightTerm = popTerm();
+            asg::Term* leftTerm  = popTerm();
             switch (node.type()) {
             case ast::BinaryOperator::Type::PLUS: {
-                auto operation = std::make_shared<asg::Addition>();
-                operation->addPositiveTerm(std::move(leftTerm));
-                operation->addPositiveTerm(std::move(rightTerm));
-                pushTerm(std::move(operation));
+                auto* operation = mArena.make<asg::Addition>(mArena.make<asg::Constant>(0.0));
+                operation->addPositiveTerm(leftTerm);
+                operation->addPositiveTerm(rightTerm);
+                pushTerm(operation);
             } break;
             case ast::BinaryOperator::Type::MINUS: {
-                auto operation = std::make_shared<asg::Addition>();
-                operation->addPositiveTerm(std::move(leftTerm));
-                operation->addNegativeTerm(std::move(rightTerm));
-                pushTerm(std::move(operation));
+                auto* operation = mArena.make<asg::Addition>(mArena.make<asg::Constant>(0.0));
+                operation->addPositiveTerm(leftTerm);
+                operation->addNegativeTerm(rightTerm);
+                pushTerm(operation);
             } break;
             case ast::BinaryOperator::Type::ASTERISK: {
-                auto operation = std::make_shared<asg::Multiplication>();
-                operation->addPositiveTerm(std::move(leftTerm));
-                operation->addPositiveTerm(std::move(rightTerm));
-                pushTerm(std::move(operation));
+                auto* operation = mArena.make<asg::Multiplication>(mArena.make<asg::Constant>(1.0));
+                operation->addPositiveTerm(leftTerm);
+                operation->addPositiveTerm(rightTerm);
+                pushTerm(operation);
             } break;
             case ast::BinaryOperator::Type::SLASH: {
-                auto operation = std::make_shared<asg::Multiplication>();
-                operation->addPositiveTerm(std::move(leftTerm));
-                operation->addNegativeTerm(std::move(rightTerm));
-                pushTerm(std::move(operation));
+                auto* operation = mArena.make<asg::Multiplication>(mArena.make<asg::Constant>(1.0));
+                operation->addPositiveTerm(leftTerm);
+                operation->addNegativeTerm(rightTerm);
+                pushTerm(operation);
             } break;
             case ast::BinaryOperator::Type::CARET:
-                pushTerm(std::make_shared<asg::Exponentiation>(std::move(leftTerm), std::move(rightTerm)));
+                pushTerm(mArena.make<asg::Exponentiation>(leftTerm, rightTerm));
+                break;
+            // Note: The "greater" comparisons are represented as the "less" ones with swapped operands.
+            case ast::BinaryOperator::Type::LESS:
+                pushTerm(mArena.make<asg::Comparison>(
+                    asg::Comparison::Type::LESS, leftTerm, rightTerm));
+                break;
+            case ast::BinaryOperator::Type::LESS_EQUALS:
+                pushTerm(mArena.make<asg::Comparison>(
+                    asg::Comparison::Type::LESS_EQUALS, leftTerm, rightTerm));
+                break;
+            case ast::BinaryOperator::Type::GREATER:
+                pushTerm(mArena.make<asg::Comparison>(
+                    asg::Comparison::Type::LESS, rightTerm, leftTerm));
+                break;
+            case ast::BinaryOperator::Type::GREATER_EQUALS:
+                pushTerm(mArena.make<asg::Comparison>(
+                    asg::Comparison::Type::LESS_EQUALS, rightTerm, leftTerm));
+                break;
+            case ast::BinaryOperator::Type::DOUBLE_EQUALS:
+                pushTerm(mArena.make<asg::Comparison>(
+                    asg::Comparison::Type::EQUALS, leftTerm, rightTerm));
+                break;
+            case ast::BinaryOperator::Type::NOT_EQUALS:
+                pushTerm(mArena.make<asg::Comparison>(
+                    asg::Comparison::Type::NOT_EQUALS, leftTerm, rightTerm));
                 break;
             default:
                 throw Exception("Unhandled binary operator type.");
             }
             lastTerm()->setSourceNode(&node);
         }
+
+        virtual void visit(const ast::Conditional& node) override {
+            node.condition().accept(*this);
+            node.whenTrue().accept(*this);
+            node.whenFalse().accept(*this);
+            asg::Term* whenFalseTerm = popTerm();
+            asg::Term* whenTrueTerm  = popTerm();
+            asg::Term* conditionTerm = popTerm();
+            pushTerm(mArena.make<asg::Selection>(conditionTerm, whenTrueTerm, whenFalseTerm));
+            lastTerm()->setSourceNode(&node);
+        }
     };
 
+    //========================================================================================================
+    // Optimization
+    //========================================================================================================
+
+    using OptimizationStage1 = asg::Reduced<asg::Grouped<asg::ConstEvaluated<asg::Merge>>>;
+    using OptimizationStage2 = asg::TrigonometricIdentities<asg::Merge>;
+
+    static const asg::Term* optimizeGraph(asg::Arena& arena, const asg::Term* graph) {
+        graph = OptimizationStage1(arena).transform(graph);
+        graph = OptimizationStage2(arena).transform(graph);
+        return graph;
+    }
+
+    //========================================================================================================
+    // Intrinsics
+    //========================================================================================================
+
+    // Returns the intrinsic instruction replacing the calls of the function (`NOP` if none).
+    //
+    // Note: The calls of "sin" and "cos" of the same value are further fused into `SINCOS`.
+    Program::Opcode getIntrinsic(RealFunction function) {
+        static const std::pair<RealFunction, Program::Opcode> INTRINSICS[] = {
+            { &std::sin, Program::Opcode::SIN },
+            { &std::cos, Program::Opcode::COS },
+            { &std::exp, Program::Opcode::EXP },
+            { &std::log, Program::Opcode::LOG },
+        };
+        for (const auto& [intrinsicFunction, opcode] : INTRINSICS) {
+            if (function == intrinsicFunction) {
+                return opcode;
+            }
+        }
+        return Program::Opcode::NOP;
+    }
+
+    // Returns the intrinsic instruction replacing the calls of the binary function (`NOP` if none).
+    Program::Opcode getIntrinsic(BinaryRealFunction function) {
+        static const std::pair<BinaryRealFunction, Program::Opcode> INTRINSICS[] = {
+            { &std::atan2, Program::Opcode::ATAN2 }, { &std::hypot, Program::Opcode::HYPOT },
+            { &std::fmin, Program::Opcode::MIN },    { &std::fmax, Program::Opcode::MAX },
+            { &std::fmod, Program::Opcode::FMOD },   { &std::copysign, Program::Opcode::COPYSIGN },
+        };
+        for (const auto& [intrinsicFunction, opcode] : INTRINSICS) {
+            if (function == intrinsicFunction) {
+                return opcode;
+            }
+        }
+        return Program::Opcode::NOP;
+    }
+
     //========================================================================================================
     // CodeGenerator
     //========================================================================================================
@@ -155,25 +278,29 @@ namespace {
         Program::Constants                                     mConstants;
         Program::Instructions                                  mInstructions;
         Program::Comments                                      mComments;
+        Program::BinaryFunctions                               mBinaryFunctions;
+        Program::Tables                                        mTables;
         std::unordered_map<const asg::Term*, Program::Address> mMemoryMapping;
+        std::unordered_multimap<uint64_t, size_t>              mInstructionIndices; // by `getInstructionKey`
 
     public:
         explicit CodeGenerator(const asg::Term& graphRoot) { graphRoot.accept(*this); }
 
-        Program generate(const Lexicon& publicSymbols) {
-            mInputs        = {};
-            mOutputs       = {};
-            mConstants     = {};
-            mInstructions  = {};
-            mComments      = {};
-            mMemoryMapping = {};
+        Program generate(const Lexicon& publicSymbols, MathAccuracy mathAccuracy) {
+            mInputs          = {};
+            mOutputs         = {};
+            mConstants       = {};
+            mInstructions    = {};
+            mComments        = {};
+            mBinaryFunctions = {};
+            mTables          = {};
+            mMemoryMapping   = {};
+            mInstructionIndices.clear();
             addComment(Program::SCRATCHPAD_ADDRESS, "scratch-pad");
             for (int level = 0; level < mTermLevels.size(); ++level) {
                 std::stable_sort(mTermLevels[level].begin(),
                                  mTermLevels[level].end(),
-                                 [](const auto& t1, const auto& t2) {
-                                     return typeid(*t1).before(typeid(*t2));
-                                 });
+                                 [](const auto& t1, const auto& t2) { return t1->kind() < t2->kind(); });
                 if (level == 0) {
                     generateDataSection(mTermLevels[level]);
                 } else {
@@ -183,7 +310,7 @@ namespace {
             generateIntrinsics();
             // Map unused variables to scratch-pad.
             for (const auto& [name, symbol] : publicSymbols.symbols()) {
-                if (const auto* variable = dynamic_cast<const VariableSymbol*>(symbol.get())) {
+                if (const auto* variable = symbol->as<VariableSymbol>()) {
                     // Note: Will insert only if not already present.
                     if (mInputs.insert({ variable->name(), Program::SCRATCHPAD_ADDRESS }).second) {
                         addComment(Program::SCRATCHPAD_ADDRESS, std::format("'{}'", variable->name()));
@@ -194,7 +321,10 @@ namespace {
                            std::move(mOutputs),
                            std::move(mConstants),
                            std::move(mInstructions),
-                           std::move(mComments));
+                           std::move(mComments),
+                           std::move(mBinaryFunctions),
+                           std::move(mTables),
+                           mathAccuracy);
         }
 
     private:
@@ -202,7 +332,7 @@ namespace {
             if (!mMemoryMapping.insert({ term, address }).second) {
                 throw CompileException("Code generation failed -- ambiguous memory mapping");
             }
-            if (const auto* output = dynamic_cast<const asg::Output*>(term)) {
+            if (const auto* output = term->as<asg::Output>()) {
                 addComment(address, std::format("'{}'", output->name()));
             } else if (term->sourceNode()) {
                 addComment(address, std::format("'{}'", term->sourceNode()->outerSourceView()));
@@ -225,15 +355,42 @@ namespace {
             addressComment += comment;
         }
 
+        // Note: The keys are not unique, i.e. the instructions of equal keys are compared. The immediates are
+        //       keyed by all their bits (the low ones being zeros for most constants), the other operands by
+        //       the first 4 bytes of the union (written by every instruction).
+        static uint64_t getInstructionKey(const Program::Instruction& instruction) {
+            uint64_t operands = 0;
+            switch (instruction.opcode) {
+            case Program::Opcode::ADD_IMM:
+            case Program::Opcode::SUBTRACT_IMM:
+            case Program::Opcode::MULTIPLY_IMM:
+            case Program::Opcode::DIVIDE_IMM:
+                operands = std::bit_cast<uint64_t>(instruction.immediate);
+                break;
+            default:
+                std::memcpy(&operands, &instruction.source, sizeof(uint32_t));
+                break;
+            }
+            operands ^= uint64_t(instruction.operand) << 8 | uint64_t(instruction.opcode);
+            return operands * 0x9e3779b97f4a7c15; // Fibonacci hashing, i.e. spreading the bits
+        }
+
         Program::Address emitInstruction(const Program::Instruction& instruction,
                                          const asg::Term*            emitter = nullptr) {
-            const auto instructionIt =
-                std::find(mInstructions.instructions.begin(), mInstructions.instructions.end(), instruction);
-            const auto address = mInstructions.memoryOffset +
-                                 Program::Address(instructionIt - mInstructions.instructions.begin());
-            if (instructionIt == mInstructions.instructions.end()) {
+            const uint64_t key = getInstructionKey(instruction);
+            const auto [firstIndex, lastIndex] = mInstructionIndices.equal_range(key);
+            const auto indexIt = std::find_if(firstIndex, lastIndex, [&](const auto& keyIndex) {
+                return mInstructions.instructions[keyIndex.second] == instruction;
+            });
+            size_t index;
+            if (indexIt != lastIndex) {
+                index = indexIt->second;
+            } else {
+                index = mInstructions.instructions.size();
                 mInstructions.instructions.push_back(instruction);
+                mInstructionIndices.insert({ key, index });
             }
+            const auto address = mInstructions.memoryOffset + Program::Address(index);
             if (emitter) {
                 mapToMemory(emitter, address);
             }
@@ -246,15 +403,15 @@ namespace {
                                         Program::Opcode            initialNegativeOp,
                                         Program::Opcode            sequentialNegativeOp) {
             std::optional<Program::Address> lastAddress;
-            std::optional<Program::Opcode>  pendingOperation;
-            const double                    constant      = operation.constantTerm()->value();
-            const bool                      needsConstant = constant != operation.identity();
+            Program::Opcode                 pendingOperation = Program::Opcode::NOP; // none
+            const double                    constant         = operation.constantTerm()->value();
+            const bool                      needsConstant    = constant != operation.identity();
             for (const auto& term : operation.positiveTerms()) {
-                const Program::Address address = getAddress(term.get());
+                const Program::Address address = getAddress(term);
                 if (lastAddress) {
                     lastAddress = emitInstruction(
                         { .opcode = sequentialPositiveOp, .operand = address, .source = *lastAddress });
-                    pendingOperation = std::nullopt;
+                    pendingOperation = Program::Opcode::NOP;
                 } else if (needsConstant) {
                     lastAddress = emitInstruction(
                         { .opcode = initialPositiveOp, .operand = address, .immediate = constant });
@@ -264,11 +421,11 @@ namespace {
                 }
             }
             for (const auto& term : operation.negativeTerms()) {
-                const Program::Address address = getAddress(term.get());
+                const Program::Address address = getAddress(term);
                 if (lastAddress) {
                     lastAddress = emitInstruction(
                         { .opcode = sequentialNegativeOp, .operand = address, .source = *lastAddress });
-                    pendingOperation = std::nullopt;
+                    pendingOperation = Program::Opcode::NOP;
                 } else if (needsConstant) {
                     lastAddress = emitInstruction(
                         { .opcode = initialNegativeOp, .operand = address, .immediate = constant });
@@ -278,20 +435,42 @@ namespace {
                 }
             }
             assert(lastAddress);
-            if (pendingOperation) {
+            if (pendingOperation != Program::Opcode::NOP) {
                 lastAddress = emitInstruction(
-                    { .opcode = *pendingOperation, .operand = *lastAddress, .immediate = constant });
+                    { .opcode = pendingOperation, .operand = *lastAddress, .immediate = constant });
             }
             mapToMemory(&operation, *lastAddress);
         }
 
+        // Note: The standard binary functions are directly replaced with intrinsics.
+        void emitBinaryFunction(const asg::BinaryFunction& operation) {
+            const Program::Address firstAddress  = getAddress(operation.firstArgument());
+            const Program::Address secondAddress = getAddress(operation.secondArgument());
+            if (const Program::Opcode opcode = getIntrinsic(operation.function());
+                opcode != Program::Opcode::NOP) {
+                emitInstruction({ .opcode = opcode, .operand = secondAddress, .source = firstAddress },
+                                &operation);
+                return;
+            }
+            auto functionIt =
+                std::find(mBinaryFunctions.begin(), mBinaryFunctions.end(), operation.function());
+            if (functionIt == mBinaryFunctions.end()) {
+                functionIt = mBinaryFunctions.insert(functionIt, operation.function());
+            }
+            emitInstruction({ .opcode     = Program::Opcode::CALL_BINARY,
+                              .operand    = secondAddress,
+                              .binaryCall = { .source   = firstAddress,
+                                              .function = uint32_t(functionIt - mBinaryFunctions.begin()) } },
+                            &operation);
+        }
+
         void generateDataSection(const std::vector<const asg::Term*>& terms) {
             Program::Address constantCount = 0;
             Program::Address variableCount = 0;
             for (const auto& term : terms) {
-                if (dynamic_cast<const asg::Constant*>(term)) {
+                if (term->as<asg::Constant>()) {
                     ++constantCount;
-                } else if (dynamic_cast<const asg::Input*>(term)) {
+                } else if (term->as<asg::Input>()) {
                     ++variableCount;
                 } else {
                     throw CompileException("Code generation failed -- code present in the data section");
@@ -301,14 +480,14 @@ namespace {
             const Program::Address constantSection = variableSection + variableCount;
             const Program::Address codeSection     = constantSection + constantCount;
             for (const auto& term : terms) {
-                if (const auto* constant = dynamic_cast<const asg::Constant*>(term)) {
+                if (const auto* constant = term->as<asg::Constant>()) {
                     auto address = Program::Address(constantSection + mConstants.values.size());
                     mConstants.values.push_back(constant->value());
                     if (!mComments.contains(address)) {
                         addComment(address, "constant");
                     }
                     mapToMemory(constant, address);
-                } else if (const auto* input = dynamic_cast<const asg::Input*>(term)) {
+                } else if (const auto* input = term->as<asg::Input>()) {
                     auto address = Program::Address(variableSection + mInputs.size());
                     address      = mInputs.insert({ String(input->name()), address }).first->second;
                     if (!mComments.contains(address)) {
@@ -323,36 +502,68 @@ namespace {
 
         void generateCodeSection(const std::vector<const asg::Term*>& terms) {
             for (const auto& term : terms) {
-                if (const auto* output = dynamic_cast<const asg::Output*>(term)) {
-                    const Program::Address address = getAddress(output->term().get());
+                if (const auto* output = term->as<asg::Output>()) {
+                    const Program::Address address = getAddress(output->term());
                     mOutputs.insert({ String(output->name()), address });
                     mapToMemory(output, address);
-                } else if (const auto* operation = dynamic_cast<const asg::UnaryFunction*>(term)) {
-                    emitInstruction({ .opcode   = Program::Opcode::CALL,
-                                      .operand  = getAddress(operation->argument().get()),
-                                      .function = operation->function() },
+                } else if (const auto* operation = term->as<asg::UnaryFunction>()) {
+                    if (const auto& table = operation->table()) {
+                        if (std::find(mTables.begin(), mTables.end(), table) == mTables.end()) {
+                            mTables.push_back(table);
+                        }
+                        emitInstruction({ .opcode  = Program::Opcode::TABLE_LOOKUP,
+                                          .operand = getAddress(operation->argument()),
+                                          .table   = table.get() },
+                                        operation);
+                    } else if (operation->batchFunction()) {
+                        emitInstruction({ .opcode        = Program::Opcode::CALL_BATCH,
+                                          .operand       = getAddress(operation->argument()),
+                                          .batchFunction = operation->batchFunction() },
+                                        operation);
+                    } else {
+                        emitInstruction({ .opcode   = Program::Opcode::CALL,
+                                          .operand  = getAddress(operation->argument()),
+                                          .function = operation->function() },
+                                        operation);
+                    }
+                } else if (const auto* operation = term->as<asg::BinaryFunction>()) {
+                    emitBinaryFunction(*operation);
+                } else if (const auto* operation = term->as<asg::Comparison>()) {
+                    static constexpr Program::Opcode OPCODES[] = { Program::Opcode::CMP_LT,
+                                                                   Program::Opcode::CMP_LE,
+                                                                   Program::Opcode::CMP_EQ,
+                                                                   Program::Opcode::CMP_NE };
+                    emitInstruction({ .opcode  = OPCODES[int(operation->type())],
+                                      .operand = getAddress(operation->right()),
+                                      .source  = getAddress(operation->left()) },
                                     operation);
-                } else if (const auto* operation = dynamic_cast<const asg::Addition*>(term)) {
+                } else if (const auto* operation = term->as<asg::Selection>()) {
+                    emitInstruction({ .opcode  = Program::Opcode::SELECT,
+                                      .operand = getAddress(operation->condition()),
+                                      .select  = { .whenTrue  = getAddress(operation->whenTrue()),
+                                                   .whenFalse = getAddress(operation->whenFalse()) } },
+                                    operation);
+                } else if (const auto* operation = term->as<asg::Addition>()) {
                     emitGroupOperationSequence(*operation,
                                                Program::Opcode::ADD_IMM,
                                                Program::Opcode::ADD,
                                                Program::Opcode::SUBTRACT_IMM,
                                                Program::Opcode::SUBTRACT);
-                } else if (const auto* operation = dynamic_cast<const asg::Multiplication*>(term)) {
+                } else if (const auto* operation = term->as<asg::Multiplication>()) {
                     emitGroupOperationSequence(*operation,
                                                Program::Opcode::MULTIPLY_IMM,
                                                Program::Opcode::MULTIPLY,
                                                Program::Opcode::DIVIDE_IMM,
                                                Program::Opcode::DIVIDE);
-                } else if (const auto* operation = dynamic_cast<const asg::Exponentiation*>(term)) {
+                } else if (const auto* operation = term->as<asg::Exponentiation>()) {
                     emitInstruction({ .opcode  = Program::Opcode::POWER,
-                                      .operand = getAddress(operation->exponent().get()),
-                                      .source  = getAddress(operation->base().get()) },
+                                      .operand = getAddress(operation->exponent()),
+                                      .source  = getAddress(operation->base()) },
                                     operation);
-                } else if (const auto* operation = dynamic_cast<const asg::Squaring*>(term)) {
+                } else if (const auto* operation = term->as<asg::Squaring>()) {
                     emitInstruction({ .opcode  = Program::Opcode::MULTIPLY,
-                                      .operand = getAddress(operation->base().get()),
-                                      .source  = getAddress(operation->base().get()) },
+                                      .operand = getAddress(operation->base()),
+                                      .source  = getAddress(operation->base()) },
                                     operation);
                 } else {
                     throw CompileException("Code generation failed -- data present in the code section");
@@ -373,11 +584,18 @@ namespace {
             for (Program::Address index = 0; index < mInstructions.instructions.size(); ++index) {
                 Program::Instruction& instruction = mInstructions.instructions[index];
                 if (instruction.opcode == Program::Opcode::CALL) {
-                    if (instruction.function == RealFunction(&std::sin)) {
+                    switch (const Program::Opcode opcode = getIntrinsic(instruction.function)) {
+                    case Program::Opcode::SIN:
                         candidates[instruction.operand].sin = &instruction;
-                    }
-                    if (instruction.function == RealFunction(&std::cos)) {
+                        break;
+                    case Program::Opcode::COS:
                         candidates[instruction.operand].cos = &instruction;
+                        break;
+                    case Program::Opcode::NOP:
+                        break;
+                    default:
+                        instruction.opcode = opcode;
+                        break;
                     }
                 }
             }
@@ -394,14 +612,17 @@ namespace {
             }
         }
 
-        void gather(const asg::Term& term) {
-            if (mUniqueTerms.insert(&term).second) {
-                const size_t level = size_t(term.depth());
-                if (mTermLevels.size() < level + 1) {
-                    mTermLevels.resize(level + 1);
-                }
-                mTermLevels[level].push_back(&term);
+        // Returns whether the term is gathered for the first time, i.e. the shared subterms are visited once.
+        bool gather(const asg::Term& term) {
+            if (!mUniqueTerms.insert(&term).second) {
+                return false;
             }
+            const size_t level = size_t(term.depth());
+            if (mTermLevels.size() < level + 1) {
+                mTermLevels.resize(level + 1);
+            }
+            mTermLevels[level].push_back(&term);
+            return true;
         }
 
         // Visitor Interface
@@ -417,23 +638,148 @@ namespace {
         virtual void visit(const asg::Input& term) override { gather(term); }
 
         virtual void visit(const asg::Output& term) override {
-            gather(term);
-            term.term()->accept(*this);
+            if (gather(term)) {
+                term.term()->accept(*this);
+            }
         }
 
         virtual void visit(const asg::UnaryFunction& term) override {
-            gather(term);
-            term.argument()->accept(*this);
+            if (gather(term)) {
+                term.argument()->accept(*this);
+            }
+        }
+
+        virtual void visit(const asg::BinaryFunction& term) override {
+            if (gather(term)) {
+                term.firstArgument()->accept(*this);
+                term.secondArgument()->accept(*this);
+            }
+        }
+
+        virtual void visit(const asg::Comparison& term) override {
+            if (gather(term)) {
+                term.left()->accept(*this);
+                term.right()->accept(*this);
+            }
+        }
+
+        virtual void visit(const asg::Selection& term) override {
+            if (gather(term)) {
+                term.condition()->accept(*this);
+                term.whenTrue()->accept(*this);
+                term.whenFalse()->accept(*this);
+            }
         }
 
         void visit(const asg::GroupOperation& term) {
-            gather(term);
-            // Note: The constant term is excluded on purpose.
-            for (const auto& t : term.positiveTerms()) {
-                t->accept(*this);
+            if (gather(term)) {
+                // Note: The constant term is excluded on purpose.
+                for (const auto& t : term.positiveTerms()) {
+                    t->accept(*this);
+                }
+                for (const auto& t : term.negativeTerms()) {
+                    t->accept(*this);
+                }
             }
-            for (const auto& t : term.negativeTerms()) {
-                t->accept(*this);
+        }
+
+        virtual void visit(const asg::Addition& term) override {
+            visit(static_cast<const asg::GroupOperation&>(term));
+        }
+
+        virtual void visit(const asg::Multiplication& term) override {
+            visit(static_cast<const asg::GroupOperation&>(term));
+        }
+
+        virtual void visit(const asg::Exponentiation& term) override {
+            if (gather(term)) {
+                term.base()->accept(*this);
+                term.exponent()->accept(*this);
+            }
+        }
+
+        virtual void visit(const asg::Squaring& term) override {
+            if (gather(term)) {
+                term.base()->accept(*this);
+            }
+        }
+    };
+
+    //========================================================================================================
+    // CompileStats
+    //========================================================================================================
+
+    /// Counts the distinct terms of a graph (including the constant terms of the group operations).
+    class TermCounter final : asg::Visitor {
+        std::unordered_set<const asg::Term*> mTerms;
+
+    public:
+        static size_t count(const asg::Term& graph) {
+            TermCounter counter;
+            graph.accept(counter);
+            return counter.mTerms.size();
+        }
+
+    private:
+        bool insert(const asg::Term& term) { return mTerms.insert(&term).second; }
+
+        // Visitor Interface
+
+        virtual void visit(const asg::Sequence& term) override {
+            if (insert(term)) {
+                for (const auto& t : term.terms()) {
+                    t->accept(*this);
+                }
+            }
+        }
+
+        virtual void visit(const asg::Constant& term) override { insert(term); }
+
+        virtual void visit(const asg::Input& term) override { insert(term); }
+
+        virtual void visit(const asg::Output& term) override {
+            if (insert(term)) {
+                term.term()->accept(*this);
+            }
+        }
+
+        virtual void visit(const asg::UnaryFunction& term) override {
+            if (insert(term)) {
+                term.argument()->accept(*this);
+            }
+        }
+
+        virtual void visit(const asg::BinaryFunction& term) override {
+            if (insert(term)) {
+                term.firstArgument()->accept(*this);
+                term.secondArgument()->accept(*this);
+            }
+        }
+
+        virtual void visit(const asg::Comparison& term) override {
+            if (insert(term)) {
+                term.left()->accept(*this);
+                term.right()->accept(*this);
+            }
+        }
+
+        virtual void visit(const asg::Selection& term) override {
+            if (insert(term)) {
+                term.condition()->accept(*this);
+                term.whenTrue()->accept(*this);
+                term.whenFalse()->accept(*this);
+            }
+        }
+
+        void visit(const asg::GroupOperation& term) {
+            if (insert(term)) {
+                term.constantTerm()->accept(*this);
+                for (const auto& t : term.positiveTerms()) {
+                    t->accept(*this);
+                }
+                for (const auto& t : term.negativeTerms()) {
+                    t->accept(*this);
+                }
             }
         }
 
@@ -446,17 +792,102 @@ namespace {
         }
 
         virtual void visit(const asg::Exponentiation& term) override {
-            gather(term);
-            term.base()->accept(*this);
-            term.exponent()->accept(*this);
+            if (insert(term)) {
+                term.base()->accept(*this);
+                term.exponent()->accept(*this);
+            }
         }
 
         virtual void visit(const asg::Squaring& term) override {
-            gather(term);
-            term.base()->accept(*this);
+            if (insert(term)) {
+                term.base()->accept(*this);
+            }
+        }
+    };
+
+    /// Records the passes of a compilation into the statistics.
+    class PassRecorder {
+        using Clock = std::chrono::steady_clock;
+
+        CompileStats&           mStats;
+        const Clock::time_point mStart = Clock::now();
+
+    public:
+        explicit PassRecorder(CompileStats& stats)
+            : mStats(stats) {
+            mStats = {};
+        }
+
+        ~PassRecorder() { mStats.duration = secondsSinceStart(); }
+
+        /// Runs and times the pass. Its input terms are those output by the previous pass.
+        template <typename TPass>
+        auto run(StringView name, TPass&& pass) {
+            const size_t termsIn = mStats.passes.empty() ? 0 : mStats.passes.back().termsOut;
+            const double start   = secondsSinceStart();
+            auto         result  = pass();
+            mStats.passes.push_back({ .name             = String(name),
+                                      .start            = start,
+                                      .duration         = secondsSinceStart() - start,
+                                      .termsIn          = termsIn,
+                                      .termsOut         = 0,
+                                      .mergeLookups     = 0,
+                                      .mergeHits        = 0,
+                                      .instructionCount = 0 });
+            return result;
+        }
+
+        /// Returns the record of the last pass, to be completed by the caller.
+        CompileStats::Pass& last() { return mStats.passes.back(); }
+
+    private:
+        double secondsSinceStart() const {
+            return std::chrono::duration<double>(Clock::now() - mStart).count();
         }
     };
 
+    //========================================================================================================
+    // FingerprintWriter
+    //========================================================================================================
+
+    /// The canonical (binary) form of a sequence of values, i.e. the input of the fingerprint.
+    class FingerprintWriter {
+        String mBytes;
+
+    public:
+        String&& bytes() && { return std::move(mBytes); }
+
+        void add(StringView text) {
+            add(uint64_t(text.size()));
+            addBytes(text.data(), text.size());
+        }
+
+        void add(uint64_t value) { addBytes(&value, sizeof(value)); }
+        void add(Real value) { addBytes(&value, sizeof(value)); }
+
+        /// Adds the tokens of the expression, i.e. regardless of the whitespace and of the number notation.
+        void addTokens(StringView expression) {
+            Tokenizer tokenizer(expression);
+            while (const Token token = tokenizer.getNext()) {
+                add(uint64_t(token.type));
+                if (token.type == TokenType::NUMBER) {
+                    add(token.numericValue);
+                } else {
+                    add(token.text);
+                }
+            }
+            add(uint64_t(TokenType::END_OF_INPUT)); // i.e. the form of the sequences stays unambiguous
+        }
+
+        template <typename TFunction>
+        void addAddress(TFunction function) {
+            add(uint64_t(reinterpret_cast<uintptr_t>(function)));
+        }
+
+    private:
+        void addBytes(const void* data, size_t size) { mBytes.append(static_cast<const char*>(data), size); }
+    };
+
 } // anonymous namespace
 
 //============================================================================================================
@@ -466,11 +897,15 @@ namespace {
 class Compiler::Context {
     Lexicon                                        mPublicSymbols;
     std::vector<std::shared_ptr<ExpressionSymbol>> mOutputSymbols;
+    MathAccuracy                                   mMathAccuracy = MathAccuracy::ULP_1;
 
 public:
     const Lexicon&                                        publicSymbols() const { return mPublicSymbols; }
     const std::vector<std::shared_ptr<ExpressionSymbol>>& outputSymbols() const { return mOutputSymbols; }
 
+    MathAccuracy mathAccuracy() const { return mMathAccuracy; }
+    void         setMathAccuracy(MathAccuracy accuracy) { mMathAccuracy = accuracy; }
+
     void addPublicSymbol(std::shared_ptr<Symbol> symbol) { mPublicSymbols.add(std::move(symbol)); }
 
     void addOutputSymbol(std::shared_ptr<ExpressionSymbol> symbol) {
@@ -496,6 +931,20 @@ void Compiler::addFunction(StringView name, RealFunction function) {
     mContext->addPublicSymbol(std::make_shared<FunctionSymbol>(name, function));
 }
 
+void Compiler::addFunction(StringView name, BinaryRealFunction function) {
+    mContext->addPublicSymbol(std::make_shared<BinaryFunctionSymbol>(name, function));
+}
+
+void Compiler::addFunction(StringView name, RealFunction function, Interval domain, Real tolerance) {
+    mContext->addPublicSymbol(std::make_shared<FunctionSymbol>(
+        name, function, nullptr, std::make_shared<const FunctionTable>(function, domain, tolerance)));
+}
+
+void Compiler::addFunction(StringView name, RealFunction function, BatchFunction batchFunction) {
+    assert(batchFunction);
+    mContext->addPublicSymbol(std::make_shared<FunctionSymbol>(name, function, batchFunction));
+}
+
 void Compiler::addParameter(StringView name, Real value) {
     mContext->addPublicSymbol(std::make_shared<ParameterSymbol>(name, value));
 }
@@ -506,13 +955,7 @@ void Compiler::addVariable(StringView name) {
 
 Expression Compiler::addExpression(StringView name, StringView expression, Visibility visibility) {
     Expression parsedExpression = ExpressionParser(mContext->publicSymbols()).parseToExpression(expression);
-    auto       symbol           = std::make_shared<ExpressionSymbol>(name, parsedExpression);
-    if (visibility != Visibility::PRIVATE) {
-        mContext->addPublicSymbol(symbol);
-    }
-    if (visibility != Visibility::SYMBOLIC) {
-        mContext->addOutputSymbol(symbol);
-    }
+    addExpressionSymbol(name, parsedExpression, visibility);
     return parsedExpression;
 }
 
@@ -520,10 +963,14 @@ void Compiler::addSourceScript(StringView input) {
     ScriptParser(*this).parseScript(input);
 }
 
+void Compiler::setMathAccuracy(MathAccuracy accuracy) {
+    mContext->setMathAccuracy(accuracy);
+}
+
 std::vector<StringView> Compiler::getInputs() const {
     std::vector<StringView> inputs;
     for (const auto& [name, symbol] : mContext->publicSymbols().symbols()) {
-        if (dynamic_cast<const VariableSymbol*>(symbol.get())) {
+        if (symbol->as<VariableSymbol>()) {
             inputs.emplace_back(name);
         }
     }
@@ -533,7 +980,7 @@ std::vector<StringView> Compiler::getInputs() const {
 std::vector<std::pair<StringView, Real>> Compiler::getParameters() const {
     std::vector<std::pair<StringView, Real>> parameters;
     for (const auto& [name, symbol] : mContext->publicSymbols().symbols()) {
-        if (const auto* parameter = dynamic_cast<const ParameterSymbol*>(symbol.get())) {
+        if (const auto* parameter = symbol->as<ParameterSymbol>()) {
             parameters.emplace_back(name, parameter->value());
         }
     }
@@ -548,18 +995,177 @@ std::vector<std::pair<StringView, Expression>> Compiler::getOutputs() const {
     return outputs;
 }
 
+FunctionRegistry Compiler::getFunctions() const {
+    FunctionRegistry functions;
+    for (const auto& [name, symbol] : mContext->publicSymbols().symbols()) {
+        if (const auto* function = symbol->as<FunctionSymbol>()) {
+            functions.add(name, function->function());
+            if (function->batchFunction()) {
+                functions.add(name, function->batchFunction());
+            }
+        } else if (const auto* binaryFunction = symbol->as<BinaryFunctionSymbol>()) {
+            functions.add(name, binaryFunction->function());
+        }
+    }
+    return functions;
+}
+
+uint64_t Compiler::fingerprint(bool withFunctionAddresses) const {
+    // The 64-bit FNV-1a hash.
+    uint64_t hash = 0xCBF29CE484222325;
+    for (const char byte : fingerprintInput(withFunctionAddresses)) {
+        hash = (hash ^ uint8_t(byte)) * 0x100000001B3;
+    }
+    return hash;
+}
+
+String Compiler::fingerprintInput(bool withFunctionAddresses) const {
+    std::vector<std::pair<StringView, const Symbol*>> symbols;
+    for (const auto& [name, symbol] : mContext->publicSymbols().symbols()) {
+        symbols.emplace_back(name, symbol.get());
+    }
+    std::sort(symbols.begin(), symbols.end());
+
+    FingerprintWriter writer;
+    for (const auto& [name, symbol] : symbols) {
+        writer.add(name);
+        if (const auto* constant = symbol->as<ConstantSymbol>()) {
+            writer.add("constant");
+            writer.add(constant->value());
+        } else if (const auto* parameter = symbol->as<ParameterSymbol>()) {
+            writer.add("parameter");
+            writer.add(parameter->value());
+        } else if (symbol->as<VariableSymbol>()) {
+            writer.add("variable");
+        } else if (const auto* expression = symbol->as<ExpressionSymbol>()) {
+            writer.add("expression");
+            writer.addTokens(expression->expression().input());
+        } else if (const auto* function = symbol->as<FunctionSymbol>()) {
+            writer.add("function");
+            // Note: Whether the calls are replaced by an intrinsic depends on the function, not on its name.
+            writer.add(uint64_t(getIntrinsic(function->function())));
+            writer.add(uint64_t(function->batchFunction() != nullptr));
+            if (withFunctionAddresses) {
+                writer.addAddress(function->function());
+                writer.addAddress(function->batchFunction());
+            }
+            writer.add(uint64_t(function->table() != nullptr));
+            if (const auto& table = function->table()) {
+                writer.add(table->domain().lower);
+                writer.add(table->domain().upper);
+                writer.add(uint64_t(table->segmentCount()));
+            }
+        } else if (const auto* function = symbol->as<BinaryFunctionSymbol>()) {
+            writer.add("binary function");
+            writer.add(uint64_t(getIntrinsic(function->function())));
+            if (withFunctionAddresses) {
+                writer.addAddress(function->function());
+            }
+        }
+    }
+    for (const auto& output : mContext->outputSymbols()) {
+        writer.add("output");
+        writer.add(output->name());
+        writer.addTokens(output->expression().input());
+    }
+    writer.add(uint64_t(mContext->mathAccuracy()));
+    return std::move(writer).bytes();
+}
+
 Program Compiler::compile() const {
-    using Stage1 = asg::Reduced<asg::Grouped<asg::ConstEvaluated<asg::Merge>>>;
-    using Stage2 = asg::TrigonometricIdentities<asg::Merge>;
+    [[maybe_unused]] const Metrics::CompilationScope metrics;
+    asg::Arena arena;
+    return compileGraph(*optimizeGraph(arena, makeGraph(arena)));
+}
+
+Program Compiler::compile(CompileStats& stats) const {
+    [[maybe_unused]] const Metrics::CompilationScope metrics;
+    PassRecorder recorder(stats);
 
-    std::shared_ptr<const asg::Term> graph = makeGraph();
-    graph                                  = Stage1{}.transform(graph);
-    graph                                  = Stage2{}.transform(graph);
-    return compileGraph(*graph);
+    // Note: The terms are counted outside of the timed passes.
+    asg::Arena       arena;
+    const asg::Term* graph = recorder.run("GraphBuilder", [&] { return makeGraph(arena); });
+    recorder.last().termsOut = TermCounter::count(*graph);
+
+    // Note: The transforms are released after their passes, i.e. with their maps of the transformed terms
+    //       (the terms themselves are kept in the arena till the end of the compilation).
+    {
+        OptimizationStage1 stage1(arena);
+        graph = recorder.run("Stage1 (Reduced<Grouped<ConstEvaluated<Merge>>>)",
+                             [&] { return stage1.transform(graph); });
+        recorder.last().termsOut     = TermCounter::count(*graph);
+        recorder.last().mergeLookups = stage1.lookupCount();
+        recorder.last().mergeHits    = stage1.hitCount();
+    }
+    {
+        OptimizationStage2 stage2(arena);
+        graph = recorder.run("Stage2 (TrigonometricIdentities<Merge>)",
+                             [&] { return stage2.transform(graph); });
+        recorder.last().termsOut     = TermCounter::count(*graph);
+        recorder.last().mergeLookups = stage2.lookupCount();
+        recorder.last().mergeHits    = stage2.hitCount();
+    }
+
+    Program program = recorder.run("CodeGenerator", [&] { return compileGraph(*graph); });
+    recorder.last().instructionCount = program.instructions().instructions.size();
+    return program;
 }
 
-std::shared_ptr<const asg::Term> Compiler::makeGraph() const {
-    GraphBuilder graphBuilder;
+Program Compiler::compileFused(const std::vector<Script>& scripts) {
+    [[maybe_unused]] const Metrics::CompilationScope metrics;
+    if (scripts.empty()) {
+        throw CompileException("No scripts to fuse");
+    }
+    const MathAccuracy             mathAccuracy = scripts.front().second->mContext->mathAccuracy();
+    asg::Arena                     arena; // shared by the graphs of all the scripts
+    auto*                          root         = arena.make<asg::Sequence>();
+    Lexicon                        inputs;
+    std::unordered_set<StringView> scriptNames;
+    std::unordered_set<String>     outputNames; // the renamed ones
+    for (const auto& [name, compiler] : scripts) {
+        const Context& context = *compiler->mContext;
+        if (!scriptNames.insert(name).second) {
+            throw CompileException(std::format("Script '{}': Duplicate script name", name));
+        }
+        if (context.mathAccuracy() != mathAccuracy) {
+            throw CompileException(std::format("Script '{}': Mismatching math accuracy", name));
+        }
+        std::unordered_map<String, String> renames;
+        for (const auto& output : context.outputSymbols()) {
+            String renamed = std::format("{}.{}", name, output->name());
+            // Note: The names passed to `addExpression` may contain dots, i.e. the renamed outputs of
+            //       distinct scripts may still collide (e.g. "a.b" + "c" and "a" + "b.c").
+            if (!outputNames.insert(renamed).second) {
+                throw CompileException(
+                    std::format("Script '{}': Output '{}' collides with another output", name, renamed));
+            }
+            renames.insert({ String(output->name()), std::move(renamed) });
+        }
+        const asg::Term* graph = nullptr;
+        try {
+            graph = asg::Renamed<asg::Identity>(arena, std::move(renames))
+                        .transform(compiler->makeGraph(arena));
+        } catch (const CompileException& exception) {
+            throw CompileException(std::format("Script '{}': {}", name, exception.message()));
+        }
+        // Note: Each graph is a sequence of the outputs.
+        const auto* sequence = graph->as<asg::Sequence>();
+        assert(sequence);
+        for (const auto& output : sequence->terms()) {
+            root->addTerm(output);
+        }
+        for (const auto& [symbolName, symbol] : context.publicSymbols().symbols()) {
+            if (symbol->as<VariableSymbol>() && !inputs.find(symbolName)) {
+                inputs.add(symbol);
+            }
+        }
+    }
+    // Note: The common subexpressions of all the scripts are merged by the optimization of the whole graph.
+    return CodeGenerator(*optimizeGraph(arena, root)).generate(inputs, mathAccuracy);
+}
+
+const asg::Term* Compiler::makeGraph(asg::Arena& arena) const {
+    GraphBuilder graphBuilder(arena);
     for (const auto& output : mContext->outputSymbols()) {
         try {
             graphBuilder.addOutput(output->name(), output->expression());
@@ -571,7 +1177,21 @@ std::shared_ptr<const asg::Term> Compiler::makeGraph() const {
 }
 
 Program Compiler::compileGraph(const asg::Term& graph) const {
-    return CodeGenerator(graph).generate(mContext->publicSymbols());
+    return CodeGenerator(graph).generate(mContext->publicSymbols(), mContext->mathAccuracy());
+}
+
+const Lexicon& Compiler::publicSymbols() const {
+    return mContext->publicSymbols();
+}
+
+void Compiler::addExpressionSymbol(StringView name, const Expression& expression, Visibility visibility) {
+    auto symbol = std::make_shared<ExpressionSymbol>(name, expression);
+    if (visibility != Visibility::PRIVATE) {
+        mContext->addPublicSymbol(symbol);
+    }
+    if (visibility != Visibility::SYMBOLIC) {
+        mContext->addOutputSymbol(symbol);
+    }
 }
 
 SIXPACK_NAMESPACE_END
@@ -1,16 +1,36 @@
 #pragma once
 #include "Common.h"
+#include "FunctionRegistry.h"
 #include <memory>
 #include <vector>
 
 SIXPACK_NAMESPACE_BEGIN
 
 namespace asg {
+    class Arena;
     class Term;
 }
 class Expression;
+class Lexicon;
 class Program;
 
+/// The cost of the passes of a compilation, in the order of their execution.
+struct CompileStats {
+    struct Pass {
+        String   name;
+        double   start;            ///< seconds since the start of the compilation
+        double   duration;         ///< seconds (wall time)
+        size_t   termsIn;          ///< the distinct terms of the input graph (0 if none)
+        size_t   termsOut;         ///< the distinct terms of the output graph (0 if none)
+        uint64_t mergeLookups;     ///< the terms looked up by the merging of the equal terms (0 if none)
+        uint64_t mergeHits;        ///< the terms replaced by an equal term merged before
+        size_t   instructionCount; ///< the instructions of the generated program (0 if none)
+    };
+
+    std::vector<Pass> passes;
+    double            duration = 0.0; ///< seconds (wall time) of the whole compilation
+};
+
 class Compiler {
     class Context;
     const std::unique_ptr<Context> mContext;
@@ -22,6 +42,25 @@ public:
     void addConstant(StringView name, Real value);
     void addFunction(StringView name, RealFunction function);
 
+    /// Adds a function of two arguments.
+    ///
+    /// The standard `atan2`, `hypot`, `fmin`, `fmax`, `fmod` and `copysign` functions are compiled to
+    /// intrinsic instructions.
+    void addFunction(StringView name, BinaryRealFunction function);
+
+    /// Adds a function which is evaluated from a piecewise-cubic table within the given domain.
+    ///
+    /// The table is sampled at once, refined until the absolute error is within the tolerance. Outside the
+    /// domain, the function itself is called.
+    ///
+    /// \throws Exception if the function cannot be tabulated within the tolerance.
+    void addFunction(StringView name, RealFunction function, Interval domain, Real tolerance);
+
+    /// Adds a function with a batch variant, which is called once per vector word (rather than per lane).
+    ///
+    /// The scalar variant is still used for the evaluation of constant expressions.
+    void addFunction(StringView name, RealFunction function, BatchFunction batchFunction);
+
     void addParameter(StringView name, Real value);
     void addVariable(StringView name);
 
@@ -35,16 +74,61 @@ public:
 
     void addSourceScript(StringView input);
 
+    /// Sets the accuracy of the intrinsic functions of the compiled programs (full precision by default).
+    void setMathAccuracy(MathAccuracy accuracy);
+
     std::vector<StringView>                        getInputs() const;
     std::vector<std::pair<StringView, Real>>       getParameters() const;
     std::vector<std::pair<StringView, Expression>> getOutputs() const;
 
+    /// Returns the registry of the functions added to the compiler, e.g. to serialize the compiled programs.
+    FunctionRegistry getFunctions() const;
+
+    /// Returns the hash of everything the compiled program depends on: the symbols (including the values of
+    /// the constants and the parameters, and the source of the expressions), the outputs and the options.
+    ///
+    /// The expressions are hashed by their tokens, i.e. the changes of the whitespace or of the notation of
+    /// the numbers are insignificant.
+    ///
+    /// Note: The functions are identified by name and by the intrinsic they are compiled to (rather than by
+    ///       address), i.e. the fingerprint is stable across the processes, unless identified also by address
+    ///       (e.g. for the in-process caches).
+    uint64_t fingerprint(bool withFunctionAddresses = false) const;
+
+    /// Returns the input of the fingerprint, i.e. the canonical (binary) form of the compiler.
+    ///
+    /// Unlike the fingerprint, it is free of collisions, i.e. equal only for the equivalent compilers (e.g.
+    /// to verify the hits of the caches keyed by the fingerprints).
+    String fingerprintInput(bool withFunctionAddresses = false) const;
+
     Program compile() const;
 
+    /// Compiles the program and measures the cost of each pass (at the cost of counting the terms of the
+    /// graphs between the passes).
+    Program compile(CompileStats& stats) const;
+
+    /// A compiler of a fused program with the namespace of its outputs.
+    using Script = std::pair<StringView, const Compiler*>;
+
+    /// Compiles several scripts (on the same inputs) into a single program, i.e. with the subexpressions
+    /// shared across the scripts evaluated once.
+    ///
+    /// The outputs are namespaced by the script, i.e. named "<script>.<output>". The inputs of the same name
+    /// are shared; the symbols (including the parameters) of each script are resolved within the script.
+    ///
+    /// \throws CompileException if the scripts differ in the math accuracy, if any script name is repeated or
+    ///         if any of the namespaced output names collide.
+    static Program compileFused(const std::vector<Script>& scripts);
+
     // Internals
 
-    std::shared_ptr<const asg::Term> makeGraph() const;
-    Program                          compileGraph(const asg::Term& graph) const;
+    const asg::Term* makeGraph(asg::Arena& arena) const;
+    Program          compileGraph(const asg::Term& graph) const;
+
+    const Lexicon& publicSymbols() const;
+
+    /// Adds the symbol of the expression, which may be parsed later (see `ExpressionParser`).
+    void addExpressionSymbol(StringView name, const Expression& expression, Visibility visibility);
 };
 
 SIXPACK_NAMESPACE_END
@@ -5,6 +5,8 @@
 
 SIXPACK_NAMESPACE_BEGIN
 
+Expression::Data::~Data() = default;
+
 StringView Expression::input() const {
     return mData ? mData->input : StringView{};
 }
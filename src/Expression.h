@@ -6,6 +6,7 @@
 SIXPACK_NAMESPACE_BEGIN
 
 namespace ast {
+    class Arena;
     class Node;
     class Visitor;
 }
@@ -16,8 +17,11 @@ class Expression {
 
     struct Data {
         String                          input;
-        std::unique_ptr<ast::Node>      astRoot;
+        std::unique_ptr<ast::Arena>     arena; // of the nodes of the tree
+        const ast::Node*                astRoot = nullptr;
         std::unique_ptr<ParseException> error;
+
+        ~Data();
     };
     std::shared_ptr<Data> mData;
 
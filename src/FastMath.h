@@ -0,0 +1,344 @@
+#pragma once
+#include "Common.h"
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+SIXPACK_NAMESPACE_BEGIN
+
+/// Kernels of the transcendental intrinsic functions.
+///
+/// The `MathAccuracy::ULP_1` kernels forward to the standard library. The reduced-accuracy kernels are
+/// branch-free polynomial approximations (interpolated at Chebyshev nodes, i.e. close to minimax), so that
+/// the compiler is able to vectorize them across the lanes of a vector word.
+namespace fastmath {
+
+    namespace detail {
+
+        template <MathAccuracy TAccuracy>
+        struct Polynomials;
+
+        // Maximum relative errors: sin 3.4e-9, cos 3.9e-8, exp 1.0e-7, log 6.9e-10, atan 1.9e-8
+        template <>
+        struct Polynomials<MathAccuracy::REL_1E6> {
+            static constexpr std::array<Real, 4> SIN = { 0.9999999969177037,
+                                                         -0.16666650673996888,
+                                                         0.008332035785601629,
+                                                         -0.00019503904251270978 };
+            static constexpr std::array<Real, 4> COS = { 0.9999999723284944,
+                                                         -0.4999985641918237,
+                                                         0.04165501492489197,
+                                                         -0.0013585779264935316 };
+            static constexpr std::array<Real, 6> EXP = { 1.0000000754548972,  1.00000001077157,
+                                                         0.49998869378303235, 0.16666505260408312,
+                                                         0.041917507249629886, 0.0083691484908358 };
+            static constexpr std::array<Real, 4> LOG = { 0.9999999993156591,
+                                                         0.3333340766907518,
+                                                         0.19987425258923197,
+                                                         0.1496219523472216 };
+            static constexpr std::array<Real, 5> ATAN = { 0.9999999812646112,
+                                                          -0.3333278577192651,
+                                                          0.1997408241554351,
+                                                          -0.13848490212523237,
+                                                          0.07976291807368324 };
+        };
+
+        // Maximum relative errors: sin 4.3e-4, cos 1.4e-5, exp 1.0e-4, log 1.2e-7, atan 1.9e-5
+        template <>
+        struct Polynomials<MathAccuracy::REL_1E3> {
+            static constexpr std::array<Real, 2> SIN = { 0.99960941924772, -0.16159182468428127 };
+            static constexpr std::array<Real, 3> COS = { 0.9999899797834088,
+                                                         -0.49970742500618,
+                                                         0.04039737638404688 };
+            static constexpr std::array<Real, 4> EXP = { 0.9999245569508708,
+                                                         0.9999849286318739,
+                                                         0.505022284213558,
+                                                         0.16767011875167726 };
+            static constexpr std::array<Real, 3> LOG = { 1.0000001178987574,
+                                                         0.3332613336293264,
+                                                         0.20647454590649766 };
+            static constexpr std::array<Real, 3> ATAN = { 0.9999813450979945,
+                                                          -0.33136184831444465,
+                                                          0.16806253719203693 };
+        };
+
+        static constexpr Real TWO_OVER_PI = 0.63661977236758134308;
+        static constexpr Real PIO2_1      = 1.57079632673412561417e+00; // first 33 bits of pi/2
+        static constexpr Real PIO2_2      = 6.07710050630396597660e-11; // next 33 bits of pi/2
+        static constexpr Real PIO2_3      = 2.02226624879595063154e-21; // pi/2 - (PIO2_1 + PIO2_2)
+        static constexpr Real LOG2_E      = 1.44269504088896338700e+00;
+        static constexpr Real LN2_HI      = 6.93147180369123816490e-01;
+        static constexpr Real LN2_LO      = 1.90821492927058770002e-10;
+        static constexpr Real EXP_MAX     = 7.09782712893383973096e+02; // exp(EXP_MAX) == DBL_MAX
+        static constexpr Real EXP_MIN     = -7.08396418532264106224e+02; // exp(EXP_MIN) == DBL_MIN
+        static constexpr Real TAN_PI_8    = 0.41421356237309504880;
+        static constexpr Real HYPOT_MAX   = 6.70390396497129854978e+153; // 2^511
+        static constexpr Real HYPOT_MIN   = 1.49166814624004134866e-154; // 2^-511
+        static constexpr Real TRIG_MAX    = 8.23549664582963282200e+05;  // 2^19 * pi/2
+
+        // Adding this constant to an integral value (|value| < 2^51) moves it to the low mantissa bits.
+        static constexpr Real INTEGER_MAGIC = 6755399441055744.0; // 1.5 * 2^52
+
+        template <size_t N>
+        FORCEINLINE inline Real polynomial(const Real x, const std::array<Real, N>& coefficients) {
+            Real result = coefficients[N - 1];
+            for (size_t i = N - 1; i > 0; --i) {
+                result = result * x + coefficients[i - 1];
+            }
+            return result;
+        }
+
+        /// Reduces the argument to `x = k*pi/2 + r` (Cody-Waite), where `|r| <= pi/4`.
+        ///
+        /// Note: Accurate only for `|x| <= TRIG_MAX`, i.e. while `k` has at most 20 bits and thus the products
+        ///       `k*PIO2_1` and `k*PIO2_2` (of 33-bit constants) are exact; see `isTrigFastPath`. The reduction
+        ///       is still not exact: `r` carries the rounding of `k*PIO2_3` and of the last subtractions, which
+        ///       stays far below the error of the polynomials even next to the multiples of pi/2.
+        ///
+        /// \param[out] quadrant The lowest bits of `k`.
+        FORCEINLINE inline Real reduceHalfPi(const Real x, uint32_t& quadrant) {
+            const Real k = std::nearbyint(x * TWO_OVER_PI);
+            quadrant     = uint32_t(std::bit_cast<uint64_t>(k + INTEGER_MAGIC));
+            return ((x - k * PIO2_1) - k * PIO2_2) - k * PIO2_3;
+        }
+
+        /// Selects `sin(x)` from the sine and cosine of the reduced argument.
+        FORCEINLINE inline Real applyQuadrant(const Real sine, const Real cosine, const uint32_t quadrant) {
+            const Real value = (quadrant & 1) ? cosine : sine;
+            return (quadrant & 2) ? -value : value;
+        }
+
+        template <MathAccuracy TAccuracy>
+        FORCEINLINE inline Real reducedSin(const Real r) {
+            return r * polynomial(r * r, Polynomials<TAccuracy>::SIN);
+        }
+
+        template <MathAccuracy TAccuracy>
+        FORCEINLINE inline Real reducedCos(const Real r) {
+            return polynomial(r * r, Polynomials<TAccuracy>::COS);
+        }
+
+    } // namespace detail
+
+    /// Returns `true` if the reduced-accuracy sin()/cos() kernels handle the argument (`|x| <= 2^19*pi/2`).
+    ///
+    /// The other cases (the argument reduction would lose precision, non-finite arguments) are left to
+    /// `std::sin`/`std::cos`.
+    FORCEINLINE inline bool isTrigFastPath(const Real x) {
+        return std::abs(x) <= detail::TRIG_MAX;
+    }
+
+    /// The branch-free part of sin(); valid only if `isTrigFastPath(x)`.
+    template <MathAccuracy TAccuracy>
+    FORCEINLINE inline Real sinFastPath(const Real x) {
+        if constexpr (TAccuracy == MathAccuracy::ULP_1) {
+            return std::sin(x);
+        } else {
+            uint32_t   quadrant;
+            const Real r = detail::reduceHalfPi(x, quadrant);
+            return detail::applyQuadrant(
+                detail::reducedSin<TAccuracy>(r), detail::reducedCos<TAccuracy>(r), quadrant);
+        }
+    }
+
+    /// The branch-free part of cos(); valid only if `isTrigFastPath(x)`.
+    template <MathAccuracy TAccuracy>
+    FORCEINLINE inline Real cosFastPath(const Real x) {
+        if constexpr (TAccuracy == MathAccuracy::ULP_1) {
+            return std::cos(x);
+        } else {
+            uint32_t   quadrant;
+            const Real r = detail::reduceHalfPi(x, quadrant);
+            return detail::applyQuadrant(
+                detail::reducedSin<TAccuracy>(r), detail::reducedCos<TAccuracy>(r), quadrant + 1);
+        }
+    }
+
+    /// The branch-free part of sincos(); valid only if `isTrigFastPath(x)`.
+    template <MathAccuracy TAccuracy>
+    FORCEINLINE inline void sincosFastPath(const Real x, Real& sine, Real& cosine) {
+        if constexpr (TAccuracy == MathAccuracy::ULP_1) {
+            sine   = std::sin(x);
+            cosine = std::cos(x);
+        } else {
+            uint32_t   quadrant;
+            const Real r        = detail::reduceHalfPi(x, quadrant);
+            const Real sinValue = detail::reducedSin<TAccuracy>(r);
+            const Real cosValue = detail::reducedCos<TAccuracy>(r);
+            sine                = detail::applyQuadrant(sinValue, cosValue, quadrant);
+            cosine              = detail::applyQuadrant(sinValue, cosValue, quadrant + 1);
+        }
+    }
+
+    template <MathAccuracy TAccuracy>
+    FORCEINLINE inline Real sin(const Real x) {
+        if constexpr (TAccuracy == MathAccuracy::ULP_1) {
+            return std::sin(x);
+        } else {
+            return isTrigFastPath(x) ? sinFastPath<TAccuracy>(x) : std::sin(x);
+        }
+    }
+
+    template <MathAccuracy TAccuracy>
+    FORCEINLINE inline Real cos(const Real x) {
+        if constexpr (TAccuracy == MathAccuracy::ULP_1) {
+            return std::cos(x);
+        } else {
+            return isTrigFastPath(x) ? cosFastPath<TAccuracy>(x) : std::cos(x);
+        }
+    }
+
+    template <MathAccuracy TAccuracy>
+    FORCEINLINE inline void sincos(const Real x, Real& sine, Real& cosine) {
+        if (TAccuracy == MathAccuracy::ULP_1 || isTrigFastPath(x)) {
+            sincosFastPath<TAccuracy>(x, sine, cosine);
+        } else {
+            sine   = std::sin(x);
+            cosine = std::cos(x);
+        }
+    }
+
+    /// Note: The reduced-accuracy kernels flush subnormal results to zero.
+    template <MathAccuracy TAccuracy>
+    FORCEINLINE inline Real exp(const Real x) {
+        if constexpr (TAccuracy == MathAccuracy::ULP_1) {
+            return std::exp(x);
+        } else {
+            const Real k = std::nearbyint(x * detail::LOG2_E);
+            const Real r = (x - k * detail::LN2_HI) - k * detail::LN2_LO;
+            // Only the topmost k (1024) does not fit into the exponent; it is compensated by the last factor.
+            const Real     clampedK = std::min(std::max(k, -1022.0), 1023.0);
+            const uint64_t exponent = std::bit_cast<uint64_t>(clampedK + (detail::INTEGER_MAGIC + 1023.0));
+            const Real     scale    = std::bit_cast<Real>(exponent << 52);
+            const Real     result   = detail::polynomial(r, detail::Polynomials<TAccuracy>::EXP) * scale *
+                                (k - clampedK + 1.0);
+            return x > detail::EXP_MAX ? std::numeric_limits<Real>::infinity()
+                                       : (x < detail::EXP_MIN ? 0.0 : result);
+        }
+    }
+
+    template <MathAccuracy TAccuracy>
+    FORCEINLINE inline Real log(const Real x) {
+        if constexpr (TAccuracy == MathAccuracy::ULP_1) {
+            return std::log(x);
+        } else {
+            static constexpr uint64_t SQRT_HALF_BITS = 0x3fe6a09e667f3bcd;
+            static constexpr uint64_t EXPONENT_MASK  = 0x7ff0000000000000;
+            static constexpr Real     SUBNORMAL_SCALE = 18014398509481984.0; // 2^54
+
+            // Split x into 2^k * z, where z is in [sqrt(1/2), sqrt(2)).
+            const bool     subnormal = x < std::numeric_limits<Real>::min();
+            const uint64_t bits      = std::bit_cast<uint64_t>(subnormal ? x * SUBNORMAL_SCALE : x);
+            const uint64_t offset    = bits - SQRT_HALF_BITS;
+            const Real     k         = Real(int64_t(offset) >> 52) - (subnormal ? 54.0 : 0.0);
+            const Real     z         = std::bit_cast<Real>(bits - (offset & 0xfff0000000000000));
+            // log(z) = 2*atanh(s), where s = (z-1)/(z+1)
+            const Real s      = (z - 1.0) / (z + 1.0);
+            const Real result = k * detail::LN2_HI +
+                                (2.0 * s * detail::polynomial(s * s, detail::Polynomials<TAccuracy>::LOG) +
+                                 k * detail::LN2_LO);
+
+            const uint64_t xBits   = std::bit_cast<uint64_t>(x);
+            const Real     special = (xBits & EXPONENT_MASK) == EXPONENT_MASK ? x : result; // +inf or NaN
+            return x == 0.0 ? -std::numeric_limits<Real>::infinity()
+                            : ((xBits >> 63) ? std::numeric_limits<Real>::quiet_NaN() : special);
+        }
+    }
+
+    /// Returns `true` if the reduced-accuracy pow() kernel handles the given arguments.
+    ///
+    /// The other cases (non-positive or non-finite base, non-finite exponent) are left to `std::pow`.
+    FORCEINLINE inline bool isPowFastPath(const Real x, const Real y) {
+        static constexpr uint64_t EXPONENT_MASK = 0x7ff0000000000000;
+        return x > 0.0 && (std::bit_cast<uint64_t>(x) & EXPONENT_MASK) != EXPONENT_MASK &&
+               (std::bit_cast<uint64_t>(y) & EXPONENT_MASK) != EXPONENT_MASK;
+    }
+
+    /// The branch-free part of pow(); valid only if `isPowFastPath(x, y)`.
+    template <MathAccuracy TAccuracy>
+    FORCEINLINE inline Real powFastPath(const Real x, const Real y) {
+        if constexpr (TAccuracy == MathAccuracy::ULP_1) {
+            return std::pow(x, y);
+        } else {
+            return fastmath::exp<TAccuracy>(y * fastmath::log<TAccuracy>(x));
+        }
+    }
+
+    template <MathAccuracy TAccuracy>
+    FORCEINLINE inline Real pow(const Real x, const Real y) {
+        if constexpr (TAccuracy == MathAccuracy::ULP_1) {
+            return std::pow(x, y);
+        } else {
+            return isPowFastPath(x, y) ? powFastPath<TAccuracy>(x, y) : std::pow(x, y);
+        }
+    }
+
+    /// Note: The reduced-accuracy kernels follow `std::atan2` including the signed zeros and infinities.
+    template <MathAccuracy TAccuracy>
+    FORCEINLINE inline Real atan2(const Real y, const Real x) {
+        if constexpr (TAccuracy == MathAccuracy::ULP_1) {
+            return std::atan2(y, x);
+        } else {
+            static constexpr Real PI = 3.14159265358979323846;
+
+            // Reduce to atan(t), where t = min/max is in [0, 1], and further to [0, tan(pi/8)].
+            // Note: The quotients 0/0 and inf/inf are avoided explicitly.
+            const Real a       = std::abs(y);
+            const Real b       = std::abs(x);
+            const Real minimum = a < b ? a : b;
+            const Real maximum = a < b ? b : a;
+            const Real t       = maximum == 0.0 ? 0.0 : (minimum == maximum ? 1.0 : minimum / maximum);
+            const bool upper   = t > detail::TAN_PI_8;
+            const Real r       = upper ? (t - 1.0) / (t + 1.0) : t;
+            const Real atanR   = r * detail::polynomial(r * r, detail::Polynomials<TAccuracy>::ATAN);
+            const Real atanT   = (upper ? PI / 4 : 0.0) + atanR;
+            const Real angle   = a > b ? PI / 2 - atanT : atanT;
+            const Real result  = std::copysign(std::signbit(x) ? PI - angle : angle, y);
+            return (x != x || y != y) ? x + y : result;
+        }
+    }
+
+    /// Returns `true` if the reduced-accuracy hypot() kernel handles the given arguments.
+    ///
+    /// The other cases (risk of overflow or underflow, non-finite arguments) are left to `std::hypot`.
+    FORCEINLINE inline bool isHypotFastPath(const Real x, const Real y) {
+        const Real maximum = std::max(std::abs(x), std::abs(y));
+        return maximum < detail::HYPOT_MAX && (maximum > detail::HYPOT_MIN || maximum == 0.0);
+    }
+
+    /// The branch-free part of hypot(); valid only if `isHypotFastPath(x, y)`.
+    template <MathAccuracy TAccuracy>
+    FORCEINLINE inline Real hypotFastPath(const Real x, const Real y) {
+        if constexpr (TAccuracy == MathAccuracy::ULP_1) {
+            return std::hypot(x, y);
+        } else {
+            return std::sqrt(x * x + y * y);
+        }
+    }
+
+    template <MathAccuracy TAccuracy>
+    FORCEINLINE inline Real hypot(const Real x, const Real y) {
+        if constexpr (TAccuracy == MathAccuracy::ULP_1) {
+            return std::hypot(x, y);
+        } else {
+            return isHypotFastPath(x, y) ? hypotFastPath<TAccuracy>(x, y) : std::hypot(x, y);
+        }
+    }
+
+    /// Same as `std::fmin` (i.e. NaN is returned only if both arguments are NaN), but compiled to a compare
+    /// and a blend rather than a library call.
+    FORCEINLINE inline Real fmin(const Real x, const Real y) {
+        return (y < x || x != x) ? y : x;
+    }
+
+    /// Same as `std::fmax` (i.e. NaN is returned only if both arguments are NaN), but compiled to a compare
+    /// and a blend rather than a library call.
+    FORCEINLINE inline Real fmax(const Real x, const Real y) {
+        return (y > x || x != x) ? y : x;
+    }
+
+} // namespace fastmath
+
+SIXPACK_NAMESPACE_END
@@ -0,0 +1,69 @@
+#include "FunctionRegistry.h"
+#include "Exception.h"
+#include <format>
+
+SIXPACK_NAMESPACE_BEGIN
+
+namespace {
+
+    template <typename TFunctions, typename TFunction>
+    static void addFunction(TFunctions& functions, StringView name, TFunction function) {
+        assert(function);
+        if (!functions.byName.try_emplace(String(name), function).second) {
+            throw Exception(std::format("Duplicate function '{}'", name));
+        }
+        // Note: The function registered under several names is serialized by the first one.
+        functions.byAddress.try_emplace(function, name);
+    }
+
+    template <typename TFunctions>
+    static auto lookUpFunction(const TFunctions& functions, StringView name) {
+        const auto functionIt = functions.byName.find(String(name));
+        return functionIt != functions.byName.end() ? functionIt->second : nullptr;
+    }
+
+    template <typename TFunctions, typename TFunction>
+    static StringView lookUpName(const TFunctions& functions, TFunction function) {
+        const auto nameIt = functions.byAddress.find(function);
+        return nameIt != functions.byAddress.end() ? StringView(nameIt->second) : StringView();
+    }
+
+} // anonymous namespace
+
+void FunctionRegistry::add(StringView name, RealFunction function) {
+    addFunction(mFunctions, name, function);
+}
+
+void FunctionRegistry::add(StringView name, BinaryRealFunction function) {
+    addFunction(mBinaryFunctions, name, function);
+}
+
+void FunctionRegistry::add(StringView name, BatchFunction function) {
+    addFunction(mBatchFunctions, name, function);
+}
+
+RealFunction FunctionRegistry::findFunction(StringView name) const {
+    return lookUpFunction(mFunctions, name);
+}
+
+BinaryRealFunction FunctionRegistry::findBinaryFunction(StringView name) const {
+    return lookUpFunction(mBinaryFunctions, name);
+}
+
+BatchFunction FunctionRegistry::findBatchFunction(StringView name) const {
+    return lookUpFunction(mBatchFunctions, name);
+}
+
+StringView FunctionRegistry::nameOf(RealFunction function) const {
+    return lookUpName(mFunctions, function);
+}
+
+StringView FunctionRegistry::nameOf(BinaryRealFunction function) const {
+    return lookUpName(mBinaryFunctions, function);
+}
+
+StringView FunctionRegistry::nameOf(BatchFunction function) const {
+    return lookUpName(mBatchFunctions, function);
+}
+
+SIXPACK_NAMESPACE_END
@@ -0,0 +1,45 @@
+#pragma once
+#include "Common.h"
+#include <unordered_map>
+
+SIXPACK_NAMESPACE_BEGIN
+
+/// A two-way mapping between the names of the functions and their addresses.
+///
+/// The addresses of the functions are specific to the process; the serialized programs refer to the
+/// functions by name, which are re-bound through the registry on load.
+class FunctionRegistry {
+    template <typename TFunction>
+    struct Functions {
+        std::unordered_map<String, TFunction> byName;
+        std::unordered_map<TFunction, String> byAddress;
+    };
+
+    Functions<RealFunction>       mFunctions;
+    Functions<BinaryRealFunction> mBinaryFunctions;
+    Functions<BatchFunction>      mBatchFunctions;
+
+public:
+    /// Adds a named function.
+    ///
+    /// \throws Exception if another function of the same kind is already registered under the name.
+    void add(StringView name, RealFunction function);
+    void add(StringView name, BinaryRealFunction function);
+    void add(StringView name, BatchFunction function);
+
+    /// Finds the function of the given name.
+    ///
+    /// \returns The function, or nullptr.
+    RealFunction       findFunction(StringView name) const;
+    BinaryRealFunction findBinaryFunction(StringView name) const;
+    BatchFunction      findBatchFunction(StringView name) const;
+
+    /// Finds the name of the given function.
+    ///
+    /// \returns The name, or an empty string.
+    StringView nameOf(RealFunction function) const;
+    StringView nameOf(BinaryRealFunction function) const;
+    StringView nameOf(BatchFunction function) const;
+};
+
+SIXPACK_NAMESPACE_END
@@ -0,0 +1,120 @@
+#include "FunctionTable.h"
+#include "Exception.h"
+#include <cmath>
+#include <format>
+#include <numbers>
+
+SIXPACK_NAMESPACE_BEGIN
+
+namespace {
+
+    static constexpr int INITIAL_SEGMENT_COUNT = 16;
+    static constexpr int MAXIMUM_SEGMENT_COUNT = 1 << 16;
+
+} // anonymous namespace
+
+FunctionTable::FunctionTable(RealFunction function, Interval domain, Real tolerance)
+    : mFunction(function)
+    , mDomain(domain) {
+    assert(mFunction);
+    if (!(mDomain.lower < mDomain.upper) || !std::isfinite(mDomain.lower) || !std::isfinite(mDomain.upper)) {
+        throw Exception(std::format("Invalid domain [{}, {}]", mDomain.lower, mDomain.upper));
+    }
+    for (int segmentCount = INITIAL_SEGMENT_COUNT; segmentCount <= MAXIMUM_SEGMENT_COUNT; segmentCount *= 2) {
+        build(segmentCount);
+        const Real error = measureError();
+        if (!std::isfinite(error)) {
+            throw Exception(
+                std::format("Function is not finite over the domain [{}, {}]", mDomain.lower, mDomain.upper));
+        }
+        if (error <= tolerance) {
+            return;
+        }
+    }
+    throw Exception(std::format("Unable to tabulate the function within the tolerance {}", tolerance));
+}
+
+FunctionTable::FunctionTable(RealFunction function, Interval domain, std::vector<Real> coefficients)
+    : mFunction(function)
+    , mDomain(domain)
+    , mCoefficients(std::move(coefficients))
+    , mData(mCoefficients.data()) {
+    initialize(mCoefficients.size());
+}
+
+FunctionTable::FunctionTable(RealFunction function, Interval domain, std::span<const Real> coefficients)
+    : mFunction(function)
+    , mDomain(domain)
+    , mData(coefficients.data()) {
+    initialize(coefficients.size());
+}
+
+void FunctionTable::initialize(size_t coefficientCount) {
+    assert(mFunction);
+    if (!(mDomain.lower < mDomain.upper) || !std::isfinite(mDomain.lower) || !std::isfinite(mDomain.upper)) {
+        throw Exception(std::format("Invalid domain [{}, {}]", mDomain.lower, mDomain.upper));
+    }
+    if (coefficientCount == 0 || coefficientCount % COEFFICIENTS != 0 ||
+        coefficientCount / COEFFICIENTS > MAXIMUM_SEGMENT_COUNT) {
+        throw Exception(std::format("Invalid number of the table coefficients ({})", coefficientCount));
+    }
+    mSegmentCount = int(coefficientCount / COEFFICIENTS);
+    mScale        = Real(mSegmentCount) / (mDomain.upper - mDomain.lower);
+}
+
+// Interpolates each segment at the Chebyshev nodes (i.e. a near-minimax cubic).
+void FunctionTable::build(int segmentCount) {
+    static constexpr int NODES = COEFFICIENTS;
+
+    mSegmentCount = segmentCount;
+    mScale        = Real(segmentCount) / (mDomain.upper - mDomain.lower);
+    mCoefficients.assign(size_t(COEFFICIENTS) * segmentCount, 0.0);
+    mData = mCoefficients.data();
+
+    Real nodes[NODES];
+    for (int j = 0; j < NODES; ++j) {
+        nodes[j] = std::cos(std::numbers::pi_v<Real> * (j + 0.5) / NODES);
+    }
+    const Real segmentWidth = 1.0 / mScale;
+    for (int segment = 0; segment < segmentCount; ++segment) {
+        const Real center = mDomain.lower + (segment + 0.5) * segmentWidth;
+        // Chebyshev coefficients
+        Real chebyshev[NODES] = {};
+        for (int j = 0; j < NODES; ++j) {
+            const Real value = mFunction(center + 0.5 * segmentWidth * nodes[j]);
+            const Real theta = std::numbers::pi_v<Real> * (j + 0.5) / NODES;
+            for (int k = 0; k < NODES; ++k) {
+                chebyshev[k] += 2.0 / NODES * value * std::cos(k * theta);
+            }
+        }
+        chebyshev[0] /= 2.0;
+        // Conversion to the monomial basis: T2 = 2s^2-1, T3 = 4s^3-3s
+        Real* const c = mCoefficients.data() + COEFFICIENTS * segment;
+        c[0]          = chebyshev[0] - chebyshev[2];
+        c[1]          = chebyshev[1] - 3.0 * chebyshev[3];
+        c[2]          = 2.0 * chebyshev[2];
+        c[3]          = 4.0 * chebyshev[3];
+    }
+}
+
+// Compares the table to the function in between (and at) the interpolation nodes.
+Real FunctionTable::measureError() const {
+    static constexpr int SAMPLES = 8;
+
+    Real       maxError     = 0.0;
+    const Real segmentWidth = 1.0 / mScale;
+    for (int segment = 0; segment < mSegmentCount; ++segment) {
+        for (int i = 0; i <= SAMPLES; ++i) {
+            const Real x =
+                std::min(mDomain.lower + (segment + Real(i) / SAMPLES) * segmentWidth, mDomain.upper);
+            const Real error = std::abs(interpolate(x) - mFunction(x));
+            if (!std::isfinite(error)) {
+                return error;
+            }
+            maxError = std::max(maxError, error);
+        }
+    }
+    return maxError;
+}
+
+SIXPACK_NAMESPACE_END
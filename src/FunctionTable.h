@@ -0,0 +1,72 @@
+#pragma once
+#include "Common.h"
+#include <algorithm>
+#include <span>
+#include <vector>
+
+SIXPACK_NAMESPACE_BEGIN
+
+/// A tabulated (piecewise-cubic) approximation of a function of a single real argument.
+///
+/// The table covers the given domain with uniform segments; the segment count is refined until the
+/// approximation meets the requested (absolute) tolerance. Outside the domain, the original function is used.
+class FunctionTable {
+    static constexpr int COEFFICIENTS = 4;
+
+    const RealFunction mFunction;
+    const Interval     mDomain;
+    int                mSegmentCount = 0;
+    Real               mScale        = 0.0;     // segments per unit
+    std::vector<Real>  mCoefficients;           // COEFFICIENTS per segment, in the local variable [-1, 1]
+    const Real*        mData         = nullptr; // the coefficients, either owned or viewed
+
+public:
+    /// Samples the function into the table.
+    ///
+    /// \throws Exception if the function is not finite over the domain or if the tolerance cannot be met.
+    FunctionTable(RealFunction function, Interval domain, Real tolerance);
+
+    /// Restores the previously sampled table (e.g. a deserialized one) from its coefficients.
+    ///
+    /// \throws Exception if the domain or the coefficients are not valid.
+    FunctionTable(RealFunction function, Interval domain, std::vector<Real> coefficients);
+
+    /// Views the coefficients of the previously sampled table in place (e.g. in a shared program image),
+    /// i.e. without any copy. The coefficients must outlive the table.
+    ///
+    /// \throws Exception if the domain or the coefficients are not valid.
+    FunctionTable(RealFunction function, Interval domain, std::span<const Real> coefficients);
+
+    FunctionTable(const FunctionTable&)            = delete;
+    FunctionTable& operator=(const FunctionTable&) = delete;
+
+    RealFunction    function() const { return mFunction; }
+    const Interval& domain() const { return mDomain; }
+    int             segmentCount() const { return mSegmentCount; }
+
+    std::span<const Real> coefficients() const { return { mData, size_t(COEFFICIENTS) * mSegmentCount }; }
+
+    bool contains(const Real x) const { return x >= mDomain.lower && x <= mDomain.upper; }
+
+    /// Evaluates the tabulated polynomial; the argument is clamped to the domain.
+    ///
+    /// The evaluation is branch-free so that it can be vectorized (the coefficients are gathered).
+    FORCEINLINE Real interpolate(const Real x) const {
+        const Real t       = (x - mDomain.lower) * mScale;
+        const Real clamped = std::min(t > 0.0 ? t : 0.0, Real(mSegmentCount)); // NaN -> 0
+        const int  segment = std::min(int(clamped), mSegmentCount - 1);
+        const Real s       = 2.0 * (clamped - Real(segment)) - 1.0;
+        const Real* const c = mData + COEFFICIENTS * segment;
+        return ((c[3] * s + c[2]) * s + c[1]) * s + c[0];
+    }
+
+    /// Evaluates the function, either from the table or from the original function outside the domain.
+    Real evaluate(const Real x) const { return contains(x) ? interpolate(x) : mFunction(x); }
+
+private:
+    void initialize(size_t coefficientCount);
+    void build(int segmentCount);
+    Real measureError() const;
+};
+
+SIXPACK_NAMESPACE_END
@@ -0,0 +1,206 @@
+#include "MappedFile.h"
+#include "Exception.h"
+#include <format>
+
+#if defined(_WIN32)
+#   define NOMINMAX
+#   define WIN32_LEAN_AND_MEAN
+#   include <windows.h>
+#else
+#   include <cerrno>
+#   include <cstring>
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+SIXPACK_NAMESPACE_BEGIN
+
+namespace {
+
+#if defined(_WIN32)
+
+    static Exception makeSystemException(StringView what, const String& path) {
+        return Exception(std::format("Cannot {} '{}' (error {})", what, path, GetLastError()));
+    }
+
+#else
+
+    static Exception makeSystemException(StringView what, const String& path) {
+        return Exception(std::format("Cannot {} '{}' ({})", what, path, std::strerror(errno)));
+    }
+
+#endif
+
+} // anonymous namespace
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const String& path) {
+    mFile = CreateFileA(path.c_str(),
+                        GENERIC_READ,
+                        FILE_SHARE_READ,
+                        nullptr,
+                        OPEN_EXISTING,
+                        FILE_FLAG_SEQUENTIAL_SCAN,
+                        nullptr);
+    if (mFile == INVALID_HANDLE_VALUE) {
+        mFile = nullptr;
+        throw makeSystemException("open", path);
+    }
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(mFile, &size)) {
+        const Exception exception = makeSystemException("stat", path);
+        close();
+        throw exception;
+    }
+    mSize = size_t(size.QuadPart);
+    if (mSize == 0) {
+        return; // empty files cannot be mapped
+    }
+    mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    mData    = mMapping ? static_cast<std::byte*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+    if (!mData) {
+        const Exception exception = makeSystemException("map", path);
+        close();
+        throw exception;
+    }
+}
+
+MappedFile::MappedFile(const String& path, size_t size)
+    : mSize(size)
+    , mWritable(true) {
+    mFile = CreateFileA(path.c_str(),
+                        GENERIC_READ | GENERIC_WRITE,
+                        0,
+                        nullptr,
+                        CREATE_ALWAYS,
+                        FILE_ATTRIBUTE_NORMAL,
+                        nullptr);
+    if (mFile == INVALID_HANDLE_VALUE) {
+        mFile = nullptr;
+        throw makeSystemException("create", path);
+    }
+    if (mSize == 0) {
+        return;
+    }
+    const LARGE_INTEGER largeSize{ .QuadPart = LONGLONG(mSize) };
+    mMapping = CreateFileMappingA(
+        mFile, nullptr, PAGE_READWRITE, DWORD(largeSize.HighPart), largeSize.LowPart, nullptr);
+    mData = mMapping ? static_cast<std::byte*>(MapViewOfFile(mMapping, FILE_MAP_WRITE, 0, 0, 0)) : nullptr;
+    if (!mData) {
+        const Exception exception = makeSystemException("map", path);
+        close();
+        throw exception;
+    }
+}
+
+void MappedFile::adviseSequential() const {
+    if (mData) {
+        WIN32_MEMORY_RANGE_ENTRY range{ .VirtualAddress = mData, .NumberOfBytes = mSize };
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+}
+
+void MappedFile::flush() const {
+    if (mData && mWritable && (!FlushViewOfFile(mData, 0) || !FlushFileBuffers(mFile))) {
+        throw Exception(std::format("Cannot flush the mapped file (error {})", GetLastError()));
+    }
+}
+
+void MappedFile::close() {
+    if (mData) {
+        UnmapViewOfFile(mData);
+    }
+    if (mMapping) {
+        CloseHandle(mMapping);
+    }
+    if (mFile) {
+        CloseHandle(mFile);
+    }
+    mData    = nullptr;
+    mMapping = nullptr;
+    mFile    = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile(const String& path) {
+    mFile = ::open(path.c_str(), O_RDONLY);
+    if (mFile < 0) {
+        throw makeSystemException("open", path);
+    }
+    struct stat status {};
+    if (::fstat(mFile, &status) != 0) {
+        const Exception exception = makeSystemException("stat", path);
+        close();
+        throw exception;
+    }
+    mSize = size_t(status.st_size);
+    if (mSize == 0) {
+        return; // empty files cannot be mapped
+    }
+    void* const data = ::mmap(nullptr, mSize, PROT_READ, MAP_SHARED, mFile, 0);
+    if (data == MAP_FAILED) {
+        const Exception exception = makeSystemException("map", path);
+        close();
+        throw exception;
+    }
+    mData = static_cast<std::byte*>(data);
+}
+
+MappedFile::MappedFile(const String& path, size_t size)
+    : mSize(size)
+    , mWritable(true) {
+    mFile = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (mFile < 0) {
+        throw makeSystemException("create", path);
+    }
+    if (::ftruncate(mFile, off_t(mSize)) != 0) {
+        const Exception exception = makeSystemException("resize", path);
+        close();
+        throw exception;
+    }
+    if (mSize == 0) {
+        return;
+    }
+    void* const data = ::mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFile, 0);
+    if (data == MAP_FAILED) {
+        const Exception exception = makeSystemException("map", path);
+        close();
+        throw exception;
+    }
+    mData = static_cast<std::byte*>(data);
+}
+
+void MappedFile::adviseSequential() const {
+    if (mData) {
+        ::madvise(mData, mSize, MADV_SEQUENTIAL);
+    }
+}
+
+void MappedFile::flush() const {
+    if (mData && mWritable && ::msync(mData, mSize, MS_SYNC) != 0) {
+        throw Exception(std::format("Cannot flush the mapped file ({})", std::strerror(errno)));
+    }
+}
+
+void MappedFile::close() {
+    if (mData) {
+        ::munmap(mData, mSize);
+    }
+    if (mFile >= 0) {
+        ::close(mFile);
+    }
+    mData = nullptr;
+    mFile = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+SIXPACK_NAMESPACE_END
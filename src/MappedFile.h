@@ -0,0 +1,58 @@
+#pragma once
+#include "Common.h"
+#include <cstddef>
+#include <span>
+
+SIXPACK_NAMESPACE_BEGIN
+
+/// A file mapped into the memory of the process.
+///
+/// The pages are read (or written back) by the operating system on demand, i.e. without any copies through
+/// the user-space buffers.
+class MappedFile {
+    std::byte* mData     = nullptr;
+    size_t     mSize     = 0;
+    bool       mWritable = false;
+#if defined(_WIN32)
+    void* mFile    = nullptr;
+    void* mMapping = nullptr;
+#else
+    int mFile = -1;
+#endif
+
+public:
+    /// Maps the existing file for reading.
+    ///
+    /// \throws Exception if the file cannot be opened or mapped.
+    explicit MappedFile(const String& path);
+
+    /// Creates (or truncates) the file of the given size and maps it for writing.
+    ///
+    /// \throws Exception if the file cannot be created or mapped.
+    MappedFile(const String& path, size_t size);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    size_t size() const { return mSize; }
+
+    std::span<const std::byte> data() const { return { mData, mSize }; }
+
+    /// Returns the writable view of the file (empty if mapped for reading).
+    std::span<std::byte> writableData() { return { mWritable ? mData : nullptr, mWritable ? mSize : 0 }; }
+
+    /// Hints the operating system that the file is going to be accessed sequentially (i.e. to read ahead).
+    void adviseSequential() const;
+
+    /// Writes the modified pages back to the file and waits for the completion.
+    ///
+    /// \throws Exception if the pages cannot be written.
+    void flush() const;
+
+private:
+    void close();
+};
+
+SIXPACK_NAMESPACE_END
@@ -0,0 +1,131 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <mutex>
+#include <unordered_set>
+
+SIXPACK_NAMESPACE_BEGIN
+
+// Note: Only the marker of the setting of the library is defined, see `SIXPACK_METRICS`.
+const int configuration::SIXPACK_METRICS_MARKER = SIXPACK_METRICS;
+
+namespace {
+
+    struct Registry {
+        std::mutex                                   mutex;
+        std::unordered_set<Metrics::ThreadCounters*> threads;
+        Metrics::Snapshot                            exitedThreads{}; // the counters of the exited threads
+    };
+
+    // Note: The registry is never destroyed, i.e. it outlives the counters of the threads exiting late.
+    static Registry& getRegistry() {
+        static Registry* const registry = new Registry;
+        return *registry;
+    }
+
+    static uint64_t read(const std::atomic<uint64_t>& counter) {
+        return counter.load(std::memory_order_relaxed);
+    }
+
+    static void accumulate(Metrics::Snapshot& snapshot, const Metrics::ThreadCounters& counters) {
+        snapshot.runs             += read(counters.runs);
+        snapshot.points           += read(counters.points);
+        snapshot.batches          += read(counters.batches);
+        snapshot.batchPoints      += read(counters.batchPoints);
+        snapshot.batchNanoseconds += read(counters.batchNanoseconds);
+        for (size_t i = 0; i < Metrics::BATCH_HISTOGRAM_SIZE; ++i) {
+            snapshot.batchSizes[i] += read(counters.batchSizes[i]);
+        }
+        snapshot.nanOutputs            += read(counters.nanOutputs);
+        snapshot.infinityOutputs       += read(counters.infinityOutputs);
+        snapshot.compilations          += read(counters.compilations);
+        snapshot.failedCompilations    += read(counters.failedCompilations);
+        snapshot.compileNanoseconds    += read(counters.compileNanoseconds);
+        snapshot.maxCompileNanoseconds  = std::max(snapshot.maxCompileNanoseconds,
+                                                  read(counters.maxCompileNanoseconds));
+    }
+
+} // anonymous namespace
+
+Metrics::ThreadCounters::ThreadCounters() {
+    Registry&       registry = getRegistry();
+    std::lock_guard lock(registry.mutex);
+    registry.threads.insert(this);
+}
+
+Metrics::ThreadCounters::~ThreadCounters() {
+    Registry&       registry = getRegistry();
+    std::lock_guard lock(registry.mutex);
+    accumulate(registry.exitedThreads, *this);
+    registry.threads.erase(this);
+}
+
+double Metrics::Snapshot::pointsPerSecond(const Snapshot& earlier) const {
+    const double seconds = std::chrono::duration<double>(time - earlier.time).count();
+    return seconds > 0.0 ? double(points - earlier.points) / seconds : 0.0;
+}
+
+Metrics::Snapshot Metrics::Snapshot::operator-(const Snapshot& earlier) const {
+    Snapshot difference          = *this;
+    difference.runs             -= earlier.runs;
+    difference.points           -= earlier.points;
+    difference.batches          -= earlier.batches;
+    difference.batchPoints      -= earlier.batchPoints;
+    difference.batchNanoseconds -= earlier.batchNanoseconds;
+    for (size_t i = 0; i < BATCH_HISTOGRAM_SIZE; ++i) {
+        difference.batchSizes[i] -= earlier.batchSizes[i];
+    }
+    difference.nanOutputs         -= earlier.nanOutputs;
+    difference.infinityOutputs    -= earlier.infinityOutputs;
+    difference.compilations       -= earlier.compilations;
+    difference.failedCompilations -= earlier.failedCompilations;
+    difference.compileNanoseconds -= earlier.compileNanoseconds;
+    return difference;
+}
+
+Metrics::Snapshot Metrics::snapshot() {
+    Registry&       registry = getRegistry();
+    std::lock_guard lock(registry.mutex);
+    Snapshot        snapshot = registry.exitedThreads;
+    for (const ThreadCounters* counters : registry.threads) {
+        accumulate(snapshot, *counters);
+    }
+    snapshot.time = std::chrono::steady_clock::now();
+    return snapshot;
+}
+
+void Metrics::recordCompilation(uint64_t nanoseconds, bool failed) {
+    ThreadCounters& counters = local();
+    add(counters.compilations, 1);
+    add(counters.failedCompilations, failed ? 1 : 0);
+    add(counters.compileNanoseconds, nanoseconds);
+    if (nanoseconds > read(counters.maxCompileNanoseconds)) {
+        counters.maxCompileNanoseconds.store(nanoseconds, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::recordBatch(size_t pointCount, uint64_t nanoseconds) {
+    ThreadCounters& counters = local();
+    add(counters.batches, 1);
+    add(counters.batchPoints, pointCount);
+    add(counters.batchNanoseconds, nanoseconds);
+    const size_t bucket = pointCount > 0 ? size_t(std::bit_width(pointCount)) - 1 : 0;
+    add(counters.batchSizes[std::min(bucket, BATCH_HISTOGRAM_SIZE - 1)], 1);
+}
+
+void Metrics::recordNonFinite(const Real* values, size_t count) {
+    uint64_t nanCount      = 0;
+    uint64_t infinityCount = 0;
+    for (size_t i = 0; i < count; ++i) {
+        nanCount      += std::isnan(values[i]) ? 1 : 0;
+        infinityCount += std::isinf(values[i]) ? 1 : 0;
+    }
+    if (nanCount > 0 || infinityCount > 0) {
+        ThreadCounters& counters = local();
+        add(counters.nanOutputs, nanCount);
+        add(counters.infinityOutputs, infinityCount);
+    }
+}
+
+SIXPACK_NAMESPACE_END
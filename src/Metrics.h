@@ -0,0 +1,175 @@
+#pragma once
+#include "Common.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <exception>
+
+// The switch of the evaluation metrics: if 0 (the default), the recording compiles to nothing, i.e. the
+// snapshots are all zeros.
+//
+// Note: The switch changes the classes below and the inline `Executable::run`, i.e. it is a build-wide
+//       setting: it must be the same for the library and all of its users (e.g. defined for all the
+//       projects). A mismatch fails to link, as each object including this header refers to the marker of
+//       its setting, which only Metrics.cpp defines (MSVC also compares the settings of all the objects).
+#ifndef SIXPACK_METRICS
+#   define SIXPACK_METRICS 0
+#endif
+
+#if SIXPACK_METRICS
+#   define SIXPACK_METRICS_MARKER metricsEnabled
+#else
+#   define SIXPACK_METRICS_MARKER metricsDisabled
+#endif
+
+#if defined(_MSC_VER)
+#   if SIXPACK_METRICS
+#       pragma detect_mismatch("SIXPACK_METRICS", "1")
+#   else
+#       pragma detect_mismatch("SIXPACK_METRICS", "0")
+#   endif
+#endif
+
+SIXPACK_NAMESPACE_BEGIN
+
+namespace configuration {
+    extern const int SIXPACK_METRICS_MARKER;
+
+#if !defined(_MSC_VER) || defined(__clang__)
+    [[gnu::used]] static const int* const metricsMarker = &SIXPACK_METRICS_MARKER;
+#endif
+} // namespace configuration
+
+/// The process-wide counters of the evaluations and of the compilations.
+///
+/// Each thread records into its own counters (i.e. with no atomic read-modify-write and no sharing of the
+/// cache lines); the snapshot sums the counters of all the threads, including those already exited. The
+/// counts are monotonic, i.e. the rates are the differences of two snapshots.
+///
+/// The executables count their runs, the parallel evaluations their batches (i.e. the calls of `evaluate`)
+/// and the non-finite outputs, the compiler its compilations.
+class Metrics {
+public:
+    static constexpr bool   ENABLED             = SIXPACK_METRICS != 0;
+    static constexpr size_t BATCH_HISTOGRAM_SIZE = 32;
+
+    struct Snapshot {
+        std::chrono::steady_clock::time_point time;
+
+        uint64_t runs;   ///< of the executables (i.e. words)
+        uint64_t points; ///< evaluated by the runs (i.e. lanes)
+
+        uint64_t                                   batches;
+        uint64_t                                   batchPoints;
+        uint64_t                                   batchNanoseconds;
+        std::array<uint64_t, BATCH_HISTOGRAM_SIZE> batchSizes; ///< the batches of [2^i, 2^(i+1)) points
+        uint64_t                                   nanOutputs;
+        uint64_t                                   infinityOutputs;
+
+        uint64_t compilations;
+        uint64_t failedCompilations;
+        uint64_t compileNanoseconds;
+        uint64_t maxCompileNanoseconds;
+
+        /// Returns the evaluated points per second since the earlier snapshot.
+        double pointsPerSecond(const Snapshot& earlier) const;
+
+        /// Returns the counts since the earlier snapshot (the maximum compile time is kept).
+        Snapshot operator-(const Snapshot& earlier) const;
+    };
+
+    /// The counters of a thread.
+    ///
+    /// Note: The counters are written by their thread only, i.e. the relaxed loads and stores suffice.
+    struct alignas(64) ThreadCounters {
+        std::atomic<uint64_t>                                   runs{ 0 };
+        std::atomic<uint64_t>                                   points{ 0 };
+        std::atomic<uint64_t>                                   batches{ 0 };
+        std::atomic<uint64_t>                                   batchPoints{ 0 };
+        std::atomic<uint64_t>                                   batchNanoseconds{ 0 };
+        std::array<std::atomic<uint64_t>, BATCH_HISTOGRAM_SIZE> batchSizes{};
+        std::atomic<uint64_t>                                   nanOutputs{ 0 };
+        std::atomic<uint64_t>                                   infinityOutputs{ 0 };
+        std::atomic<uint64_t>                                   compilations{ 0 };
+        std::atomic<uint64_t>                                   failedCompilations{ 0 };
+        std::atomic<uint64_t>                                   compileNanoseconds{ 0 };
+        std::atomic<uint64_t>                                   maxCompileNanoseconds{ 0 };
+
+        ThreadCounters();
+        ~ThreadCounters();
+
+        ThreadCounters(const ThreadCounters&)            = delete;
+        ThreadCounters& operator=(const ThreadCounters&) = delete;
+    };
+
+    /// Measures a compilation, from the construction to the destruction (failed if by an exception).
+    class CompilationScope {
+#if SIXPACK_METRICS
+        const std::chrono::steady_clock::time_point mStart = std::chrono::steady_clock::now();
+        const int                                   mExceptionCount = std::uncaught_exceptions();
+
+    public:
+        ~CompilationScope() {
+            recordCompilation(nanosecondsSince(mStart), std::uncaught_exceptions() > mExceptionCount);
+        }
+#endif
+    };
+
+    /// Measures a batch, from the construction to the destruction.
+    class BatchScope {
+#if SIXPACK_METRICS
+        const std::chrono::steady_clock::time_point mStart = std::chrono::steady_clock::now();
+        const size_t                                mPointCount;
+
+    public:
+        explicit BatchScope(size_t pointCount)
+            : mPointCount(pointCount) {}
+
+        ~BatchScope() { recordBatch(mPointCount, nanosecondsSince(mStart)); }
+#else
+    public:
+        explicit BatchScope(size_t) {}
+#endif
+    };
+
+    /// Returns the sum of the counters of all the threads.
+    static Snapshot snapshot();
+
+    /// Records a run of an executable evaluating the given number of points.
+    FORCEINLINE static void recordRun([[maybe_unused]] size_t pointCount) {
+        if constexpr (ENABLED) {
+            ThreadCounters& counters = local();
+            add(counters.runs, 1);
+            add(counters.points, pointCount);
+        }
+    }
+
+    /// Counts the non-finite values among the outputs.
+    static void recordOutputs([[maybe_unused]] const Real* values, [[maybe_unused]] size_t count) {
+        if constexpr (ENABLED) {
+            recordNonFinite(values, count);
+        }
+    }
+
+private:
+    static ThreadCounters& local() {
+        thread_local ThreadCounters counters;
+        return counters;
+    }
+
+    FORCEINLINE static void add(std::atomic<uint64_t>& counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    static uint64_t nanosecondsSince(std::chrono::steady_clock::time_point start) {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start)
+                            .count());
+    }
+
+    static void recordCompilation(uint64_t nanoseconds, bool failed);
+    static void recordBatch(size_t pointCount, uint64_t nanoseconds);
+    static void recordNonFinite(const Real* values, size_t count);
+};
+
+SIXPACK_NAMESPACE_END
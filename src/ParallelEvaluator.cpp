@@ -0,0 +1,228 @@
+#include "ParallelEvaluator.h"
+#include "Exception.h"
+#include <algorithm>
+#include <format>
+#include <optional>
+
+SIXPACK_NAMESPACE_BEGIN
+
+namespace {
+
+    // The minimum number of chunks per worker (if there are enough points) for the load balancing.
+    static constexpr size_t CHUNKS_PER_WORKER = 4;
+
+    static std::vector<Program::Address> getInputAddresses(const Program& program, const auto& names) {
+        std::vector<Program::Address> addresses;
+        for (const auto& name : names) {
+            addresses.push_back(program.getInputAddress(name));
+        }
+        return addresses;
+    }
+
+    static const std::vector<Real*>* checkColumns(const std::vector<String>& outputs,
+                                                  const std::vector<Real*>&  columns) {
+        if (columns.size() != outputs.size()) {
+            throw Exception(
+                std::format("Expected {} output columns, {} given", outputs.size(), columns.size()));
+        }
+        return &columns;
+    }
+
+} // anonymous namespace
+
+ParallelEvaluator::ParallelEvaluator(const Program& program, ThreadPool& threadPool, size_t chunkSize)
+    : mProgram(program)
+    , mThreadPool(threadPool)
+    , mChunkSize(std::max(chunkSize, size_t(Program::Vector::SIZE))) {}
+
+void ParallelEvaluator::evaluate(const Grid&                grid,
+                                 const std::vector<String>& outputs,
+                                 const Sink&                sink) const {
+    evaluate(makeInput(grid), outputs, sink, nullptr);
+}
+
+void ParallelEvaluator::evaluate(const Points&              points,
+                                 const std::vector<String>& outputs,
+                                 const Sink&                sink) const {
+    evaluate(makeInput(points), outputs, sink, nullptr);
+}
+
+void ParallelEvaluator::evaluate(const Columns&             columns,
+                                 const std::vector<String>& outputs,
+                                 const Sink&                sink) const {
+    evaluate(makeInput(columns), outputs, sink, nullptr);
+}
+
+void ParallelEvaluator::evaluate(const ColumnarBatch& inputs, const ColumnarBatch& outputs) const {
+    if (inputs.rowCount() != outputs.rowCount()) {
+        throw Exception(std::format(
+            "The output batch has {} rows, {} expected", outputs.rowCount(), inputs.rowCount()));
+    }
+    Columns columns{ .inputs = {}, .values = {}, .pointCount = inputs.rowCount(), .strides = {} };
+    for (size_t i = 0; i < inputs.columnCount(); ++i) {
+        columns.inputs.emplace_back(inputs.columnName(i));
+        columns.values.push_back(inputs.column(i));
+    }
+    std::vector<String> outputNames;
+    std::vector<Real*>  outputColumns;
+    for (size_t i = 0; i < outputs.columnCount(); ++i) {
+        outputNames.emplace_back(outputs.columnName(i));
+        outputColumns.push_back(outputs.writableColumn(i));
+        if (!outputColumns.back()) {
+            throw Exception("The output batch is read-only");
+        }
+    }
+    evaluate(makeInput(columns), outputNames, nullptr, &outputColumns);
+}
+
+void ParallelEvaluator::evaluate(const Grid&                grid,
+                                 const std::vector<String>& outputs,
+                                 const std::vector<Real*>&  columns) const {
+    evaluate(makeInput(grid), outputs, nullptr, checkColumns(outputs, columns));
+}
+
+void ParallelEvaluator::evaluate(const Points&              points,
+                                 const std::vector<String>& outputs,
+                                 const std::vector<Real*>&  columns) const {
+    evaluate(makeInput(points), outputs, nullptr, checkColumns(outputs, columns));
+}
+
+void ParallelEvaluator::evaluate(const Columns&             columns,
+                                 const std::vector<String>& outputs,
+                                 const std::vector<Real*>&  outputColumns) const {
+    evaluate(makeInput(columns), outputs, nullptr, checkColumns(outputs, outputColumns));
+}
+
+ParallelEvaluator::Input ParallelEvaluator::makeInput(const Grid& grid) const {
+    std::vector<String> inputs;
+    size_t              pointCount = grid.empty() ? 0 : 1;
+    for (const Axis& axis : grid) {
+        inputs.push_back(axis.input);
+        pointCount *= axis.count;
+    }
+    return { .pointCount = pointCount,
+             .setInputs  = [&grid, addresses = getInputAddresses(mProgram, inputs)](
+                              std::vector<Program::Vector>& memory, size_t firstPoint, int laneCount) {
+                 for (int lane = 0; lane < laneCount; ++lane) {
+                     size_t index = firstPoint + lane;
+                     for (size_t i = grid.size(); i-- > 0;) {
+                         const Axis& axis           = grid[i];
+                         memory[addresses[i]][lane] = axis.start + Real(index % axis.count) * axis.step;
+                         index /= axis.count;
+                     }
+                 }
+             } };
+}
+
+ParallelEvaluator::Input ParallelEvaluator::makeInput(const Points& points) const {
+    const size_t inputCount = points.inputs.size();
+    if (inputCount == 0 || points.values.size() % inputCount != 0) {
+        throw Exception(std::format("The point values do not match the {} inputs", inputCount));
+    }
+    return { .pointCount = points.values.size() / inputCount,
+             .setInputs  = [&points, inputCount, addresses = getInputAddresses(mProgram, points.inputs)](
+                              std::vector<Program::Vector>& memory, size_t firstPoint, int laneCount) {
+                 for (int lane = 0; lane < laneCount; ++lane) {
+                     const Real* const values = points.values.data() + (firstPoint + lane) * inputCount;
+                     for (size_t i = 0; i < inputCount; ++i) {
+                         memory[addresses[i]][lane] = values[i];
+                     }
+                 }
+             } };
+}
+
+ParallelEvaluator::Input ParallelEvaluator::makeInput(const Columns& columns) const {
+    if (columns.values.size() != columns.inputs.size() ||
+        (!columns.strides.empty() && columns.strides.size() != columns.inputs.size())) {
+        throw Exception(std::format("Expected {} input columns", columns.inputs.size()));
+    }
+    std::vector<size_t> strides = columns.strides;
+    strides.resize(columns.inputs.size(), 1);
+    return { .pointCount = columns.pointCount,
+             .setInputs  = [&columns, strides, addresses = getInputAddresses(mProgram, columns.inputs)](
+                              std::vector<Program::Vector>& memory, size_t firstPoint, int laneCount) {
+                 for (size_t i = 0; i < addresses.size(); ++i) {
+                     const size_t      stride = strides[i];
+                     const Real* const values = columns.values[i] + firstPoint * stride;
+                     Program::Vector&  word   = memory[addresses[i]];
+                     for (int lane = 0; lane < laneCount; ++lane) {
+                         word[lane] = values[lane * stride];
+                     }
+                 }
+             } };
+}
+
+void ParallelEvaluator::evaluate(const Input&               input,
+                                 const std::vector<String>& outputs,
+                                 const Sink&                sink,
+                                 const std::vector<Real*>*  outputColumns) const {
+    static constexpr size_t WORD_SIZE = Program::Vector::SIZE;
+
+    std::vector<Program::Address> outputAddresses;
+    for (const String& name : outputs) {
+        outputAddresses.push_back(mProgram.getOutputAddress(name));
+    }
+    const size_t pointCount = input.pointCount;
+    if (pointCount == 0) {
+        return;
+    }
+    const Metrics::BatchScope batch(pointCount);
+
+    // Note: The chunks are shrunk (down to a single word) so that every worker gets several of them.
+    const size_t workerChunks = CHUNKS_PER_WORKER * mThreadPool.workerCount();
+    const size_t chunkSize =
+        (std::min(mChunkSize, (pointCount + workerChunks - 1) / workerChunks) + WORD_SIZE - 1) / WORD_SIZE *
+        WORD_SIZE;
+    const size_t chunkCount = (pointCount + chunkSize - 1) / chunkSize;
+
+    // The state is created lazily, by the worker which is going to use it. Hence the executable memory and
+    // its instructions are first touched by the (possibly pinned) worker, i.e. allocated on its node.
+    struct alignas(64) WorkerState {
+        std::optional<Executable<Program::Vector>> executable;
+        std::vector<Real>                          buffer;
+        Chunk                                      chunk;
+    };
+    std::vector<WorkerState> states(mThreadPool.workerCount());
+
+    mThreadPool.parallelFor(chunkCount, [&](size_t chunkIndex, unsigned worker) {
+        WorkerState& state = states[worker];
+        if (!state.executable) {
+            state.executable.emplace(mProgram.makeVectorExecutable());
+            if (!outputColumns) {
+                state.buffer.resize(chunkSize * outputAddresses.size());
+                for (size_t i = 0; i < outputAddresses.size(); ++i) {
+                    state.chunk.outputs.push_back(state.buffer.data() + i * chunkSize);
+                }
+            }
+        }
+        std::vector<Program::Vector>& memory = state.executable->memory();
+        const size_t                  first  = chunkIndex * chunkSize;
+        const size_t                  count  = std::min(chunkSize, pointCount - first);
+        for (size_t offset = 0; offset < count; offset += WORD_SIZE) {
+            const int laneCount = int(std::min(WORD_SIZE, count - offset));
+            input.setInputs(memory, first + offset, laneCount);
+            state.executable->run();
+            for (size_t i = 0; i < outputAddresses.size(); ++i) {
+                const Program::Vector& values = memory[outputAddresses[i]];
+                Real* const            column = outputColumns ? (*outputColumns)[i] + first + offset
+                                                              : state.buffer.data() + i * chunkSize + offset;
+                for (int lane = 0; lane < laneCount; ++lane) {
+                    column[lane] = values[lane];
+                }
+            }
+        }
+        if constexpr (Metrics::ENABLED) {
+            for (size_t i = 0; i < outputAddresses.size(); ++i) {
+                Metrics::recordOutputs(outputColumns ? (*outputColumns)[i] + first : state.chunk.outputs[i],
+                                       count);
+            }
+        }
+        if (sink) {
+            state.chunk.firstPoint = first;
+            state.chunk.pointCount = count;
+            sink(state.chunk);
+        }
+    });
+}
+
+SIXPACK_NAMESPACE_END
@@ -0,0 +1,126 @@
+#pragma once
+#include "ColumnarBatch.h"
+#include "Common.h"
+#include "Program.h"
+#include "ThreadPool.h"
+#include <functional>
+#include <span>
+#include <vector>
+
+SIXPACK_NAMESPACE_BEGIN
+
+/// Evaluates a program over many input points in parallel.
+///
+/// The points are split into chunks (which fit into the cache) scheduled over the thread pool. Each worker
+/// evaluates its chunks with its own vector executable; the outputs of a chunk are passed to a sink.
+class ParallelEvaluator {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 1024; // points
+
+    /// An axis of an input grid: `count` evenly spaced values `start + i*step`.
+    struct Axis {
+        String input;
+        Real   start;
+        Real   step;
+        size_t count;
+    };
+
+    /// An N-dimensional input grid. The points are ordered row-major, i.e. the last axis varies the fastest.
+    using Grid = std::vector<Axis>;
+
+    /// An explicit set of input points, stored row-major (i.e. `values[point * inputs.size() + input]`).
+    struct Points {
+        std::vector<String>   inputs;
+        std::span<const Real> values;
+    };
+
+    /// An explicit set of input points, stored column-wise (i.e. `values[input][point * strides[input]]`).
+    struct Columns {
+        std::vector<String>      inputs;
+        std::vector<const Real*> values;     // `pointCount` values per each input
+        size_t                   pointCount;
+        std::vector<size_t>      strides;    // the distances of the values (all 1 if empty)
+    };
+
+    /// The outputs of a chunk of consecutive points.
+    struct Chunk {
+        size_t                   firstPoint;
+        size_t                   pointCount;
+        std::vector<const Real*> outputs; // `pointCount` values per each requested output
+    };
+
+    /// The consumer of the evaluated chunks.
+    ///
+    /// Note: The sink is called concurrently from the worker threads, in no particular order.
+    using Sink = std::function<void(const Chunk& chunk)>;
+
+private:
+    const Program& mProgram;
+    ThreadPool&    mThreadPool;
+    const size_t   mChunkSize;
+
+public:
+    ParallelEvaluator(const Program& program, ThreadPool& threadPool, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+    /// Evaluates the program over the grid; the inputs not present in the grid are zero.
+    ///
+    /// \throws Exception if any of the inputs/outputs is unknown (or the first exception thrown by the sink).
+    void evaluate(const Grid& grid, const std::vector<String>& outputs, const Sink& sink) const;
+
+    /// Evaluates the program over the point set; the inputs not present in the set are zero.
+    ///
+    /// \throws Exception if any of the inputs/outputs is unknown (or the first exception thrown by the sink).
+    void evaluate(const Points& points, const std::vector<String>& outputs, const Sink& sink) const;
+
+    /// Evaluates the program over the point set; the inputs not present in the set are zero.
+    ///
+    /// \throws Exception if any of the inputs/outputs is unknown (or the first exception thrown by the sink).
+    void evaluate(const Columns& columns, const std::vector<String>& outputs, const Sink& sink) const;
+
+    /// Evaluates the program over the points of the input batch (with the columns named as the inputs),
+    /// storing the outputs directly into the output batch (with the columns named as the outputs).
+    ///
+    /// \throws Exception if any of the columns is unknown, the output batch is read-only or the row counts
+    ///         differ.
+    void evaluate(const ColumnarBatch& inputs, const ColumnarBatch& outputs) const;
+
+    /// Evaluates the program over the grid, storing the outputs into the given columns (one value per point).
+    ///
+    /// Note: The outputs are stored directly by the workers, i.e. without the intermediate chunk buffers.
+    void evaluate(const Grid&                grid,
+                  const std::vector<String>& outputs,
+                  const std::vector<Real*>&  columns) const;
+
+    /// Evaluates the program over the point set, storing the outputs into the given columns.
+    void evaluate(const Points&              points,
+                  const std::vector<String>& outputs,
+                  const std::vector<Real*>&  columns) const;
+
+    /// Evaluates the program over the point set, storing the outputs into the given columns.
+    void evaluate(const Columns&             columns,
+                  const std::vector<String>& outputs,
+                  const std::vector<Real*>&  outputColumns) const;
+
+private:
+    /// Sets the inputs of the `laneCount` consecutive points starting at `firstPoint` to the memory.
+    using InputSetter =
+        std::function<void(std::vector<Program::Vector>& memory, size_t firstPoint, int laneCount)>;
+
+    struct Input {
+        size_t      pointCount;
+        InputSetter setInputs;
+    };
+
+    /// \throws Exception if any of the inputs is unknown.
+    Input makeInput(const Grid& grid) const;
+    Input makeInput(const Points& points) const;
+    Input makeInput(const Columns& columns) const;
+
+    /// Evaluates the points, passing the outputs either to the sink or directly to the output columns.
+    void evaluate(const Input&               input,
+                  const std::vector<String>& outputs,
+                  const Sink&                sink,
+                  const std::vector<Real*>*  outputColumns) const;
+};
+
+SIXPACK_NAMESPACE_END
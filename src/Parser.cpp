@@ -4,8 +4,12 @@
 #include "Exception.h"
 #include "Expression.h"
 #include "Symbols.h"
+#include "ThreadPool.h"
 #include "Tokenizer.h"
+#include <algorithm>
+#include <exception>
 #include <format>
+#include <unordered_map>
 
 SIXPACK_NAMESPACE_BEGIN
 
@@ -46,15 +50,19 @@ void ParserBase::fail(String message, std::optional<StringPosition> position) co
 //============================================================================================================
 
 class ExpressionParser::Impl : ParserBase {
-    const Lexicon& mLexicon;
+    const Lexicon&      mLexicon;
+    const SymbolFilter& mFilter;
+    ast::Arena&         mArena;
 
 public:
-    Impl(StringView input, const Lexicon& lexicon)
+    Impl(StringView input, const Lexicon& lexicon, const SymbolFilter& filter, ast::Arena& arena)
         : ParserBase(input)
-        , mLexicon(lexicon) {}
+        , mLexicon(lexicon)
+        , mFilter(filter)
+        , mArena(arena) {}
 
-    std::unique_ptr<ast::Node> parse() {
-        std::unique_ptr<ast::Node> expression = parseL4();
+    ast::Node* parse() {
+        ast::Node* expression = parseL5();
         expect(TokenType::END_OF_INPUT);
         return expression;
     }
@@ -63,17 +71,15 @@ private:
     using UnaryOperatorMapping  = std::pair<TokenType, ast::UnaryOperator::Type>;
     using BinaryOperatorMapping = std::pair<TokenType, ast::BinaryOperator::Type>;
 
-    /// Creates a new AST node.
+    /// Creates a new AST node (in the arena).
     ///
     /// \tparam    T          The type of the AST node.
     /// \param[in] startToken The token which started the parse sequence of the node.
     /// \param[in] innerToken The token which represent the node itself.
     /// \param[in] args...    The arguments for the node's constructor.
     template <typename T, typename... TArgs>
-    std::unique_ptr<ast::Node> makeNode(const Token& startToken,
-                                        const Token& innerToken,
-                                        TArgs&&... args) const {
-        auto node = std::make_unique<T>(std::forward<TArgs>(args)...);
+    ast::Node* makeNode(const Token& startToken, const Token& innerToken, TArgs&&... args) const {
+        T* const node = mArena.make<T>(std::forward<TArgs>(args)...);
         node->setInnerSourceView(innerToken.text);
         node->setOuterSourceView(
             StringView(startToken.text.data(), lastToken().text.data() + lastToken().text.size()));
@@ -86,12 +92,12 @@ private:
     ///
     /// \param[in] mapping The mapping of supported tokens to the associated AST operator node types.
     template <auto TNextParseStage>
-    std::unique_ptr<ast::Node> parseUnaryOperator(std::initializer_list<UnaryOperatorMapping> mapping) {
+    ast::Node* parseUnaryOperator(std::initializer_list<UnaryOperatorMapping> mapping) {
         const Token startToken = nextToken();
         for (const auto& [tokenType, operatorType] : mapping) {
             if (accept(tokenType)) {
-                std::unique_ptr<ast::Node> postfix = (this->*TNextParseStage)();
-                return makeNode<ast::UnaryOperator>(startToken, startToken, operatorType, std::move(postfix));
+                ast::Node* postfix = (this->*TNextParseStage)();
+                return makeNode<ast::UnaryOperator>(startToken, startToken, operatorType, postfix);
             }
         }
         return (this->*TNextParseStage)();
@@ -104,24 +110,24 @@ private:
     ///
     /// \param[in] mapping The mapping of supported tokens to the associated AST operator node types.
     template <auto TNextParseStage>
-    std::unique_ptr<ast::Node> parseBinaryOperator(std::initializer_list<BinaryOperatorMapping> mapping) {
-        const Token                startToken = nextToken();
-        std::unique_ptr<ast::Node> prefix     = (this->*TNextParseStage)();
+    ast::Node* parseBinaryOperator(std::initializer_list<BinaryOperatorMapping> mapping) {
+        const Token startToken = nextToken();
+        ast::Node*  prefix     = (this->*TNextParseStage)();
 
-        const auto parseInfix = [&]() -> std::unique_ptr<ast::Node> {
+        const auto parseInfix = [&]() -> ast::Node* {
             const Token innerToken = nextToken();
             for (const auto& [tokenType, operatorType] : mapping) {
                 if (accept(tokenType)) {
-                    std::unique_ptr<ast::Node> postfix = (this->*TNextParseStage)();
+                    ast::Node* postfix = (this->*TNextParseStage)();
                     return makeNode<ast::BinaryOperator>(
-                        startToken, innerToken, operatorType, std::move(prefix), std::move(postfix));
+                        startToken, innerToken, operatorType, prefix, postfix);
                 }
             }
             return nullptr;
         };
 
-        while (std::unique_ptr<ast::Node> infix = parseInfix()) {
-            prefix = std::move(infix);
+        while (ast::Node* infix = parseInfix()) {
+            prefix = infix;
         }
         return prefix;
     }
@@ -130,21 +136,47 @@ private:
     //========================================================================================================
 
     /// L0 stage (highest priority) -- identifiers, functions and parentheses.
-    std::unique_ptr<ast::Node> parseL0() {
+    ast::Node* parseL0() {
         const Token startToken = nextToken();
         if (accept(TokenType::IDENTIFIER)) {
             std::shared_ptr<Symbol> symbol = mLexicon.find(startToken.text);
-            if (auto valueSymbol = std::dynamic_pointer_cast<ValueSymbol>(symbol)) {
-                return makeNode<ast::Value>(startToken, startToken, std::move(valueSymbol));
+            if (symbol && mFilter && !mFilter(*symbol)) {
+                symbol = nullptr;
+            }
+            if (symbol && symbol->isValue()) {
+                return makeNode<ast::Value>(
+                    startToken, startToken, std::static_pointer_cast<ValueSymbol>(std::move(symbol)));
+            }
+            if (symbol && symbol->as<FunctionSymbol>()) {
+                auto functionSymbol = std::static_pointer_cast<FunctionSymbol>(std::move(symbol));
+                expect(TokenType::PARENTHESIS_LEFT, "Expected '('");
+                ast::Node* argument = parseL5();
+                expect(TokenType::PARENTHESIS_RIGHT, "Expected ')'");
+                return makeNode<ast::UnaryFunction>(
+                    startToken, startToken, std::move(functionSymbol), argument);
             }
-            if (auto functionSymbol = std::dynamic_pointer_cast<FunctionSymbol>(symbol)) {
+            if (symbol && symbol->as<BinaryFunctionSymbol>()) {
+                auto functionSymbol = std::static_pointer_cast<BinaryFunctionSymbol>(std::move(symbol));
                 expect(TokenType::PARENTHESIS_LEFT, "Expected '('");
-                std::unique_ptr<ast::Node> argument = parseL4();
+                ast::Node* firstArgument = parseL5();
+                expect(TokenType::COMMA, "Expected ','");
+                ast::Node* secondArgument = parseL5();
                 expect(TokenType::PARENTHESIS_RIGHT, "Expected ')'");
-                return makeNode<ast::UnaryFunction>(startToken,
-                                                    startToken,
-                                                    std::move(functionSymbol),
-                                                    std::move(argument));
+                return makeNode<ast::BinaryFunction>(startToken,
+                                                     startToken,
+                                                     std::move(functionSymbol),
+                                                     firstArgument,
+                                                     secondArgument);
+            }
+            if (!symbol && startToken.text == "if") {
+                expect(TokenType::PARENTHESIS_LEFT, "Expected '('");
+                ast::Node* condition = parseL5();
+                expect(TokenType::COMMA, "Expected ','");
+                ast::Node* whenTrue = parseL5();
+                expect(TokenType::COMMA, "Expected ','");
+                ast::Node* whenFalse = parseL5();
+                expect(TokenType::PARENTHESIS_RIGHT, "Expected ')'");
+                return makeNode<ast::Conditional>(startToken, startToken, condition, whenTrue, whenFalse);
             }
             fail(std::format("Unknown symbol '{}'", lastToken().text), lastToken().position);
         }
@@ -152,14 +184,14 @@ private:
             return makeNode<ast::Literal>(startToken, startToken, lastToken().numericValue);
         }
         if (accept(TokenType::PARENTHESIS_LEFT)) {
-            std::unique_ptr<ast::Node> infix = parseL4();
+            ast::Node* infix = parseL5();
             expect(TokenType::PARENTHESIS_RIGHT, "Expected ')'");
             infix->setOuterSourceView(
                 StringView(startToken.text.data(), lastToken().text.data() + lastToken().text.size()));
             return infix;
         }
         if (accept(TokenType::BRACKET_LEFT)) {
-            std::unique_ptr<ast::Node> infix = parseL4();
+            ast::Node* infix = parseL5();
             expect(TokenType::BRACKET_RIGHT, "Expected ']'");
             infix->setOuterSourceView(
                 StringView(startToken.text.data(), lastToken().text.data() + lastToken().text.size()));
@@ -170,54 +202,88 @@ private:
     }
 
     /// L1 stage -- the binary `^` operator.
-    std::unique_ptr<ast::Node> parseL1() {
+    ast::Node* parseL1() {
         return parseBinaryOperator<&Impl::parseL0>(
             { BinaryOperatorMapping{ TokenType::OPERATOR_CARET, ast::BinaryOperator::Type::CARET } });
     }
 
     /// L2 stage -- the unary `+` and `-` operators.
-    std::unique_ptr<ast::Node> parseL2() {
+    ast::Node* parseL2() {
         return parseUnaryOperator<&Impl::parseL1>(
             { UnaryOperatorMapping{ TokenType::OPERATOR_PLUS, ast::UnaryOperator::Type::PLUS },
               UnaryOperatorMapping{ TokenType::OPERATOR_MINUS, ast::UnaryOperator::Type::MINUS } });
     }
 
     /// L3 stage -- the binary `*` and `/` operators.
-    std::unique_ptr<ast::Node> parseL3() {
+    ast::Node* parseL3() {
         return parseBinaryOperator<&Impl::parseL2>(
             { BinaryOperatorMapping{ TokenType::OPERATOR_ASTERISK, ast::BinaryOperator::Type::ASTERISK },
               BinaryOperatorMapping{ TokenType::OPERATOR_SLASH, ast::BinaryOperator::Type::SLASH } });
     }
 
-    /// L4 stage (lowest priority) -- the binary `+` and `-` operators.
-    std::unique_ptr<ast::Node> parseL4() {
+    /// L4 stage -- the binary `+` and `-` operators.
+    ast::Node* parseL4() {
         return parseBinaryOperator<&Impl::parseL3>(
             { BinaryOperatorMapping{ TokenType::OPERATOR_PLUS, ast::BinaryOperator::Type::PLUS },
               BinaryOperatorMapping{ TokenType::OPERATOR_MINUS, ast::BinaryOperator::Type::MINUS } });
     }
+
+    /// L5 stage (lowest priority) -- the comparison operators.
+    ast::Node* parseL5() {
+        using Type = ast::BinaryOperator::Type;
+        return parseBinaryOperator<&Impl::parseL4>(
+            { BinaryOperatorMapping{ TokenType::OPERATOR_LESS, Type::LESS },
+              BinaryOperatorMapping{ TokenType::OPERATOR_LESS_EQUALS, Type::LESS_EQUALS },
+              BinaryOperatorMapping{ TokenType::OPERATOR_GREATER, Type::GREATER },
+              BinaryOperatorMapping{ TokenType::OPERATOR_GREATER_EQUALS, Type::GREATER_EQUALS },
+              BinaryOperatorMapping{ TokenType::OPERATOR_DOUBLE_EQUALS, Type::DOUBLE_EQUALS },
+              BinaryOperatorMapping{ TokenType::OPERATOR_NOT_EQUALS, Type::NOT_EQUALS } });
+    }
 };
 
-std::unique_ptr<ast::Node> ExpressionParser::parseToTree(StringView input) const {
-    Impl impl(input, mLexicon);
+const ast::Node* ExpressionParser::parseToTree(StringView input, ast::Arena& arena) const {
+    Impl impl(input, mLexicon, mFilter, arena);
     return impl.parse();
 }
 
 Expression ExpressionParser::parseToExpression(StringView input) const {
+    Expression expression = declareExpression(input);
+    parseExpression(expression);
+    return expression;
+}
+
+Expression ExpressionParser::declareExpression(StringView input) {
     Expression expression;
     expression.mData        = std::make_shared<Expression::Data>();
     expression.mData->input = String(input);
+    return expression;
+}
+
+void ExpressionParser::parseExpression(Expression& expression) const {
+    assert(expression.mData && !expression.mData->astRoot && !expression.mData->error);
     try {
-        expression.mData->astRoot = parseToTree(expression.mData->input);
+        // Note: The nodes of a failing parse are released with its arena.
+        auto arena                = std::make_unique<ast::Arena>();
+        expression.mData->astRoot = parseToTree(expression.mData->input, *arena);
+        expression.mData->arena   = std::move(arena);
     } catch (const ParseException& exception) {
         expression.mData->error = std::make_unique<ParseException>(exception);
     }
-    return expression;
 }
 
 //============================================================================================================
 // ScriptParser
 //============================================================================================================
 
+/// The symbol declared by a line of a script.
+struct ScriptParser::Declaration {
+    StringView           name;         // empty if none (i.e. an empty line)
+    bool                 isExpression; // i.e. the body follows
+    StringView           body;
+    StringPosition       bodyPosition; // of the first token of the body
+    Compiler::Visibility visibility;
+};
+
 class ScriptParser::Impl : ParserBase {
     Compiler& mCompiler;
 
@@ -226,69 +292,135 @@ public:
         : ParserBase(input)
         , mCompiler(compiler) {}
 
-    void parse() {
+    /// Parses the line up to the body of the expression (if any); the constants, the parameters and the
+    /// inputs are added to the compiler, the expressions are left to the caller.
+    Declaration declare() {
+        Declaration declaration{};
         while (accept(TokenType::IDENTIFIER)) {
             if (lastToken().text == "const") {
                 expect(TokenType::IDENTIFIER);
-                const StringView name = lastToken().text;
+                declaration.name = lastToken().text;
                 expect(TokenType::OPERATOR_EQUALS);
                 expect(TokenType::NUMBER);
-                mCompiler.addConstant(name, lastToken().numericValue);
+                mCompiler.addConstant(declaration.name, lastToken().numericValue);
                 break;
             }
             if (lastToken().text == "param") {
                 expect(TokenType::IDENTIFIER);
-                const StringView name  = lastToken().text;
-                Real             value = 0.0;
+                declaration.name = lastToken().text;
+                Real value       = 0.0;
                 if (accept(TokenType::OPERATOR_EQUALS)) {
                     expect(TokenType::NUMBER);
                     value = lastToken().numericValue;
                 }
-                mCompiler.addParameter(name, value);
+                mCompiler.addParameter(declaration.name, value);
                 break;
             }
             if (lastToken().text == "input") {
                 expect(TokenType::IDENTIFIER);
-                mCompiler.addVariable(lastToken().text);
+                declaration.name = lastToken().text;
+                mCompiler.addVariable(declaration.name);
                 break;
             }
-            Compiler::Visibility visibility{};
             if (lastToken().text == "output") {
                 expect(TokenType::IDENTIFIER);
-                visibility = Compiler::Visibility::PUBLIC;
+                declaration.visibility = Compiler::Visibility::PUBLIC;
             } else {
-                visibility = Compiler::Visibility::SYMBOLIC;
+                declaration.visibility = Compiler::Visibility::SYMBOLIC;
             }
-            const StringView name = lastToken().text;
+            declaration.name = lastToken().text;
             expect(TokenType::OPERATOR_EQUALS);
-            const StringView exprString = input().substr(lastToken().position + lastToken().text.size());
-            const Expression expression = mCompiler.addExpression(name, exprString, visibility);
-            if (!expression) {
-                fail(String(expression.error()), expression.errorPosition() + nextToken().position);
-            }
-            return;
+            declaration.isExpression = true;
+            declaration.body         = input().substr(lastToken().position + lastToken().text.size());
+            declaration.bodyPosition = nextToken().position;
+            return declaration;
         }
         expect(TokenType::END_OF_INPUT);
+        return declaration;
     }
 };
 
 void ScriptParser::parseScript(StringView input) const {
-    StringPosition start = 0;
+    struct PendingExpression {
+        Expression     expression;
+        size_t         line;
+        StringPosition bodyPosition; // within the script
+    };
+
+    // Note: A failure stops the declarations, but it is reported only if none of the expressions of the
+    //       preceding lines fails.
+    std::vector<PendingExpression>            expressions;
+    std::unordered_map<const Symbol*, size_t> declarationLines; // of the symbols declared by the script
+    std::exception_ptr                        declarationFailure;
+    StringPosition                            start = 0;
+    size_t                                    line  = 0;
     do {
         const StringPosition next = input.find('\n', start);
-        const StringView     line = input.substr(start, next - start);
+        const StringView     text = input.substr(start, next - start);
         try {
-            parseScriptLine(line);
+            const Declaration declaration = Impl(text.substr(0, text.find('#')), mCompiler).declare();
+            if (declaration.isExpression) {
+                Expression expression = ExpressionParser::declareExpression(declaration.body);
+                mCompiler.addExpressionSymbol(declaration.name, expression, declaration.visibility);
+                expressions.push_back({ .expression   = std::move(expression),
+                                        .line         = line,
+                                        .bodyPosition = start + declaration.bodyPosition });
+            }
+            if (const auto symbol = mCompiler.publicSymbols().find(declaration.name)) {
+                declarationLines.insert({ symbol.get(), line });
+            }
         } catch (const ParseException& exception) {
-            throw ParseException(exception.message(), exception.where() + start);
+            declarationFailure =
+                std::make_exception_ptr(ParseException(exception.message(), exception.where() + start));
+            break;
+        } catch (const Exception&) {
+            declarationFailure = std::current_exception();
+            break;
         }
         start = next + 1; // npos + 1 -> 0
+        ++line;
     } while (start > 0);
+
+    const auto parse = [&](size_t index) {
+        PendingExpression& pending = expressions[index];
+        // Note: The symbols declared by the script are visible to the expressions of the later lines only.
+        const auto isDeclaredBefore = [&](const Symbol& symbol) {
+            const auto lineIt = declarationLines.find(&symbol);
+            return lineIt == declarationLines.end() || lineIt->second < pending.line;
+        };
+        ExpressionParser(mCompiler.publicSymbols(), isDeclaredBefore).parseExpression(pending.expression);
+    };
+    if (expressions.size() >= PARALLEL_EXPRESSION_COUNT) {
+        ThreadPool threadPool(std::max(std::thread::hardware_concurrency(), 1u) - 1, AffinityPolicy::NONE);
+        threadPool.parallelFor(expressions.size(), [&](size_t index, unsigned) { parse(index); });
+    } else {
+        for (size_t i = 0; i < expressions.size(); ++i) {
+            parse(i);
+        }
+    }
+
+    for (const PendingExpression& pending : expressions) {
+        if (!pending.expression) {
+            throw ParseException(String(pending.expression.error()),
+                                 pending.expression.errorPosition() + pending.bodyPosition);
+        }
+    }
+    if (declarationFailure) {
+        std::rethrow_exception(declarationFailure);
+    }
 }
 
 void ScriptParser::parseScriptLine(StringView input) const {
     input = input.substr(0, input.find('#')); // truncate line comments
-    Impl(input, mCompiler).parse();
+    const Declaration declaration = Impl(input, mCompiler).declare();
+    if (declaration.isExpression) {
+        const Expression expression =
+            mCompiler.addExpression(declaration.name, declaration.body, declaration.visibility);
+        if (!expression) {
+            throw ParseException(String(expression.error()),
+                                 expression.errorPosition() + declaration.bodyPosition);
+        }
+    }
 }
 
 SIXPACK_NAMESPACE_END
@@ -1,16 +1,19 @@
 #pragma once
 #include "Tokenizer.h"
+#include <functional>
 #include <memory>
 #include <optional>
 
 SIXPACK_NAMESPACE_BEGIN
 
 namespace ast {
+    class Arena;
     class Node;
 }
 class Compiler;
 class Expression;
 class Lexicon;
+class Symbol;
 
 class ParserBase {
     Tokenizer mTokenizer;
@@ -50,25 +53,53 @@ protected:
 };
 
 class ExpressionParser {
+public:
+    /// Decides whether a symbol of the lexicon is visible to the parsed expression.
+    using SymbolFilter = std::function<bool(const Symbol& symbol)>;
+
+private:
     class Impl;
-    const Lexicon& mLexicon;
+    const Lexicon&     mLexicon;
+    const SymbolFilter mFilter;
 
 public:
-    explicit ExpressionParser(const Lexicon& lexicon)
-        : mLexicon(lexicon) {}
+    explicit ExpressionParser(const Lexicon& lexicon, SymbolFilter filter = {})
+        : mLexicon(lexicon)
+        , mFilter(std::move(filter)) {}
+
+    /// Parses the input into a tree of nodes constructed in the arena.
+    const ast::Node* parseToTree(StringView input, ast::Arena& arena) const;
+    Expression       parseToExpression(StringView input) const;
+
+    /// Makes an expression of the input, not parsed yet (e.g. to declare its symbol before the parsing).
+    static Expression declareExpression(StringView input);
 
-    std::unique_ptr<ast::Node> parseToTree(StringView input) const;
-    Expression                 parseToExpression(StringView input) const;
+    /// Parses the expression made by `declareExpression`; the failure is stored into the expression.
+    void parseExpression(Expression& expression) const;
 };
 
 class ScriptParser {
     class Impl;
+    struct Declaration;
     Compiler& mCompiler;
 
 public:
+    /// The least number of the expressions of a script parsed by multiple threads.
+    static constexpr size_t PARALLEL_EXPRESSION_COUNT = 4096;
+
     explicit ScriptParser(Compiler& compiler)
         : mCompiler(compiler) {}
 
+    /// Parses the script in two passes: the first one declares the symbols of the lines in order (the bodies
+    /// of the expressions are only scanned for the end of the line), the second one parses the bodies of the
+    /// expressions, by multiple threads if there are many of them.
+    ///
+    /// Each expression sees only the symbols declared before it, i.e. as if parsed line by line, and the
+    /// first failure in the order of the lines is reported.
+    ///
+    /// Note: Unlike parsing line by line, a failing expression does not stop the declarations: on failure,
+    ///       the compiler is left with the symbols of all the lines before the first failing declaration
+    ///       (including the lines after the failing expression).
     void parseScript(StringView input) const;
     void parseScriptLine(StringView input) const;
 };
@@ -0,0 +1,251 @@
+#include "Pipeline.h"
+#include "Exception.h"
+#include "Topology.h"
+#include <algorithm>
+#include <cassert>
+#include <format>
+#include <latch>
+
+SIXPACK_NAMESPACE_BEGIN
+
+namespace {
+
+    // The worker's executable of a version of the program, with the addresses of the pipeline inputs/outputs.
+    struct Evaluator {
+        Executable<Program::Vector>   executable;
+        std::vector<Program::Address> inputAddresses;
+        std::vector<Program::Address> outputAddresses;
+        uint64_t                      version;
+    };
+
+    // \throws Exception if any of the inputs/outputs is unknown.
+    static std::unique_ptr<Evaluator> makeEvaluator(const ProgramHandle::Snapshot& snapshot,
+                                                    const std::vector<String>&     inputs,
+                                                    const std::vector<String>&     outputs) {
+        std::vector<Program::Address> inputAddresses;
+        for (const String& name : inputs) {
+            inputAddresses.push_back(snapshot->getInputAddress(name));
+        }
+        std::vector<Program::Address> outputAddresses;
+        for (const String& name : outputs) {
+            outputAddresses.push_back(snapshot->getOutputAddress(name));
+        }
+        return std::unique_ptr<Evaluator>(new Evaluator{ .executable      = snapshot->makeVectorExecutable(),
+                                                         .inputAddresses  = std::move(inputAddresses),
+                                                         .outputAddresses = std::move(outputAddresses),
+                                                         .version         = snapshot.version() });
+    }
+
+} // anonymous namespace
+
+Pipeline::Pipeline(const Program&      program,
+                   std::vector<String> inputs,
+                   std::vector<String> outputs,
+                   const Options&      options)
+    : Pipeline(program, std::move(inputs), std::move(outputs), Consumer{}, options) {}
+
+Pipeline::Pipeline(const Program&      program,
+                   std::vector<String> inputs,
+                   std::vector<String> outputs,
+                   Consumer            consumer,
+                   const Options&      options)
+    : Pipeline(std::make_unique<ProgramHandle>(program),
+               nullptr,
+               std::move(inputs),
+               std::move(outputs),
+               std::move(consumer),
+               options) {}
+
+Pipeline::Pipeline(ProgramHandle&      handle,
+                   std::vector<String> inputs,
+                   std::vector<String> outputs,
+                   const Options&      options)
+    : Pipeline(handle, std::move(inputs), std::move(outputs), Consumer{}, options) {}
+
+Pipeline::Pipeline(ProgramHandle&      handle,
+                   std::vector<String> inputs,
+                   std::vector<String> outputs,
+                   Consumer            consumer,
+                   const Options&      options)
+    : Pipeline(nullptr, &handle, std::move(inputs), std::move(outputs), std::move(consumer), options) {}
+
+Pipeline::Pipeline(std::unique_ptr<ProgramHandle> ownedHandle,
+                   ProgramHandle*                 handle,
+                   std::vector<String>            inputs,
+                   std::vector<String>            outputs,
+                   Consumer                       consumer,
+                   const Options&                 options)
+    : mOwnedHandle(std::move(ownedHandle))
+    , mHandle(handle ? *handle : *mOwnedHandle)
+    , mInputs(std::move(inputs))
+    , mOutputs(std::move(outputs))
+    , mInputQueue(options.queueCapacity)
+    , mOutputQueue(options.queueCapacity)
+    , mConsumer(std::move(consumer)) {
+    const ProgramHandle::Snapshot snapshot = mHandle.acquire();
+    makeEvaluator(snapshot, mInputs, mOutputs); // validates the inputs/outputs
+    const std::vector<int> processors =
+        ThreadPool::mapProcessors(std::max(1u, options.workerCount), options.affinity, Topology::current());
+    mActiveWorkers = unsigned(processors.size());
+    // Note: The validated version is held until all the workers have made their executables of it.
+    std::latch started(ptrdiff_t(processors.size()));
+    for (int processor : processors) {
+        mWorkers.emplace_back(&Pipeline::workerLoop, this, processor, std::cref(snapshot), std::ref(started));
+    }
+    started.wait();
+    if (mConsumer) {
+        mConsumerThread = std::thread(&Pipeline::consumerLoop, this);
+    }
+}
+
+Pipeline::~Pipeline() {
+    close();
+    if (!mConsumer) {
+        Block block;
+        while (pop(block)) {
+            // discarding the blocks not popped by the user
+        }
+    }
+    for (std::thread& worker : mWorkers) {
+        worker.join();
+    }
+    if (mConsumerThread.joinable()) {
+        mConsumerThread.join();
+    }
+}
+
+void Pipeline::push(Block block) {
+    validate(block);
+    mInputQueue.push(std::move(block));
+}
+
+bool Pipeline::tryPush(Block& block) {
+    validate(block);
+    return mInputQueue.tryPush(block);
+}
+
+bool Pipeline::pop(Block& block) {
+    assert(!mConsumer);
+    mOutputQueue.pop(block);
+    if (block.pointCount == END_OF_STREAM) {
+        mOutputQueue.push(std::move(block)); // keeping the marker for the other callers
+        return false;
+    }
+    return true;
+}
+
+void Pipeline::close() {
+    if (mClosed.exchange(true)) {
+        return;
+    }
+    mPendingMarkers.store(mWorkers.size(), std::memory_order_relaxed);
+    pushPendingMarkers();
+}
+
+Pipeline::Block Pipeline::endOfStreamMarker() {
+    return Block{ .sequence = 0, .pointCount = END_OF_STREAM, .version = 0, .inputs = {}, .outputs = {} };
+}
+
+void Pipeline::validate(const Block& block) const {
+    if (mClosed) {
+        throw Exception("The pipeline is closed");
+    }
+    const size_t valueCount = block.pointCount * mInputs.size();
+    if (block.pointCount == END_OF_STREAM || block.inputs.size() != valueCount) {
+        throw Exception(std::format("Expected {} input values for {} points, {} given",
+                                    valueCount,
+                                    block.pointCount,
+                                    block.inputs.size()));
+    }
+}
+
+void Pipeline::pushPendingMarkers() {
+    // Note: Called by `close` and by the workers after each pop, i.e. whenever some room may have been made
+    //       in the input queue. Blocking there would deadlock without a consumer: the workers may be waiting
+    //       for room in the output queue, drained only by the caller of `close` (e.g. the destructor).
+    //
+    //       The lock is taken only while any marker is pending, i.e. the pops stay lock-free until `close`.
+    //       The fence orders the check after the pop (and after the count set by `close`), so either the
+    //       worker sees the count or `close` sees the room made by the pop.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mPendingMarkers.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    std::lock_guard lock(mMarkerMutex);
+    for (size_t pending = mPendingMarkers.load(std::memory_order_relaxed); pending > 0; --pending) {
+        Block marker = endOfStreamMarker();
+        if (!mInputQueue.tryPush(marker)) {
+            break;
+        }
+        mPendingMarkers.store(pending - 1, std::memory_order_relaxed);
+    }
+}
+
+void Pipeline::workerLoop(int processor, const ProgramHandle::Snapshot& initial, std::latch& started) {
+    static constexpr size_t WORD_SIZE = Program::Vector::SIZE;
+
+    if (processor >= 0 && Topology::pinCurrentThread(processor)) {
+        Topology::preferNodeMemory(Topology::current().nodeOf(processor));
+    }
+    // Note: The executables are created by the worker, i.e. in its local memory.
+    std::unique_ptr<Evaluator> evaluator   = makeEvaluator(initial, mInputs, mOutputs);
+    uint64_t                   version     = evaluator->version; // the latest version seen
+    const size_t               inputCount  = mInputs.size();
+    const size_t               outputCount = mOutputs.size();
+    started.count_down();
+
+    Block block;
+    for (;;) {
+        mInputQueue.pop(block);
+        pushPendingMarkers();
+        if (block.pointCount == END_OF_STREAM) {
+            break;
+        }
+        if (mHandle.version() != version) {
+            const ProgramHandle::Snapshot snapshot = mHandle.acquire();
+            version                                = snapshot.version();
+            try {
+                evaluator = makeEvaluator(snapshot, mInputs, mOutputs);
+            } catch (const Exception&) {
+                // skipping the incompatible version
+            }
+        }
+        std::vector<Program::Vector>& memory = evaluator->executable.memory();
+        block.version                        = evaluator->version;
+        block.outputs.resize(block.pointCount * outputCount);
+        for (size_t first = 0; first < block.pointCount; first += WORD_SIZE) {
+            const int laneCount = int(std::min(WORD_SIZE, block.pointCount - first));
+            for (int lane = 0; lane < laneCount; ++lane) {
+                const Real* const row = block.inputs.data() + (first + lane) * inputCount;
+                for (size_t i = 0; i < inputCount; ++i) {
+                    memory[evaluator->inputAddresses[i]][lane] = row[i];
+                }
+            }
+            evaluator->executable.run();
+            for (int lane = 0; lane < laneCount; ++lane) {
+                Real* const row = block.outputs.data() + (first + lane) * outputCount;
+                for (size_t i = 0; i < outputCount; ++i) {
+                    row[i] = memory[evaluator->outputAddresses[i]][lane];
+                }
+            }
+        }
+        mOutputQueue.push(std::move(block));
+    }
+    // The last worker passes the end-of-stream marker to the consumer(s).
+    if (--mActiveWorkers == 0) {
+        mOutputQueue.push(endOfStreamMarker());
+    }
+}
+
+void Pipeline::consumerLoop() {
+    Block block;
+    for (;;) {
+        mOutputQueue.pop(block);
+        if (block.pointCount == END_OF_STREAM) {
+            break;
+        }
+        mConsumer(std::move(block));
+    }
+}
+
+SIXPACK_NAMESPACE_END
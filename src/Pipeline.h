@@ -0,0 +1,150 @@
+#pragma once
+#include "Common.h"
+#include "Program.h"
+#include "ProgramHandle.h"
+#include "Queues.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+SIXPACK_NAMESPACE_BEGIN
+
+struct PipelineOptions {
+    unsigned       workerCount   = std::max(1u, std::thread::hardware_concurrency());
+    size_t         queueCapacity = 64; // blocks, per queue
+    AffinityPolicy affinity      = AffinityPolicy::AUTO;
+};
+
+/// An asynchronous evaluation of a stream of input blocks.
+///
+/// The producers push the input blocks into a bounded queue, the evaluator threads (each with its own vector
+/// executable) fill the outputs and pass the blocks to a second bounded queue, drained by the consumer. When
+/// a queue is full, its writers wait, i.e. a slow stage slows down the previous ones and the number of the
+/// blocks in flight (hence the latency) stays bounded.
+///
+/// The blocks are delivered in the order of their completion; use `Block::sequence` to restore the order if
+/// needed.
+///
+/// With a program handle, each evaluator picks up the latest version of the program before its next block.
+/// The versions lacking any of the inputs/outputs of the pipeline are skipped (the evaluator keeps its
+/// executable of the previous version).
+class Pipeline {
+public:
+    struct Block {
+        uint64_t          sequence   = 0; // not used by the pipeline (e.g. for restoring the order)
+        size_t            pointCount = 0;
+        uint64_t          version    = 0; // the version of the program which evaluated the block
+        std::vector<Real> inputs;         // `pointCount` rows of the input values (in the order of inputs)
+        std::vector<Real> outputs;        // `pointCount` rows of the output values (filled by the pipeline)
+    };
+
+    /// The consumer of the evaluated blocks, called from the (single) consumer thread. It must not throw.
+    using Consumer = std::function<void(Block&& block)>;
+
+    using Options = PipelineOptions;
+
+private:
+    static constexpr size_t END_OF_STREAM = ~size_t(0); // the point count of the end-of-stream marker
+
+    const std::unique_ptr<ProgramHandle> mOwnedHandle; // the handle of the program passed by reference
+    ProgramHandle&                       mHandle;
+    const std::vector<String>            mInputs;
+    const std::vector<String>            mOutputs;
+    MpmcQueue<Block>                     mInputQueue;
+    MpmcQueue<Block>                     mOutputQueue;
+    const Consumer                       mConsumer;
+    std::atomic<unsigned>                mActiveWorkers  = 0;
+    std::atomic<bool>                    mClosed         = false;
+    std::mutex                           mMarkerMutex;        // serializes the pushes of the markers
+    std::atomic<size_t>                  mPendingMarkers = 0; // the end-of-stream markers not pushed yet
+    std::vector<std::thread>             mWorkers;
+    std::thread                          mConsumerThread;
+
+public:
+    /// Starts the pipeline with the blocks delivered through `pop`.
+    ///
+    /// \throws Exception if any of the inputs/outputs is unknown.
+    Pipeline(const Program&      program,
+             std::vector<String> inputs,
+             std::vector<String> outputs,
+             const Options&      options = {});
+
+    /// Starts the pipeline with the blocks delivered to the consumer.
+    ///
+    /// \throws Exception if any of the inputs/outputs is unknown.
+    Pipeline(const Program&      program,
+             std::vector<String> inputs,
+             std::vector<String> outputs,
+             Consumer            consumer,
+             const Options&      options = {});
+
+    /// Starts the pipeline over the versions of the program published to the handle, with the blocks
+    /// delivered through `pop`.
+    ///
+    /// \throws Exception if any of the inputs/outputs is unknown (to the current version).
+    Pipeline(ProgramHandle&      handle,
+             std::vector<String> inputs,
+             std::vector<String> outputs,
+             const Options&      options = {});
+
+    /// Starts the pipeline over the versions of the program published to the handle, with the blocks
+    /// delivered to the consumer.
+    ///
+    /// \throws Exception if any of the inputs/outputs is unknown (to the current version).
+    Pipeline(ProgramHandle&      handle,
+             std::vector<String> inputs,
+             std::vector<String> outputs,
+             Consumer            consumer,
+             const Options&      options = {});
+
+    /// Closes the pipeline and waits until all the pushed blocks are evaluated (and consumed).
+    ///
+    /// Note: Without a consumer, the blocks not popped yet are discarded.
+    ~Pipeline();
+
+    Pipeline(const Pipeline&)            = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    /// Pushes the block for the evaluation, waiting while the input queue is full.
+    ///
+    /// \throws Exception if the pipeline is closed or if the block size does not match the inputs.
+    void push(Block block);
+
+    /// Pushes the block for the evaluation unless the input queue is full (the block is left intact then).
+    ///
+    /// \throws Exception if the pipeline is closed or if the block size does not match the inputs.
+    bool tryPush(Block& block);
+
+    /// Pops the next evaluated block, waiting while none is ready (only without a consumer).
+    ///
+    /// \returns False once the pipeline is closed and all the blocks are popped.
+    bool pop(Block& block);
+
+    /// Marks the end of the input stream, i.e. no more blocks may be pushed.
+    ///
+    /// Note: Does not wait for a full input queue (the workers pass the end of the stream once they make some
+    ///       room), i.e. the blocks may still be popped after the call. Must not be called concurrently with
+    ///       `push`/`tryPush`.
+    void close();
+
+private:
+    Pipeline(std::unique_ptr<ProgramHandle> ownedHandle,
+             ProgramHandle*                 handle,
+             std::vector<String>            inputs,
+             std::vector<String>            outputs,
+             Consumer                       consumer,
+             const Options&                 options);
+
+    static Block endOfStreamMarker();
+
+    void validate(const Block& block) const;
+    void pushPendingMarkers();
+    void workerLoop(int processor, const ProgramHandle::Snapshot& initial, std::latch& started);
+    void consumerLoop();
+};
+
+SIXPACK_NAMESPACE_END
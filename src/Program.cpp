@@ -1,14 +1,28 @@
 #include "Program.h"
 #include "Exception.h"
+#include "FastMath.h"
+#include "FunctionTable.h"
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <format>
+#include <memory>
+#include <type_traits>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#   include <intrin.h>
+#   define SIXPACK_HAS_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#   include <x86intrin.h>
+#   define SIXPACK_HAS_RDTSC
+#endif
 
 SIXPACK_NAMESPACE_BEGIN
 
 namespace {
 
-    static constexpr std::array<Executable<Program::Scalar>::Function, 14> SCALAR_FUNCTIONS = {
+    template <MathAccuracy TAccuracy>
+    static constexpr std::array<Executable<Program::Scalar>::Function, 30> SCALAR_FUNCTIONS = {
         // Opcode::NOP
         [](const Executable<Program::Scalar>::Instruction*) {},
         // Opcode::ADD
@@ -61,7 +75,8 @@ namespace {
         },
         // Opcode::POWER
         [](const Executable<Program::Scalar>::Instruction* instruction) {
-            const Program::Scalar result = std::pow(*instruction->extraInput, *instruction->input);
+            const Program::Scalar result =
+                fastmath::pow<TAccuracy>(*instruction->extraInput, *instruction->input);
             *instruction->output         = result;
             return instruction->next(instruction + 1);
         },
@@ -71,30 +86,134 @@ namespace {
             *instruction->output         = result;
             return instruction->next(instruction + 1);
         },
+        // Opcode::CALL_BATCH
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            Program::Scalar result; // prevents aliasing
+            instruction->batchCallable(instruction->input, &result, 1);
+            *instruction->output = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::CALL_BINARY
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            const Executable<Program::Scalar>::Instruction& extension = instruction[1];
+            const Program::Scalar result =
+                extension.binaryCallable(*instruction->extraInput, *instruction->input);
+            *instruction->output = result;
+            return extension.next(instruction + 2);
+        },
+        // Opcode::CMP_LT
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            const Program::Scalar result = *instruction->extraInput < *instruction->input ? 1.0 : 0.0;
+            *instruction->output         = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::CMP_LE
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            const Program::Scalar result = *instruction->extraInput <= *instruction->input ? 1.0 : 0.0;
+            *instruction->output         = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::CMP_EQ
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            const Program::Scalar result = *instruction->extraInput == *instruction->input ? 1.0 : 0.0;
+            *instruction->output         = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::CMP_NE
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            const Program::Scalar result = *instruction->extraInput != *instruction->input ? 1.0 : 0.0;
+            *instruction->output         = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::SELECT
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            const Executable<Program::Scalar>::Instruction& extension = instruction[1];
+            // Note: Both arms are already computed, the selection is a conditional move.
+            const Program::Scalar result =
+                *instruction->input != 0.0 ? *instruction->extraInput : *extension.whenFalse;
+            *instruction->output = result;
+            return extension.next(instruction + 2);
+        },
         // Opcode::SIN
         [](const Executable<Program::Scalar>::Instruction* instruction) {
-            const Program::Scalar result = std::sin(*instruction->input);
+            const Program::Scalar result = fastmath::sin<TAccuracy>(*instruction->input);
             *instruction->output         = result;
             return instruction->next(instruction + 1);
         },
         // Opcode::COS
         [](const Executable<Program::Scalar>::Instruction* instruction) {
-            const Program::Scalar result = std::cos(*instruction->input);
+            const Program::Scalar result = fastmath::cos<TAccuracy>(*instruction->input);
             *instruction->output         = result;
             return instruction->next(instruction + 1);
         },
         // Opcode::SINCOS
         [](const Executable<Program::Scalar>::Instruction* instruction) {
-            const Program::Scalar argument = *instruction->input;
-            const Program::Scalar sine     = std::sin(argument);
-            const Program::Scalar cosine   = std::cos(argument);
-            *instruction->output           = sine;
-            *instruction->extraOutput      = cosine;
+            Program::Scalar sine, cosine; // prevents aliasing
+            fastmath::sincos<TAccuracy>(*instruction->input, sine, cosine);
+            *instruction->output      = sine;
+            *instruction->extraOutput = cosine;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::EXP
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            const Program::Scalar result = fastmath::exp<TAccuracy>(*instruction->input);
+            *instruction->output         = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::LOG
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            const Program::Scalar result = fastmath::log<TAccuracy>(*instruction->input);
+            *instruction->output         = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::ATAN2
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            const Program::Scalar result =
+                fastmath::atan2<TAccuracy>(*instruction->extraInput, *instruction->input);
+            *instruction->output         = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::HYPOT
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            const Program::Scalar result =
+                fastmath::hypot<TAccuracy>(*instruction->extraInput, *instruction->input);
+            *instruction->output         = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::MIN
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            const Program::Scalar result = fastmath::fmin(*instruction->extraInput, *instruction->input);
+            *instruction->output         = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::MAX
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            const Program::Scalar result = fastmath::fmax(*instruction->extraInput, *instruction->input);
+            *instruction->output         = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::FMOD
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            const Program::Scalar result = std::fmod(*instruction->extraInput, *instruction->input);
+            *instruction->output         = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::COPYSIGN
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            const Program::Scalar result = std::copysign(*instruction->extraInput, *instruction->input);
+            *instruction->output         = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::TABLE_LOOKUP
+        [](const Executable<Program::Scalar>::Instruction* instruction) {
+            const Program::Scalar result = instruction->table->evaluate(*instruction->input);
+            *instruction->output         = result;
             return instruction->next(instruction + 1);
         }
     };
 
-    static constexpr std::array<Executable<Program::Vector>::Function, 14> VECTOR_FUNCTIONS = {
+    template <MathAccuracy TAccuracy>
+    static constexpr std::array<Executable<Program::Vector>::Function, 30> VECTOR_FUNCTIONS = {
         // Opcode::NOP
         [](const Executable<Program::Vector>::Instruction*) {},
         // Opcode::ADD
@@ -151,7 +270,14 @@ namespace {
             const Program::Vector argument1 = *instruction->extraInput;
             const Program::Vector argument2 = *instruction->input;
             for (int i = 0; i < Program::Vector::SIZE; ++i) {
-                result[i] = std::pow(argument1[i], argument2[i]);
+                result[i] = fastmath::powFastPath<TAccuracy>(argument1[i], argument2[i]);
+            }
+            if constexpr (TAccuracy != MathAccuracy::ULP_1) {
+                for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                    if (!fastmath::isPowFastPath(argument1[i], argument2[i])) {
+                        result[i] = std::pow(argument1[i], argument2[i]);
+                    }
+                }
             }
             *instruction->output = result;
             return instruction->next(instruction + 1);
@@ -167,12 +293,97 @@ namespace {
             *instruction->output = result;
             return instruction->next(instruction + 1);
         },
+        // Opcode::CALL_BATCH
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            Program::Vector result; // prevents aliasing
+            instruction->batchCallable(instruction->input->data(), result.data(), Program::Vector::SIZE);
+            *instruction->output = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::CALL_BINARY
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            const Executable<Program::Vector>::Instruction& extension = instruction[1];
+            Program::Vector          result; // prevents aliasing
+            const Program::Vector    argument1 = *instruction->extraInput;
+            const Program::Vector    argument2 = *instruction->input;
+            const BinaryRealFunction callable  = extension.binaryCallable;
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                result[i] = callable(argument1[i], argument2[i]);
+            }
+            *instruction->output = result;
+            return extension.next(instruction + 2);
+        },
+        // Opcode::CMP_LT
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            Program::Vector       result; // prevents aliasing
+            const Program::Vector argument1 = *instruction->extraInput;
+            const Program::Vector argument2 = *instruction->input;
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                result[i] = argument1[i] < argument2[i] ? 1.0 : 0.0;
+            }
+            *instruction->output = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::CMP_LE
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            Program::Vector       result; // prevents aliasing
+            const Program::Vector argument1 = *instruction->extraInput;
+            const Program::Vector argument2 = *instruction->input;
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                result[i] = argument1[i] <= argument2[i] ? 1.0 : 0.0;
+            }
+            *instruction->output = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::CMP_EQ
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            Program::Vector       result; // prevents aliasing
+            const Program::Vector argument1 = *instruction->extraInput;
+            const Program::Vector argument2 = *instruction->input;
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                result[i] = argument1[i] == argument2[i] ? 1.0 : 0.0;
+            }
+            *instruction->output = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::CMP_NE
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            Program::Vector       result; // prevents aliasing
+            const Program::Vector argument1 = *instruction->extraInput;
+            const Program::Vector argument2 = *instruction->input;
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                result[i] = argument1[i] != argument2[i] ? 1.0 : 0.0;
+            }
+            *instruction->output = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::SELECT
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            const Executable<Program::Vector>::Instruction& extension = instruction[1];
+            Program::Vector       result; // prevents aliasing
+            const Program::Vector condition = *instruction->input;
+            const Program::Vector whenTrue  = *instruction->extraInput;
+            const Program::Vector whenFalse = *extension.whenFalse;
+            // Note: Both arms are already computed for all lanes, the selection is a (branch-free) blend.
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                result[i] = condition[i] != 0.0 ? whenTrue[i] : whenFalse[i];
+            }
+            *instruction->output = result;
+            return extension.next(instruction + 2);
+        },
         // Opcode::SIN
         [](const Executable<Program::Vector>::Instruction* instruction) {
             Program::Vector       result; // prevents aliasing
             const Program::Vector argument = *instruction->input;
             for (int i = 0; i < Program::Vector::SIZE; ++i) {
-                result[i] = std::sin(argument[i]);
+                result[i] = fastmath::sinFastPath<TAccuracy>(argument[i]);
+            }
+            if constexpr (TAccuracy != MathAccuracy::ULP_1) {
+                for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                    if (!fastmath::isTrigFastPath(argument[i])) {
+                        result[i] = std::sin(argument[i]);
+                    }
+                }
             }
             *instruction->output = result;
             return instruction->next(instruction + 1);
@@ -182,7 +393,14 @@ namespace {
             Program::Vector       result; // prevents aliasing
             const Program::Vector argument = *instruction->input;
             for (int i = 0; i < Program::Vector::SIZE; ++i) {
-                result[i] = std::cos(argument[i]);
+                result[i] = fastmath::cosFastPath<TAccuracy>(argument[i]);
+            }
+            if constexpr (TAccuracy != MathAccuracy::ULP_1) {
+                for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                    if (!fastmath::isTrigFastPath(argument[i])) {
+                        result[i] = std::cos(argument[i]);
+                    }
+                }
             }
             *instruction->output = result;
             return instruction->next(instruction + 1);
@@ -192,12 +410,130 @@ namespace {
             Program::Vector       sines, cosines; // prevents aliasing
             const Program::Vector argument = *instruction->input;
             for (int i = 0; i < Program::Vector::SIZE; ++i) {
-                sines[i]   = std::sin(argument[i]);
-                cosines[i] = std::cos(argument[i]);
+                fastmath::sincosFastPath<TAccuracy>(argument[i], sines[i], cosines[i]);
+            }
+            if constexpr (TAccuracy != MathAccuracy::ULP_1) {
+                for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                    if (!fastmath::isTrigFastPath(argument[i])) {
+                        sines[i]   = std::sin(argument[i]);
+                        cosines[i] = std::cos(argument[i]);
+                    }
+                }
             }
             *instruction->output      = sines;
             *instruction->extraOutput = cosines;
             return instruction->next(instruction + 1);
+        },
+        // Opcode::EXP
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            Program::Vector       result; // prevents aliasing
+            const Program::Vector argument = *instruction->input;
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                result[i] = fastmath::exp<TAccuracy>(argument[i]);
+            }
+            *instruction->output = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::LOG
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            Program::Vector       result; // prevents aliasing
+            const Program::Vector argument = *instruction->input;
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                result[i] = fastmath::log<TAccuracy>(argument[i]);
+            }
+            *instruction->output = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::ATAN2
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            Program::Vector       result; // prevents aliasing
+            const Program::Vector argument1 = *instruction->extraInput;
+            const Program::Vector argument2 = *instruction->input;
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                result[i] = fastmath::atan2<TAccuracy>(argument1[i], argument2[i]);
+            }
+            *instruction->output = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::HYPOT
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            Program::Vector       result; // prevents aliasing
+            const Program::Vector argument1 = *instruction->extraInput;
+            const Program::Vector argument2 = *instruction->input;
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                result[i] = fastmath::hypotFastPath<TAccuracy>(argument1[i], argument2[i]);
+            }
+            if constexpr (TAccuracy != MathAccuracy::ULP_1) {
+                for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                    if (!fastmath::isHypotFastPath(argument1[i], argument2[i])) {
+                        result[i] = std::hypot(argument1[i], argument2[i]);
+                    }
+                }
+            }
+            *instruction->output = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::MIN
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            Program::Vector       result; // prevents aliasing
+            const Program::Vector argument1 = *instruction->extraInput;
+            const Program::Vector argument2 = *instruction->input;
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                result[i] = fastmath::fmin(argument1[i], argument2[i]);
+            }
+            *instruction->output = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::MAX
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            Program::Vector       result; // prevents aliasing
+            const Program::Vector argument1 = *instruction->extraInput;
+            const Program::Vector argument2 = *instruction->input;
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                result[i] = fastmath::fmax(argument1[i], argument2[i]);
+            }
+            *instruction->output = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::FMOD
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            Program::Vector       result; // prevents aliasing
+            const Program::Vector argument1 = *instruction->extraInput;
+            const Program::Vector argument2 = *instruction->input;
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                result[i] = std::fmod(argument1[i], argument2[i]);
+            }
+            *instruction->output = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::COPYSIGN
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            Program::Vector       result; // prevents aliasing
+            const Program::Vector argument1 = *instruction->extraInput;
+            const Program::Vector argument2 = *instruction->input;
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                result[i] = std::copysign(argument1[i], argument2[i]);
+            }
+            *instruction->output = result;
+            return instruction->next(instruction + 1);
+        },
+        // Opcode::TABLE_LOOKUP
+        [](const Executable<Program::Vector>::Instruction* instruction) {
+            Program::Vector            result; // prevents aliasing
+            const Program::Vector      argument = *instruction->input;
+            const FunctionTable* const table    = instruction->table;
+            // Note: All lanes are interpolated (the coefficients are gathered), the rare lanes outside
+            //       the domain are then patched by the original function.
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                result[i] = table->interpolate(argument[i]);
+            }
+            for (int i = 0; i < Program::Vector::SIZE; ++i) {
+                if (!table->contains(argument[i])) {
+                    result[i] = table->function()(argument[i]);
+                }
+            }
+            *instruction->output = result;
+            return instruction->next(instruction + 1);
         }
     };
 
@@ -218,9 +554,29 @@ bool Program::Instruction::operator==(const Instruction& other) const {
         case Opcode::DIVIDE_IMM:   return operand == other.operand && immediate == other.immediate;
         case Opcode::POWER:        return operand == other.operand && source == other.source;
         case Opcode::CALL:         return operand == other.operand && function  == other.function;
+        case Opcode::CALL_BATCH:   return operand == other.operand && batchFunction == other.batchFunction;
+        case Opcode::CALL_BINARY:  return operand == other.operand &&
+                                          binaryCall.source == other.binaryCall.source &&
+                                          binaryCall.function == other.binaryCall.function;
+        case Opcode::CMP_LT:       return operand == other.operand && source == other.source;
+        case Opcode::CMP_LE:       return operand == other.operand && source == other.source;
+        case Opcode::CMP_EQ:       return operand == other.operand && source == other.source;
+        case Opcode::CMP_NE:       return operand == other.operand && source == other.source;
+        case Opcode::SELECT:       return operand == other.operand &&
+                                          select.whenTrue == other.select.whenTrue &&
+                                          select.whenFalse == other.select.whenFalse;
         case Opcode::SIN:          return operand == other.operand;
         case Opcode::COS:          return operand == other.operand;
         case Opcode::SINCOS:       return operand == other.operand && target == other.target;
+        case Opcode::EXP:          return operand == other.operand;
+        case Opcode::LOG:          return operand == other.operand;
+        case Opcode::ATAN2:        return operand == other.operand && source == other.source;
+        case Opcode::HYPOT:        return operand == other.operand && source == other.source;
+        case Opcode::MIN:          return operand == other.operand && source == other.source;
+        case Opcode::MAX:          return operand == other.operand && source == other.source;
+        case Opcode::FMOD:         return operand == other.operand && source == other.source;
+        case Opcode::COPYSIGN:     return operand == other.operand && source == other.source;
+        case Opcode::TABLE_LOOKUP: return operand == other.operand && table     == other.table;
         // clang-format on
         default:
             assert(false);
@@ -229,16 +585,22 @@ bool Program::Instruction::operator==(const Instruction& other) const {
     return false;
 }
 
-Program::Program(Variables&&    inputs,
-                 Variables&&    outputs,
-                 Constants&&    constants,
-                 Instructions&& instructions,
-                 Comments&&     comments)
+Program::Program(Variables&&       inputs,
+                 Variables&&       outputs,
+                 Constants&&       constants,
+                 Instructions&&    instructions,
+                 Comments&&        comments,
+                 BinaryFunctions&& binaryFunctions,
+                 Tables&&          tables,
+                 MathAccuracy      mathAccuracy)
     : mInputs(std::move(inputs))
     , mOutputs(std::move(outputs))
     , mConstants(std::move(constants))
     , mInstructions(std::move(instructions))
-    , mComments(std::move(comments)) {
+    , mComments(std::move(comments))
+    , mBinaryFunctions(std::move(binaryFunctions))
+    , mTables(std::move(tables))
+    , mMathAccuracy(mathAccuracy) {
     assert(mConstants.values.empty() ||
            (SCRATCHPAD_ADDRESS - mConstants.memoryOffset >= mConstants.values.size() &&
             mConstants.memoryOffset + mConstants.values.size() <= mInstructions.memoryOffset));
@@ -268,42 +630,69 @@ Program::Address Program::getOutputAddress(StringView name) const {
     return outputIt->second;
 }
 
+/// The instructions of an executable (not chained yet) with their kernels.
 template <typename TWord>
-static Executable<TWord> makeExecutable(const Program::Constants&    constants,
-                                        const Program::Instructions& program,
-                                        const auto&                  functions) {
-    std::vector<TWord>                                   memory;
-    std::vector<typename Executable<TWord>::Instruction> instructions;
-    typename Executable<TWord>::Function                 startPoint;
-
-    const auto emitCall = [&](typename Executable<TWord>::Function call) {
-        if (instructions.empty()) {
-            startPoint = call;
-        } else {
-            instructions.back().next = call;
-        }
-    };
+struct Translation {
+    std::vector<typename Executable<TWord>::Instruction>   instructions;
+    std::vector<typename ProfilingExecutable<TWord>::Step> steps; // by the (not `NOP`) program instructions
+};
 
-    const size_t programSize = program.instructions.size();
-    memory.resize(program.memoryOffset + programSize, TWord{});
+/// Returns the memory of an executable, i.e. with the constants.
+template <typename TWord>
+static std::vector<TWord> makeMemory(const Program& source) {
+    const Program::Constants&    constants = source.constants();
+    const Program::Instructions& program   = source.instructions();
+
+    std::vector<TWord> memory(program.memoryOffset + program.instructions.size(), TWord{});
     std::copy(constants.values.begin(), constants.values.end(), memory.begin() + constants.memoryOffset);
+    return memory;
+}
+
+/// Translates the instructions of the program; `locate` returns the word of the memory at an address.
+template <typename TWord>
+static Translation<TWord> translate(const Program& source, const auto& functions, const auto& locate) {
+    const Program::Instructions& program = source.instructions();
+
+    Translation<TWord> translation;
+    auto&              instructions = translation.instructions;
+
+    const size_t programSize = program.instructions.size();
     instructions.reserve(programSize);
     for (int i = 0; i < programSize; ++i) {
         const Program::Instruction& input = program.instructions[i];
         if (input.opcode == Program::Opcode::NOP) {
             continue;
         }
-        emitCall(functions[int(input.opcode)]);
+        translation.steps.push_back(
+            { .call = functions[int(input.opcode)], .instruction = instructions.size() });
         typename Executable<TWord>::Instruction& output = instructions.emplace_back();
-        output.output                                   = memory.data() + program.memoryOffset + i;
-        output.input                                    = memory.data() + input.operand;
+        output.output                                   = locate(program.memoryOffset + i);
+        output.input                                    = locate(input.operand);
         switch (input.opcode) {
         case Program::Opcode::ADD:
         case Program::Opcode::SUBTRACT:
         case Program::Opcode::MULTIPLY:
         case Program::Opcode::DIVIDE:
         case Program::Opcode::POWER:
-            output.extraInput = memory.data() + input.source;
+        case Program::Opcode::ATAN2:
+        case Program::Opcode::HYPOT:
+        case Program::Opcode::MIN:
+        case Program::Opcode::MAX:
+        case Program::Opcode::FMOD:
+        case Program::Opcode::COPYSIGN:
+        case Program::Opcode::CMP_LT:
+        case Program::Opcode::CMP_LE:
+        case Program::Opcode::CMP_EQ:
+        case Program::Opcode::CMP_NE:
+            output.extraInput = locate(input.source);
+            break;
+        case Program::Opcode::CALL_BINARY:
+            output.extraInput = locate(input.binaryCall.source);
+            instructions.emplace_back().binaryCallable = source.binaryFunctions()[input.binaryCall.function];
+            break;
+        case Program::Opcode::SELECT:
+            output.extraInput                     = locate(input.select.whenTrue);
+            instructions.emplace_back().whenFalse = locate(input.select.whenFalse);
             break;
         case Program::Opcode::ADD_IMM:
         case Program::Opcode::SUBTRACT_IMM:
@@ -312,26 +701,280 @@ static Executable<TWord> makeExecutable(const Program::Constants&    constants,
         case Program::Opcode::CALL:
             output.immediate = input.immediate;
             break;
+        case Program::Opcode::CALL_BATCH:
+            output.batchCallable = input.batchFunction;
+            break;
         case Program::Opcode::SIN:
         case Program::Opcode::COS:
+        case Program::Opcode::EXP:
+        case Program::Opcode::LOG:
             break;
         case Program::Opcode::SINCOS:
-            output.extraOutput = memory.data() + program.memoryOffset + (i + input.target);
+            output.extraOutput = locate(program.memoryOffset + (i + input.target));
+            break;
+        case Program::Opcode::TABLE_LOOKUP:
+            output.table = input.table;
             break;
         default:
             assert(false);
         }
     }
-    emitCall(functions[int(Program::Opcode::NOP)]);
-    return Executable<TWord>(std::move(memory), std::move(instructions), startPoint);
+    return translation;
+}
+
+/// Chains the translated instructions.
+///
+/// \returns The call of the first instruction.
+template <typename TWord>
+static typename Executable<TWord>::Function chain(Translation<TWord>& translation, const auto& functions) {
+    auto& instructions = translation.instructions;
+
+    // Note: Each kernel calls the next one, i.e. the call of each instruction is stored in the preceding one
+    //       (or its extension).
+    typename Executable<TWord>::Function startPoint = functions[int(Program::Opcode::NOP)];
+    for (const auto& step : translation.steps) {
+        (step.instruction == 0 ? startPoint : instructions[step.instruction - 1].next) = step.call;
+    }
+    if (!instructions.empty()) {
+        instructions.back().next = functions[int(Program::Opcode::NOP)];
+    }
+    return startPoint;
+}
+
+template <typename TWord>
+static Executable<TWord> makeExecutable(const Program& source, const auto& functions) {
+    std::vector<TWord> memory      = makeMemory<TWord>(source);
+    const auto         locate      = [&](Program::Address address) { return memory.data() + address; };
+    Translation<TWord> translation = translate<TWord>(source, functions, locate);
+    const auto startPoint = chain(translation, functions);
+    return Executable<TWord>(
+        std::move(memory), std::move(translation.instructions), startPoint, source.tables());
+}
+
+template <typename TWord>
+static ProfilingExecutable<TWord> instrument(const Program& source, const auto& functions) {
+    std::vector<TWord> memory      = makeMemory<TWord>(source);
+    const auto         locate      = [&](Program::Address address) { return memory.data() + address; };
+    Translation<TWord> translation = translate<TWord>(source, functions, locate);
+    for (auto& instruction : translation.instructions) {
+        instruction.next = functions[int(Program::Opcode::NOP)];
+    }
+    const Program::Instructions& program = source.instructions();
+    Program::Profile             profile;
+    for (Program::Address i = 0; i < program.instructions.size(); ++i) {
+        if (program.instructions[i].opcode != Program::Opcode::NOP) {
+            profile.push_back({ .address = program.memoryOffset + i,
+                                .opcode  = program.instructions[i].opcode,
+                                .count   = 0,
+                                .ticks   = 0 });
+        }
+    }
+    return ProfilingExecutable<TWord>(std::move(memory),
+                                      std::move(translation.instructions),
+                                      std::move(translation.steps),
+                                      std::move(profile),
+                                      source.tables());
 }
 
 Executable<Program::Scalar> Program::makeScalarExecutable() const {
-    return makeExecutable<Scalar>(mConstants, mInstructions, SCALAR_FUNCTIONS);
+    switch (mMathAccuracy) {
+    case MathAccuracy::REL_1E6:
+        return makeExecutable<Scalar>(*this, SCALAR_FUNCTIONS<MathAccuracy::REL_1E6>);
+    case MathAccuracy::REL_1E3:
+        return makeExecutable<Scalar>(*this, SCALAR_FUNCTIONS<MathAccuracy::REL_1E3>);
+    default:
+        return makeExecutable<Scalar>(*this, SCALAR_FUNCTIONS<MathAccuracy::ULP_1>);
+    }
 }
 
 Executable<Program::Vector> Program::makeVectorExecutable() const {
-    return makeExecutable<Vector>(mConstants, mInstructions, VECTOR_FUNCTIONS);
+    switch (mMathAccuracy) {
+    case MathAccuracy::REL_1E6:
+        return makeExecutable<Vector>(*this, VECTOR_FUNCTIONS<MathAccuracy::REL_1E6>);
+    case MathAccuracy::REL_1E3:
+        return makeExecutable<Vector>(*this, VECTOR_FUNCTIONS<MathAccuracy::REL_1E3>);
+    default:
+        return makeExecutable<Vector>(*this, VECTOR_FUNCTIONS<MathAccuracy::ULP_1>);
+    }
 }
 
+/// Makes the executable of single points: the inputs and the outputs are relocated to the first words of the
+/// memory, followed by the other words in the order of their addresses.
+static PointExecutable assemblePointExecutable(const Program&             source,
+                                               const std::vector<String>& inputs,
+                                               const std::vector<String>& outputs,
+                                               const auto&                functions) {
+    using Instruction = PointExecutable::Instruction;
+    using Copy        = PointExecutable::Copy;
+
+    static constexpr uint32_t UNMAPPED = UINT32_MAX;
+
+    const Program::Constants&    constants = source.constants();
+    const Program::Instructions& program   = source.instructions();
+
+    // Note: The unused inputs (i.e. at the scratch-pad) and the repeated ones get words never read.
+    std::vector<uint32_t> locations(program.memoryOffset + program.instructions.size(), UNMAPPED);
+    uint32_t              wordCount = 0;
+    for (const String& name : inputs) {
+        const Program::Address address = source.getInputAddress(name);
+        if (address != Program::SCRATCHPAD_ADDRESS && locations[address] == UNMAPPED) {
+            locations[address] = wordCount;
+        }
+        ++wordCount;
+    }
+    // Note: Only the outputs of the instructions are computed in place, the others are copied after the run.
+    std::vector<Program::Address> outputAddresses;
+    for (const String& name : outputs) {
+        const Program::Address address = source.getOutputAddress(name);
+        if (address >= program.memoryOffset && locations[address] == UNMAPPED) {
+            locations[address] = wordCount;
+        }
+        outputAddresses.push_back(address);
+        ++wordCount;
+    }
+    for (uint32_t& location : locations) {
+        if (location == UNMAPPED) {
+            location = wordCount++;
+        }
+    }
+    std::vector<Copy> copies;
+    for (size_t i = 0; i < outputAddresses.size(); ++i) {
+        const uint32_t target = uint32_t(inputs.size() + i);
+        if (locations[outputAddresses[i]] != target) {
+            copies.push_back({ .source = locations[outputAddresses[i]], .target = target });
+        }
+    }
+
+    // Note: `CALL_BINARY` and `SELECT` are followed by their extensions.
+    size_t instructionCount = 0;
+    for (const Program::Instruction& instruction : program.instructions) {
+        if (instruction.opcode == Program::Opcode::CALL_BINARY ||
+            instruction.opcode == Program::Opcode::SELECT) {
+            instructionCount += 2;
+        } else if (instruction.opcode != Program::Opcode::NOP) {
+            instructionCount += 1;
+        }
+    }
+    const size_t memoryOffset = instructionCount * sizeof(Instruction);
+    const size_t copyOffset   = memoryOffset + wordCount * sizeof(Program::Scalar);
+    const size_t blockSize    = copyOffset + copies.size() * sizeof(Copy);
+    PointExecutable::Block block(static_cast<std::byte*>(
+        ::operator new(blockSize, std::align_val_t(PointExecutable::BLOCK_ALIGNMENT))));
+
+    Program::Scalar* const memory = reinterpret_cast<Program::Scalar*>(block.get() + memoryOffset);
+    std::fill_n(memory, wordCount, Program::Scalar(0.0));
+    for (size_t i = 0; i < constants.values.size(); ++i) {
+        memory[locations[constants.memoryOffset + i]] = constants.values[i];
+    }
+    Translation<Program::Scalar> translation = translate<Program::Scalar>(
+        source, functions, [&](Program::Address address) { return memory + locations[address]; });
+    assert(translation.instructions.size() == instructionCount);
+    const auto startPoint = chain(translation, functions);
+
+    Instruction* const instructions = reinterpret_cast<Instruction*>(block.get());
+    std::uninitialized_copy(translation.instructions.begin(), translation.instructions.end(), instructions);
+    Copy* const copiesInBlock = reinterpret_cast<Copy*>(block.get() + copyOffset);
+    std::uninitialized_copy(copies.begin(), copies.end(), copiesInBlock);
+    return PointExecutable(std::move(block),
+                           instructions,
+                           memory,
+                           copiesInBlock,
+                           inputs.size(),
+                           outputs.size(),
+                           copies.size(),
+                           startPoint,
+                           source.tables());
+}
+
+PointExecutable Program::makePointExecutable(const std::vector<String>& inputs,
+                                             const std::vector<String>& outputs) const {
+    switch (mMathAccuracy) {
+    case MathAccuracy::REL_1E6:
+        return assemblePointExecutable(*this, inputs, outputs, SCALAR_FUNCTIONS<MathAccuracy::REL_1E6>);
+    case MathAccuracy::REL_1E3:
+        return assemblePointExecutable(*this, inputs, outputs, SCALAR_FUNCTIONS<MathAccuracy::REL_1E3>);
+    default:
+        return assemblePointExecutable(*this, inputs, outputs, SCALAR_FUNCTIONS<MathAccuracy::ULP_1>);
+    }
+}
+
+template <typename TWord>
+ProfilingExecutable<TWord> Program::makeProfilingExecutable() const {
+    const auto make = [&]<MathAccuracy TAccuracy>() {
+        if constexpr (std::is_same_v<TWord, Scalar>) {
+            return instrument<Scalar>(*this, SCALAR_FUNCTIONS<TAccuracy>);
+        } else {
+            return instrument<Vector>(*this, VECTOR_FUNCTIONS<TAccuracy>);
+        }
+    };
+    switch (mMathAccuracy) {
+    case MathAccuracy::REL_1E6:
+        return make.template operator()<MathAccuracy::REL_1E6>();
+    case MathAccuracy::REL_1E3:
+        return make.template operator()<MathAccuracy::REL_1E3>();
+    default:
+        return make.template operator()<MathAccuracy::ULP_1>();
+    }
+}
+
+template ProfilingExecutable<Program::Scalar> Program::makeProfilingExecutable() const;
+template ProfilingExecutable<Program::Vector> Program::makeProfilingExecutable() const;
+
+//============================================================================================================
+// ProfilingExecutable
+//============================================================================================================
+
+static uint64_t readTimestamp() {
+#if defined(SIXPACK_HAS_RDTSC)
+    return __rdtsc();
+#else
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count());
+#endif
+}
+
+template <typename TWord>
+ProfilingExecutable<TWord>::ProfilingExecutable(std::vector<TWord>       memory,
+                                                std::vector<Instruction> instructions,
+                                                std::vector<Step>        steps,
+                                                Program::Profile         profile,
+                                                Program::Tables          tables)
+    : mMemory(std::move(memory))
+    , mInstructions(std::move(instructions))
+    , mSteps(std::move(steps))
+    , mProfile(std::move(profile))
+    , mTables(std::move(tables)) {
+    assert(mSteps.size() == mProfile.size());
+    // Note: The overhead is the least time of an empty measurement, i.e. the instructions never cost less.
+    mOverhead = UINT64_MAX;
+    for (int i = 0; i < 1000; ++i) {
+        const uint64_t start = readTimestamp();
+        mOverhead            = std::min(mOverhead, readTimestamp() - start);
+    }
+}
+
+template <typename TWord>
+void ProfilingExecutable<TWord>::run() {
+    const Instruction* const instructions = mInstructions.data();
+    for (size_t i = 0; i < mSteps.size(); ++i) {
+        const uint64_t start = readTimestamp();
+        mSteps[i].call(instructions + mSteps[i].instruction);
+        const uint64_t ticks = readTimestamp() - start;
+        mProfile[i].count += 1;
+        mProfile[i].ticks += ticks > mOverhead ? ticks - mOverhead : 0;
+    }
+}
+
+template <typename TWord>
+void ProfilingExecutable<TWord>::reset() {
+    for (Program::InstructionProfile& instruction : mProfile) {
+        instruction.count = 0;
+        instruction.ticks = 0;
+    }
+}
+
+template class ProfilingExecutable<Program::Scalar>;
+template class ProfilingExecutable<Program::Vector>;
+
 SIXPACK_NAMESPACE_END
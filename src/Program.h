@@ -1,6 +1,11 @@
 #pragma once
 #include "Common.h"
+#include "Metrics.h"
+#include <array>
+#include <iosfwd>
 #include <memory>
+#include <new>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -9,8 +14,13 @@ SIXPACK_NAMESPACE_BEGIN
 namespace asg {
     class Term;
 }
+class FunctionRegistry;
+class FunctionTable;
 template <typename TWord>
 class Executable;
+template <typename TWord>
+class ProfilingExecutable;
+class PointExecutable;
 
 class Program {
 public:
@@ -55,6 +65,9 @@ public:
         FORCEINLINE Real  operator[](const auto index) const { return mValues[index]; }
         FORCEINLINE Real& operator[](const auto index) { return mValues[index]; }
 
+        FORCEINLINE const Real* data() const { return mValues; }
+        FORCEINLINE Real*       data() { return mValues; }
+
     private:
         Real mValues[SIZE];
     };
@@ -82,21 +95,47 @@ public:
         DIVIDE_IMM,                   // output <-- immediate      / memory[operand]
         POWER,                        // output <-- memory[source] ^ memory[operand]
         CALL,                         // output <-- function(memory[operand])
+        CALL_BATCH,                   // output <-- batchFunction(memory[operand])
+        CALL_BINARY,                  // output <-- binaryFunctions[function](memory[source], memory[operand])
+        CMP_LT,                       // output <-- memory[source] <  memory[operand] ? 1 : 0
+        CMP_LE,                       // output <-- memory[source] <= memory[operand] ? 1 : 0
+        CMP_EQ,                       // output <-- memory[source] == memory[operand] ? 1 : 0
+        CMP_NE,                       // output <-- memory[source] != memory[operand] ? 1 : 0
+        SELECT,                       // output <-- memory[operand] ? memory[whenTrue] : memory[whenFalse]
         /*** Intrinsic Functions ***/ //
         SIN,                          // output        <-- sin(memory[operand])
         COS,                          // output        <-- cos(memory[operand])
-        SINCOS                        // output        <-- sin(memory[operand])
+        SINCOS,                       // output        <-- sin(memory[operand])
                                       // output+target <-- cos(memory[operand])
+        EXP,                          // output        <-- exp(memory[operand])
+        LOG,                          // output        <-- log(memory[operand])
+        ATAN2,                        // output        <-- atan2(memory[source], memory[operand])
+        HYPOT,                        // output        <-- hypot(memory[source], memory[operand])
+        MIN,                          // output        <-- fmin(memory[source], memory[operand])
+        MAX,                          // output        <-- fmax(memory[source], memory[operand])
+        FMOD,                         // output        <-- fmod(memory[source], memory[operand])
+        COPYSIGN,                     // output        <-- copysign(memory[source], memory[operand])
+        TABLE_LOOKUP                  // output        <-- table(memory[operand])
     };
 
     struct Instruction {
         Opcode  opcode;
         Address operand;
         union {
-            Address      source;
-            Real         immediate;
-            RealFunction function;
-            ptrdiff_t    target;
+            Address              source;
+            Real                 immediate;
+            RealFunction         function;
+            BatchFunction        batchFunction;
+            const FunctionTable* table;
+            ptrdiff_t            target;
+            struct {
+                Address  source;
+                uint32_t function; // index into the binary functions
+            } binaryCall;
+            struct {
+                Address whenTrue;
+                Address whenFalse;
+            } select;
         };
 
         bool operator==(const Instruction& other) const;
@@ -110,31 +149,135 @@ public:
 
     using Comments = std::unordered_map<Address, String>;
 
+    /// The functions referenced (by index) by the `CALL_BINARY` instructions.
+    using BinaryFunctions = std::vector<BinaryRealFunction>;
+
+    /// The function tables referenced by the `TABLE_LOOKUP` instructions.
+    using Tables = std::vector<std::shared_ptr<const FunctionTable>>;
+
+    /// The execution count and the cost of an instruction, as measured by `ProfilingExecutable`.
+    struct InstructionProfile {
+        Address  address;
+        Opcode   opcode;
+        uint64_t count;
+        uint64_t ticks; // of the timestamp counter (or nanoseconds where not available)
+    };
+
+    using Profile = std::vector<InstructionProfile>;
+
+    static constexpr size_t OPCODE_COUNT = size_t(Opcode::TABLE_LOOKUP) + 1;
+
+    enum class Microarchitecture {
+        GENERIC, ///< a recent x86-64 core with AVX2
+        SKYLAKE, ///< Intel Skylake (client) up to Comet Lake
+        ZEN4,    ///< AMD Zen 4
+    };
+
+    /// The estimated cost of the instructions on a microarchitecture, in cycles per word (i.e. per point of
+    /// the scalar executables, per `Vector::SIZE` points of the vector ones).
+    ///
+    /// Note: The costs of the calls are those of the typical functions of the standard library, i.e. the
+    ///       estimates of the programs calling expensive functions are optimistic.
+    struct CostModel {
+        struct Cost {
+            double latency;    ///< from the operands to the output
+            double throughput; ///< reciprocal, i.e. the cycles per instruction if independent
+        };
+
+        StringView                     name;
+        std::array<Cost, OPCODE_COUNT> scalar;
+        std::array<Cost, OPCODE_COUNT> vector;
+        double                         dispatch; ///< the cycles of the (indirect) call of each kernel
+
+        static const CostModel& get(Microarchitecture microarchitecture);
+    };
+
+    /// The static performance estimate of a program, see `analyze`.
+    struct Analysis {
+        struct Estimate {
+            double latencyBound;    ///< the cycles of the critical path (i.e. with unlimited resources)
+            double throughputBound; ///< the cycles of issuing all the instructions (i.e. if independent)
+            size_t codeBytes;       ///< of the instructions of the executable
+            size_t dataBytes;       ///< of the memory of the executable
+
+            /// The estimated cycles per evaluation (i.e. per word).
+            double cycles() const { return latencyBound > throughputBound ? latencyBound : throughputBound; }
+        };
+
+        StringView                       costModel;
+        std::array<size_t, OPCODE_COUNT> opcodeCounts;
+        size_t                           instructionCount;   ///< excluding `NOP`
+        size_t                           criticalPathLength; ///< the instructions of the critical path
+        double                           averageParallelism; ///< the instructions per critical path step
+        size_t                           peakLiveWords;      ///< including the inputs and the constants
+        size_t                           tableBytes;         ///< of the function tables (shared)
+        Estimate                         scalar;
+        Estimate                         vector;
+    };
+
 private:
-    const Variables    mInputs;
-    const Variables    mOutputs;
-    const Constants    mConstants;
-    const Instructions mInstructions;
-    const Comments     mComments;
+    const Variables       mInputs;
+    const Variables       mOutputs;
+    const Constants       mConstants;
+    const Instructions    mInstructions;
+    const Comments        mComments;
+    const BinaryFunctions mBinaryFunctions;
+    const Tables          mTables;
+    const MathAccuracy    mMathAccuracy;
 
 public:
-    Program(Variables&&    inputs,
-            Variables&&    outputs,
-            Constants&&    constants,
-            Instructions&& instructions,
-            Comments&&     comments);
-
-    const Variables&    inputs() const { return mInputs; }
-    const Variables&    outputs() const { return mOutputs; }
-    const Constants&    constants() const { return mConstants; }
-    const Instructions& instructions() const { return mInstructions; }
-    const Comments&     comments() const { return mComments; }
+    Program(Variables&&       inputs,
+            Variables&&       outputs,
+            Constants&&       constants,
+            Instructions&&    instructions,
+            Comments&&        comments,
+            BinaryFunctions&& binaryFunctions = {},
+            Tables&&          tables          = {},
+            MathAccuracy      mathAccuracy    = MathAccuracy::ULP_1);
+
+    const Variables&       inputs() const { return mInputs; }
+    const Variables&       outputs() const { return mOutputs; }
+    const Constants&       constants() const { return mConstants; }
+    const Instructions&    instructions() const { return mInstructions; }
+    const Comments&        comments() const { return mComments; }
+    const BinaryFunctions& binaryFunctions() const { return mBinaryFunctions; }
+    const Tables&          tables() const { return mTables; }
+    MathAccuracy           mathAccuracy() const { return mMathAccuracy; }
 
     Address getInputAddress(StringView name) const;
     Address getOutputAddress(StringView name) const;
 
     Executable<Scalar> makeScalarExecutable() const;
     Executable<Vector> makeVectorExecutable() const;
+
+    /// Makes an executable of single points (see `PointExecutable`), with the inputs and the outputs in the
+    /// given order.
+    ///
+    /// \throws Exception if any of the inputs or the outputs is unknown.
+    PointExecutable makePointExecutable(const std::vector<String>& inputs,
+                                        const std::vector<String>& outputs) const;
+
+    /// Estimates the cost of the program without running it: the instruction mix, the cycles per evaluation
+    /// bound by the latency (the critical path) and by the throughput of the instructions, the parallelism
+    /// of the instructions, the peak of the live memory and the sizes of the executables.
+    Analysis analyze(Microarchitecture microarchitecture = Microarchitecture::GENERIC) const;
+
+    /// Makes an instrumented executable measuring the cost of each instruction (much slower than the regular
+    /// one, i.e. meant for finding the hot spots only).
+    template <typename TWord>
+    ProfilingExecutable<TWord> makeProfilingExecutable() const;
+
+    /// Writes the program into the (binary) stream, optionally including the comments.
+    ///
+    /// The functions called by the program (or tabulated) are stored by name, as found in the registry.
+    ///
+    /// \throws Exception if any of the functions is not in the registry or if the stream cannot be written.
+    void serialize(std::ostream& output, const FunctionRegistry& functions, bool withComments = false) const;
+
+    /// Reads the program written by `serialize`; the functions are re-bound by name through the registry.
+    ///
+    /// \throws Exception if the stream does not hold a valid program or if any of the functions is unknown.
+    static Program deserialize(std::istream& input, const FunctionRegistry& functions);
 };
 
 template <typename TWord>
@@ -143,15 +286,22 @@ public:
     struct Instruction;
     using Function = void (*)(const Instruction* instruction);
 
+    /// Note: The instructions needing more operands than fit into a single instruction (`CALL_BINARY` and
+    ///       `SELECT`) are followed by an extension, i.e. an instruction holding the extra operands and the
+    ///       next call.
     struct alignas(32) Instruction {
         Function     next;
         TWord*       output;
         const TWord* input;
         union {
-            const TWord* extraInput;
-            Real         immediate;
-            RealFunction callable;
-            TWord*       extraOutput;
+            const TWord*         extraInput;
+            Real                 immediate;
+            RealFunction         callable;
+            BatchFunction        batchCallable;
+            BinaryRealFunction   binaryCallable; // extension of CALL_BINARY
+            const TWord*         whenFalse;      // extension of SELECT
+            const FunctionTable* table;
+            TWord*               extraOutput;
         };
     };
 
@@ -159,19 +309,152 @@ private:
     std::vector<TWord>             mMemory;
     const std::vector<Instruction> mInstructions;
     const Function                 mStartPoint;
+    const Program::Tables          mTables; // keeps the referenced tables alive
 
 public:
-    Executable(std::vector<TWord> memory, std::vector<Instruction> instructions, Function startPoint)
+    Executable(std::vector<TWord>       memory,
+               std::vector<Instruction> instructions,
+               Function                 startPoint,
+               Program::Tables          tables = {})
         : mMemory(std::move(memory))
         , mInstructions(std::move(instructions))
-        , mStartPoint(startPoint) {
+        , mStartPoint(startPoint)
+        , mTables(std::move(tables)) {
+        assert(startPoint);
+    }
+
+    std::vector<TWord>&       memory() { return mMemory; }
+    const std::vector<TWord>& memory() const { return mMemory; }
+
+    void run() {
+        Metrics::recordRun(sizeof(TWord) / sizeof(Real));
+        mStartPoint(mInstructions.data());
+    }
+};
+
+/// An executable evaluating a single point at a time with the least latency, e.g. within a control loop.
+///
+/// The inputs and the outputs are relocated to the first words of the memory, in the order given to
+/// `Program::makePointExecutable`, i.e. `eval` copies them with no lookup. The instructions, the memory and
+/// the copies of the outputs not computed in place (e.g. the outputs being inputs or constants) share a
+/// single cache-aligned block, i.e. the whole executable stays within a few cache lines and `eval` does not
+/// allocate.
+class PointExecutable {
+public:
+    using Instruction = Executable<Program::Scalar>::Instruction;
+    using Function    = Executable<Program::Scalar>::Function;
+
+    static constexpr size_t BLOCK_ALIGNMENT = 64;
+
+    /// The copy of a word of the memory into an output.
+    struct Copy {
+        uint32_t source;
+        uint32_t target;
+    };
+
+    struct BlockDeleter {
+        void operator()(std::byte* block) const {
+            ::operator delete(block, std::align_val_t(BLOCK_ALIGNMENT));
+        }
+    };
+
+    using Block = std::unique_ptr<std::byte, BlockDeleter>;
+
+private:
+    Block              mBlock; // the instructions, the memory and the copies
+    const Instruction* mInstructions;
+    Program::Scalar*   mMemory;
+    const Copy*        mCopies;
+    size_t             mInputCount;
+    size_t             mOutputCount;
+    size_t             mCopyCount;
+    Function           mStartPoint;
+    Program::Tables    mTables; // keeps the referenced tables alive
+
+public:
+    PointExecutable(Block              block,
+                    const Instruction* instructions,
+                    Program::Scalar*   memory,
+                    const Copy*        copies,
+                    size_t             inputCount,
+                    size_t             outputCount,
+                    size_t             copyCount,
+                    Function           startPoint,
+                    Program::Tables    tables = {})
+        : mBlock(std::move(block))
+        , mInstructions(instructions)
+        , mMemory(memory)
+        , mCopies(copies)
+        , mInputCount(inputCount)
+        , mOutputCount(outputCount)
+        , mCopyCount(copyCount)
+        , mStartPoint(startPoint)
+        , mTables(std::move(tables)) {
         assert(startPoint);
     }
 
+    size_t inputCount() const { return mInputCount; }
+    size_t outputCount() const { return mOutputCount; }
+
+    /// Evaluates the point, i.e. `inputCount` inputs into `outputCount` outputs.
+    FORCEINLINE void eval(std::span<const Real> inputs, std::span<Real> outputs) {
+        assert(inputs.size() == mInputCount && outputs.size() == mOutputCount);
+        Metrics::recordRun(1);
+        for (size_t i = 0; i < mInputCount; ++i) {
+            mMemory[i] = inputs[i];
+        }
+        mStartPoint(mInstructions);
+        for (size_t i = 0; i < mCopyCount; ++i) {
+            mMemory[mCopies[i].target] = mMemory[mCopies[i].source];
+        }
+        for (size_t i = 0; i < mOutputCount; ++i) {
+            outputs[i] = mMemory[mInputCount + i];
+        }
+    }
+};
+
+/// An executable counting the executions and measuring the cost of each instruction.
+///
+/// The instructions are executed by the same kernels as those of `Executable`, but one at a time (rather
+/// than chained), each one timed separately. The overhead of the timing is calibrated and subtracted, i.e.
+/// the costs of the cheap instructions are approximate.
+template <typename TWord>
+class ProfilingExecutable {
+public:
+    using Instruction = typename Executable<TWord>::Instruction;
+    using Function    = typename Executable<TWord>::Function;
+
+    /// An instruction with its kernel.
+    struct Step {
+        Function call;
+        size_t   instruction; // the index into the instructions
+    };
+
+private:
+    std::vector<TWord>             mMemory;
+    const std::vector<Instruction> mInstructions; // all chained to `NOP`, i.e. returning after themselves
+    const std::vector<Step>        mSteps;
+    Program::Profile               mProfile; // by step
+    const Program::Tables          mTables;  // keeps the referenced tables alive
+    uint64_t                       mOverhead = 0;
+
+public:
+    ProfilingExecutable(std::vector<TWord>       memory,
+                        std::vector<Instruction> instructions,
+                        std::vector<Step>        steps,
+                        Program::Profile         profile,
+                        Program::Tables          tables = {});
+
     std::vector<TWord>&       memory() { return mMemory; }
     const std::vector<TWord>& memory() const { return mMemory; }
 
-    void run() { mStartPoint(mInstructions.data()); }
+    /// Returns the accumulated profile of the executed (i.e. not `NOP`) instructions, in the program order.
+    const Program::Profile& profile() const { return mProfile; }
+
+    void run();
+
+    /// Clears the counters of the profile.
+    void reset();
 };
 
 SIXPACK_NAMESPACE_END
@@ -0,0 +1,292 @@
+#include "FunctionTable.h"
+#include "Program.h"
+#include <algorithm>
+
+SIXPACK_NAMESPACE_BEGIN
+
+namespace {
+
+    // The costs of the kernels of the executables, i.e. including the loads and the stores of the operands,
+    // and the lane loops of the vector kernels of the functions. The costs of the arithmetic follow the
+    // instruction tables of the microarchitectures, those of the functions are rough estimates.
+
+    /// The costs of an opcode: the latency and the reciprocal throughput, scalar and vector.
+    struct CostRow {
+        double scalarLatency;
+        double scalarThroughput;
+        double vectorLatency;
+        double vectorThroughput;
+    };
+
+    using CostTable = std::array<CostRow, Program::OPCODE_COUNT>;
+
+    static constexpr CostTable GENERIC_COSTS = { {
+        { 0, 0, 0, 0 },       // NOP
+        { 5, 1, 5, 1 },       // ADD
+        { 5, 1, 5, 1 },       // ADD_IMM
+        { 5, 1, 5, 1 },       // SUBTRACT
+        { 5, 1, 5, 1 },       // SUBTRACT_IMM
+        { 5, 1, 5, 1 },       // MULTIPLY
+        { 5, 1, 5, 1 },       // MULTIPLY_IMM
+        { 15, 5, 15, 8 },     // DIVIDE
+        { 15, 5, 15, 8 },     // DIVIDE_IMM
+        { 60, 40, 240, 160 }, // POWER
+        { 45, 30, 180, 120 }, // CALL
+        { 45, 30, 70, 50 },   // CALL_BATCH
+        { 55, 35, 220, 140 }, // CALL_BINARY
+        { 5, 1, 5, 1 },       // CMP_LT
+        { 5, 1, 5, 1 },       // CMP_LE
+        { 5, 1, 5, 1 },       // CMP_EQ
+        { 5, 1, 5, 1 },       // CMP_NE
+        { 3, 1, 3, 1 },       // SELECT
+        { 30, 18, 60, 40 },   // SIN
+        { 30, 18, 60, 40 },   // COS
+        { 35, 22, 70, 48 },   // SINCOS
+        { 25, 14, 50, 30 },   // EXP
+        { 28, 16, 56, 34 },   // LOG
+        { 50, 35, 200, 140 }, // ATAN2
+        { 22, 10, 88, 40 },   // HYPOT
+        { 5, 1, 8, 4 },       // MIN
+        { 5, 1, 8, 4 },       // MAX
+        { 35, 25, 140, 100 }, // FMOD
+        { 3, 1, 6, 4 },       // COPYSIGN
+        { 15, 6, 40, 24 },    // TABLE_LOOKUP
+    } };
+
+    static constexpr CostTable SKYLAKE_COSTS = { {
+        { 0, 0, 0, 0 },       // NOP
+        { 4, 0.5, 4, 0.5 },   // ADD
+        { 4, 0.5, 4, 0.5 },   // ADD_IMM
+        { 4, 0.5, 4, 0.5 },   // SUBTRACT
+        { 4, 0.5, 4, 0.5 },   // SUBTRACT_IMM
+        { 4, 0.5, 4, 0.5 },   // MULTIPLY
+        { 4, 0.5, 4, 0.5 },   // MULTIPLY_IMM
+        { 14, 4, 14, 8 },     // DIVIDE
+        { 14, 4, 14, 8 },     // DIVIDE_IMM
+        { 55, 38, 220, 150 }, // POWER
+        { 42, 28, 168, 112 }, // CALL
+        { 42, 28, 64, 46 },   // CALL_BATCH
+        { 52, 32, 208, 128 }, // CALL_BINARY
+        { 5, 1, 5, 1 },       // CMP_LT
+        { 5, 1, 5, 1 },       // CMP_LE
+        { 5, 1, 5, 1 },       // CMP_EQ
+        { 5, 1, 5, 1 },       // CMP_NE
+        { 2, 1, 2, 1 },       // SELECT
+        { 28, 16, 56, 36 },   // SIN
+        { 28, 16, 56, 36 },   // COS
+        { 33, 20, 66, 44 },   // SINCOS
+        { 23, 12, 46, 28 },   // EXP
+        { 26, 14, 52, 32 },   // LOG
+        { 48, 32, 192, 128 }, // ATAN2
+        { 20, 9, 80, 36 },    // HYPOT
+        { 4, 1, 8, 4 },       // MIN
+        { 4, 1, 8, 4 },       // MAX
+        { 32, 22, 128, 88 },  // FMOD
+        { 2, 1, 6, 4 },       // COPYSIGN
+        { 14, 5, 36, 22 },    // TABLE_LOOKUP
+    } };
+
+    static constexpr CostTable ZEN4_COSTS = { {
+        { 0, 0, 0, 0 },       // NOP
+        { 3, 0.5, 3, 0.5 },   // ADD
+        { 3, 0.5, 3, 0.5 },   // ADD_IMM
+        { 3, 0.5, 3, 0.5 },   // SUBTRACT
+        { 3, 0.5, 3, 0.5 },   // SUBTRACT_IMM
+        { 3, 0.5, 3, 0.5 },   // MULTIPLY
+        { 3, 0.5, 3, 0.5 },   // MULTIPLY_IMM
+        { 13, 5, 13, 5 },     // DIVIDE
+        { 13, 5, 13, 5 },     // DIVIDE_IMM
+        { 45, 30, 180, 120 }, // POWER
+        { 36, 24, 144, 96 },  // CALL
+        { 36, 24, 56, 40 },   // CALL_BATCH
+        { 44, 28, 176, 112 }, // CALL_BINARY
+        { 4, 1, 4, 1 },       // CMP_LT
+        { 4, 1, 4, 1 },       // CMP_LE
+        { 4, 1, 4, 1 },       // CMP_EQ
+        { 4, 1, 4, 1 },       // CMP_NE
+        { 2, 0.5, 2, 0.5 },   // SELECT
+        { 24, 14, 48, 30 },   // SIN
+        { 24, 14, 48, 30 },   // COS
+        { 28, 17, 56, 36 },   // SINCOS
+        { 20, 10, 40, 24 },   // EXP
+        { 22, 12, 44, 26 },   // LOG
+        { 40, 28, 160, 112 }, // ATAN2
+        { 17, 8, 68, 32 },    // HYPOT
+        { 3, 0.5, 6, 3 },     // MIN
+        { 3, 0.5, 6, 3 },     // MAX
+        { 28, 20, 112, 80 },  // FMOD
+        { 2, 0.5, 4, 3 },     // COPYSIGN
+        { 12, 4, 30, 18 },    // TABLE_LOOKUP
+    } };
+
+    static Program::CostModel makeCostModel(StringView name, const CostTable& table, double dispatch) {
+        Program::CostModel model{ .name = name, .scalar = {}, .vector = {}, .dispatch = dispatch };
+        for (size_t i = 0; i < Program::OPCODE_COUNT; ++i) {
+            model.scalar[i] = { .latency = table[i].scalarLatency, .throughput = table[i].scalarThroughput };
+            model.vector[i] = { .latency = table[i].vectorLatency, .throughput = table[i].vectorThroughput };
+        }
+        return model;
+    }
+
+    /// Calls the function with the addresses of the operands of the instruction.
+    static void forEachOperand(const Program::Instruction& instruction, const auto& function) {
+        switch (instruction.opcode) {
+        case Program::Opcode::NOP:
+            break;
+        case Program::Opcode::ADD:
+        case Program::Opcode::SUBTRACT:
+        case Program::Opcode::MULTIPLY:
+        case Program::Opcode::DIVIDE:
+        case Program::Opcode::POWER:
+        case Program::Opcode::CMP_LT:
+        case Program::Opcode::CMP_LE:
+        case Program::Opcode::CMP_EQ:
+        case Program::Opcode::CMP_NE:
+        case Program::Opcode::ATAN2:
+        case Program::Opcode::HYPOT:
+        case Program::Opcode::MIN:
+        case Program::Opcode::MAX:
+        case Program::Opcode::FMOD:
+        case Program::Opcode::COPYSIGN:
+            function(instruction.source);
+            function(instruction.operand);
+            break;
+        case Program::Opcode::CALL_BINARY:
+            function(instruction.binaryCall.source);
+            function(instruction.operand);
+            break;
+        case Program::Opcode::SELECT:
+            function(instruction.select.whenTrue);
+            function(instruction.select.whenFalse);
+            function(instruction.operand);
+            break;
+        default:
+            function(instruction.operand);
+            break;
+        }
+    }
+
+} // namespace
+
+const Program::CostModel& Program::CostModel::get(Microarchitecture microarchitecture) {
+    static const CostModel GENERIC = makeCostModel("generic", GENERIC_COSTS, 3.0);
+    static const CostModel SKYLAKE = makeCostModel("skylake", SKYLAKE_COSTS, 2.5);
+    static const CostModel ZEN4    = makeCostModel("zen4", ZEN4_COSTS, 2.0);
+    switch (microarchitecture) {
+    case Microarchitecture::SKYLAKE:
+        return SKYLAKE;
+    case Microarchitecture::ZEN4:
+        return ZEN4;
+    default:
+        return GENERIC;
+    }
+}
+
+Program::Analysis Program::analyze(Microarchitecture microarchitecture) const {
+    const CostModel&                model       = CostModel::get(microarchitecture);
+    const Address                   codeSection = mInstructions.memoryOffset;
+    const std::vector<Instruction>& code        = mInstructions.instructions;
+    const auto                      isCode      = [&](Address address) {
+        return address >= codeSection && address - codeSection < code.size();
+    };
+
+    Analysis analysis{ .costModel          = model.name,
+                       .opcodeCounts       = {},
+                       .instructionCount   = 0,
+                       .criticalPathLength = 0,
+                       .averageParallelism = 0.0,
+                       .peakLiveWords      = codeSection,
+                       .tableBytes         = 0,
+                       .scalar             = {},
+                       .vector             = {} };
+
+    // The earliest completion of each instruction (i.e. of its output), with unlimited resources.
+    struct Completion {
+        size_t length; // in instructions
+        double scalarCycles;
+        double vectorCycles;
+    };
+    std::vector<Completion> completions(code.size(), Completion{});
+    // The index of the last consumer of each output, i.e. the end of its lifetime.
+    std::vector<size_t> lastConsumers(code.size(), 0);
+    size_t              extensionCount = 0;
+    for (size_t i = 0; i < code.size(); ++i) {
+        const Instruction& instruction = code[i];
+        if (instruction.opcode == Opcode::NOP) {
+            continue;
+        }
+        const size_t opcode = size_t(instruction.opcode);
+        ++analysis.opcodeCounts[opcode];
+        ++analysis.instructionCount;
+        if (instruction.opcode == Opcode::CALL_BINARY || instruction.opcode == Opcode::SELECT) {
+            ++extensionCount;
+        }
+
+        Completion ready{};
+        forEachOperand(instruction, [&](Address address) {
+            // Note: The data section (i.e. the inputs and the constants) is ready at the start.
+            if (isCode(address)) {
+                const Completion& operand = completions[address - codeSection];
+                ready.length              = std::max(ready.length, operand.length);
+                ready.scalarCycles        = std::max(ready.scalarCycles, operand.scalarCycles);
+                ready.vectorCycles        = std::max(ready.vectorCycles, operand.vectorCycles);
+                lastConsumers[address - codeSection] = i;
+            }
+        });
+        completions[i] = { .length       = ready.length + 1,
+                           .scalarCycles = ready.scalarCycles + model.scalar[opcode].latency,
+                           .vectorCycles = ready.vectorCycles + model.vector[opcode].latency };
+        lastConsumers[i] = std::max(lastConsumers[i], i);
+        if (instruction.opcode == Opcode::SINCOS) {
+            // Note: The cosine is stored by the instruction into the slot of its `NOP`.
+            const size_t cosine = size_t(ptrdiff_t(i) + instruction.target);
+            if (cosine < code.size()) {
+                completions[cosine]   = completions[i];
+                lastConsumers[cosine] = std::max(lastConsumers[cosine], cosine);
+            }
+        }
+
+        analysis.criticalPathLength  = std::max(analysis.criticalPathLength, completions[i].length);
+        analysis.scalar.latencyBound = std::max(analysis.scalar.latencyBound, completions[i].scalarCycles);
+        analysis.vector.latencyBound = std::max(analysis.vector.latencyBound, completions[i].vectorCycles);
+        // Note: The kernels are called one after another, i.e. the dispatch limits the throughput.
+        analysis.scalar.throughputBound += model.scalar[opcode].throughput + model.dispatch;
+        analysis.vector.throughputBound += model.vector[opcode].throughput + model.dispatch;
+    }
+    if (analysis.criticalPathLength > 0) {
+        analysis.averageParallelism = double(analysis.instructionCount) / double(analysis.criticalPathLength);
+    }
+
+    // The outputs are live until the end; the data section is live all the time.
+    for (const auto& [name, address] : mOutputs) {
+        if (isCode(address)) {
+            lastConsumers[address - codeSection] = code.size();
+        }
+    }
+    std::vector<ptrdiff_t> liveChanges(code.size() + 2, 0);
+    for (size_t i = 0; i < code.size(); ++i) {
+        if (code[i].opcode != Opcode::NOP || lastConsumers[i] > i) {
+            ++liveChanges[i];
+            --liveChanges[lastConsumers[i] + 1];
+        }
+    }
+    ptrdiff_t liveWords = 0;
+    for (size_t i = 0; i < code.size(); ++i) {
+        liveWords += liveChanges[i];
+        analysis.peakLiveWords = std::max(analysis.peakLiveWords, codeSection + size_t(liveWords));
+    }
+
+    // Note: The instructions of CALL_BINARY and SELECT are followed by an extension in the executables.
+    const size_t memoryWords     = codeSection + code.size();
+    const size_t executableCount = analysis.instructionCount + extensionCount;
+    analysis.scalar.codeBytes    = executableCount * sizeof(Executable<Scalar>::Instruction);
+    analysis.scalar.dataBytes    = memoryWords * sizeof(Scalar);
+    analysis.vector.codeBytes    = executableCount * sizeof(Executable<Vector>::Instruction);
+    analysis.vector.dataBytes    = memoryWords * sizeof(Vector);
+    for (const auto& table : mTables) {
+        analysis.tableBytes += table->coefficients().size_bytes();
+    }
+    return analysis;
+}
+
+SIXPACK_NAMESPACE_END
@@ -0,0 +1,114 @@
+#include "ProgramCache.h"
+#include "Compiler.h"
+#include "Exception.h"
+#include "FunctionRegistry.h"
+#include "Program.h"
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <system_error>
+#include <thread>
+
+SIXPACK_NAMESPACE_BEGIN
+
+ProgramCache::ProgramCache(std::filesystem::path directory, bool withComments)
+    : mDirectory(std::move(directory))
+    , mWithComments(withComments) {
+    std::error_code error;
+    std::filesystem::create_directories(mDirectory, error);
+    if (error) {
+        throw Exception(
+            std::format("Cannot create the cache directory '{}' ({})", mDirectory.string(), error.message()));
+    }
+}
+
+Program ProgramCache::compile(const Compiler& compiler) const {
+    const uint64_t         fingerprint      = compiler.fingerprint();
+    const String           fingerprintInput = compiler.fingerprintInput();
+    const FunctionRegistry functions        = compiler.getFunctions();
+    if (std::optional<Program> program = load(fingerprint, fingerprintInput, functions)) {
+        return std::move(*program);
+    }
+    Program program = compiler.compile();
+    try {
+        store(fingerprint, fingerprintInput, program, functions);
+    } catch (const Exception&) {
+        // Note: The program is compiled again the next time.
+    }
+    return program;
+}
+
+std::optional<Program> ProgramCache::load(uint64_t                fingerprint,
+                                          StringView              fingerprintInput,
+                                          const FunctionRegistry& functions) const {
+    std::ifstream file(makePath(fingerprint), std::ios::binary);
+    if (!file) {
+        return std::nullopt;
+    }
+    // Note: The entry of a colliding fingerprint is treated as missing (i.e. replaced by the caller).
+    uint64_t size = 0;
+    file.read(reinterpret_cast<char*>(&size), sizeof(size));
+    if (!file || size != fingerprintInput.size()) {
+        return std::nullopt;
+    }
+    String storedInput(size, '\0');
+    file.read(storedInput.data(), std::streamsize(size));
+    if (!file || storedInput != fingerprintInput) {
+        return std::nullopt;
+    }
+    try {
+        return Program::deserialize(file, functions);
+    } catch (const Exception&) {
+        return std::nullopt;
+    }
+}
+
+void ProgramCache::store(uint64_t                fingerprint,
+                         StringView              fingerprintInput,
+                         const Program&          program,
+                         const FunctionRegistry& functions) const {
+    static std::atomic<uint64_t> temporaryCounter = 0;
+
+    // Note: The program is written into a unique temporary file first, which is then renamed over the entry,
+    //       so that the concurrent readers (and writers) never see a partial program.
+    const std::filesystem::path path          = makePath(fingerprint);
+    const std::filesystem::path temporaryPath = std::format(
+        "{}.{:x}.{:x}.tmp",
+        path.string(),
+        std::chrono::steady_clock::now().time_since_epoch().count(),
+        std::hash<std::thread::id>()(std::this_thread::get_id()) ^ temporaryCounter.fetch_add(1));
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw Exception(std::format("Cannot create '{}'", temporaryPath.string()));
+        }
+        try {
+            const uint64_t size = fingerprintInput.size();
+            file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            file.write(fingerprintInput.data(), std::streamsize(size));
+            program.serialize(file, functions, mWithComments);
+            file.close();
+            if (!file) {
+                throw Exception(std::format("Cannot write '{}'", temporaryPath.string()));
+            }
+        } catch (const Exception&) {
+            file.close();
+            std::error_code error;
+            std::filesystem::remove(temporaryPath, error);
+            throw;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::filesystem::remove(temporaryPath, error);
+        throw Exception(std::format("Cannot store '{}'", path.string()));
+    }
+}
+
+std::filesystem::path ProgramCache::makePath(uint64_t fingerprint) const {
+    return mDirectory / std::format("{:016x}.program", fingerprint);
+}
+
+SIXPACK_NAMESPACE_END
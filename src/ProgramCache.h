@@ -0,0 +1,58 @@
+#pragma once
+#include "Common.h"
+#include <filesystem>
+#include <optional>
+
+SIXPACK_NAMESPACE_BEGIN
+
+class Compiler;
+class FunctionRegistry;
+class Program;
+
+/// A directory of the serialized programs, keyed by the fingerprints of the compilers.
+///
+/// The compilation is skipped for the compilers equivalent to those of the cached programs, i.e. with the
+/// same scripts, parameters, function names and options. The directory can be shared by several processes.
+///
+/// Each entry starts with the input of the fingerprint (`Compiler::fingerprintInput`), compared on loading,
+/// i.e. the colliding fingerprints are not mistaken for the same compiler.
+class ProgramCache {
+    const std::filesystem::path mDirectory;
+    const bool                  mWithComments;
+
+public:
+    /// Opens the cache directory, creating it if needed.
+    ///
+    /// \throws Exception if the directory cannot be created.
+    explicit ProgramCache(std::filesystem::path directory, bool withComments = false);
+
+    const std::filesystem::path& directory() const { return mDirectory; }
+
+    /// Loads the program compiled previously from the equivalent compiler, or compiles and stores it.
+    ///
+    /// Note: The cache is best-effort, i.e. the invalid (e.g. outdated) entries are compiled again and the
+    ///       failures to store the program are ignored.
+    ///
+    /// \throws CompileException if the program cannot be compiled.
+    Program compile(const Compiler& compiler) const;
+
+    /// Loads the cached program of the given fingerprint and its input.
+    ///
+    /// \returns The program, or nothing if not cached (or not valid, or cached for another input).
+    std::optional<Program> load(uint64_t                fingerprint,
+                                StringView              fingerprintInput,
+                                const FunctionRegistry& functions) const;
+
+    /// Stores the program under the given fingerprint and its input, replacing any previous one atomically.
+    ///
+    /// \throws Exception if the program cannot be stored.
+    void store(uint64_t                fingerprint,
+               StringView              fingerprintInput,
+               const Program&          program,
+               const FunctionRegistry& functions) const;
+
+private:
+    std::filesystem::path makePath(uint64_t fingerprint) const;
+};
+
+SIXPACK_NAMESPACE_END
@@ -0,0 +1,122 @@
+#include "ProgramHandle.h"
+#include <algorithm>
+#include <utility>
+
+SIXPACK_NAMESPACE_BEGIN
+
+// Note: All the epoch and pointer operations are sequentially consistent. A reader announces its epoch before
+//       loading the current version, and a writer replaces the version before advancing the epoch and
+//       scanning the slots; hence a reader is either seen by the scan, or it loads the new version.
+
+ProgramHandle::Snapshot::~Snapshot() {
+    mSlot->epoch.store(IDLE);
+    mSlot->used.store(false, std::memory_order_release);
+}
+
+ProgramHandle::ProgramHandle(Program program)
+    : mCurrent(new Version{ .program = std::move(program), .number = 1 })
+    , mVersionNumber(1) {}
+
+ProgramHandle::~ProgramHandle() {
+    {
+        std::lock_guard lock(mCompileMutex);
+        mStopping = true;
+        mCompileRequests.clear();
+    }
+    mCompileCondition.notify_all();
+    if (mCompileThread.joinable()) {
+        mCompileThread.join();
+    }
+    delete mCurrent.load();
+    for (Slot* slot = mSlots.load(); slot;) {
+        assert(!slot->used);
+        delete std::exchange(slot, slot->next);
+    }
+}
+
+ProgramHandle::Snapshot ProgramHandle::acquire() {
+    Slot& slot = acquireSlot();
+    slot.epoch.store(mEpoch.load());
+    return Snapshot(slot, *mCurrent.load());
+}
+
+uint64_t ProgramHandle::publish(Program program) {
+    std::lock_guard lock(mPublishMutex);
+    const uint64_t  number = mVersionNumber.load(std::memory_order_relaxed) + 1;
+    const Version*  retired =
+        mCurrent.exchange(new Version{ .program = std::move(program), .number = number });
+    mVersionNumber.store(number, std::memory_order_release);
+    // Note: The retired version could be acquired only in the epochs up to the current one.
+    mRetired.push_back({ .version = std::unique_ptr<const Version>(retired), .epoch = mEpoch.fetch_add(1) });
+    reclaimLocked();
+    return number;
+}
+
+std::future<uint64_t> ProgramHandle::recompile(std::function<Program()> compile) {
+    std::future<uint64_t> published;
+    {
+        std::lock_guard lock(mCompileMutex);
+        mCompileRequests.push_back({ .compile = std::move(compile), .published = {} });
+        published = mCompileRequests.back().published.get_future();
+        if (!mCompileThread.joinable()) {
+            mCompileThread = std::thread(&ProgramHandle::compileLoop, this);
+        }
+    }
+    mCompileCondition.notify_one();
+    return published;
+}
+
+void ProgramHandle::reclaim() {
+    std::lock_guard lock(mPublishMutex);
+    reclaimLocked();
+}
+
+ProgramHandle::Slot& ProgramHandle::acquireSlot() {
+    Slot* head = mSlots.load(std::memory_order_acquire);
+    for (Slot* slot = head; slot; slot = slot->next) {
+        bool used = false;
+        if (!slot->used.load(std::memory_order_relaxed) &&
+            slot->used.compare_exchange_strong(used, true, std::memory_order_acquire)) {
+            return *slot;
+        }
+    }
+    // Note: The slots are only ever prepended, so the new one is published by a single exchange.
+    Slot* slot = new Slot;
+    slot->used.store(true, std::memory_order_relaxed);
+    slot->next = head;
+    while (!mSlots.compare_exchange_weak(slot->next, slot, std::memory_order_acq_rel)) {
+    }
+    return *slot;
+}
+
+void ProgramHandle::reclaimLocked() {
+    uint64_t oldestEpoch = IDLE;
+    for (Slot* slot = mSlots.load(); slot; slot = slot->next) {
+        oldestEpoch = std::min(oldestEpoch, slot->epoch.load());
+    }
+    std::erase_if(mRetired, [&](const Retired& retired) {
+        return retired.epoch < oldestEpoch;
+    });
+}
+
+void ProgramHandle::compileLoop() {
+    for (;;) {
+        CompileRequest request;
+        {
+            std::unique_lock lock(mCompileMutex);
+            mCompileCondition.wait(lock, [&] { return mStopping || !mCompileRequests.empty(); });
+            if (mStopping) {
+                return;
+            }
+            request = std::move(mCompileRequests.front());
+            mCompileRequests.pop_front();
+        }
+        try {
+            request.published.set_value(publish(request.compile()));
+        } catch (...) {
+            request.published.set_exception(std::current_exception());
+        }
+    }
+}
+
+SIXPACK_NAMESPACE_END
@@ -0,0 +1,128 @@
+#pragma once
+#include "Common.h"
+#include "Program.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+SIXPACK_NAMESPACE_BEGIN
+
+/// A replaceable program shared by concurrent evaluations.
+///
+/// A new version of the program is published atomically, while the readers go on with the version they
+/// hold. The replaced versions are retired and destroyed once no reader holds them (RCU-style): each reader
+/// announces the epoch it has entered in its own slot, and a retired version is destroyed when all the active
+/// readers have entered a later epoch.
+///
+/// The readers are expected to check `version()` (a single atomic load) at their batch boundaries and to
+/// take a snapshot only when it has changed, e.g. to make a new executable.
+class ProgramHandle {
+    struct Version {
+        Program  program;
+        uint64_t number;
+    };
+
+    struct Slot {
+        std::atomic<uint64_t> epoch = IDLE; // the epoch entered by the reader (or `IDLE`)
+        std::atomic<bool>     used  = false;
+        Slot*                 next  = nullptr;
+    };
+
+    struct Retired {
+        std::unique_ptr<const Version> version;
+        uint64_t                       epoch; // the last epoch in which the version could be acquired
+    };
+
+    struct CompileRequest {
+        std::function<Program()> compile;
+        std::promise<uint64_t>   published;
+    };
+
+    static constexpr uint64_t IDLE = ~uint64_t(0);
+
+    std::atomic<const Version*> mCurrent;
+    std::atomic<uint64_t>       mVersionNumber;
+    std::atomic<uint64_t>       mEpoch = 1;
+    std::atomic<Slot*>          mSlots = nullptr; // never removed until the handle is destroyed
+
+    std::mutex           mPublishMutex; // serializes the writers
+    std::vector<Retired> mRetired;
+
+    std::mutex                 mCompileMutex;
+    std::condition_variable    mCompileCondition;
+    std::deque<CompileRequest> mCompileRequests;
+    bool                       mStopping = false;
+    std::thread                mCompileThread; // started by the first `recompile`
+
+public:
+    /// A pinned version of the program, i.e. a read-side critical section.
+    ///
+    /// Note: The retired versions cannot be destroyed while any snapshot is alive; hold it only for as long
+    ///       as the program itself is needed (the executables do not reference the program).
+    class Snapshot {
+        Slot*          mSlot;
+        const Version* mVersion;
+
+        Snapshot(Slot& slot, const Version& version)
+            : mSlot(&slot)
+            , mVersion(&version) {}
+
+        friend class ProgramHandle;
+
+    public:
+        ~Snapshot();
+
+        Snapshot(const Snapshot&)            = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+
+        const Program& program() const { return mVersion->program; }
+        const Program& operator*() const { return mVersion->program; }
+        const Program* operator->() const { return &mVersion->program; }
+
+        uint64_t version() const { return mVersion->number; }
+    };
+
+    /// Publishes the initial program as the version 1.
+    explicit ProgramHandle(Program program);
+
+    /// Note: Must not be destroyed while any snapshot is alive; the pending recompilations are abandoned.
+    ~ProgramHandle();
+
+    ProgramHandle(const ProgramHandle&)            = delete;
+    ProgramHandle& operator=(const ProgramHandle&) = delete;
+
+    /// Returns the number of the current version (without locking).
+    uint64_t version() const { return mVersionNumber.load(std::memory_order_acquire); }
+
+    /// Pins and returns the current version of the program (without locking).
+    Snapshot acquire();
+
+    /// Publishes the new version of the program and retires the previous one.
+    ///
+    /// \returns The number of the new version.
+    uint64_t publish(Program program);
+
+    /// Compiles the new version of the program on the background thread and publishes it. The requests are
+    /// processed one at a time, in the order of submission.
+    ///
+    /// \returns The future number of the new version (or the exception thrown by the compilation, in which
+    ///          case the current version is kept).
+    std::future<uint64_t> recompile(std::function<Program()> compile);
+
+    /// Destroys the retired versions no longer held by any reader. Called by `publish`, i.e. needed only to
+    /// release the memory sooner.
+    void reclaim();
+
+private:
+    Slot& acquireSlot();
+    void  reclaimLocked();
+    void  compileLoop();
+};
+
+SIXPACK_NAMESPACE_END
@@ -0,0 +1,626 @@
+#include "ProgramImage.h"
+#include "Exception.h"
+#include "FastMath.h"
+#include "FunctionRegistry.h"
+#include "FunctionTable.h"
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <type_traits>
+
+SIXPACK_NAMESPACE_BEGIN
+
+namespace {
+
+    static size_t alignUp(size_t size) {
+        return (size + ProgramImage::ALIGNMENT - 1) / ProgramImage::ALIGNMENT * ProgramImage::ALIGNMENT;
+    }
+
+    /// The offsets of the sections of the image, from its start.
+    struct Layout {
+        size_t symbols;
+        size_t tables;
+        size_t constants;
+        size_t instructions;
+        size_t coefficients;
+
+        explicit Layout(const ProgramImage::Header& header) {
+            using Image = ProgramImage;
+
+            const size_t symbolCount = size_t(header.inputCount) + header.outputCount + header.functionCount;
+            symbols      = sizeof(Image::Header);
+            tables       = alignUp(symbols + symbolCount * sizeof(Image::SymbolDescriptor));
+            constants    = alignUp(tables + header.tableCount * sizeof(Image::TableDescriptor));
+            instructions = alignUp(constants + header.constantCount * sizeof(Real));
+            coefficients = alignUp(instructions + header.instructionCount * sizeof(Image::Instruction));
+        }
+    };
+
+    /// Applies the scalar function on each lane of the words.
+    template <typename TWord, typename TFunction, typename... TWords>
+    FORCEINLINE inline TWord lanewise(TFunction function, const TWords... arguments) {
+        if constexpr (std::is_same_v<TWord, Program::Scalar>) {
+            return function(arguments...);
+        } else {
+            TWord result; // prevents aliasing
+            for (int i = 0; i < TWord::SIZE; ++i) {
+                result[i] = function(arguments[i]...);
+            }
+            return result;
+        }
+    }
+
+    template <typename TWord>
+    FORCEINLINE inline TWord callBatch(BatchFunction function, const TWord argument) {
+        TWord result; // prevents aliasing
+        if constexpr (std::is_same_v<TWord, Program::Scalar>) {
+            function(&argument, &result, 1);
+        } else {
+            function(argument.data(), result.data(), TWord::SIZE);
+        }
+        return result;
+    }
+
+    template <MathAccuracy TAccuracy, typename TWord>
+    FORCEINLINE inline void sincos(const TWord argument, TWord& sine, TWord& cosine) {
+        if constexpr (std::is_same_v<TWord, Program::Scalar>) {
+            fastmath::sincos<TAccuracy>(argument, sine, cosine);
+        } else {
+            for (int i = 0; i < TWord::SIZE; ++i) {
+                fastmath::sincos<TAccuracy>(argument[i], sine[i], cosine[i]);
+            }
+        }
+    }
+
+    template <MathAccuracy TAccuracy, typename TWord>
+    static void execute(const ProgramImage::Instruction*                         instructions,
+                        uint32_t                                                 instructionCount,
+                        ProgramImage::Address                                    instructionAddress,
+                        const std::vector<RealFunction>&                         functions,
+                        const std::vector<BatchFunction>&                        batchFunctions,
+                        const std::vector<BinaryRealFunction>&                   binaryFunctions,
+                        const std::vector<std::unique_ptr<const FunctionTable>>& tables,
+                        TWord* const                                             memory) {
+        using Opcode = ProgramImage::Opcode;
+
+        TWord* const output = memory + instructionAddress;
+        for (uint32_t i = 0; i < instructionCount; ++i) {
+            const ProgramImage::Instruction& instruction = instructions[i];
+            const TWord                      argument    = memory[instruction.operand];
+            switch (instruction.opcode) {
+            case Opcode::NOP:
+                break;
+            case Opcode::ADD:
+                output[i] = memory[instruction.source] + argument;
+                break;
+            case Opcode::ADD_IMM:
+                output[i] = TWord(instruction.immediate) + argument;
+                break;
+            case Opcode::SUBTRACT:
+                output[i] = memory[instruction.source] - argument;
+                break;
+            case Opcode::SUBTRACT_IMM:
+                output[i] = TWord(instruction.immediate) - argument;
+                break;
+            case Opcode::MULTIPLY:
+                output[i] = memory[instruction.source] * argument;
+                break;
+            case Opcode::MULTIPLY_IMM:
+                output[i] = TWord(instruction.immediate) * argument;
+                break;
+            case Opcode::DIVIDE:
+                output[i] = memory[instruction.source] / argument;
+                break;
+            case Opcode::DIVIDE_IMM:
+                output[i] = TWord(instruction.immediate) / argument;
+                break;
+            case Opcode::POWER:
+                output[i] = lanewise<TWord>(fastmath::pow<TAccuracy>, memory[instruction.source], argument);
+                break;
+            case Opcode::CALL:
+                output[i] = lanewise<TWord>(functions[instruction.function], argument);
+                break;
+            case Opcode::CALL_BATCH:
+                output[i] = callBatch(batchFunctions[instruction.function], argument);
+                break;
+            case Opcode::CALL_BINARY:
+                output[i] = lanewise<TWord>(binaryFunctions[instruction.binaryCall.function],
+                                            memory[instruction.binaryCall.source],
+                                            argument);
+                break;
+            case Opcode::CMP_LT:
+                output[i] = lanewise<TWord>([](Real x, Real y) { return x < y ? 1.0 : 0.0; },
+                                            memory[instruction.source],
+                                            argument);
+                break;
+            case Opcode::CMP_LE:
+                output[i] = lanewise<TWord>([](Real x, Real y) { return x <= y ? 1.0 : 0.0; },
+                                            memory[instruction.source],
+                                            argument);
+                break;
+            case Opcode::CMP_EQ:
+                output[i] = lanewise<TWord>([](Real x, Real y) { return x == y ? 1.0 : 0.0; },
+                                            memory[instruction.source],
+                                            argument);
+                break;
+            case Opcode::CMP_NE:
+                output[i] = lanewise<TWord>([](Real x, Real y) { return x != y ? 1.0 : 0.0; },
+                                            memory[instruction.source],
+                                            argument);
+                break;
+            case Opcode::SELECT:
+                // Note: Both arms are already computed, the selection is a conditional move.
+                output[i] = lanewise<TWord>([](Real condition, Real x, Real y) { return condition ? x : y; },
+                                            argument,
+                                            memory[instruction.select.whenTrue],
+                                            memory[instruction.select.whenFalse]);
+                break;
+            case Opcode::SIN:
+                output[i] = lanewise<TWord>(fastmath::sin<TAccuracy>, argument);
+                break;
+            case Opcode::COS:
+                output[i] = lanewise<TWord>(fastmath::cos<TAccuracy>, argument);
+                break;
+            case Opcode::SINCOS: {
+                TWord sine, cosine; // prevents aliasing
+                sincos<TAccuracy>(argument, sine, cosine);
+                output[i]                      = sine;
+                output[i + instruction.target] = cosine;
+                break;
+            }
+            case Opcode::EXP:
+                output[i] = lanewise<TWord>(fastmath::exp<TAccuracy>, argument);
+                break;
+            case Opcode::LOG:
+                output[i] = lanewise<TWord>(fastmath::log<TAccuracy>, argument);
+                break;
+            case Opcode::ATAN2:
+                output[i] = lanewise<TWord>(fastmath::atan2<TAccuracy>, memory[instruction.source], argument);
+                break;
+            case Opcode::HYPOT:
+                output[i] = lanewise<TWord>(fastmath::hypot<TAccuracy>, memory[instruction.source], argument);
+                break;
+            case Opcode::MIN:
+                output[i] = lanewise<TWord>(fastmath::fmin, memory[instruction.source], argument);
+                break;
+            case Opcode::MAX:
+                output[i] = lanewise<TWord>(fastmath::fmax, memory[instruction.source], argument);
+                break;
+            case Opcode::FMOD:
+                output[i] = lanewise<TWord>(
+                    [](Real x, Real y) { return std::fmod(x, y); }, memory[instruction.source], argument);
+                break;
+            case Opcode::COPYSIGN:
+                output[i] = lanewise<TWord>(
+                    [](Real x, Real y) { return std::copysign(x, y); }, memory[instruction.source], argument);
+                break;
+            case Opcode::TABLE_LOOKUP: {
+                const FunctionTable& table = *tables[instruction.function];
+                output[i] = lanewise<TWord>([&](Real x) { return table.evaluate(x); }, argument);
+                break;
+            }
+            default:
+                assert(false);
+            }
+        }
+    }
+
+} // anonymous namespace
+
+ProgramImage::ProgramImage(std::span<const std::byte> buffer, const FunctionRegistry& functions)
+    : mData(buffer.data())
+    , mSize(buffer.size()) {
+    validate();
+    link(functions);
+}
+
+size_t ProgramImage::computeSize(const Program& program) {
+    Header header{};
+    header.inputCount       = uint32_t(program.inputs().size());
+    header.outputCount      = uint32_t(program.outputs().size());
+    header.tableCount       = uint32_t(program.tables().size());
+    header.constantCount    = uint32_t(program.constants().values.size());
+    header.instructionCount = uint32_t(program.instructions().instructions.size());
+    // Note: The functions are counted by their uses, i.e. at most once per instruction.
+    for (const Program::Instruction& instruction : program.instructions().instructions) {
+        if (instruction.opcode == Opcode::CALL || instruction.opcode == Opcode::CALL_BATCH) {
+            ++header.functionCount;
+        }
+    }
+    header.functionCount += uint32_t(program.binaryFunctions().size() + program.tables().size());
+
+    size_t coefficientsSize = 0;
+    for (const auto& table : program.tables()) {
+        coefficientsSize += alignUp(table->coefficients().size_bytes());
+    }
+    return Layout(header).coefficients + coefficientsSize;
+}
+
+ProgramImage ProgramImage::format(std::span<std::byte>    buffer,
+                                  const Program&          program,
+                                  const FunctionRegistry& functions) {
+    if (reinterpret_cast<uintptr_t>(buffer.data()) % ALIGNMENT != 0) {
+        throw Exception("The image buffer is not aligned");
+    }
+    if (buffer.size() < computeSize(program)) {
+        throw Exception(std::format(
+            "The image buffer is too small ({} bytes, {} needed)", buffer.size(), computeSize(program)));
+    }
+    const Program::Instructions& programInstructions = program.instructions();
+    if (uint64_t(programInstructions.memoryOffset) + programInstructions.instructions.size() > UINT32_MAX) {
+        throw Exception("The program is too large for an image");
+    }
+
+    // The symbols (i.e. the names of the variables and the functions)
+    std::vector<SymbolDescriptor> symbols;
+    const auto                    addSymbol = [&](StringView name, uint32_t value) {
+        if (name.empty() || name.size() > MAX_NAME_LENGTH) {
+            throw Exception(std::format("Invalid name '{}' for an image", name));
+        }
+        SymbolDescriptor& symbol = symbols.emplace_back();
+        std::copy_n(name.data(), name.size(), symbol.name);
+        symbol.value = value;
+        return uint32_t(symbols.size() - 1);
+    };
+    for (const auto& [name, address] : program.inputs()) {
+        addSymbol(name, address);
+    }
+    for (const auto& [name, address] : program.outputs()) {
+        addSymbol(name, address);
+    }
+    const uint32_t firstFunction = uint32_t(symbols.size());
+    const auto     addFunction   = [&](StringView name, FunctionKind kind) {
+        if (name.empty()) {
+            throw Exception("Cannot make an image of a program calling an unregistered function");
+        }
+        for (uint32_t i = firstFunction; i < symbols.size(); ++i) {
+            if (symbols[i].name == name && symbols[i].value == uint32_t(kind)) {
+                return i - firstFunction;
+            }
+        }
+        return addSymbol(name, uint32_t(kind)) - firstFunction;
+    };
+
+    std::vector<Instruction> instructions;
+    for (const Program::Instruction& programInstruction : programInstructions.instructions) {
+        Instruction& instruction = instructions.emplace_back();
+        instruction.opcode       = programInstruction.opcode;
+        instruction.operand      = programInstruction.operand;
+        instruction.target       = 0;
+        switch (programInstruction.opcode) {
+        case Opcode::CALL:
+            instruction.function =
+                addFunction(functions.nameOf(programInstruction.function), FunctionKind::UNARY);
+            break;
+        case Opcode::CALL_BATCH:
+            instruction.function =
+                addFunction(functions.nameOf(programInstruction.batchFunction), FunctionKind::BATCH);
+            break;
+        case Opcode::CALL_BINARY: {
+            const BinaryRealFunction function =
+                program.binaryFunctions()[programInstruction.binaryCall.function];
+            instruction.binaryCall.source   = programInstruction.binaryCall.source;
+            instruction.binaryCall.function = addFunction(functions.nameOf(function), FunctionKind::BINARY);
+            break;
+        }
+        case Opcode::TABLE_LOOKUP: {
+            const Program::Tables& programTables = program.tables();
+            const auto             tableIt =
+                std::find_if(programTables.begin(), programTables.end(), [&](const auto& table) {
+                    return table.get() == programInstruction.table;
+                });
+            assert(tableIt != program.tables().end());
+            instruction.function = uint32_t(tableIt - program.tables().begin());
+            break;
+        }
+        case Opcode::SINCOS:
+            instruction.target = int64_t(programInstruction.target);
+            break;
+        default:
+            // Note: The remaining operands are not pointers, i.e. are copied as they are.
+            std::memcpy(&instruction.immediate, &programInstruction.immediate, sizeof(Real));
+            break;
+        }
+    }
+    std::vector<TableDescriptor> tables;
+    for (const auto& table : program.tables()) {
+        const uint32_t function = addFunction(functions.nameOf(table->function()), FunctionKind::UNARY);
+        tables.push_back({ .function     = function,
+                           .segmentCount = uint32_t(table->segmentCount()),
+                           .domain       = table->domain(),
+                           .offset       = 0 });
+    }
+
+    Header& header = *reinterpret_cast<Header*>(buffer.data());
+    header         = {};
+    std::copy_n(MAGIC, sizeof(MAGIC), header.magic);
+    header.version            = VERSION;
+    header.byteOrderMark      = BYTE_ORDER_MARK;
+    header.mathAccuracy       = uint32_t(program.mathAccuracy());
+    header.memorySize         = uint32_t(programInstructions.memoryOffset + instructions.size());
+    header.inputCount         = uint32_t(program.inputs().size());
+    header.outputCount        = uint32_t(program.outputs().size());
+    header.functionCount      = uint32_t(symbols.size() - firstFunction);
+    header.tableCount         = uint32_t(tables.size());
+    header.constantAddress    = program.constants().memoryOffset;
+    header.constantCount      = uint32_t(program.constants().values.size());
+    header.instructionAddress = programInstructions.memoryOffset;
+    header.instructionCount   = uint32_t(instructions.size());
+
+    const Layout layout(header);
+    size_t       offset = layout.coefficients;
+    for (size_t i = 0; i < tables.size(); ++i) {
+        const std::span<const Real> coefficients = program.tables()[i]->coefficients();
+        tables[i].offset                         = offset;
+        std::copy(coefficients.begin(), coefficients.end(), reinterpret_cast<Real*>(buffer.data() + offset));
+        offset += alignUp(coefficients.size_bytes());
+    }
+    header.size = offset;
+
+    const std::vector<Real>& constants = program.constants().values;
+    std::byte* const         data      = buffer.data();
+    std::copy(symbols.begin(), symbols.end(), reinterpret_cast<SymbolDescriptor*>(data + layout.symbols));
+    std::copy(tables.begin(), tables.end(), reinterpret_cast<TableDescriptor*>(data + layout.tables));
+    std::copy(constants.begin(), constants.end(), reinterpret_cast<Real*>(data + layout.constants));
+    std::copy(
+        instructions.begin(), instructions.end(), reinterpret_cast<Instruction*>(data + layout.instructions));
+    return ProgramImage(buffer.first(offset), functions);
+}
+
+std::vector<StringView> ProgramImage::getInputs() const {
+    std::vector<StringView> inputs;
+    for (uint32_t i = 0; i < header().inputCount; ++i) {
+        inputs.emplace_back(symbols()[i].name);
+    }
+    return inputs;
+}
+
+std::vector<StringView> ProgramImage::getOutputs() const {
+    std::vector<StringView> outputs;
+    for (uint32_t i = 0; i < header().outputCount; ++i) {
+        outputs.emplace_back(symbols()[header().inputCount + i].name);
+    }
+    return outputs;
+}
+
+ProgramImage::Address ProgramImage::getInputAddress(StringView name) const {
+    for (uint32_t i = 0; i < header().inputCount; ++i) {
+        if (symbols()[i].name == name) {
+            return symbols()[i].value;
+        }
+    }
+    throw Exception(std::format("Unknown input '{}'", name));
+}
+
+ProgramImage::Address ProgramImage::getOutputAddress(StringView name) const {
+    for (uint32_t i = header().inputCount; i < header().inputCount + header().outputCount; ++i) {
+        if (symbols()[i].name == name) {
+            return symbols()[i].value;
+        }
+    }
+    throw Exception(std::format("Unknown output '{}'", name));
+}
+
+ImageExecutable<Program::Scalar> ProgramImage::makeScalarExecutable() const {
+    return ImageExecutable<Program::Scalar>(*this);
+}
+
+ImageExecutable<Program::Vector> ProgramImage::makeVectorExecutable() const {
+    return ImageExecutable<Program::Vector>(*this);
+}
+
+const ProgramImage::SymbolDescriptor* ProgramImage::symbols() const {
+    return reinterpret_cast<const SymbolDescriptor*>(mData + Layout(header()).symbols);
+}
+
+const ProgramImage::TableDescriptor* ProgramImage::tables() const {
+    return reinterpret_cast<const TableDescriptor*>(mData + Layout(header()).tables);
+}
+
+const Real* ProgramImage::constants() const {
+    return reinterpret_cast<const Real*>(mData + Layout(header()).constants);
+}
+
+const ProgramImage::Instruction* ProgramImage::instructions() const {
+    return reinterpret_cast<const Instruction*>(mData + Layout(header()).instructions);
+}
+
+// Note: The image is checked entirely so that its executables are safe to run, whatever the buffer holds.
+void ProgramImage::validate() const {
+    if (mSize < sizeof(Header) || std::memcmp(header().magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw Exception("Not a program image");
+    }
+    if (header().version != VERSION || header().byteOrderMark != BYTE_ORDER_MARK) {
+        throw Exception(std::format("Unsupported program image (version {}, byte order {:#x})",
+                                    header().version,
+                                    header().byteOrderMark));
+    }
+    if (reinterpret_cast<uintptr_t>(mData) % ALIGNMENT != 0) {
+        throw Exception("The program image is not aligned");
+    }
+    const Header& image = header();
+    const Layout  layout(image);
+    if (image.size > mSize || layout.coefficients > image.size) {
+        throw Exception("The program image is truncated");
+    }
+    const auto fail = [](StringView what) { throw Exception(std::format("The program image has {}", what)); };
+    if (image.mathAccuracy > uint32_t(MathAccuracy::REL_1E3)) {
+        fail("an invalid math accuracy");
+    }
+    if (uint64_t(image.instructionAddress) + image.instructionCount != image.memorySize ||
+        (image.constantCount > 0 && (image.constantAddress == Program::SCRATCHPAD_ADDRESS ||
+                                     uint64_t(image.constantAddress) + image.constantCount >
+                                         image.instructionAddress))) {
+        fail("an invalid memory layout");
+    }
+    const uint32_t symbolCount = image.inputCount + image.outputCount + image.functionCount;
+    for (uint32_t i = 0; i < symbolCount; ++i) {
+        const SymbolDescriptor& symbol = symbols()[i];
+        if (std::memchr(symbol.name, 0, sizeof(symbol.name)) == nullptr) {
+            fail("a corrupted symbol");
+        }
+        if (i < image.inputCount && symbol.value >= image.instructionAddress) {
+            fail(std::format("an invalid address of the input '{}'", symbol.name));
+        }
+        if (i >= image.inputCount && i < image.inputCount + image.outputCount &&
+            (symbol.value == Program::SCRATCHPAD_ADDRESS || symbol.value >= image.memorySize)) {
+            fail(std::format("an invalid address of the output '{}'", symbol.name));
+        }
+        if (i >= image.inputCount + image.outputCount && symbol.value > uint32_t(FunctionKind::BINARY)) {
+            fail(std::format("an invalid kind of the function '{}'", symbol.name));
+        }
+    }
+    const auto checkFunction = [&](uint32_t function, FunctionKind kind) {
+        if (function >= image.functionCount ||
+            symbols()[image.inputCount + image.outputCount + function].value != uint32_t(kind)) {
+            fail("an invalid function reference");
+        }
+    };
+    for (uint32_t i = 0; i < image.tableCount; ++i) {
+        const TableDescriptor& table = tables()[i];
+        checkFunction(table.function, FunctionKind::UNARY);
+        const uint64_t segmentCapacity = (image.size - std::min(table.offset, image.size)) / sizeof(Real) / 4;
+        if (table.offset % ALIGNMENT != 0 || table.offset < layout.coefficients ||
+            segmentCapacity < table.segmentCount) {
+            fail("a table out of the image");
+        }
+    }
+    const auto checkAddress = [&](Address address) {
+        if (address >= image.memorySize) {
+            fail(std::format("an address out of the memory ({})", address));
+        }
+    };
+    for (uint32_t i = 0; i < image.instructionCount; ++i) {
+        const Instruction& instruction = instructions()[i];
+        checkAddress(instruction.operand);
+        switch (instruction.opcode) {
+        case Opcode::NOP:
+        case Opcode::ADD_IMM:
+        case Opcode::SUBTRACT_IMM:
+        case Opcode::MULTIPLY_IMM:
+        case Opcode::DIVIDE_IMM:
+        case Opcode::SIN:
+        case Opcode::COS:
+        case Opcode::EXP:
+        case Opcode::LOG:
+            break;
+        case Opcode::ADD:
+        case Opcode::SUBTRACT:
+        case Opcode::MULTIPLY:
+        case Opcode::DIVIDE:
+        case Opcode::POWER:
+        case Opcode::CMP_LT:
+        case Opcode::CMP_LE:
+        case Opcode::CMP_EQ:
+        case Opcode::CMP_NE:
+        case Opcode::ATAN2:
+        case Opcode::HYPOT:
+        case Opcode::MIN:
+        case Opcode::MAX:
+        case Opcode::FMOD:
+        case Opcode::COPYSIGN:
+            checkAddress(instruction.source);
+            break;
+        case Opcode::CALL:
+            checkFunction(instruction.function, FunctionKind::UNARY);
+            break;
+        case Opcode::CALL_BATCH:
+            checkFunction(instruction.function, FunctionKind::BATCH);
+            break;
+        case Opcode::CALL_BINARY:
+            checkAddress(instruction.binaryCall.source);
+            checkFunction(instruction.binaryCall.function, FunctionKind::BINARY);
+            break;
+        case Opcode::SELECT:
+            checkAddress(instruction.select.whenTrue);
+            checkAddress(instruction.select.whenFalse);
+            break;
+        case Opcode::SINCOS:
+            if (instruction.target < -int64_t(i) ||
+                instruction.target >= int64_t(image.instructionCount) - int64_t(i)) {
+                fail("an invalid target of SINCOS");
+            }
+            break;
+        case Opcode::TABLE_LOOKUP:
+            if (instruction.function >= image.tableCount) {
+                fail("an invalid table reference");
+            }
+            break;
+        default:
+            fail(std::format("an invalid opcode {}", int(instruction.opcode)));
+        }
+    }
+}
+
+void ProgramImage::link(const FunctionRegistry& functions) {
+    auto linkage = std::make_shared<Linkage>();
+    for (uint32_t i = 0; i < header().functionCount; ++i) {
+        const SymbolDescriptor& symbol = symbols()[header().inputCount + header().outputCount + i];
+        bool                    found  = false;
+        // Note: The indices are shared by the kinds, i.e. the functions of the other kinds are left null.
+        linkage->functions.push_back(nullptr);
+        linkage->batchFunctions.push_back(nullptr);
+        linkage->binaryFunctions.push_back(nullptr);
+        switch (FunctionKind(symbol.value)) {
+        case FunctionKind::UNARY:
+            found = (linkage->functions.back() = functions.findFunction(symbol.name)) != nullptr;
+            break;
+        case FunctionKind::BATCH:
+            found = (linkage->batchFunctions.back() = functions.findBatchFunction(symbol.name)) != nullptr;
+            break;
+        case FunctionKind::BINARY:
+            found = (linkage->binaryFunctions.back() = functions.findBinaryFunction(symbol.name)) != nullptr;
+            break;
+        }
+        if (!found) {
+            throw Exception(std::format("Unknown function '{}'", symbol.name));
+        }
+    }
+    for (uint32_t i = 0; i < header().tableCount; ++i) {
+        const TableDescriptor& table = tables()[i];
+        const Real* const      data  = reinterpret_cast<const Real*>(mData + table.offset);
+        const size_t           count = size_t(4) * table.segmentCount; // coefficients per segment
+        linkage->tables.push_back(std::make_unique<const FunctionTable>(
+            linkage->functions[table.function], table.domain, std::span(data, count)));
+    }
+    mLinkage = std::move(linkage);
+}
+
+template <typename TWord>
+void ProgramImage::run(TWord* memory) const {
+    const Linkage& linkage = *mLinkage;
+    const auto     run     = [&]<MathAccuracy TAccuracy>() {
+        execute<TAccuracy>(instructions(),
+                           header().instructionCount,
+                           header().instructionAddress,
+                           linkage.functions,
+                           linkage.batchFunctions,
+                           linkage.binaryFunctions,
+                           linkage.tables,
+                           memory);
+    };
+    switch (mathAccuracy()) {
+    case MathAccuracy::REL_1E6:
+        return run.template operator()<MathAccuracy::REL_1E6>();
+    case MathAccuracy::REL_1E3:
+        return run.template operator()<MathAccuracy::REL_1E3>();
+    default:
+        return run.template operator()<MathAccuracy::ULP_1>();
+    }
+}
+
+template <typename TWord>
+ImageExecutable<TWord>::ImageExecutable(const ProgramImage& image)
+    : mImage(&image)
+    , mMemory(image.header().memorySize, TWord{}) {
+    const ProgramImage::Header& header = image.header();
+    std::copy_n(image.constants(), header.constantCount, mMemory.begin() + header.constantAddress);
+}
+
+template void ProgramImage::run(Program::Scalar* memory) const;
+template void ProgramImage::run(Program::Vector* memory) const;
+
+template class ImageExecutable<Program::Scalar>;
+template class ImageExecutable<Program::Vector>;
+
+SIXPACK_NAMESPACE_END
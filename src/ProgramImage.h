@@ -0,0 +1,184 @@
+#pragma once
+#include "Program.h"
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+SIXPACK_NAMESPACE_BEGIN
+
+class FunctionRegistry;
+class FunctionTable;
+template <typename TWord>
+class ImageExecutable;
+
+/// A position-independent, read-only image of a compiled program, usable in place (e.g. when mapped from a
+/// shared memory segment or a file by several processes).
+///
+/// Unlike `Executable`, the image holds no pointers: the instructions address the memory by offsets and
+/// refer to the functions and the tables by index. The functions are stored by name and resolved within
+/// each process (through a registry); the coefficients of the tables are used in place. The executables of
+/// an image only hold their private memory.
+///
+/// To share the image, one process formats it into a file created in a shared memory file system (e.g.
+/// `/dev/shm` through `MappedFile`), the others map the file read-only and make their views of it.
+///
+///     Header             64 bytes
+///     SymbolDescriptor   64 bytes per input, output and function
+///     TableDescriptor    32 bytes per table
+///     constants          `constantCount` doubles
+///     Instruction        16 bytes per instruction
+///     coefficients       doubles of the tables
+///
+/// Each section is aligned to 64 bytes. All the values are stored in the native byte order; the header
+/// records it by the `BYTE_ORDER_MARK`.
+class ProgramImage {
+public:
+    static constexpr char     MAGIC[8]        = { 'S', 'I', 'X', 'P', 'A', 'C', 'K', 'I' };
+    static constexpr uint32_t VERSION         = 1;
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static constexpr size_t   ALIGNMENT       = 64;
+    static constexpr size_t   MAX_NAME_LENGTH = 47;
+
+    using Address = Program::Address;
+    using Opcode  = Program::Opcode;
+
+    struct Header {
+        char     magic[8];
+        uint32_t version;
+        uint32_t byteOrderMark;
+        uint32_t mathAccuracy;
+        uint32_t memorySize; // words of the memory of the executables
+        uint32_t inputCount;
+        uint32_t outputCount;
+        uint32_t functionCount;
+        uint32_t tableCount;
+        Address  constantAddress;
+        uint32_t constantCount;
+        Address  instructionAddress;
+        uint32_t instructionCount;
+        uint64_t size;
+    };
+    static_assert(sizeof(Header) == ALIGNMENT);
+
+    enum class FunctionKind : uint32_t {
+        UNARY,  ///< `RealFunction`
+        BATCH,  ///< `BatchFunction`
+        BINARY, ///< `BinaryRealFunction`
+    };
+
+    struct SymbolDescriptor {
+        char     name[MAX_NAME_LENGTH + 1]; // zero-terminated
+        uint32_t value;                     // the address of an input or an output, the kind of a function
+        uint8_t  reserved[12];
+    };
+    static_assert(sizeof(SymbolDescriptor) == ALIGNMENT);
+
+    struct TableDescriptor {
+        uint32_t function; // index of the (unary) function
+        uint32_t segmentCount;
+        Interval domain;
+        uint64_t offset; // of the coefficients, from the start of the image
+    };
+    static_assert(sizeof(TableDescriptor) == 32);
+
+    /// The instruction of `Program` with the pointers replaced by indices.
+    struct Instruction {
+        Opcode  opcode;
+        Address operand;
+        union {
+            Address  source;
+            Real     immediate;
+            uint32_t function; // index of the function (`CALL`, `CALL_BATCH`) or the table (`TABLE_LOOKUP`)
+            int64_t  target;
+            struct {
+                Address  source;
+                uint32_t function;
+            } binaryCall;
+            struct {
+                Address whenTrue;
+                Address whenFalse;
+            } select;
+        };
+    };
+    static_assert(sizeof(Instruction) == 16);
+
+private:
+    /// The functions and the tables of the image, resolved within the process.
+    struct Linkage {
+        std::vector<RealFunction>                         functions; // by the index of the function
+        std::vector<BatchFunction>                        batchFunctions;
+        std::vector<BinaryRealFunction>                   binaryFunctions;
+        std::vector<std::unique_ptr<const FunctionTable>> tables;
+    };
+
+    const std::byte*               mData;
+    size_t                         mSize;
+    std::shared_ptr<const Linkage> mLinkage;
+
+public:
+    /// Makes a view of the image and resolves its functions through the registry.
+    ///
+    /// \throws Exception if the buffer does not hold a valid image or if any of the functions is unknown.
+    ProgramImage(std::span<const std::byte> buffer, const FunctionRegistry& functions);
+
+    /// Returns the size of the image of the program (at most), in bytes.
+    static size_t computeSize(const Program& program);
+
+    /// Formats the image of the program into the buffer, which must be aligned to `ALIGNMENT` and at least
+    /// `computeSize` bytes long. The functions are stored by the names found in the registry.
+    ///
+    /// \throws Exception if any of the names is too long or not in the registry, or if the buffer is not
+    ///         suitable.
+    static ProgramImage format(std::span<std::byte>    buffer,
+                               const Program&          program,
+                               const FunctionRegistry& functions);
+
+    size_t       size() const { return mSize; }
+    MathAccuracy mathAccuracy() const { return MathAccuracy(header().mathAccuracy); }
+
+    std::vector<StringView> getInputs() const;
+    std::vector<StringView> getOutputs() const;
+    Address                 getInputAddress(StringView name) const;
+    Address                 getOutputAddress(StringView name) const;
+
+    /// Makes an executable of the image; the image must outlive it.
+    ImageExecutable<Program::Scalar> makeScalarExecutable() const;
+    ImageExecutable<Program::Vector> makeVectorExecutable() const;
+
+private:
+    template <typename TWord>
+    friend class ImageExecutable;
+
+    const Header&           header() const { return *reinterpret_cast<const Header*>(mData); }
+    const SymbolDescriptor* symbols() const;
+    const TableDescriptor*  tables() const;
+    const Real*             constants() const;
+    const Instruction*      instructions() const;
+
+    void validate() const;
+    void link(const FunctionRegistry& functions);
+
+    template <typename TWord>
+    void run(TWord* memory) const;
+};
+
+/// An executable of a program image, i.e. the private memory of the evaluation.
+template <typename TWord>
+class ImageExecutable {
+    const ProgramImage* mImage;
+    std::vector<TWord>  mMemory;
+
+public:
+    explicit ImageExecutable(const ProgramImage& image);
+
+    std::vector<TWord>&       memory() { return mMemory; }
+    const std::vector<TWord>& memory() const { return mMemory; }
+
+    void run() {
+        Metrics::recordRun(sizeof(TWord) / sizeof(Real));
+        mImage->run(mMemory.data());
+    }
+};
+
+SIXPACK_NAMESPACE_END
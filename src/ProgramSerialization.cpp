@@ -0,0 +1,446 @@
+#include "Exception.h"
+#include "FunctionRegistry.h"
+#include "FunctionTable.h"
+#include "Program.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <format>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <type_traits>
+
+SIXPACK_NAMESPACE_BEGIN
+
+// The serialized program is a sequence of the following sections; all the values are stored in the native
+// byte order (recorded by the byte order mark), the counts as 64-bit and the strings prefixed by a count:
+//
+//     header           magic, version, byte order mark, math accuracy
+//     inputs, outputs  (name, address), sorted by name
+//     constants        memory offset, values
+//     functions        names of the functions, the batch functions and the binary functions
+//     tables           (function index, domain, coefficients)
+//     instructions     memory offset, (opcode, operand, payload)
+//     comments         (address, text), sorted by address
+//
+// The payload of an instruction holds either the operands, or an index of the function or the table.
+
+namespace {
+
+    static constexpr char     MAGIC[8]        = { 'S', 'I', 'X', 'P', 'A', 'C', 'K', 'P' };
+    static constexpr uint32_t VERSION         = 1;
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    // Note: Guards the allocations against the corrupted counts.
+    static constexpr uint64_t MAX_COUNT = uint64_t(1) << 32;
+
+    class Writer {
+        std::ostream& mOutput;
+
+    public:
+        explicit Writer(std::ostream& output)
+            : mOutput(output) {}
+
+        template <typename T>
+        void write(const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            mOutput.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        void writeString(StringView text) {
+            write(uint64_t(text.size()));
+            mOutput.write(text.data(), std::streamsize(text.size()));
+        }
+
+        void writeVariables(const Program::Variables& variables) {
+            std::vector<std::pair<StringView, Program::Address>> sorted(variables.begin(), variables.end());
+            std::sort(sorted.begin(), sorted.end());
+            write(uint64_t(sorted.size()));
+            for (const auto& [name, address] : sorted) {
+                writeString(name);
+                write(address);
+            }
+        }
+
+        void writeValues(std::span<const Real> values) {
+            write(uint64_t(values.size()));
+            mOutput.write(reinterpret_cast<const char*>(values.data()),
+                          std::streamsize(values.size() * sizeof(Real)));
+        }
+    };
+
+    class Reader {
+        std::istream& mInput;
+
+    public:
+        explicit Reader(std::istream& input)
+            : mInput(input) {}
+
+        template <typename T>
+        T read() {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T value;
+            readBytes(&value, sizeof(T));
+            return value;
+        }
+
+        uint64_t readCount() {
+            const uint64_t count = read<uint64_t>();
+            if (count > MAX_COUNT) {
+                throw Exception("The serialized program is corrupted");
+            }
+            return count;
+        }
+
+        String readString() {
+            // Note: Read by chunks, i.e. a corrupted count fails at the end of the input (not allocating).
+            static constexpr uint64_t CHUNK_SIZE = 4096;
+            const uint64_t            count      = readCount();
+            String                    text;
+            while (text.size() < count) {
+                const size_t offset = text.size();
+                text.resize(offset + size_t(std::min(count - offset, CHUNK_SIZE)));
+                readBytes(text.data() + offset, text.size() - offset);
+            }
+            return text;
+        }
+
+        Program::Variables readVariables() {
+            Program::Variables variables;
+            for (uint64_t i = readCount(); i > 0; --i) {
+                String name = readString();
+                variables.insert({ std::move(name), read<Program::Address>() });
+            }
+            return variables;
+        }
+
+        std::vector<Real> readValues() {
+            std::vector<Real> values;
+            for (uint64_t i = readCount(); i > 0; --i) {
+                values.push_back(read<Real>());
+            }
+            return values;
+        }
+
+    private:
+        void readBytes(void* data, size_t size) {
+            if (!mInput.read(static_cast<char*>(data), std::streamsize(size))) {
+                throw Exception("The serialized program is truncated");
+            }
+        }
+    };
+
+    /// Assigns the indices to the functions in the order of their first use.
+    template <typename TFunction>
+    class FunctionIndex {
+        std::vector<TFunction> mFunctions;
+
+    public:
+        uint64_t operator()(TFunction function) {
+            const auto functionIt = std::find(mFunctions.begin(), mFunctions.end(), function);
+            if (functionIt != mFunctions.end()) {
+                return uint64_t(functionIt - mFunctions.begin());
+            }
+            mFunctions.push_back(function);
+            return mFunctions.size() - 1;
+        }
+
+        const std::vector<TFunction>& functions() const { return mFunctions; }
+    };
+
+    template <typename TFunction>
+    static void writeFunctionNames(Writer&                       writer,
+                                   const std::vector<TFunction>& functions,
+                                   const FunctionRegistry&       registry) {
+        writer.write(uint64_t(functions.size()));
+        for (const TFunction function : functions) {
+            const StringView name = registry.nameOf(function);
+            if (name.empty()) {
+                throw Exception("Cannot serialize a program calling an unregistered function");
+            }
+            writer.writeString(name);
+        }
+    }
+
+    template <typename TFunction>
+    static std::vector<TFunction> readFunctions(Reader&                 reader,
+                                                const FunctionRegistry& registry,
+                                                TFunction (FunctionRegistry::*find)(StringView) const) {
+        std::vector<TFunction> functions;
+        for (uint64_t i = reader.readCount(); i > 0; --i) {
+            const String    name     = reader.readString();
+            const TFunction function = (registry.*find)(name);
+            if (!function) {
+                throw Exception(std::format("Unknown function '{}'", name));
+            }
+            functions.push_back(function);
+        }
+        return functions;
+    }
+
+    static uint64_t packPair(uint32_t low, uint32_t high) {
+        return uint64_t(low) | (uint64_t(high) << 32);
+    }
+
+} // anonymous namespace
+
+void Program::serialize(std::ostream& output, const FunctionRegistry& functions, bool withComments) const {
+    Writer writer(output);
+    writer.write(MAGIC);
+    writer.write(VERSION);
+    writer.write(BYTE_ORDER_MARK);
+    writer.write(uint32_t(mMathAccuracy));
+    writer.writeVariables(mInputs);
+    writer.writeVariables(mOutputs);
+    writer.write(mConstants.memoryOffset);
+    writer.writeValues(mConstants.values);
+
+    // Note: The function indices are assigned before any of the names is written.
+    FunctionIndex<RealFunction>  functionIndex;
+    FunctionIndex<BatchFunction> batchFunctionIndex;
+    std::vector<uint64_t>        payloads;
+    payloads.reserve(mInstructions.instructions.size());
+    for (const Instruction& instruction : mInstructions.instructions) {
+        switch (instruction.opcode) {
+        case Opcode::ADD:
+        case Opcode::SUBTRACT:
+        case Opcode::MULTIPLY:
+        case Opcode::DIVIDE:
+        case Opcode::POWER:
+        case Opcode::CMP_LT:
+        case Opcode::CMP_LE:
+        case Opcode::CMP_EQ:
+        case Opcode::CMP_NE:
+        case Opcode::ATAN2:
+        case Opcode::HYPOT:
+        case Opcode::MIN:
+        case Opcode::MAX:
+        case Opcode::FMOD:
+        case Opcode::COPYSIGN:
+            payloads.push_back(instruction.source);
+            break;
+        case Opcode::ADD_IMM:
+        case Opcode::SUBTRACT_IMM:
+        case Opcode::MULTIPLY_IMM:
+        case Opcode::DIVIDE_IMM:
+            payloads.push_back(std::bit_cast<uint64_t>(instruction.immediate));
+            break;
+        case Opcode::CALL:
+            payloads.push_back(functionIndex(instruction.function));
+            break;
+        case Opcode::CALL_BATCH:
+            payloads.push_back(batchFunctionIndex(instruction.batchFunction));
+            break;
+        case Opcode::CALL_BINARY:
+            payloads.push_back(packPair(instruction.binaryCall.source, instruction.binaryCall.function));
+            break;
+        case Opcode::SELECT:
+            payloads.push_back(packPair(instruction.select.whenTrue, instruction.select.whenFalse));
+            break;
+        case Opcode::SINCOS:
+            payloads.push_back(std::bit_cast<uint64_t>(int64_t(instruction.target)));
+            break;
+        case Opcode::TABLE_LOOKUP: {
+            const auto tableIt = std::find_if(mTables.begin(), mTables.end(), [&](const auto& table) {
+                return table.get() == instruction.table;
+            });
+            assert(tableIt != mTables.end());
+            payloads.push_back(uint64_t(tableIt - mTables.begin()));
+            break;
+        }
+        default:
+            payloads.push_back(0);
+            break;
+        }
+    }
+    for (const auto& table : mTables) {
+        functionIndex(table->function());
+    }
+    writeFunctionNames(writer, functionIndex.functions(), functions);
+    writeFunctionNames(writer, batchFunctionIndex.functions(), functions);
+    writeFunctionNames(writer, mBinaryFunctions, functions);
+
+    writer.write(uint64_t(mTables.size()));
+    for (const auto& table : mTables) {
+        writer.write(functionIndex(table->function()));
+        writer.write(table->domain());
+        writer.writeValues(table->coefficients());
+    }
+
+    writer.write(mInstructions.memoryOffset);
+    writer.write(uint64_t(mInstructions.instructions.size()));
+    for (size_t i = 0; i < mInstructions.instructions.size(); ++i) {
+        writer.write(mInstructions.instructions[i].opcode);
+        writer.write(mInstructions.instructions[i].operand);
+        writer.write(payloads[i]);
+    }
+
+    std::vector<std::pair<Address, StringView>> comments;
+    if (withComments) {
+        comments.assign(mComments.begin(), mComments.end());
+        std::sort(comments.begin(), comments.end());
+    }
+    writer.write(uint64_t(comments.size()));
+    for (const auto& [address, text] : comments) {
+        writer.write(address);
+        writer.writeString(text);
+    }
+    if (!output) {
+        throw Exception("Cannot write the serialized program");
+    }
+}
+
+Program Program::deserialize(std::istream& input, const FunctionRegistry& functions) {
+    Reader reader(input);
+    const auto magic = reader.read<std::array<char, sizeof(MAGIC)>>();
+    if (!std::equal(magic.begin(), magic.end(), MAGIC)) {
+        throw Exception("Not a serialized program");
+    }
+    const uint32_t version       = reader.read<uint32_t>();
+    const uint32_t byteOrderMark = reader.read<uint32_t>();
+    if (version != VERSION || byteOrderMark != BYTE_ORDER_MARK) {
+        throw Exception(std::format("Unsupported serialized program (version {}, byte order {:#x})",
+                                    version,
+                                    byteOrderMark));
+    }
+    const uint32_t mathAccuracy = reader.read<uint32_t>();
+    if (mathAccuracy > uint32_t(MathAccuracy::REL_1E3)) {
+        throw Exception("The serialized program is corrupted");
+    }
+    Variables inputs  = reader.readVariables();
+    Variables outputs = reader.readVariables();
+    Constants constants;
+    constants.memoryOffset = reader.read<Address>();
+    constants.values       = reader.readValues();
+
+    const std::vector<RealFunction> realFunctions =
+        readFunctions(reader, functions, &FunctionRegistry::findFunction);
+    const std::vector<BatchFunction> batchFunctions =
+        readFunctions(reader, functions, &FunctionRegistry::findBatchFunction);
+    BinaryFunctions binaryFunctions = readFunctions(reader, functions, &FunctionRegistry::findBinaryFunction);
+
+    Tables tables;
+    for (uint64_t i = reader.readCount(); i > 0; --i) {
+        const uint64_t function = reader.read<uint64_t>();
+        const Interval domain   = reader.read<Interval>();
+        if (function >= realFunctions.size()) {
+            throw Exception("The serialized program is corrupted");
+        }
+        tables.push_back(
+            std::make_shared<const FunctionTable>(realFunctions[function], domain, reader.readValues()));
+    }
+
+    Instructions instructions;
+    instructions.memoryOffset = reader.read<Address>();
+    const uint64_t instructionCount = reader.readCount();
+    const uint64_t memorySize       = uint64_t(instructions.memoryOffset) + instructionCount;
+    const auto     checkAddress     = [&](uint64_t address) {
+        if (address >= memorySize) {
+            throw Exception(std::format("The serialized program addresses out of its memory ({})", address));
+        }
+        return Address(address);
+    };
+    const auto checkIndex = [&](uint64_t index, size_t count) {
+        if (index >= count) {
+            throw Exception("The serialized program is corrupted");
+        }
+        return index;
+    };
+    for (uint64_t i = 0; i < instructionCount; ++i) {
+        Instruction& instruction = instructions.instructions.emplace_back();
+        instruction.opcode       = reader.read<Opcode>();
+        instruction.operand      = checkAddress(reader.read<Address>());
+        const uint64_t payload   = reader.read<uint64_t>();
+        switch (instruction.opcode) {
+        case Opcode::NOP:
+        case Opcode::SIN:
+        case Opcode::COS:
+        case Opcode::EXP:
+        case Opcode::LOG:
+            instruction.source = 0;
+            break;
+        case Opcode::ADD:
+        case Opcode::SUBTRACT:
+        case Opcode::MULTIPLY:
+        case Opcode::DIVIDE:
+        case Opcode::POWER:
+        case Opcode::CMP_LT:
+        case Opcode::CMP_LE:
+        case Opcode::CMP_EQ:
+        case Opcode::CMP_NE:
+        case Opcode::ATAN2:
+        case Opcode::HYPOT:
+        case Opcode::MIN:
+        case Opcode::MAX:
+        case Opcode::FMOD:
+        case Opcode::COPYSIGN:
+            instruction.source = checkAddress(payload);
+            break;
+        case Opcode::ADD_IMM:
+        case Opcode::SUBTRACT_IMM:
+        case Opcode::MULTIPLY_IMM:
+        case Opcode::DIVIDE_IMM:
+            instruction.immediate = std::bit_cast<Real>(payload);
+            break;
+        case Opcode::CALL:
+            instruction.function = realFunctions[checkIndex(payload, realFunctions.size())];
+            break;
+        case Opcode::CALL_BATCH:
+            instruction.batchFunction = batchFunctions[checkIndex(payload, batchFunctions.size())];
+            break;
+        case Opcode::CALL_BINARY:
+            instruction.binaryCall.source   = checkAddress(uint32_t(payload));
+            instruction.binaryCall.function = uint32_t(checkIndex(payload >> 32, binaryFunctions.size()));
+            break;
+        case Opcode::SELECT:
+            instruction.select.whenTrue  = checkAddress(uint32_t(payload));
+            instruction.select.whenFalse = checkAddress(payload >> 32);
+            break;
+        case Opcode::SINCOS:
+            instruction.target = ptrdiff_t(std::bit_cast<int64_t>(payload));
+            checkIndex(uint64_t(int64_t(i) + instruction.target), instructionCount);
+            break;
+        case Opcode::TABLE_LOOKUP:
+            instruction.table = tables[checkIndex(payload, tables.size())].get();
+            break;
+        default:
+            throw Exception(
+                std::format("Invalid opcode {} of the serialized program", int(instruction.opcode)));
+        }
+    }
+
+    Comments comments;
+    for (uint64_t i = reader.readCount(); i > 0; --i) {
+        const Address address = reader.read<Address>();
+        comments.insert({ address, reader.readString() });
+    }
+
+    // Note: The layout of the memory is checked so that the program is safe to execute.
+    const uint64_t constantsEnd = uint64_t(constants.memoryOffset) + constants.values.size();
+    if (!constants.values.empty() &&
+        (constants.memoryOffset == SCRATCHPAD_ADDRESS || constantsEnd > instructions.memoryOffset)) {
+        throw Exception("The serialized program is corrupted");
+    }
+    for (const auto& [name, address] : inputs) {
+        if (address >= instructions.memoryOffset ||
+            (address >= constants.memoryOffset && address < constantsEnd)) {
+            throw Exception(std::format("Invalid address of the serialized input '{}'", name));
+        }
+    }
+    for (const auto& [name, address] : outputs) {
+        if (address == SCRATCHPAD_ADDRESS || address >= memorySize) {
+            throw Exception(std::format("Invalid address of the serialized output '{}'", name));
+        }
+    }
+    return Program(std::move(inputs),
+                   std::move(outputs),
+                   std::move(constants),
+                   std::move(instructions),
+                   std::move(comments),
+                   std::move(binaryFunctions),
+                   std::move(tables),
+                   MathAccuracy(mathAccuracy));
+}
+
+SIXPACK_NAMESPACE_END
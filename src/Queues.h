@@ -0,0 +1,114 @@
+#pragma once
+#include "Common.h"
+#include <atomic>
+#include <bit>
+#include <memory>
+
+SIXPACK_NAMESPACE_BEGIN
+
+// Note: The queue is a bounded ring buffer (the capacity is rounded up to a power of two). The blocking
+//       variants of push/pop wait (without spinning) while the queue is full/empty, i.e. they provide the
+//       backpressure between the producers and the consumers.
+
+static constexpr size_t CACHE_LINE_SIZE = 64;
+
+/// A bounded lock-free queue for any number of producer and consumer threads.
+///
+/// Each cell carries a sequence number telling whether it is ready for the push or for the pop of the given
+/// position (the algorithm by D. Vyukov).
+template <typename T>
+class MpmcQueue {
+    struct alignas(CACHE_LINE_SIZE) Cell {
+        std::atomic<size_t> sequence;
+        T                   value;
+    };
+
+    const size_t                  mMask;
+    const std::unique_ptr<Cell[]> mCells;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mPushPosition = 0;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> mPopPosition  = 0;
+
+public:
+    explicit MpmcQueue(size_t capacity)
+        : mMask(std::bit_ceil(std::max(capacity, size_t(1))) - 1)
+        , mCells(std::make_unique<Cell[]>(mMask + 1)) {
+        for (size_t i = 0; i <= mMask; ++i) {
+            mCells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    size_t capacity() const { return mMask + 1; }
+
+    /// Moves the value into the queue, unless the queue is full.
+    bool tryPush(T& value) {
+        size_t position = mPushPosition.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell&           cell       = mCells[position & mMask];
+            const size_t    sequence   = cell.sequence.load(std::memory_order_acquire);
+            const ptrdiff_t difference = ptrdiff_t(sequence - position);
+            if (difference == 0) {
+                if (mPushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    cell.sequence.notify_all();
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = mPushPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Moves the value out of the queue, unless the queue is empty.
+    bool tryPop(T& value) {
+        size_t position = mPopPosition.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell&           cell       = mCells[position & mMask];
+            const size_t    sequence   = cell.sequence.load(std::memory_order_acquire);
+            const ptrdiff_t difference = ptrdiff_t(sequence - (position + 1));
+            if (difference == 0) {
+                if (mPopPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(position + mMask + 1, std::memory_order_release);
+                    cell.sequence.notify_all();
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = mPopPosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Moves the value into the queue, waiting while the queue is full.
+    void push(T value) {
+        while (!tryPush(value)) {
+            // Note: Waits only if the cell still holds the value of the previous round (otherwise retries).
+            const size_t position = mPushPosition.load(std::memory_order_relaxed);
+            Cell&        cell     = mCells[position & mMask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == position - mMask) {
+                cell.sequence.wait(sequence, std::memory_order_acquire);
+            }
+        }
+    }
+
+    /// Moves the value out of the queue, waiting while the queue is empty.
+    void pop(T& value) {
+        while (!tryPop(value)) {
+            // Note: Waits only if the cell is still waiting for the push of this round (otherwise retries).
+            const size_t position = mPopPosition.load(std::memory_order_relaxed);
+            Cell&        cell     = mCells[position & mMask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == position) {
+                cell.sequence.wait(sequence, std::memory_order_acquire);
+            }
+        }
+    }
+};
+
+SIXPACK_NAMESPACE_END
@@ -4,18 +4,36 @@
 
 SIXPACK_NAMESPACE_BEGIN
 
+class FunctionTable;
+
 // Named Symbols
 //============================================================================================================
 
 class Symbol {
-    String mName;
+public:
+    /// The concrete class of a symbol, i.e. the compiler dispatches on the kind rather than through RTTI.
+    enum class Kind : uint8_t { CONSTANT, PARAMETER, VARIABLE, EXPRESSION, FUNCTION, BINARY_FUNCTION };
+
+private:
+    String     mName;
+    const Kind mKind;
 
 public:
-    explicit Symbol(StringView name)
-        : mName(name) {}
+    Symbol(Kind kind, StringView name)
+        : mName(name)
+        , mKind(kind) {}
     virtual ~Symbol() = default;
 
     const String& name() const { return mName; }
+    Kind          kind() const { return mKind; }
+
+    /// Returns the symbol as the given (final) class, or nullptr if of another kind.
+    template <typename T>
+    const T* as() const {
+        return mKind == T::KIND ? static_cast<const T*>(this) : nullptr;
+    }
+    /// Returns whether the symbol is a `ValueSymbol`, i.e. a constant, parameter, variable or expression.
+    bool isValue() const { return mKind <= Kind::EXPRESSION; }
 };
 
 class ValueSymbol : public Symbol {
@@ -27,8 +45,10 @@ class ConstantSymbol final : public ValueSymbol {
     Real mValue;
 
 public:
+    static constexpr Kind KIND = Kind::CONSTANT;
+
     ConstantSymbol(StringView name, Real value)
-        : ValueSymbol(name)
+        : ValueSymbol(KIND, name)
         , mValue(value) {}
 
     Real value() const { return mValue; }
@@ -38,8 +58,10 @@ class ParameterSymbol final : public ValueSymbol {
     Real mValue;
 
 public:
+    static constexpr Kind KIND = Kind::PARAMETER;
+
     ParameterSymbol(StringView name, Real value)
-        : ValueSymbol(name)
+        : ValueSymbol(KIND, name)
         , mValue(value) {}
 
     Real value() const { return mValue; }
@@ -48,31 +70,66 @@ public:
 
 class VariableSymbol final : public ValueSymbol {
 public:
-    using ValueSymbol::ValueSymbol;
+    static constexpr Kind KIND = Kind::VARIABLE;
+
+    explicit VariableSymbol(StringView name)
+        : ValueSymbol(KIND, name) {}
 };
 
 class ExpressionSymbol final : public ValueSymbol {
     Expression mExpression;
 
 public:
+    static constexpr Kind KIND = Kind::EXPRESSION;
+
     ExpressionSymbol(StringView name, Expression expression)
-        : ValueSymbol(name)
+        : ValueSymbol(KIND, name)
         , mExpression(expression) {}
 
     Expression expression() const { return mExpression; }
 };
 
 class FunctionSymbol final : public Symbol {
-    RealFunction mFunction;
+    RealFunction                         mFunction;
+    BatchFunction                        mBatchFunction;
+    std::shared_ptr<const FunctionTable> mTable;
 
 public:
-    FunctionSymbol(StringView name, RealFunction function)
-        : Symbol(name)
-        , mFunction(function) {
+    static constexpr Kind KIND = Kind::FUNCTION;
+
+    FunctionSymbol(StringView                           name,
+                   RealFunction                         function,
+                   BatchFunction                        batchFunction = nullptr,
+                   std::shared_ptr<const FunctionTable> table         = {})
+        : Symbol(KIND, name)
+        , mFunction(function)
+        , mBatchFunction(batchFunction)
+        , mTable(std::move(table)) {
         assert(mFunction);
     }
 
     RealFunction function() const { return mFunction; }
+
+    /// The variant of the function evaluating multiple arguments at once, or nullptr.
+    BatchFunction batchFunction() const { return mBatchFunction; }
+
+    /// The tabulated approximation of the function, or nullptr.
+    const std::shared_ptr<const FunctionTable>& table() const { return mTable; }
+};
+
+class BinaryFunctionSymbol final : public Symbol {
+    BinaryRealFunction mFunction;
+
+public:
+    static constexpr Kind KIND = Kind::BINARY_FUNCTION;
+
+    BinaryFunctionSymbol(StringView name, BinaryRealFunction function)
+        : Symbol(KIND, name)
+        , mFunction(function) {
+        assert(mFunction);
+    }
+
+    BinaryRealFunction function() const { return mFunction; }
 };
 
 // Lexicon (Symbol Table)
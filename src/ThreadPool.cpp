@@ -0,0 +1,198 @@
+#include "ThreadPool.h"
+#include "Topology.h"
+#include <atomic>
+#include <exception>
+
+SIXPACK_NAMESPACE_BEGIN
+
+struct ThreadPool::Job {
+    const Task*         task;
+    std::atomic<size_t> remaining;
+    std::atomic<bool>   failed = false;
+    std::mutex          exceptionMutex;
+    std::exception_ptr  exception;
+
+    Job(const Task& task, size_t count)
+        : task(&task)
+        , remaining(count) {}
+};
+
+ThreadPool::ThreadPool(unsigned threadCount, AffinityPolicy policy)
+    : ThreadPool(mapProcessors(threadCount, policy, Topology::current())) {}
+
+ThreadPool::ThreadPool(std::vector<int> processors)
+    : mProcessors(std::move(processors)) {
+    const size_t threadCount = mProcessors.size();
+    mProcessors.push_back(-1); // the calling thread
+    mWorkers.reserve(threadCount + 1);
+    for (size_t i = 0; i < threadCount + 1; ++i) {
+        mWorkers.push_back(std::make_unique<Worker>());
+    }
+    mThreads.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i) {
+        mThreads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(mMutex);
+        mStopping = true;
+    }
+    mWakeCondition.notify_all();
+    for (std::thread& thread : mThreads) {
+        thread.join();
+    }
+}
+
+std::vector<int> ThreadPool::mapProcessors(unsigned        threadCount,
+                                           AffinityPolicy  policy,
+                                           const Topology& topology) {
+    if (policy == AffinityPolicy::AUTO) {
+        policy = topology.nodeCount() > 1 ? AffinityPolicy::SCATTER : AffinityPolicy::NONE;
+    }
+    std::vector<int> order; // the processors in the order of the assignment
+    switch (policy) {
+    case AffinityPolicy::COMPACT:
+        for (const Topology::Node& node : topology.nodes()) {
+            order.insert(order.end(), node.processors.begin(), node.processors.end());
+        }
+        break;
+    case AffinityPolicy::SCATTER:
+        for (size_t index = 0; order.size() < topology.processorCount(); ++index) {
+            for (const Topology::Node& node : topology.nodes()) {
+                if (index < node.processors.size()) {
+                    order.push_back(node.processors[index]);
+                }
+            }
+        }
+        break;
+    default:
+        break;
+    }
+    std::vector<int> processors(threadCount, -1);
+    if (!order.empty()) {
+        for (unsigned i = 0; i < threadCount; ++i) {
+            processors[i] = order[i % order.size()];
+        }
+    }
+    return processors;
+}
+
+void ThreadPool::parallelFor(size_t count, const Task& task) {
+    if (count == 0) {
+        return;
+    }
+    std::lock_guard jobLock(mJobMutex);
+    Job             job(task, count);
+    // Note: The indices are initially split into contiguous ranges, one per worker.
+    const size_t workerCount = mWorkers.size();
+    for (size_t worker = 0; worker < workerCount; ++worker) {
+        const size_t begin = count * worker / workerCount;
+        const size_t end   = count * (worker + 1) / workerCount;
+        if (begin < end) {
+            std::lock_guard lock(mWorkers[worker]->mutex);
+            mWorkers[worker]->ranges.push_back({ .job = &job, .begin = begin, .end = end });
+        }
+    }
+    {
+        std::lock_guard lock(mMutex);
+        ++mGeneration;
+    }
+    mWakeCondition.notify_all();
+    runTasks(unsigned(workerCount - 1));
+    {
+        std::unique_lock lock(mMutex);
+        mDoneCondition.wait(lock, [&] { return job.remaining.load(std::memory_order_acquire) == 0; });
+    }
+    if (job.exception) {
+        std::rethrow_exception(job.exception);
+    }
+}
+
+void ThreadPool::workerLoop(unsigned worker) {
+    if (const int processor = mProcessors[worker]; processor >= 0) {
+        if (Topology::pinCurrentThread(processor)) {
+            Topology::preferNodeMemory(Topology::current().nodeOf(processor));
+        }
+    }
+    uint64_t generation = 0;
+    for (;;) {
+        {
+            std::unique_lock lock(mMutex);
+            mWakeCondition.wait(lock, [&] { return mStopping || mGeneration != generation; });
+            if (mStopping) {
+                return;
+            }
+            generation = mGeneration;
+        }
+        runTasks(worker);
+    }
+}
+
+void ThreadPool::runTasks(unsigned worker) {
+    Range taken;
+    while (takeIndex(worker, taken) || (stealRange(worker) && takeIndex(worker, taken))) {
+        Job& job = *taken.job;
+        if (!job.failed.load(std::memory_order_relaxed)) {
+            try {
+                (*job.task)(taken.begin, worker);
+            } catch (...) {
+                std::lock_guard lock(job.exceptionMutex);
+                if (!job.exception) {
+                    job.exception = std::current_exception();
+                }
+                job.failed = true;
+            }
+        }
+        // Note: The job must not be accessed after the last index is completed (the caller may return).
+        if (job.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard lock(mMutex);
+            mDoneCondition.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::takeIndex(unsigned worker, Range& taken) {
+    Worker&         self = *mWorkers[worker];
+    std::lock_guard lock(self.mutex);
+    if (self.ranges.empty()) {
+        return false;
+    }
+    Range& front = self.ranges.front();
+    taken        = { .job = front.job, .begin = front.begin, .end = front.begin + 1 };
+    if (++front.begin == front.end) {
+        self.ranges.pop_front();
+    }
+    return true;
+}
+
+bool ThreadPool::stealRange(unsigned worker) {
+    const unsigned workerCount = unsigned(mWorkers.size());
+    for (unsigned offset = 1; offset < workerCount; ++offset) {
+        Worker& victim = *mWorkers[(worker + offset) % workerCount];
+        Range   stolen;
+        {
+            std::lock_guard lock(victim.mutex);
+            if (victim.ranges.empty()) {
+                continue;
+            }
+            Range& back = victim.ranges.back();
+            if (back.end - back.begin > 1) {
+                const size_t middle = back.begin + (back.end - back.begin) / 2;
+                stolen              = { .job = back.job, .begin = middle, .end = back.end };
+                back.end            = middle;
+            } else {
+                stolen = back;
+                victim.ranges.pop_back();
+            }
+        }
+        Worker&         self = *mWorkers[worker];
+        std::lock_guard lock(self.mutex);
+        self.ranges.push_back(stolen);
+        return true;
+    }
+    return false;
+}
+
+SIXPACK_NAMESPACE_END
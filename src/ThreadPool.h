@@ -0,0 +1,102 @@
+#pragma once
+#include "Common.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+SIXPACK_NAMESPACE_BEGIN
+
+class Topology;
+
+/// The placement of the worker threads on the logical processors.
+enum class AffinityPolicy {
+    NONE,    ///< The threads are not pinned (i.e. placed by the operating system).
+    AUTO,    ///< As `SCATTER` on the multi-node (NUMA) machines, as `NONE` otherwise.
+    COMPACT, ///< The threads are pinned to the processors of one node after another.
+    SCATTER  ///< The threads are pinned round-robin over the nodes.
+};
+
+/// A persistent pool of worker threads executing parallel loops with work stealing.
+///
+/// Each worker owns a queue of index ranges. A worker takes the indices one by one from the front of its own
+/// queue; once its queue is empty, it steals the upper half of a range from the back of another worker's
+/// queue. Hence the load is balanced even if the cost of the individual indices varies greatly.
+///
+/// The pinned workers prefer the memory of their own node, so anything a worker allocates and touches first
+/// (such as its executable) is local to it.
+class ThreadPool {
+public:
+    /// The loop body, called with the loop index and the index of the executing worker.
+    using Task = std::function<void(size_t index, unsigned worker)>;
+
+private:
+    struct Job;
+
+    struct Range {
+        Job*   job;
+        size_t begin;
+        size_t end;
+    };
+
+    struct Worker {
+        std::mutex        mutex;
+        std::deque<Range> ranges;
+    };
+
+    std::vector<std::unique_ptr<Worker>> mWorkers;    // the last one is the calling thread
+    std::vector<int>                     mProcessors; // the processor of each worker (-1 if not pinned)
+    std::vector<std::thread>             mThreads;
+    std::mutex                           mMutex;
+    std::condition_variable              mWakeCondition;
+    std::condition_variable              mDoneCondition;
+    uint64_t                             mGeneration = 0;
+    bool                                 mStopping   = false;
+    std::mutex                           mJobMutex; // serializes the parallel loops
+
+public:
+    /// Starts the worker threads.
+    ///
+    /// \param[in] threadCount The number of the background threads; the calling thread of `parallelFor` is
+    ///                        always used as an additional worker (it is never pinned).
+    /// \param[in] policy      The placement of the background threads.
+    explicit ThreadPool(unsigned       threadCount = std::thread::hardware_concurrency(),
+                        AffinityPolicy policy      = AffinityPolicy::AUTO);
+
+    /// Starts the worker threads pinned to the given logical processors (-1 for not pinned).
+    explicit ThreadPool(std::vector<int> processors);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Returns the number of the workers, i.e. the upper bound of the worker index passed to the tasks.
+    unsigned workerCount() const { return unsigned(mWorkers.size()); }
+
+    /// Returns the logical processor the worker is pinned to, or -1 if it is not pinned.
+    int workerProcessor(unsigned worker) const { return mProcessors[worker]; }
+
+    /// Maps the background threads to the logical processors according to the policy.
+    static std::vector<int> mapProcessors(unsigned        threadCount,
+                                          AffinityPolicy  policy,
+                                          const Topology& topology);
+
+    /// Calls the task for each index in [0, count) and waits for the completion.
+    ///
+    /// The loops are executed one at a time, i.e. the method must not be called from within a task.
+    ///
+    /// \throws The first exception thrown by the task (the remaining indices are skipped).
+    void parallelFor(size_t count, const Task& task);
+
+private:
+    void workerLoop(unsigned worker);
+    void runTasks(unsigned worker);
+    bool takeIndex(unsigned worker, Range& taken);
+    bool stealRange(unsigned worker);
+};
+
+SIXPACK_NAMESPACE_END
@@ -36,6 +36,17 @@ Token Tokenizer::getNext() {
                       .numericValue = numericValue };
     };
 
+    if (mPosition < mInput.size() && mInput[mPosition] == '=') {
+        switch (startChar) {
+        // clang-format off
+        case '=': ++mPosition; return makeToken(TokenType::OPERATOR_DOUBLE_EQUALS);
+        case '<': ++mPosition; return makeToken(TokenType::OPERATOR_LESS_EQUALS);
+        case '>': ++mPosition; return makeToken(TokenType::OPERATOR_GREATER_EQUALS);
+        case '!': ++mPosition; return makeToken(TokenType::OPERATOR_NOT_EQUALS);
+        // clang-format on
+        }
+    }
+
     switch (startChar) {
     // clang-format off
     case '=': return makeToken(TokenType::OPERATOR_EQUALS);
@@ -44,10 +55,13 @@ Token Tokenizer::getNext() {
     case '*': return makeToken(TokenType::OPERATOR_ASTERISK);
     case '/': return makeToken(TokenType::OPERATOR_SLASH);
     case '^': return makeToken(TokenType::OPERATOR_CARET);
+    case '<': return makeToken(TokenType::OPERATOR_LESS);
+    case '>': return makeToken(TokenType::OPERATOR_GREATER);
     case '(': return makeToken(TokenType::PARENTHESIS_LEFT);
     case ')': return makeToken(TokenType::PARENTHESIS_RIGHT);
     case '[': return makeToken(TokenType::BRACKET_LEFT);
     case ']': return makeToken(TokenType::BRACKET_RIGHT);
+    case ',': return makeToken(TokenType::COMMA);
     // clang-format on
     default:
         if (isDigit(startChar)) {
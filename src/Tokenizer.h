@@ -4,20 +4,27 @@
 SIXPACK_NAMESPACE_BEGIN
 
 enum class TokenType {
-    NUMBER,            // 0, 1.23, 3.46e+4, ...
-    IDENTIFIER,        // A, ab_c, _abc3, ...
-    OPERATOR_EQUALS,   // =
-    OPERATOR_PLUS,     // +
-    OPERATOR_MINUS,    // -
-    OPERATOR_ASTERISK, // *
-    OPERATOR_SLASH,    // /
-    OPERATOR_CARET,    // ^
-    PARENTHESIS_LEFT,  // (
-    PARENTHESIS_RIGHT, // )
-    BRACKET_LEFT,      // [
-    BRACKET_RIGHT,     // ]
-    UNKNOWN,           // (anything else)
-    END_OF_INPUT       // (end of input)
+    NUMBER,                  // 0, 1.23, 3.46e+4, ...
+    IDENTIFIER,              // A, ab_c, _abc3, ...
+    OPERATOR_EQUALS,         // =
+    OPERATOR_PLUS,           // +
+    OPERATOR_MINUS,          // -
+    OPERATOR_ASTERISK,       // *
+    OPERATOR_SLASH,          // /
+    OPERATOR_CARET,          // ^
+    OPERATOR_LESS,           // <
+    OPERATOR_LESS_EQUALS,    // <=
+    OPERATOR_GREATER,        // >
+    OPERATOR_GREATER_EQUALS, // >=
+    OPERATOR_DOUBLE_EQUALS,  // ==
+    OPERATOR_NOT_EQUALS,     // !=
+    PARENTHESIS_LEFT,        // (
+    PARENTHESIS_RIGHT,       // )
+    BRACKET_LEFT,            // [
+    BRACKET_RIGHT,           // ]
+    COMMA,                   // ,
+    UNKNOWN,                 // (anything else)
+    END_OF_INPUT             // (end of input)
 };
 
 struct Token {
@@ -0,0 +1,205 @@
+#include "Topology.h"
+#include <algorithm>
+#include <thread>
+
+#if defined(_WIN32)
+#   define NOMINMAX
+#   define WIN32_LEAN_AND_MEAN
+#   include <windows.h>
+#elif defined(__linux__)
+#   include <filesystem>
+#   include <fstream>
+#   include <sched.h>
+#endif
+
+#if defined(SIXPACK_ENABLE_LIBNUMA)
+#   include <numa.h>
+#endif
+
+SIXPACK_NAMESPACE_BEGIN
+
+namespace {
+
+    // Returns all the processors as a single node.
+    static std::vector<Topology::Node> getUniformTopology(std::vector<int> processors) {
+        if (processors.empty()) {
+            const int processorCount = std::max(1, int(std::thread::hardware_concurrency()));
+            for (int processor = 0; processor < processorCount; ++processor) {
+                processors.push_back(processor);
+            }
+        }
+        return { Topology::Node{ .id = 0, .processors = std::move(processors) } };
+    }
+
+#if defined(_WIN32)
+
+    // Note: Only the first processor group (i.e. up to 64 logical processors) is supported.
+    static std::vector<Topology::Node> detectTopology() {
+        DWORD_PTR processMask = 0;
+        DWORD_PTR systemMask  = 0;
+        if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+            return getUniformTopology({});
+        }
+        std::vector<int> allowedProcessors;
+        for (int processor = 0; processor < 64; ++processor) {
+            if (processMask & (DWORD_PTR(1) << processor)) {
+                allowedProcessors.push_back(processor);
+            }
+        }
+        ULONG highestNode = 0;
+        if (!GetNumaHighestNodeNumber(&highestNode)) {
+            return getUniformTopology(std::move(allowedProcessors));
+        }
+        std::vector<Topology::Node> nodes;
+        for (ULONG node = 0; node <= highestNode; ++node) {
+            GROUP_AFFINITY affinity{};
+            if (GetNumaNodeProcessorMaskEx(USHORT(node), &affinity) && affinity.Group == 0) {
+                std::vector<int> processors;
+                for (int processor : allowedProcessors) {
+                    if (affinity.Mask & (KAFFINITY(1) << processor)) {
+                        processors.push_back(processor);
+                    }
+                }
+                if (!processors.empty()) {
+                    nodes.push_back({ .id = int(node), .processors = std::move(processors) });
+                }
+            }
+        }
+        return nodes.empty() ? getUniformTopology(std::move(allowedProcessors)) : nodes;
+    }
+
+#elif defined(__linux__)
+
+    // Parses the list of processors in the "0-3,8,10-11" format.
+    static std::vector<int> parseProcessorList(const String& list) {
+        std::vector<int> processors;
+        size_t           position = 0;
+        while (position < list.size()) {
+            size_t    length = 0;
+            const int first  = std::stoi(list.substr(position), &length);
+            int       last   = first;
+            position += length;
+            if (position < list.size() && list[position] == '-') {
+                last = std::stoi(list.substr(position + 1), &length);
+                position += 1 + length;
+            }
+            for (int processor = first; processor <= last; ++processor) {
+                processors.push_back(processor);
+            }
+            position = list.find_first_of("0123456789", position);
+        }
+        return processors;
+    }
+
+    static std::vector<Topology::Node> detectTopology() {
+        cpu_set_t        allowedSet;
+        std::vector<int> allowedProcessors;
+        if (sched_getaffinity(0, sizeof(allowedSet), &allowedSet) == 0) {
+            for (int processor = 0; processor < CPU_SETSIZE; ++processor) {
+                if (CPU_ISSET(processor, &allowedSet)) {
+                    allowedProcessors.push_back(processor);
+                }
+            }
+        }
+        std::vector<Topology::Node> nodes;
+#   if defined(SIXPACK_ENABLE_LIBNUMA)
+        if (numa_available() >= 0) {
+            for (int node = 0; node <= numa_max_node(); ++node) {
+                nodes.push_back({ .id = node, .processors = {} });
+            }
+            for (int processor : allowedProcessors) {
+                const int node = numa_node_of_cpu(processor);
+                if (node >= 0 && node < int(nodes.size())) {
+                    nodes[node].processors.push_back(processor);
+                }
+            }
+        }
+#   else
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+            const String name = entry.path().filename().string();
+            if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+                name.find_first_not_of("0123456789", 4) != String::npos) {
+                continue;
+            }
+            Topology::Node node{ .id = std::stoi(name.substr(4)), .processors = {} };
+            String         list;
+            if (std::ifstream(entry.path() / "cpulist") >> list) {
+                for (int processor : parseProcessorList(list)) {
+                    if (std::find(allowedProcessors.begin(), allowedProcessors.end(), processor) !=
+                        allowedProcessors.end()) {
+                        node.processors.push_back(processor);
+                    }
+                }
+            }
+            nodes.push_back(std::move(node));
+        }
+        // Note: The directory entries are not sorted.
+        std::sort(nodes.begin(), nodes.end(), [](const auto& n1, const auto& n2) {
+            return n1.id < n2.id;
+        });
+#   endif
+        std::erase_if(nodes, [](const auto& node) {
+            return node.processors.empty();
+        });
+        return nodes.empty() ? getUniformTopology(std::move(allowedProcessors)) : nodes;
+    }
+
+#else
+
+    static std::vector<Topology::Node> detectTopology() {
+        return getUniformTopology({});
+    }
+
+#endif
+
+} // anonymous namespace
+
+const Topology& Topology::current() {
+    static const Topology topology(detectTopology());
+    return topology;
+}
+
+size_t Topology::processorCount() const {
+    size_t count = 0;
+    for (const Node& node : mNodes) {
+        count += node.processors.size();
+    }
+    return count;
+}
+
+int Topology::nodeOf(int processor) const {
+    for (const Node& node : mNodes) {
+        if (std::find(node.processors.begin(), node.processors.end(), processor) != node.processors.end()) {
+            return node.id;
+        }
+    }
+    return -1;
+}
+
+bool Topology::pinCurrentThread(int processor) {
+#if defined(_WIN32)
+    return processor >= 0 && processor < 64 &&
+           SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << processor) != 0;
+#elif defined(__linux__)
+    if (processor < 0 || processor >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t processorSet;
+    CPU_ZERO(&processorSet);
+    CPU_SET(processor, &processorSet);
+    return sched_setaffinity(0, sizeof(processorSet), &processorSet) == 0;
+#else
+    return false;
+#endif
+}
+
+void Topology::preferNodeMemory([[maybe_unused]] int node) {
+#if defined(SIXPACK_ENABLE_LIBNUMA)
+    if (numa_available() >= 0) {
+        numa_set_preferred(node);
+    }
+#endif
+}
+
+SIXPACK_NAMESPACE_END
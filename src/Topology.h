@@ -0,0 +1,45 @@
+#pragma once
+#include "Common.h"
+#include <vector>
+
+SIXPACK_NAMESPACE_BEGIN
+
+/// The logical processors available to the process, grouped by their NUMA nodes.
+///
+/// The topology is read from the operating system (or from libnuma, if built with `SIXPACK_ENABLE_LIBNUMA`).
+/// If it cannot be determined, the machine is reported as a single node.
+class Topology {
+public:
+    struct Node {
+        int              id;         // as numbered by the operating system
+        std::vector<int> processors; // the available logical processors of the node
+    };
+
+private:
+    std::vector<Node> mNodes; // the nodes with at least one available processor
+
+public:
+    explicit Topology(std::vector<Node> nodes)
+        : mNodes(std::move(nodes)) {}
+
+    /// Returns the topology of the current machine (detected once).
+    static const Topology& current();
+
+    const std::vector<Node>& nodes() const { return mNodes; }
+    size_t                   nodeCount() const { return mNodes.size(); }
+    size_t                   processorCount() const;
+
+    /// Returns the node (id) of the logical processor, or -1 if the processor is not available.
+    int nodeOf(int processor) const;
+
+    /// Pins the calling thread to the logical processor. Returns false if not supported by the platform.
+    static bool pinCurrentThread(int processor);
+
+    /// Makes the calling thread prefer the memory of the node for its new allocations.
+    ///
+    /// Note: This requires libnuma; otherwise the memory is placed by the "first touch" policy of the
+    ///       operating system, i.e. on the node of the (pinned) thread which touches it first.
+    static void preferNodeMemory(int node);
+};
+
+SIXPACK_NAMESPACE_END
@@ -1,12 +1,14 @@
 #include "Utilities.h"
 #include "Asg.h"
 #include "Ast.h"
+#include "Compiler.h"
 #include "Exception.h"
 #include "Program.h"
 #include "Symbols.h"
 #include <algorithm>
 #include <format>
 #include <iostream>
+#include <unordered_map>
 
 SIXPACK_NAMESPACE_BEGIN
 
@@ -17,6 +19,19 @@ namespace {
         return typeName.substr(typeName.rfind(':') + 1);
     }
 
+    static StringView getOpcodeName(Program::Opcode opcode) {
+        static constexpr StringView NAMES[] = { "NOP",          "ADD",         "ADD_IMM",    "SUBTRACT",
+                                                "SUBTRACT_IMM", "MULTIPLY",    "MULTIPLY_IMM", "DIVIDE",
+                                                "DIVIDE_IMM",   "POWER",       "CALL",         "CALL_BATCH",
+                                                "CALL_BINARY",  "CMP_LT",      "CMP_LE",       "CMP_EQ",
+                                                "CMP_NE",       "SELECT",      "SIN",          "COS",
+                                                "SINCOS",       "EXP",         "LOG",          "ATAN2",
+                                                "HYPOT",        "MIN",         "MAX",          "FMOD",
+                                                "COPYSIGN",     "TABLE_LOOKUP" };
+        static_assert(std::size(NAMES) == size_t(Program::Opcode::TABLE_LOOKUP) + 1);
+        return size_t(opcode) < std::size(NAMES) ? NAMES[size_t(opcode)] : "???";
+    }
+
     //========================================================================================================
     // TabulatedPrintout
     //========================================================================================================
@@ -112,11 +127,17 @@ namespace {
             if (const auto* binaryOp = dynamic_cast<const ast::BinaryOperator*>(&node)) {
                 // clang-format off
                 switch (binaryOp->type()) {
-                case ast::BinaryOperator::Type::CARET:    return -1;
-                case ast::BinaryOperator::Type::SLASH:    return -2;
-                case ast::BinaryOperator::Type::ASTERISK: return  2;
-                case ast::BinaryOperator::Type::MINUS:    return -3;
-                case ast::BinaryOperator::Type::PLUS:     return  3;
+                case ast::BinaryOperator::Type::CARET:          return -1;
+                case ast::BinaryOperator::Type::SLASH:          return -2;
+                case ast::BinaryOperator::Type::ASTERISK:       return  2;
+                case ast::BinaryOperator::Type::MINUS:          return -3;
+                case ast::BinaryOperator::Type::PLUS:           return  3;
+                case ast::BinaryOperator::Type::LESS:           return -4;
+                case ast::BinaryOperator::Type::LESS_EQUALS:    return -4;
+                case ast::BinaryOperator::Type::GREATER:        return -4;
+                case ast::BinaryOperator::Type::GREATER_EQUALS: return -4;
+                case ast::BinaryOperator::Type::DOUBLE_EQUALS:  return -4;
+                case ast::BinaryOperator::Type::NOT_EQUALS:     return -4;
                 }
                 // clang-format on
             }
@@ -152,6 +173,47 @@ namespace {
             }
         }
 
+        virtual void visit(const ast::BinaryFunction& node) override {
+            if (mNotation == Notation::INFIX) {
+                addToResult(node.functionSymbol().name() + "(");
+                node.firstArgument().accept(*this);
+                addToResult(", ");
+                node.secondArgument().accept(*this);
+                addToResult(")");
+            } else {
+                if (mNotation == Notation::PREFIX) {
+                    addToResult(node.functionSymbol().name());
+                }
+                node.firstArgument().accept(*this);
+                node.secondArgument().accept(*this);
+                if (mNotation == Notation::POSTFIX) {
+                    addToResult(node.functionSymbol().name());
+                }
+            }
+        }
+
+        virtual void visit(const ast::Conditional& node) override {
+            if (mNotation == Notation::INFIX) {
+                addToResult("if(");
+                node.condition().accept(*this);
+                addToResult(", ");
+                node.whenTrue().accept(*this);
+                addToResult(", ");
+                node.whenFalse().accept(*this);
+                addToResult(")");
+            } else {
+                if (mNotation == Notation::PREFIX) {
+                    addToResult("if");
+                }
+                node.condition().accept(*this);
+                node.whenTrue().accept(*this);
+                node.whenFalse().accept(*this);
+                if (mNotation == Notation::POSTFIX) {
+                    addToResult("if");
+                }
+            }
+        }
+
         virtual void visit(const ast::UnaryOperator& node) override {
             if (mNotation == Notation::INFIX) {
                 addToResult(node.innerSourceView());
@@ -256,6 +318,8 @@ namespace {
                 valueType = " -> " + String(getTypeName(value->valueSymbol()));
             } else if (const auto* function = dynamic_cast<const ast::UnaryFunction*>(&node)) {
                 valueType = " -> " + String(getTypeName(function->functionSymbol()));
+            } else if (const auto* function = dynamic_cast<const ast::BinaryFunction*>(&node)) {
+                valueType = " -> " + String(getTypeName(function->functionSymbol()));
             }
             mPrintout.addRow({ getColorSourceView(node.innerSourceView(), node.outerSourceView()),
                                mTreePrinter.printNode(String(getTypeName(node)) + valueType),
@@ -339,12 +403,42 @@ namespace {
         virtual void visit(const asg::UnaryFunction& term) override {
             addRow(term,
                    getTypeName(term),
-                   std::format("{:#x}", reinterpret_cast<uintptr_t>(term.function())));
+                   std::format("{:#x}{}",
+                               reinterpret_cast<uintptr_t>(term.function()),
+                               term.table() ? " (tabulated)" : ""));
             mTreePrinter.enterChildren(1);
             handleTerm(*term.argument());
             mTreePrinter.leaveChildren();
         }
 
+        virtual void visit(const asg::BinaryFunction& term) override {
+            addRow(term,
+                   getTypeName(term),
+                   std::format("{:#x}", reinterpret_cast<uintptr_t>(term.function())));
+            mTreePrinter.enterChildren(2);
+            handleTerm(*term.firstArgument());
+            handleTerm(*term.secondArgument());
+            mTreePrinter.leaveChildren();
+        }
+
+        virtual void visit(const asg::Comparison& term) override {
+            static constexpr StringView OPERATORS[] = { "<", "<=", "==", "!=" };
+            addRow(term, getTypeName(term), String(OPERATORS[int(term.type())]));
+            mTreePrinter.enterChildren(2);
+            handleTerm(*term.left());
+            handleTerm(*term.right());
+            mTreePrinter.leaveChildren();
+        }
+
+        virtual void visit(const asg::Selection& term) override {
+            addRow(term, getTypeName(term));
+            mTreePrinter.enterChildren(3);
+            handleTerm(*term.condition());
+            handleTerm(*term.whenTrue());
+            handleTerm(*term.whenFalse());
+            mTreePrinter.leaveChildren();
+        }
+
         void visit(const asg::GroupOperation& term) {
             addRow(term, getTypeName(term));
             const auto [positiveSign, negativeSign] = term.operatorSigns();
@@ -444,7 +538,7 @@ void dumpSemanticGraph(const asg::Term& root, std::ostream& output) {
     visitor.printout().print(output);
 }
 
-void dumpProgram(const Program& program, std::ostream& output) {
+void dumpProgram(const Program& program, std::ostream& output, bool withAnalysis) {
     const auto formatAddress = [](Program::Address address) {
         return std::format("[{:#04}]", address);
     };
@@ -523,6 +617,43 @@ void dumpProgram(const Program& program, std::ostream& output) {
                                     reinterpret_cast<void*>(code[i].function),
                                     formatAddress(code[i].operand));
             break;
+        case Program::Opcode::CALL_BATCH:
+            mnemonic  = "callb";
+            arguments = std::format("{:p}, {}",
+                                    reinterpret_cast<void*>(code[i].batchFunction),
+                                    formatAddress(code[i].operand));
+            break;
+        case Program::Opcode::CALL_BINARY:
+            mnemonic  = "call";
+            arguments = std::format(
+                "{:p}, {}, {}",
+                reinterpret_cast<void*>(program.binaryFunctions()[code[i].binaryCall.function]),
+                formatAddress(code[i].binaryCall.source),
+                formatAddress(code[i].operand));
+            break;
+        case Program::Opcode::CMP_LT:
+            mnemonic  = "cmplt";
+            arguments = std::format("{}, {}", formatAddress(code[i].source), formatAddress(code[i].operand));
+            break;
+        case Program::Opcode::CMP_LE:
+            mnemonic  = "cmple";
+            arguments = std::format("{}, {}", formatAddress(code[i].source), formatAddress(code[i].operand));
+            break;
+        case Program::Opcode::CMP_EQ:
+            mnemonic  = "cmpeq";
+            arguments = std::format("{}, {}", formatAddress(code[i].source), formatAddress(code[i].operand));
+            break;
+        case Program::Opcode::CMP_NE:
+            mnemonic  = "cmpne";
+            arguments = std::format("{}, {}", formatAddress(code[i].source), formatAddress(code[i].operand));
+            break;
+        case Program::Opcode::SELECT:
+            mnemonic  = "select";
+            arguments = std::format("{}, {}, {}",
+                                    formatAddress(code[i].operand),
+                                    formatAddress(code[i].select.whenTrue),
+                                    formatAddress(code[i].select.whenFalse));
+            break;
         case Program::Opcode::SIN:
             mnemonic  = "sin";
             arguments = std::format("{}", formatAddress(code[i].operand));
@@ -535,6 +666,44 @@ void dumpProgram(const Program& program, std::ostream& output) {
             mnemonic  = "sincos";
             arguments = std::format("{}, ${:+}", formatAddress(code[i].operand), code[i].target);
             break;
+        case Program::Opcode::EXP:
+            mnemonic  = "exp";
+            arguments = std::format("{}", formatAddress(code[i].operand));
+            break;
+        case Program::Opcode::LOG:
+            mnemonic  = "log";
+            arguments = std::format("{}", formatAddress(code[i].operand));
+            break;
+        case Program::Opcode::ATAN2:
+            mnemonic  = "atan2";
+            arguments = std::format("{}, {}", formatAddress(code[i].source), formatAddress(code[i].operand));
+            break;
+        case Program::Opcode::HYPOT:
+            mnemonic  = "hypot";
+            arguments = std::format("{}, {}", formatAddress(code[i].source), formatAddress(code[i].operand));
+            break;
+        case Program::Opcode::MIN:
+            mnemonic  = "min";
+            arguments = std::format("{}, {}", formatAddress(code[i].source), formatAddress(code[i].operand));
+            break;
+        case Program::Opcode::MAX:
+            mnemonic  = "max";
+            arguments = std::format("{}, {}", formatAddress(code[i].source), formatAddress(code[i].operand));
+            break;
+        case Program::Opcode::FMOD:
+            mnemonic  = "fmod";
+            arguments = std::format("{}, {}", formatAddress(code[i].source), formatAddress(code[i].operand));
+            break;
+        case Program::Opcode::COPYSIGN:
+            mnemonic  = "copysign";
+            arguments = std::format("{}, {}", formatAddress(code[i].source), formatAddress(code[i].operand));
+            break;
+        case Program::Opcode::TABLE_LOOKUP:
+            mnemonic  = "lookup";
+            arguments = std::format("{:p}, {}",
+                                    static_cast<const void*>(code[i].table),
+                                    formatAddress(code[i].operand));
+            break;
         default:
             assert(false);
             mnemonic = "???";
@@ -543,6 +712,221 @@ void dumpProgram(const Program& program, std::ostream& output) {
     }
     printout.sortByColumn(0);
     printout.print(output);
+    if (withAnalysis) {
+        output << std::endl;
+        dumpAnalysis(program.analyze(), output);
+    }
+}
+
+void dumpAnalysis(const Program::Analysis& analysis, std::ostream& output) {
+    output << std::format("Cost model: {}", analysis.costModel) << std::endl << std::endl;
+
+    TabulatedPrintout<2> opcodePrintout;
+    opcodePrintout.addRow({ "opcode", "count" });
+    for (size_t i = 0; i < Program::OPCODE_COUNT; ++i) {
+        if (analysis.opcodeCounts[i] > 0) {
+            opcodePrintout.addRow(
+                { String(getOpcodeName(Program::Opcode(i))), std::to_string(analysis.opcodeCounts[i]) });
+        }
+    }
+    opcodePrintout.addRow({ "total", std::to_string(analysis.instructionCount) });
+    opcodePrintout.print(output);
+    output << std::endl;
+
+    output << std::format("Critical path:       {} instructions", analysis.criticalPathLength) << std::endl;
+    output << std::format("Average parallelism: {:.2f}", analysis.averageParallelism) << std::endl;
+    output << std::format("Peak live memory:    {} words", analysis.peakLiveWords) << std::endl;
+    output << std::format("Function tables:     {} bytes", analysis.tableBytes) << std::endl << std::endl;
+
+    TabulatedPrintout<7> estimatePrintout;
+    estimatePrintout.addRow({ "executable", "latency", "throughput", "cycles", "per point", "code", "data" });
+    const auto addEstimate = [&](StringView name, const Program::Analysis::Estimate& estimate, int lanes) {
+        estimatePrintout.addRow({ String(name),
+                                  std::format("{:.1f}", estimate.latencyBound),
+                                  std::format("{:.1f}", estimate.throughputBound),
+                                  std::format("{:.1f}", estimate.cycles()),
+                                  std::format("{:.1f}", estimate.cycles() / lanes),
+                                  std::format("{} B", estimate.codeBytes),
+                                  std::format("{} B", estimate.dataBytes) });
+    };
+    addEstimate("scalar", analysis.scalar, 1);
+    addEstimate("vector", analysis.vector, Program::Vector::SIZE);
+    estimatePrintout.print(output);
+}
+
+void dumpProfile(const Program& program, const Program::Profile& profile, std::ostream& output) {
+    const Program::Address                   codeSection = program.instructions().memoryOffset;
+    const std::vector<Program::Instruction>& code        = program.instructions().instructions;
+
+    uint64_t totalTicks = 0;
+    for (const Program::InstructionProfile& instruction : profile) {
+        totalTicks += instruction.ticks;
+    }
+    const auto formatShare = [&](uint64_t ticks) {
+        return std::format("{:5.1f}%", totalTicks ? 100.0 * double(ticks) / double(totalTicks) : 0.0);
+    };
+    const auto findComment = [&](size_t index) -> const String* {
+        const auto commentIt = program.comments().find(codeSection + Program::Address(index));
+        return commentIt != program.comments().end() ? &commentIt->second : nullptr;
+    };
+
+    // The first consumer of each instruction (i.e. of its output), by the index.
+    std::vector<size_t> firstConsumers(code.size(), SIZE_MAX);
+    const auto          addConsumer = [&](Program::Address address, size_t consumer) {
+        if (address >= codeSection && address - codeSection < code.size()) {
+            size_t& firstConsumer = firstConsumers[address - codeSection];
+            firstConsumer         = std::min(firstConsumer, consumer);
+        }
+    };
+    for (size_t i = 0; i < code.size(); ++i) {
+        const Program::Instruction& instruction = code[i];
+        switch (instruction.opcode) {
+        case Program::Opcode::NOP:
+            break;
+        case Program::Opcode::ADD:
+        case Program::Opcode::SUBTRACT:
+        case Program::Opcode::MULTIPLY:
+        case Program::Opcode::DIVIDE:
+        case Program::Opcode::POWER:
+        case Program::Opcode::CMP_LT:
+        case Program::Opcode::CMP_LE:
+        case Program::Opcode::CMP_EQ:
+        case Program::Opcode::CMP_NE:
+        case Program::Opcode::ATAN2:
+        case Program::Opcode::HYPOT:
+        case Program::Opcode::MIN:
+        case Program::Opcode::MAX:
+        case Program::Opcode::FMOD:
+        case Program::Opcode::COPYSIGN:
+            addConsumer(instruction.source, i);
+            addConsumer(instruction.operand, i);
+            break;
+        case Program::Opcode::CALL_BINARY:
+            addConsumer(instruction.binaryCall.source, i);
+            addConsumer(instruction.operand, i);
+            break;
+        case Program::Opcode::SELECT:
+            addConsumer(instruction.select.whenTrue, i);
+            addConsumer(instruction.select.whenFalse, i);
+            addConsumer(instruction.operand, i);
+            break;
+        default:
+            addConsumer(instruction.operand, i);
+            break;
+        }
+    }
+    // Note: The cosine of `SINCOS` is stored by the instruction, i.e. its consumers are those of the sine.
+    for (size_t i = 0; i < code.size(); ++i) {
+        if (code[i].opcode == Program::Opcode::SINCOS) {
+            const size_t cosine = size_t(ptrdiff_t(i) + code[i].target);
+            if (cosine < code.size()) {
+                firstConsumers[i] = std::min(firstConsumers[i], firstConsumers[cosine]);
+            }
+        }
+    }
+    const auto findExpression = [&](size_t index) -> StringView {
+        // Note: The consumers always follow the instruction, i.e. the search terminates.
+        while (index < code.size()) {
+            if (const String* comment = findComment(index)) {
+                return *comment;
+            }
+            index = firstConsumers[index];
+        }
+        return "(unattributed)";
+    };
+
+    std::unordered_map<Program::Opcode, uint64_t> opcodeTicks;
+    std::unordered_map<StringView, uint64_t>      expressionTicks;
+    for (const Program::InstructionProfile& instruction : profile) {
+        opcodeTicks[instruction.opcode] += instruction.ticks;
+        expressionTicks[findExpression(instruction.address - codeSection)] += instruction.ticks;
+    }
+    const auto sortByTicks = [](const auto& ticks) {
+        using Key = typename std::decay_t<decltype(ticks)>::key_type;
+        std::vector<std::pair<Key, uint64_t>> sorted(ticks.begin(), ticks.end());
+        std::stable_sort(sorted.begin(), sorted.end(), [](const auto& entry1, const auto& entry2) {
+            return entry1.second > entry2.second;
+        });
+        return sorted;
+    };
+
+    output << std::format("Total: {} ticks", totalTicks) << std::endl << std::endl;
+
+    TabulatedPrintout<3> opcodePrintout;
+    opcodePrintout.addRow({ "opcode", "ticks", "share" });
+    for (const auto& [opcode, ticks] : sortByTicks(opcodeTicks)) {
+        opcodePrintout.addRow({ String(getOpcodeName(opcode)), std::to_string(ticks), formatShare(ticks) });
+    }
+    opcodePrintout.print(output);
+    output << std::endl;
+
+    std::vector<const Program::InstructionProfile*> instructions;
+    for (const Program::InstructionProfile& instruction : profile) {
+        instructions.push_back(&instruction);
+    }
+    std::stable_sort(instructions.begin(), instructions.end(), [](const auto* first, const auto* second) {
+        return first->ticks > second->ticks;
+    });
+    TabulatedPrintout<6> instructionPrintout;
+    instructionPrintout.addRow({ "address", "opcode", "count", "ticks", "share", "comment" });
+    for (const Program::InstructionProfile* instruction : instructions) {
+        const String* comment = findComment(instruction->address - codeSection);
+        instructionPrintout.addRow({ std::format("[{:#04}]", instruction->address),
+                                     String(getOpcodeName(instruction->opcode)),
+                                     std::to_string(instruction->count),
+                                     std::to_string(instruction->ticks),
+                                     formatShare(instruction->ticks),
+                                     comment ? std::format("; {}", *comment) : String{} });
+    }
+    instructionPrintout.print(output);
+    output << std::endl;
+
+    TabulatedPrintout<3> expressionPrintout;
+    expressionPrintout.addRow({ "ticks", "share", "expression" });
+    for (const auto& [expression, ticks] : sortByTicks(expressionTicks)) {
+        expressionPrintout.addRow({ std::to_string(ticks), formatShare(ticks), String(expression) });
+    }
+    expressionPrintout.print(output);
+}
+
+void dumpCompileStats(const CompileStats& stats, std::ostream& output) {
+    TabulatedPrintout<7> printout;
+    printout.addRow(
+        { "pass", "time [ms]", "terms in", "terms out", "merge lookups", "merge hits", "instructions" });
+    for (const CompileStats::Pass& pass : stats.passes) {
+        const double hitRate = pass.mergeLookups ? double(pass.mergeHits) / double(pass.mergeLookups) : 0.0;
+        printout.addRow({ pass.name,
+                          std::format("{:.3f}", 1e3 * pass.duration),
+                          std::to_string(pass.termsIn),
+                          std::to_string(pass.termsOut),
+                          std::to_string(pass.mergeLookups),
+                          std::format("{} ({:.1f}%)", pass.mergeHits, 100.0 * hitRate),
+                          std::to_string(pass.instructionCount) });
+    }
+    printout.print(output);
+    output << std::format("Total: {:.3f} ms", 1e3 * stats.duration) << std::endl;
+}
+
+void writeCompileTrace(const CompileStats& stats, std::ostream& output) {
+    // Note: The names of the passes are plain identifiers and template arguments, i.e. need no escaping.
+    output << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    for (size_t i = 0; i < stats.passes.size(); ++i) {
+        const CompileStats::Pass& pass = stats.passes[i];
+        output << (i > 0 ? ",\n" : "\n");
+        output << std::format("  {{\"name\": \"{}\", \"cat\": \"compile\", \"ph\": \"X\", \"pid\": 1, "
+                              "\"tid\": 1, \"ts\": {:.3f}, \"dur\": {:.3f}, \"args\": {{\"termsIn\": {}, "
+                              "\"termsOut\": {}, \"mergeLookups\": {}, \"mergeHits\": {}, "
+                              "\"instructions\": {}}}}}",
+                              pass.name,
+                              1e6 * pass.start,
+                              1e6 * pass.duration,
+                              pass.termsIn,
+                              pass.termsOut,
+                              pass.mergeLookups,
+                              pass.mergeHits,
+                              pass.instructionCount);
+    }
+    output << "\n]}\n";
 }
 
 SIXPACK_NAMESPACE_END
@@ -1,5 +1,6 @@
 #pragma once
 #include "Common.h"
+#include "Program.h"
 
 SIXPACK_NAMESPACE_BEGIN
 
@@ -10,7 +11,7 @@ namespace asg {
     class Term;
 }
 class Expression;
-class Program;
+struct CompileStats;
 
 enum class Notation {
     INFIX,  ///< The infix (algebraic) notation.
@@ -26,6 +27,24 @@ void dumpSyntaxTree(const Expression& expression, std::ostream& output, bool inc
 
 void dumpSemanticGraph(const asg::Term& root, std::ostream& output);
 
-void dumpProgram(const Program& program, std::ostream& output);
+/// Prints the instructions of the program, optionally followed by its analysis (on the generic cost model).
+void dumpProgram(const Program& program, std::ostream& output, bool withAnalysis = false);
+
+/// Prints the instruction counts by opcode, the critical path, the parallelism, the peak of the live memory,
+/// and the estimated cycles and sizes of the scalar and vector executables.
+void dumpAnalysis(const Program::Analysis& analysis, std::ostream& output);
+
+/// Prints the cost of the profiled program by opcode, by instruction and by source expression (i.e. by the
+/// comments of the program). The instructions without a comment are charged to the expression of their first
+/// commented consumer.
+void dumpProfile(const Program& program, const Program::Profile& profile, std::ostream& output);
+
+/// Prints the wall time, the term counts (in and out), the merge hit rate and the instruction count of each
+/// pass of the compilation.
+void dumpCompileStats(const CompileStats& stats, std::ostream& output);
+
+/// Writes the passes of the compilation as Chrome trace events (JSON), e.g. to be viewed in Perfetto or in
+/// `chrome://tracing`. The counts of each pass are its arguments.
+void writeCompileTrace(const CompileStats& stats, std::ostream& output);
 
 SIXPACK_NAMESPACE_END
@@ -0,0 +1,177 @@
+#include "ColumnarBatch.h"
+#include "Exception.h"
+#include "MappedFile.h"
+#include "Program.h"
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <vector>
+using namespace sixpack;
+
+static int failureCount = 0;
+
+static void check(bool condition, StringView description) {
+    std::cout << (condition ? "[ OK ] " : "[FAIL] ") << description << std::endl;
+    if (!condition) {
+        ++failureCount;
+    }
+}
+
+/// The buffer of a batch, aligned to `ColumnarBatch::ALIGNMENT`.
+class BatchBuffer {
+    struct alignas(ColumnarBatch::ALIGNMENT) Chunk {
+        std::byte bytes[ColumnarBatch::ALIGNMENT];
+    };
+
+    std::vector<Chunk> mChunks;
+    size_t             mSize;
+
+public:
+    explicit BatchBuffer(std::span<const std::byte> bytes)
+        : mChunks((bytes.size() + ColumnarBatch::ALIGNMENT - 1) / ColumnarBatch::ALIGNMENT)
+        , mSize(bytes.size()) {
+        std::memcpy(mChunks.data(), bytes.data(), bytes.size());
+    }
+
+    std::span<std::byte> bytes() { return { mChunks.front().bytes, mSize }; }
+};
+
+/// The value of the row of the column, distinct for each of them.
+static Real valueOf(size_t column, size_t row) {
+    return Real(column) * 1000.0 + Real(row) * 0.5 - 7.25;
+}
+
+/// Returns the message of the failure to make a view of the batch (or an empty string).
+static String viewError(std::span<const std::byte> bytes) {
+    try {
+        const ColumnarBatch batch(bytes);
+        return "";
+    } catch (const Exception& exception) {
+        return exception.message();
+    }
+}
+
+/// Returns the message of the failure to map the file (or an empty string).
+static String mapError(const std::filesystem::path& path) {
+    try {
+        const MappedFile file(path.string());
+        return "";
+    } catch (const Exception& exception) {
+        return exception.message();
+    }
+}
+
+static void writeFile(const std::filesystem::path& path, std::span<const std::byte> bytes) {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+}
+
+/// Writes the batch into the mapped file, maps it back for reading and compares the columns.
+static void checkRoundTrip(const std::filesystem::path& path,
+                           const std::vector<String>&   names,
+                           size_t                       rowCount) {
+    {
+        MappedFile          file(path.string(), ColumnarBatch::computeSize(names.size(), rowCount));
+        const ColumnarBatch batch = ColumnarBatch::format(file.writableData(), names, rowCount);
+        for (size_t column = 0; column < names.size(); ++column) {
+            for (size_t row = 0; row < rowCount; ++row) {
+                batch.writableColumn(column)[row] = valueOf(column, row);
+            }
+        }
+        file.flush();
+    }
+
+    const MappedFile    file(path.string());
+    const ColumnarBatch batch(file.data());
+    bool                same = batch.columnCount() == names.size() && batch.rowCount() == rowCount;
+    for (size_t column = 0; same && column < names.size(); ++column) {
+        same = batch.columnName(column) == names[column] && batch.writableColumn(column) == nullptr;
+        same = same && batch.findColumn(names[column]) == ptrdiff_t(column) &&
+               reinterpret_cast<uintptr_t>(batch.column(column)) % ColumnarBatch::ALIGNMENT == 0;
+        for (size_t row = 0; row < rowCount; ++row) {
+            same = same && batch.column(column)[row] == valueOf(column, row);
+        }
+    }
+    check(same && batch.size() == file.size() && batch.findColumn("missing") == -1,
+          std::format("{} columns of {} rows round-tripped through the file", names.size(), rowCount));
+}
+
+/// Round-trips the batches of several columns, with the row counts around the vector width (i.e. with the
+/// columns padded to the alignment).
+static void testRoundTrips(const std::filesystem::path& path) {
+    static constexpr size_t   SIZE  = Program::Vector::SIZE;
+    const std::vector<String> names = { "x", "y", String(ColumnarBatch::MAX_NAME_LENGTH, 'z') };
+    for (const size_t rowCount : { size_t(0), size_t(1), SIZE - 1, SIZE + 1, 3 * SIZE + 1, size_t(1001) }) {
+        for (const size_t columnCount : { 1, 2, 3 }) {
+            checkRoundTrip(path, { names.begin(), names.begin() + ptrdiff_t(columnCount) }, rowCount);
+        }
+    }
+}
+
+/// Rejects the truncated and the corrupted copies of a valid batch.
+static void testRejection(const std::filesystem::path& path) {
+    static constexpr size_t ROW_COUNT = 64;
+    checkRoundTrip(path, { "x" }, ROW_COUNT);
+    const MappedFile file(path.string());
+    BatchBuffer      valid(file.data());
+    check(viewError(valid.bytes()).empty(), "Copy of the batch accepted");
+
+    bool allThrown = true;
+    for (size_t size = 0; size < valid.bytes().size(); size += 8) {
+        allThrown = allThrown && !viewError(valid.bytes().first(size)).empty();
+    }
+    check(allThrown, "All the truncations throw");
+
+    const std::filesystem::path truncatedPath = path.string() + ".truncated";
+    writeFile(truncatedPath, file.data().first(file.size() - sizeof(Real)));
+    {
+        const MappedFile truncated(truncatedPath.string());
+        check(viewError(truncated.data()) == "The column 'x' is out of the batch", "Truncated file throws");
+    }
+    std::filesystem::remove(truncatedPath);
+
+    BatchBuffer wrongMagic(file.data());
+    wrongMagic.bytes()[0] = std::byte('X');
+    check(viewError(wrongMagic.bytes()) == "Not a columnar batch", "Wrong magic throws");
+
+    // Note: The descriptors of two columns still fit into the batch, i.e. only the layout is wrong then.
+    for (const uint64_t columnCount : { 2, 100 }) {
+        BatchBuffer mismatch(file.data());
+        reinterpret_cast<ColumnarBatch::Header*>(mismatch.bytes().data())->columnCount = columnCount;
+        check(!viewError(mismatch.bytes()).empty(),
+              std::format("Column count {} instead of 1 throws", columnCount));
+    }
+}
+
+/// Maps an empty and a missing file.
+static void testFiles(const std::filesystem::path& directory) {
+    const std::filesystem::path emptyPath = directory / "empty.bin";
+    writeFile(emptyPath, {});
+    {
+        const MappedFile empty(emptyPath.string());
+        check(empty.size() == 0 && empty.data().empty(), "Empty file mapped");
+        check(viewError(empty.data()) == "Not a columnar batch", "Empty file is not a batch");
+    }
+
+    const std::filesystem::path missingPath = directory / "missing.bin";
+    check(mapError(missingPath).starts_with("Cannot open"), "Missing file throws");
+}
+
+int main() {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "sixpack-batch-test";
+    try {
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        testRoundTrips(directory / "batch.bin");
+        testRejection(directory / "batch.bin");
+        testFiles(directory);
+    } catch (const Exception& exception) {
+        std::cerr << std::format("Unhandled exception: {}.", exception.message()) << std::endl;
+        return 1;
+    }
+    std::filesystem::remove_all(directory);
+    std::cout << std::endl << std::format("{} failure(s).", failureCount) << std::endl;
+    return failureCount == 0 ? 0 : 1;
+}
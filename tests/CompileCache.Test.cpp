@@ -0,0 +1,126 @@
+#include "CompileCache.h"
+#include "Compiler.h"
+#include "Exception.h"
+#include "Program.h"
+#include <atomic>
+#include <format>
+#include <iostream>
+#include <thread>
+#include <vector>
+using namespace sixpack;
+
+static int failureCount = 0;
+
+static void check(bool condition, StringView description) {
+    std::cout << (condition ? "[ OK ] " : "[FAIL] ") << description << std::endl;
+    if (!condition) {
+        ++failureCount;
+    }
+}
+
+static Real identity(Real x) {
+    return x;
+}
+
+static Real negation(Real x) {
+    return -x;
+}
+
+static std::atomic<bool> failing = true;
+
+/// Fails while `failing` is set, i.e. fails the compilations folding a call of it.
+static Real fragile(Real x) {
+    if (failing) {
+        throw Exception("Fragile function failed");
+    }
+    return x;
+}
+
+static void setUp(Compiler& compiler, StringView script, RealFunction function) {
+    compiler.addFunction("f", function);
+    compiler.addSourceScript(script);
+}
+
+static String describe(const CompileCache& cache) {
+    const CompileCache::Statistics statistics = cache.statistics();
+    return std::format("hits {}, misses {}, evictions {}, size {}",
+                       statistics.hits,
+                       statistics.misses,
+                       statistics.evictions,
+                       statistics.size);
+}
+
+static void test() {
+    CompileCache cache(2);
+    Compiler     compiler, spaced, rebound, other;
+    setUp(compiler, "input x\noutput y = f(x)*2 + 1\n", &identity);
+    setUp(spaced, "input  x\noutput y =f( x ) * 2 +1\n", &identity);
+    setUp(rebound, "input x\noutput y = f(x)*2 + 1\n", &negation);
+    setUp(other, "input x\noutput y = f(x)*3\n", &identity);
+
+    // The concurrent requests of equivalent compilers (up to the whitespace) are compiled once.
+    std::vector<std::shared_ptr<const Program>> programs(8);
+    std::vector<std::thread>                    threads;
+    for (size_t i = 0; i < programs.size(); ++i) {
+        threads.emplace_back([&, i] { programs[i] = cache.compile(i % 2 == 0 ? compiler : spaced); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    bool same = true;
+    for (const auto& program : programs) {
+        same = same && program && program == programs.front();
+    }
+    CompileCache::Statistics statistics = cache.statistics();
+    check(same && statistics.misses == 1 && statistics.hits == 7 && statistics.size == 1,
+          std::format("8 concurrent requests -> {}", describe(cache)));
+
+    // The same names bound to other functions make other programs.
+    const auto reboundProgram = cache.compile(rebound);
+    check(reboundProgram != programs.front() && cache.statistics().misses == 2,
+          std::format("Other function -> {}", describe(cache)));
+
+    // The least recently used program is evicted, i.e. `rebound` (as `compiler` was used later).
+    cache.compile(compiler);
+    cache.compile(other);
+    const auto recompiled = cache.compile(rebound);
+    statistics            = cache.statistics();
+    check(recompiled != reboundProgram && statistics.misses == 4 && statistics.evictions == 2 &&
+              statistics.size == 2,
+          std::format("Eviction -> {}", describe(cache)));
+
+    // The failed compilations are not cached.
+    Compiler failingCompiler;
+    setUp(failingCompiler, "output y = f(2)\n", &fragile);
+    size_t failedCount = 0;
+    for (int i = 0; i < 2; ++i) {
+        try {
+            cache.compile(failingCompiler);
+        } catch (const Exception&) {
+            ++failedCount;
+        }
+    }
+    failing                                = false;
+    const auto                  repaired   = cache.compile(failingCompiler);
+    Executable<Program::Scalar> executable = repaired->makeScalarExecutable();
+    executable.run();
+    check(failedCount == 2 && cache.statistics().misses == 7 &&
+              executable.memory()[repaired->getOutputAddress("y")] == 2.0,
+          std::format("Failed compilations -> {}", describe(cache)));
+
+    cache.clear();
+    cache.compile(compiler);
+    check(cache.statistics().size == 1 && cache.statistics().misses == 8,
+          std::format("Cleared -> {}", describe(cache)));
+}
+
+int main() {
+    try {
+        test();
+    } catch (const Exception& exception) {
+        std::cerr << std::format("Unhandled exception: {}.", exception.message()) << std::endl;
+        return 1;
+    }
+    std::cout << std::endl << std::format("{} failure(s).", failureCount) << std::endl;
+    return failureCount == 0 ? 0 : 1;
+}
@@ -1,11 +1,18 @@
 #include "Compiler.h"
+#include "Asg.h"
 #include "Exception.h"
+#include "Expression.h"
 #include "Program.h"
 #include "Utilities.h"
+#include <algorithm>
 #include <cmath>
 #include <format>
 #include <iostream>
+#include <limits>
 #include <numbers>
+#include <set>
+#include <sstream>
+#include <tuple>
 using namespace sixpack;
 
 static constexpr StringView SOURCE = R"SOURCE(### Kerr Metric ###
@@ -51,6 +58,723 @@ static void printSection(StringView title) {
     std::cout << std::endl << "-- " << title << " " << std::string(120 - title.size(), '-') << std::endl;
 }
 
+static int failureCount = 0;
+
+static void check(bool condition, StringView description) {
+    std::cout << (condition ? "[ OK ] " : "[FAIL] ") << description << std::endl;
+    if (!condition) {
+        ++failureCount;
+    }
+}
+
+static bool isSame(Real x, Real y) {
+    return x == y || (x != x && y != y);
+}
+
+static size_t countOpcodes(const Program& program, std::initializer_list<Program::Opcode> opcodes) {
+    return size_t(std::ranges::count_if(program.instructions().instructions, [&](const auto& instruction) {
+        return std::ranges::find(opcodes, instruction.opcode) != opcodes.end();
+    }));
+}
+
+/// The tolerance of the evaluation, i.e. the values within either of the bounds are accepted.
+struct Tolerance {
+    Real absolute = 0.0;
+    Real relative = 0.0;
+};
+
+static bool isWithin(Real x, Real expected, Tolerance tolerance) {
+    const Real difference = std::abs(x - expected);
+    return isSame(x, expected) || difference <= tolerance.absolute ||
+           difference <= tolerance.relative * std::abs(expected);
+}
+
+/// The points of the inputs `x` and `y` of `checkEvaluation`, including the signed zeros, the infinities, NaN
+/// and the boundaries of the tabulated domain.
+static constexpr std::pair<Real, Real> EVALUATION_POINTS[] = {
+    { 0.5, 2.0 },
+    { -1.25, 0.75 },
+    { 3.0, -4.0 },
+    { 0.0, -0.0 },
+    { -0.0, 1.0 },
+    { -7.5, 2.0 },
+    { 1.75, -1.75 },
+    { 1e300, 1e300 },
+    { -2.0, 0.0 },
+    { std::numeric_limits<Real>::quiet_NaN(), 1.0 },
+    { 1.0, std::numeric_limits<Real>::quiet_NaN() },
+    { std::numeric_limits<Real>::infinity(), -2.0 },
+    { -1.0, -std::numeric_limits<Real>::infinity() },
+    { 0.1, -0.3 },
+    { -1.999, 1.999 },
+    { 2.0, 5.5 },
+};
+
+/// Evaluates the output `o` by the scalar and the vector executables at the points of the inputs `x` and `y`
+/// (where used), checking it against the reference evaluation.
+template <typename Reference>
+static void checkEvaluation(const Program&   program,
+                            StringView       description,
+                            const Reference& reference,
+                            Tolerance        tolerance = {}) {
+    const auto xInput = program.inputs().find("x");
+    const auto yInput = program.inputs().find("y");
+    const auto output = program.getOutputAddress("o");
+
+    Executable<Program::Scalar> scalar       = program.makeScalarExecutable();
+    Executable<Program::Vector> vector       = program.makeVectorExecutable();
+    bool                        scalarPassed = true;
+    bool                        vectorPassed = true;
+    for (size_t first = 0; first < std::size(EVALUATION_POINTS); first += Program::Vector::SIZE) {
+        for (int lane = 0; lane < Program::Vector::SIZE; ++lane) {
+            const auto [x, y] = EVALUATION_POINTS[(first + lane) % std::size(EVALUATION_POINTS)];
+            if (xInput != program.inputs().end()) {
+                vector.memory()[xInput->second][lane] = x;
+            }
+            if (yInput != program.inputs().end()) {
+                vector.memory()[yInput->second][lane] = y;
+            }
+        }
+        vector.run();
+        for (int lane = 0; lane < Program::Vector::SIZE; ++lane) {
+            const auto [x, y] = EVALUATION_POINTS[(first + lane) % std::size(EVALUATION_POINTS)];
+            if (xInput != program.inputs().end()) {
+                scalar.memory()[xInput->second] = x;
+            }
+            if (yInput != program.inputs().end()) {
+                scalar.memory()[yInput->second] = y;
+            }
+            scalar.run();
+            const Real expected = reference(x, y);
+            scalarPassed = scalarPassed && isWithin(scalar.memory()[output], expected, tolerance);
+            vectorPassed = vectorPassed && isWithin(vector.memory()[output][lane], expected, tolerance);
+        }
+    }
+    check(scalarPassed, std::format("{} by the scalar executable", description));
+    check(vectorPassed, std::format("{} by the vector executable", description));
+}
+
+static constexpr StringView SELECTION_SOURCE = R"SOURCE(
+input  c
+input  x
+input  y
+output lt     = x < y
+output le     = x <= y
+output gt     = x > y
+output ge     = x >= y
+output eq     = x == y
+output ne     = x != y
+output select = if(c, x, y)
+output nested = if(x < y, 2*x, if(x == y, 0, -y))
+)SOURCE";
+
+/// Compiles the expression of `x`, checking its value (at 0.5) and the number of the selections left (as well
+/// as of the comparisons).
+static void checkFolding(StringView body, StringView description, Real expectedValue, size_t expectedCount) {
+    Compiler compiler;
+    compiler.addFunction("sin", &std::sin);
+    compiler.addVariable("x");
+    compiler.addExpression("o", body, Compiler::Visibility::PUBLIC);
+    const Program program = compiler.compile();
+
+    Executable<Program::Scalar> executable = program.makeScalarExecutable();
+    executable.memory()[program.getInputAddress("x")] = 0.5;
+    executable.run();
+    const Real   value        = executable.memory()[program.getOutputAddress("o")];
+    const size_t selectCount  = countOpcodes(program, { Program::Opcode::SELECT });
+    const size_t compareCount = countOpcodes(program,
+                                             { Program::Opcode::CMP_LT,
+                                               Program::Opcode::CMP_LE,
+                                               Program::Opcode::CMP_EQ,
+                                               Program::Opcode::CMP_NE });
+    check(selectCount == expectedCount && compareCount == expectedCount && value == expectedValue,
+          std::format("{:34} -> {} ({})", body, value, description));
+}
+
+/// Evaluates the comparisons and the selections by the scalar and the vector executables.
+static void testSelection() {
+    printSection("Comparisons and Selections");
+    static constexpr Real NaN = std::numeric_limits<Real>::quiet_NaN();
+
+    struct Case {
+        Real c, x, y;
+    };
+    // Note: Any non-zero condition (including NaN) selects the first arm, any comparison with NaN is false
+    //       except `!=`.
+    static constexpr Case CASES[] = {
+        { 1.0, 1.0, 2.0 }, { 0.0, 2.0, 2.0 }, { NaN, 3.0, 1.0 },    { -0.0, 1.0, 2.0 },
+        { 0.0, NaN, 1.0 }, { 2.0, NaN, NaN }, { -1.0, -4.0, -5.0 }, { 0.5, 5.0, 5.0 },
+    };
+    const auto expected = [](const Case& point) -> std::vector<Real> {
+        const auto [c, x, y] = point;
+        return { Real(x < y),  Real(x <= y), Real(x > y),    Real(x >= y),
+                 Real(x == y), Real(x != y), c != 0 ? x : y, x < y ? 2 * x : (x == y ? 0.0 : -y) };
+    };
+    static constexpr StringView OUTPUTS[] = { "lt", "le", "gt", "ge", "eq", "ne", "select", "nested" };
+
+    Compiler compiler;
+    compiler.addSourceScript(SELECTION_SOURCE);
+    const Program program = compiler.compile();
+
+    Executable<Program::Scalar> scalar       = program.makeScalarExecutable();
+    Executable<Program::Vector> vector       = program.makeVectorExecutable();
+    bool                        scalarPassed = true;
+    bool                        vectorPassed = true;
+    for (size_t first = 0; first < std::size(CASES); first += Program::Vector::SIZE) {
+        for (int lane = 0; lane < Program::Vector::SIZE; ++lane) {
+            const Case& point = CASES[(first + lane) % std::size(CASES)];
+            vector.memory()[program.getInputAddress("c")][lane] = point.c;
+            vector.memory()[program.getInputAddress("x")][lane] = point.x;
+            vector.memory()[program.getInputAddress("y")][lane] = point.y;
+        }
+        vector.run();
+        for (int lane = 0; lane < Program::Vector::SIZE; ++lane) {
+            const Case&             point  = CASES[(first + lane) % std::size(CASES)];
+            const std::vector<Real> values = expected(point);
+            scalar.memory()[program.getInputAddress("c")] = point.c;
+            scalar.memory()[program.getInputAddress("x")] = point.x;
+            scalar.memory()[program.getInputAddress("y")] = point.y;
+            scalar.run();
+            for (size_t i = 0; i < std::size(OUTPUTS); ++i) {
+                const Program::Address address = program.getOutputAddress(OUTPUTS[i]);
+                scalarPassed = scalarPassed && isSame(scalar.memory()[address], values[i]);
+                vectorPassed = vectorPassed && isSame(vector.memory()[address][lane], values[i]);
+            }
+        }
+    }
+    check(scalarPassed, "CMP_* and SELECT by the scalar executable");
+    check(vectorPassed, "CMP_* and SELECT by the vector executable");
+
+    // The constant conditions and the identical arms are folded, i.e. no selection is left.
+    checkFolding("if(1 < 2, x, 2*x)", "constant true condition", 0.5, 0);
+    checkFolding("if(2 <= 1, x, 2*x)", "constant false condition", 1.0, 0);
+    checkFolding("if(0, x, 3)", "zero condition", 3.0, 0);
+    checkFolding("if(x < 1, sin(x), sin(x))", "identical arms", std::sin(0.5), 0);
+    checkFolding("if(x < 1, sin(x), 2)", "variable condition", std::sin(0.5), 1);
+}
+
+static Real wave(Real x) {
+    return std::exp(-x * x) * std::cos(3 * x);
+}
+
+/// Evaluates the tabulated function, both within its domain and outside (i.e. by the function itself).
+static void testTabulation() {
+    printSection("Tabulated Functions");
+    static constexpr Real TOLERANCE = 1e-9;
+
+    Compiler compiler;
+    compiler.addFunction("wave", &wave, { -2.0, 2.0 }, TOLERANCE);
+    compiler.addVariable("x");
+    compiler.addExpression("o", "wave(x)", Compiler::Visibility::PUBLIC);
+    const Program program = compiler.compile();
+    check(countOpcodes(program, { Program::Opcode::TABLE_LOOKUP }) == 1, "wave(x) -> TABLE_LOOKUP");
+    checkEvaluation(program, "TABLE_LOOKUP", [](Real x, Real) { return wave(x); }, { .absolute = TOLERANCE });
+
+    // Note: The constant arguments are folded by the function itself (rather than by the table).
+    Compiler constantCompiler;
+    constantCompiler.addFunction("wave", &wave, { -2.0, 2.0 }, TOLERANCE);
+    constantCompiler.addVariable("x");
+    constantCompiler.addExpression("o", "wave(0.5) + x", Compiler::Visibility::PUBLIC);
+    const Program constantProgram = constantCompiler.compile();
+    check(countOpcodes(constantProgram, { Program::Opcode::TABLE_LOOKUP }) == 0, "wave(0.5) is folded");
+    checkEvaluation(constantProgram, "Folded wave(0.5)", [](Real x, Real) { return wave(0.5) + x; });
+}
+
+static Real cube(Real x) {
+    return x * x * x;
+}
+
+static size_t batchCallCount  = 0;
+static size_t batchPointCount = 0;
+
+static void cubeBatch(const Real* input, Real* output, size_t count) {
+    ++batchCallCount;
+    batchPointCount += count;
+    for (size_t i = 0; i < count; ++i) {
+        output[i] = cube(input[i]);
+    }
+}
+
+/// Evaluates the batch calls, which take the whole vector word by a single call.
+static void testBatchCalls() {
+    printSection("Batch Functions");
+    Compiler compiler;
+    compiler.addFunction("cube", &cube, &cubeBatch);
+    compiler.addVariable("x");
+    compiler.addVariable("y");
+    compiler.addExpression("o", "cube(x) - 2*cube(y)", Compiler::Visibility::PUBLIC);
+    const Program program = compiler.compile();
+    check(countOpcodes(program, { Program::Opcode::CALL_BATCH }) == 2, "cube(x), cube(y) -> CALL_BATCH");
+    checkEvaluation(program, "CALL_BATCH", [](Real x, Real y) { return cube(x) - 2 * cube(y); });
+
+    batchCallCount  = 0;
+    batchPointCount = 0;
+    Executable<Program::Vector> vector = program.makeVectorExecutable();
+    vector.run();
+    check(batchCallCount == 2 && batchPointCount == 2 * Program::Vector::SIZE,
+          std::format("{} batch calls of {} points per vector run", batchCallCount, batchPointCount));
+    Executable<Program::Scalar> scalar = program.makeScalarExecutable();
+    scalar.run();
+    check(batchCallCount == 4 && batchPointCount == 2 * Program::Vector::SIZE + 2,
+          "One point per batch call of the scalar run");
+
+    // Note: The constant arguments are folded by the scalar function.
+    Compiler constantCompiler;
+    constantCompiler.addFunction("cube", &cube, &cubeBatch);
+    constantCompiler.addVariable("x");
+    constantCompiler.addExpression("o", "cube(1.5)*x", Compiler::Visibility::PUBLIC);
+    const Program constantProgram = constantCompiler.compile();
+    check(countOpcodes(constantProgram, { Program::Opcode::CALL_BATCH }) == 0, "cube(1.5) is folded");
+    checkEvaluation(constantProgram, "Folded cube(1.5)", [](Real x, Real) { return cube(1.5) * x; });
+}
+
+static Real mix(Real x, Real y) {
+    return 0.25 * x + 0.75 * y;
+}
+
+/// Compiles `o = name(x, y)` of the binary function, checking the opcode and the values.
+static void checkBinaryFunction(StringView         name,
+                                BinaryRealFunction function,
+                                Program::Opcode    opcode,
+                                StringView         opcodeName,
+                                MathAccuracy       accuracy  = MathAccuracy::ULP_1,
+                                Tolerance          tolerance = {}) {
+    Compiler compiler;
+    compiler.addFunction(name, function);
+    compiler.setMathAccuracy(accuracy);
+    compiler.addVariable("x");
+    compiler.addVariable("y");
+    compiler.addExpression("o", std::format("{}(x, y)", name), Compiler::Visibility::PUBLIC);
+    const Program program = compiler.compile();
+    check(countOpcodes(program, { opcode }) == 1, std::format("{}(x, y) -> {}", name, opcodeName));
+    checkEvaluation(program, opcodeName, [&](Real x, Real y) { return function(x, y); }, tolerance);
+}
+
+/// Evaluates the binary intrinsics and the calls of the other binary functions.
+static void testBinaryFunctions() {
+    printSection("Binary Functions");
+    using enum Program::Opcode;
+    checkBinaryFunction("atan2", &std::atan2, ATAN2, "ATAN2");
+    checkBinaryFunction("hypot", &std::hypot, HYPOT, "HYPOT");
+    checkBinaryFunction("min", &std::fmin, MIN, "MIN");
+    checkBinaryFunction("max", &std::fmax, MAX, "MAX");
+    checkBinaryFunction("fmod", &std::fmod, FMOD, "FMOD");
+    checkBinaryFunction("copysign", &std::copysign, COPYSIGN, "COPYSIGN");
+    checkBinaryFunction("mix", &mix, CALL_BINARY, "CALL_BINARY");
+
+    // The reduced-accuracy kernels
+    for (const auto& [accuracy, bound, tier] : { std::tuple{ MathAccuracy::REL_1E6, 1e-6, "REL_1E6" },
+                                                 std::tuple{ MathAccuracy::REL_1E3, 1e-3, "REL_1E3" } }) {
+        checkBinaryFunction(
+            "atan2", &std::atan2, ATAN2, std::format("ATAN2 ({})", tier), accuracy, { .relative = bound });
+        checkBinaryFunction(
+            "hypot", &std::hypot, HYPOT, std::format("HYPOT ({})", tier), accuracy, { .relative = bound });
+    }
+}
+
+/// Returns whether compiling the fused scripts throws `CompileException`.
+static bool isFusionRejected(const std::vector<Compiler::Script>& scripts) {
+    try {
+        Compiler::compileFused(scripts);
+        return false;
+    } catch (const CompileException&) {
+        return true;
+    }
+}
+
+/// Fuses two scripts sharing an input and a subexpression, comparing the outputs with the separate programs.
+static void testFusion() {
+    printSection("Fused Scripts");
+    Compiler first;
+    first.addFunction("sin", &std::sin);
+    first.addSourceScript(R"(
+input  x
+input  y
+output s = x + y
+output t = sin(y)*x
+)");
+    Compiler second;
+    second.addFunction("sin", &std::sin);
+    second.addSourceScript(R"(
+input  y
+input  z
+param  k = 3
+output s = y - z
+output u = sin(y)*z + k
+)");
+    const Program fused = Compiler::compileFused({ { "a", &first }, { "b", &second } });
+
+    std::vector<String> outputs;
+    for (const auto& [name, _] : fused.outputs()) {
+        outputs.push_back(name);
+    }
+    std::ranges::sort(outputs);
+    check(outputs == std::vector<String>{ "a.s", "a.t", "b.s", "b.u" }, "Outputs a.s, a.t, b.s, b.u");
+    check(fused.inputs().size() == 3 && fused.inputs().contains("x") && fused.inputs().contains("y") &&
+              fused.inputs().contains("z"),
+          "Inputs x, y (shared) and z");
+    check(countOpcodes(fused, { Program::Opcode::SIN }) == 1, "sin(y) shared by the scripts");
+
+    const Program               firstProgram    = first.compile();
+    const Program               secondProgram   = second.compile();
+    Executable<Program::Scalar> fusedExecution  = fused.makeScalarExecutable();
+    Executable<Program::Scalar> firstExecution  = firstProgram.makeScalarExecutable();
+    Executable<Program::Scalar> secondExecution = secondProgram.makeScalarExecutable();
+
+    const auto isSameOutputs = [&](const Program& program, const auto& execution, StringView script) {
+        bool result = true;
+        for (const auto& [name, address] : program.outputs()) {
+            const Program::Address fusedAddress = fused.getOutputAddress(std::format("{}.{}", script, name));
+            result = result && isSame(fusedExecution.memory()[fusedAddress], execution.memory()[address]);
+        }
+        return result;
+    };
+    bool passed = true;
+    for (const auto& [x, y] : EVALUATION_POINTS) {
+        const Real z = x - 2 * y;
+        fusedExecution.memory()[fused.getInputAddress("x")]          = x;
+        fusedExecution.memory()[fused.getInputAddress("y")]          = y;
+        fusedExecution.memory()[fused.getInputAddress("z")]          = z;
+        firstExecution.memory()[firstProgram.getInputAddress("x")]   = x;
+        firstExecution.memory()[firstProgram.getInputAddress("y")]   = y;
+        secondExecution.memory()[secondProgram.getInputAddress("y")] = y;
+        secondExecution.memory()[secondProgram.getInputAddress("z")] = z;
+        fusedExecution.run();
+        firstExecution.run();
+        secondExecution.run();
+        passed = passed && isSameOutputs(firstProgram, firstExecution, "a") &&
+                 isSameOutputs(secondProgram, secondExecution, "b");
+    }
+    check(passed, "Fused outputs same as those of the separate programs");
+
+    check(isFusionRejected({ { "a", &first }, { "a", &second } }), "Duplicate script names rejected");
+    Compiler dotted;
+    dotted.addVariable("x");
+    dotted.addExpression("c", "x", Compiler::Visibility::PUBLIC);
+    Compiler nested;
+    nested.addVariable("x");
+    nested.addExpression("b.c", "2*x", Compiler::Visibility::PUBLIC);
+    check(isFusionRejected({ { "a.b", &dotted }, { "a", &nested } }), "Colliding output names rejected");
+}
+
+/// Makes the chain of the terms `a(i) = a(i-1)*a(i-1) + i` of the given leaf, i.e. with the keys doubling.
+static const asg::Term* makeChainTerm(asg::Arena& arena, int length, const asg::Term* leaf) {
+    const asg::Term* term = leaf;
+    for (int i = 1; i <= length; ++i) {
+        auto* product = arena.make<asg::Multiplication>(arena.make<asg::Constant>(1.0));
+        product->addPositiveTerm(term);
+        product->addPositiveTerm(term);
+        auto* sum = arena.make<asg::Addition>(arena.make<asg::Constant>(Real(i)));
+        sum->addPositiveTerm(product);
+        term = sum;
+    }
+    return term;
+}
+
+/// Compares the terms of the long keys, replaced by their digests.
+static void testDigestKeys() {
+    printSection("Digest Keys");
+    asg::Arena       arena;
+    const auto*      x     = arena.make<asg::Input>("x");
+    const asg::Term* chain = makeChainTerm(arena, 12, x);
+    const asg::Term* same  = makeChainTerm(arena, 12, arena.make<asg::Input>("x"));
+    const asg::Term* other = makeChainTerm(arena, 12, arena.make<asg::Input>("y"));
+    check(chain->key().size() <= asg::Term::MAX_KEY_SIZE && chain->key().find('#') != StringView::npos,
+          std::format("Key {}", chain->key()));
+    check(chain->key() == same->key() && chain->isEquivalent(*same), "Equal structures are equivalent");
+    check(chain->key() != other->key() && !chain->isEquivalent(*other),
+          "Other structures are not equivalent");
+    check(!makeChainTerm(arena, 4, x)->isEquivalent(*makeChainTerm(arena, 4, arena.make<asg::Input>("y"))),
+          "Other short structures are not equivalent");
+}
+
+static constexpr StringView SHARED_SOURCE = R"SOURCE(
+input  x
+input  y
+       s = x*y + 1
+output p = +s * y
+output q = sin(s) - s/y
+)SOURCE";
+
+/// Checks that the term of an expression symbol, shared by all its uses, is commented by its expression.
+static void testSharedComments() {
+    printSection("Shared Comments");
+    Compiler compiler;
+    compiler.addFunction("sin", &std::sin);
+    compiler.addSourceScript(SHARED_SOURCE);
+    const Program program = compiler.compile();
+
+    size_t expressionComments = 0;
+    bool   useComments        = false;
+    for (const auto& [address, comment] : program.comments()) {
+        expressionComments += comment == "'x*y + 1'" ? 1 : 0;
+        useComments         = useComments || comment == "'s'" || comment == "'+s'";
+    }
+    check(expressionComments == 1 && !useComments, "Shared term commented by its expression");
+}
+
+static constexpr StringView ANALYSIS_SOURCE = R"SOURCE(
+input  x
+input  y
+output a = x*y + x/y
+output b = sin(a)*y
+)SOURCE";
+
+/// Compares the analysis of a small program with the costs summed by hand from the cost tables.
+static void testAnalysis() {
+    printSection("Analysis");
+    using Opcode = Program::Opcode;
+
+    Compiler compiler;
+    compiler.addFunction("sin", &std::sin);
+    compiler.addSourceScript(ANALYSIS_SOURCE);
+    const Program program = compiler.compile();
+
+    // The code: t0 = x*y, t1 = x/y, a = t0 + t1, t3 = sin(a), b = t3*y, i.e. the critical path is
+    // DIVIDE -> ADD -> SIN -> MULTIPLY.
+    const Program::Analysis analysis = program.analyze(Program::Microarchitecture::GENERIC);
+    const size_t            dataSize = program.instructions().memoryOffset;
+    const auto&             counts   = analysis.opcodeCounts;
+    check(analysis.costModel == "generic", "Generic cost model");
+    check(analysis.instructionCount == 5 && counts[size_t(Opcode::MULTIPLY)] == 2 &&
+              counts[size_t(Opcode::DIVIDE)] == 1 && counts[size_t(Opcode::ADD)] == 1 &&
+              counts[size_t(Opcode::SIN)] == 1,
+          "Instruction mix");
+    check(analysis.criticalPathLength == 4 && analysis.averageParallelism == 1.25, "Critical path");
+    // Note: The products and the quotient are live until the sum, the sum (an output) until the end.
+    check(analysis.peakLiveWords == dataSize + 3, std::format("{} peak live words", analysis.peakLiveWords));
+    check(analysis.scalar.latencyBound == 15 + 5 + 30 + 5 &&
+              analysis.vector.latencyBound == 15 + 5 + 60 + 5,
+          "Latency bounds");
+    check(analysis.scalar.throughputBound == 1 + 5 + 1 + 18 + 1 + 5 * 3.0 &&
+              analysis.vector.throughputBound == 1 + 8 + 1 + 40 + 1 + 5 * 3.0,
+          "Throughput bounds");
+    check(analysis.scalar.cycles() == analysis.scalar.latencyBound &&
+              analysis.vector.cycles() == analysis.vector.latencyBound,
+          "Cycles bound by the latency");
+    check(analysis.scalar.codeBytes == 5 * sizeof(Executable<Program::Scalar>::Instruction) &&
+              analysis.vector.codeBytes == 5 * sizeof(Executable<Program::Vector>::Instruction) &&
+              analysis.scalar.dataBytes == (dataSize + 5) * sizeof(Program::Scalar) &&
+              analysis.vector.dataBytes == (dataSize + 5) * sizeof(Program::Vector) &&
+              analysis.tableBytes == 0,
+          "Executable sizes");
+
+    const Program::Analysis skylake = program.analyze(Program::Microarchitecture::SKYLAKE);
+    check(skylake.costModel == "skylake" && skylake.scalar.latencyBound == 14 + 4 + 28 + 4 &&
+              skylake.scalar.throughputBound == 0.5 + 4 + 0.5 + 16 + 0.5 + 5 * 2.5,
+          "Skylake bounds");
+}
+
+static constexpr StringView POINT_SOURCE = R"SOURCE(
+input  x
+input  y
+input  unused
+output arithmetic = x*y - x/y + x^3 - 1/(x - 2)
+output selection  = if(x < y, sin(x)*cos(x), exp(-x*x))
+output calls      = mix(x, y) + atan2(x, y) + log(1 + x*x) + wave(x) + cube(y)
+output input      = x
+output constant   = 2.5
+)SOURCE";
+
+/// Evaluates the point executable (with the inputs and the outputs in another order than those of the
+/// program, including the outputs copied after the run) and compares it with the scalar executable.
+static void testPointExecutable() {
+    printSection("Point Executable");
+    for (const auto& [accuracy, name] : { std::pair{ MathAccuracy::ULP_1, "ULP_1" },
+                                          std::pair{ MathAccuracy::REL_1E6, "REL_1E6" },
+                                          std::pair{ MathAccuracy::REL_1E3, "REL_1E3" } }) {
+        Compiler compiler;
+        compiler.setMathAccuracy(accuracy);
+        compiler.addFunction("sin", &std::sin);
+        compiler.addFunction("cos", &std::cos);
+        compiler.addFunction("exp", &std::exp);
+        compiler.addFunction("log", &std::log);
+        compiler.addFunction("atan2", &std::atan2);
+        compiler.addFunction("mix", &mix);
+        compiler.addFunction("wave", &wave, { -2.0, 2.0 }, 1e-9);
+        compiler.addFunction("cube", &cube, &cubeBatch);
+        compiler.addSourceScript(POINT_SOURCE);
+        const Program program = compiler.compile();
+
+        const std::vector<String> inputs  = { "y", "unused", "x" };
+        const std::vector<String> outputs = {
+            "constant", "calls", "input", "selection", "arithmetic", "calls",
+        };
+        PointExecutable             point  = program.makePointExecutable(inputs, outputs);
+        Executable<Program::Scalar> scalar = program.makeScalarExecutable();
+        bool                        passed = point.inputCount() == 3 && point.outputCount() == outputs.size();
+        for (const auto& [x, y] : EVALUATION_POINTS) {
+            const Real        pointInputs[] = { y, 7.0, x };
+            std::vector<Real> pointOutputs(outputs.size(), -1.0);
+            point.eval(pointInputs, pointOutputs);
+
+            scalar.memory()[program.getInputAddress("x")]      = x;
+            scalar.memory()[program.getInputAddress("y")]      = y;
+            scalar.memory()[program.getInputAddress("unused")] = 7.0;
+            scalar.run();
+            for (size_t i = 0; i < outputs.size(); ++i) {
+                const Real expected = scalar.memory()[program.getOutputAddress(outputs[i])];
+                passed              = passed && isSame(pointOutputs[i], expected);
+            }
+        }
+        check(passed, std::format("Same outputs as those of the scalar executable ({})", name));
+    }
+}
+
+/// Runs the profiling executables of a program, comparing them with the plain ones, and checks the counts of
+/// the instructions and the rows of the report.
+static void testProfiling() {
+    printSection("Profiling");
+    static constexpr size_t RUN_COUNT = 3;
+
+    Compiler compiler;
+    compiler.addFunction("sin", &std::sin);
+    compiler.addFunction("cos", &std::cos);
+    compiler.addFunction("exp", &std::exp);
+    compiler.addFunction("log", &std::log);
+    compiler.addFunction("atan2", &std::atan2);
+    compiler.addFunction("mix", &mix);
+    compiler.addFunction("wave", &wave, { -2.0, 2.0 }, 1e-9);
+    compiler.addFunction("cube", &cube, &cubeBatch);
+    compiler.addSourceScript(POINT_SOURCE);
+    const Program program = compiler.compile();
+
+    ProfilingExecutable<Program::Scalar> profiledScalar = program.makeProfilingExecutable<Program::Scalar>();
+    ProfilingExecutable<Program::Vector> profiledVector = program.makeProfilingExecutable<Program::Vector>();
+    Executable<Program::Scalar>          scalar         = program.makeScalarExecutable();
+    Executable<Program::Vector>          vector         = program.makeVectorExecutable();
+    bool                                 same           = true;
+    for (size_t run = 0; run < RUN_COUNT; ++run) {
+        const auto [x, y] = EVALUATION_POINTS[run];
+        for (const StringView input : { "x", "y", "unused" }) {
+            const Program::Address address = program.getInputAddress(input);
+            const Real             value   = input == "x" ? x : input == "y" ? y : 7.0;
+            profiledScalar.memory()[address] = value;
+            scalar.memory()[address]         = value;
+            profiledVector.memory()[address] = { value, -value, 2 * value, y };
+            vector.memory()[address]         = { value, -value, 2 * value, y };
+        }
+        profiledScalar.run();
+        scalar.run();
+        profiledVector.run();
+        vector.run();
+        for (const auto& [output, address] : program.outputs()) {
+            same = same && isSame(profiledScalar.memory()[address], scalar.memory()[address]);
+            for (int lane = 0; lane < Program::Vector::SIZE; ++lane) {
+                same = same && isSame(profiledVector.memory()[address][lane], vector.memory()[address][lane]);
+            }
+        }
+    }
+    check(same, "Same outputs as those of the plain executables");
+
+    const Program::Address                   codeSection = program.instructions().memoryOffset;
+    const std::vector<Program::Instruction>& code        = program.instructions().instructions;
+    const size_t executedCount = size_t(std::count_if(code.begin(), code.end(), [](const auto& instruction) {
+        return instruction.opcode != Program::Opcode::NOP;
+    }));
+    const auto checkCounts = [&](const Program::Profile& profile, StringView description) {
+        bool counted = profile.size() == executedCount;
+        for (const Program::InstructionProfile& instruction : profile) {
+            counted = counted && instruction.count == RUN_COUNT &&
+                      instruction.opcode == code[instruction.address - codeSection].opcode;
+        }
+        check(counted,
+              std::format("{} instructions counted {} times ({})", profile.size(), RUN_COUNT, description));
+    };
+    checkCounts(profiledScalar.profile(), "scalar");
+    checkCounts(profiledVector.profile(), "vector");
+
+    // Note: Each commented instruction is attributed to its own expression, the others to those of their
+    //       consumers (or to none).
+    std::set<StringView> expressions;
+    for (const Program::InstructionProfile& instruction : profiledScalar.profile()) {
+        if (const auto commentIt = program.comments().find(instruction.address);
+            commentIt != program.comments().end()) {
+            expressions.insert(commentIt->second);
+        }
+    }
+    std::stringstream report;
+    dumpProfile(program, profiledScalar.profile(), report);
+    size_t rowCount      = 0;
+    bool   inExpressions  = false;
+    for (String line; std::getline(report, line);) {
+        if (inExpressions && !line.empty() && line.find("(unattributed)") == String::npos) {
+            ++rowCount;
+        }
+        inExpressions = inExpressions || line.starts_with("ticks");
+    }
+    check(rowCount == expressions.size() && !expressions.empty(),
+          std::format("{} rows for the {} expressions", rowCount, expressions.size()));
+}
+
+/// Compiles a program with the statistics of the passes, comparing it with the plain compilation, and checks
+/// the statistics and their reports.
+static void testCompileStats() {
+    printSection("Compile statistics");
+    Compiler compiler;
+    compiler.addFunction("sin", &std::sin);
+    compiler.addFunction("cos", &std::cos);
+    compiler.addFunction("exp", &std::exp);
+    compiler.addFunction("log", &std::log);
+    compiler.addFunction("atan2", &std::atan2);
+    compiler.addFunction("mix", &mix);
+    compiler.addFunction("wave", &wave, { -2.0, 2.0 }, 1e-9);
+    compiler.addFunction("cube", &cube, &cubeBatch);
+    compiler.addSourceScript(POINT_SOURCE);
+
+    CompileStats  stats;
+    const Program program = compiler.compile(stats);
+    const Program plain   = compiler.compile();
+
+    const std::vector<String> passNames = { "GraphBuilder",
+                                            "Stage1 (Reduced<Grouped<ConstEvaluated<Merge>>>)",
+                                            "Stage2 (TrigonometricIdentities<Merge>)",
+                                            "CodeGenerator" };
+    bool                      named     = stats.passes.size() == passNames.size();
+    for (size_t i = 0; named && i < passNames.size(); ++i) {
+        named = stats.passes[i].name == passNames[i];
+    }
+    check(named, "Passes named in the order of their execution");
+    if (!named) {
+        return;
+    }
+
+    bool chained = stats.passes.front().termsIn == 0 && stats.passes.front().termsOut > 0;
+    bool merged  = true;
+    for (size_t i = 1; i < stats.passes.size(); ++i) {
+        chained = chained && stats.passes[i].termsIn == stats.passes[i - 1].termsOut;
+        merged  = merged && stats.passes[i].mergeHits <= stats.passes[i].mergeLookups;
+    }
+    check(chained, "Terms input by each pass are those output by the previous one");
+    check(merged && stats.passes[1].mergeLookups > 0, "Merge hits within the merge lookups");
+    check(stats.passes.back().instructionCount == program.instructions().instructions.size(),
+          std::format("{} instructions generated", stats.passes.back().instructionCount));
+
+    std::ostringstream programDump;
+    std::ostringstream plainDump;
+    dumpProgram(program, programDump);
+    dumpProgram(plain, plainDump);
+    // Note: The instructions are compared by their dumps, as the `NOP`s never compare equal.
+    check(programDump.str() == plainDump.str(), "Same program as the plain compilation");
+
+    std::stringstream statsReport;
+    dumpCompileStats(stats, statsReport);
+    bool reported = true;
+    for (const String& name : passNames) {
+        reported = reported && statsReport.str().find(name) != String::npos;
+    }
+    check(reported && statsReport.str().find("Total: ") != String::npos, "All the passes reported");
+
+    std::stringstream trace;
+    writeCompileTrace(stats, trace);
+    size_t eventCount = 0;
+    for (String line; std::getline(trace, line);) {
+        eventCount += line.find("\"ph\": \"X\"") != String::npos ? 1 : 0;
+    }
+    check(trace.str().starts_with("{\"displayTimeUnit\"") && eventCount == stats.passes.size(),
+          std::format("{} trace events for the {} passes", eventCount, stats.passes.size()));
+}
+
 static void test() {
     Compiler compiler;
     compiler.addFunction("sin", &std::sin);
@@ -159,8 +883,19 @@ static void test() {
 
 int main() {
     try {
+        testTabulation();
+        testBatchCalls();
+        testBinaryFunctions();
+        testFusion();
+        testSelection();
+        testDigestKeys();
+        testSharedComments();
+        testAnalysis();
+        testPointExecutable();
+        testProfiling();
+        testCompileStats();
         test();
-        return 0;
+        return failureCount == 0 ? 0 : 1;
     } catch (const Exception& exception) {
         printSection("ERROR");
         std::cerr << std::format("Unhandled exception: {}.", exception.message()) << std::endl;
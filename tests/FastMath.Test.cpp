@@ -0,0 +1,140 @@
+#include "FastMath.h"
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <numbers>
+#include <vector>
+using namespace sixpack;
+
+static int failureCount = 0;
+
+static void check(bool condition, StringView description) {
+    std::cout << (condition ? "[ OK ] " : "[FAIL] ") << description << std::endl;
+    if (!condition) {
+        ++failureCount;
+    }
+}
+
+static void printSection(StringView title) {
+    std::cout << std::endl << "-- " << title << " " << std::string(120 - title.size(), '-') << std::endl;
+}
+
+/// Returns the relative error of the value (zero if both values are the same, including zeros).
+static double relativeError(Real value, Real expected) {
+    return value == expected ? 0.0 : std::abs(value - expected) / std::abs(expected);
+}
+
+/// Returns the arguments of sin() and cos(): a uniform grid over the fast path, the multiples of pi/2 (i.e.
+/// the zeros, where only the relative error reveals a loss of the precision by the argument reduction) and
+/// their neighbours.
+static std::vector<Real> makeTrigArguments() {
+    static constexpr Real HALF_PI = std::numbers::pi_v<Real> / 2;
+
+    std::vector<Real> arguments;
+    for (int i = -100000; i <= 100000; ++i) {
+        arguments.push_back(Real(i) * 1e-3);
+    }
+    const auto addMultiple = [&](const Real k) {
+        for (const Real x : { k * HALF_PI, -k * HALF_PI }) {
+            arguments.push_back(x);
+            arguments.push_back(std::nextafter(x, 0.0));
+            arguments.push_back(std::nextafter(x, 2 * x));
+        }
+    };
+    for (int k = 1; k <= 10000; ++k) {
+        addMultiple(Real(k));
+    }
+    for (Real k = 10000; k <= 524288; k = std::floor(k * 1.01)) {
+        addMultiple(k);
+    }
+    return arguments;
+}
+
+static std::vector<Real> makeExpArguments() {
+    std::vector<Real> arguments;
+    for (int i = -70000; i <= 70000; ++i) {
+        arguments.push_back(Real(i) * 1e-2);
+    }
+    return arguments;
+}
+
+/// Returns the arguments of log(): a geometric grid from the subnormals up and the values next to 1 (i.e. the
+/// zero of log).
+static std::vector<Real> makeLogArguments() {
+    std::vector<Real> arguments;
+    for (int exponent = std::numeric_limits<Real>::min_exponent - std::numeric_limits<Real>::digits;
+         exponent < std::numeric_limits<Real>::max_exponent;
+         ++exponent) {
+        for (int i = 0; i < 64; ++i) {
+            arguments.push_back(std::ldexp(1.0 + Real(i) / 64, exponent));
+        }
+    }
+    for (int i = -10000; i <= 10000; ++i) {
+        arguments.push_back(1.0 + Real(i) * 1e-12);
+        arguments.push_back(1.0 + Real(i) * 1e-5);
+    }
+    return arguments;
+}
+
+/// Returns the maximum relative error of the kernel over the arguments.
+template <typename Function, typename Reference>
+static double maxRelativeError(const std::vector<Real>& arguments, Function function, Reference reference) {
+    double maximum = 0.0;
+    for (const Real x : arguments) {
+        maximum = std::max(maximum, relativeError(function(x), reference(x)));
+    }
+    return maximum;
+}
+
+/// Checks that the maximum relative errors of the tier's kernels stay within its bound.
+template <MathAccuracy TAccuracy>
+static void testAccuracy(StringView name, double bound) {
+    printSection(name);
+    static const std::vector<Real> TRIG_ARGUMENTS = makeTrigArguments();
+    static const std::vector<Real> EXP_ARGUMENTS  = makeExpArguments();
+    static const std::vector<Real> LOG_ARGUMENTS  = makeLogArguments();
+
+    const auto checkError = [&](StringView function, double error) {
+        check(error <= bound,
+              std::format("{:6} max. relative error {:.3e} (bound {:.0e})", function, error, bound));
+    };
+    // Note: The kernels are called by lambdas, as GCC cannot take the address of their (forced inline)
+    //       instances below -O2.
+    checkError("sin",
+               maxRelativeError(
+                   TRIG_ARGUMENTS,
+                   [](Real x) { return fastmath::sin<TAccuracy>(x); },
+                   [](Real x) { return std::sin(x); }));
+    checkError("cos",
+               maxRelativeError(
+                   TRIG_ARGUMENTS,
+                   [](Real x) { return fastmath::cos<TAccuracy>(x); },
+                   [](Real x) { return std::cos(x); }));
+    double sincosError = 0.0;
+    for (const Real x : TRIG_ARGUMENTS) {
+        Real sine, cosine;
+        fastmath::sincos<TAccuracy>(x, sine, cosine);
+        sincosError = std::max(
+            { sincosError, relativeError(sine, std::sin(x)), relativeError(cosine, std::cos(x)) });
+    }
+    checkError("sincos", sincosError);
+    checkError("exp",
+               maxRelativeError(
+                   EXP_ARGUMENTS,
+                   [](Real x) { return fastmath::exp<TAccuracy>(x); },
+                   [](Real x) { return std::exp(x); }));
+    checkError("log",
+               maxRelativeError(
+                   LOG_ARGUMENTS,
+                   [](Real x) { return fastmath::log<TAccuracy>(x); },
+                   [](Real x) { return std::log(x); }));
+}
+
+int main() {
+    testAccuracy<MathAccuracy::ULP_1>("MathAccuracy::ULP_1", 0.0);
+    testAccuracy<MathAccuracy::REL_1E6>("MathAccuracy::REL_1E6", 1e-6);
+    testAccuracy<MathAccuracy::REL_1E3>("MathAccuracy::REL_1E3", 1e-3);
+    return failureCount == 0 ? 0 : 1;
+}
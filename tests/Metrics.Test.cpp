@@ -0,0 +1,187 @@
+#include "Metrics.h"
+#include "Compiler.h"
+#include "Exception.h"
+#include "Expression.h"
+#include "ParallelEvaluator.h"
+#include "Program.h"
+#include "ThreadPool.h"
+#include <cmath>
+#include <format>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <vector>
+using namespace sixpack;
+
+// Note: The switch is a build-wide setting, i.e. the project of the test builds the library sources too, all
+//       with `SIXPACK_METRICS=1`.
+static_assert(Metrics::ENABLED, "The metrics test requires SIXPACK_METRICS=1");
+
+static int failureCount = 0;
+
+static void check(bool condition, StringView description) {
+    std::cout << (condition ? "[ OK ] " : "[FAIL] ") << description << std::endl;
+    if (!condition) {
+        ++failureCount;
+    }
+}
+
+static void printSection(StringView title) {
+    std::cout << std::endl << "-- " << title << " " << std::string(120 - title.size(), '-') << std::endl;
+}
+
+static Program compileQuotient() {
+    Compiler compiler;
+    compiler.addVariable("x");
+    compiler.addVariable("y");
+    compiler.addExpression("o", "x/y", Compiler::Visibility::PUBLIC);
+    return compiler.compile();
+}
+
+static bool isFailedCompilation() {
+    try {
+        Compiler compiler;
+        compiler.addVariable("x");
+        compiler.addExpression("o", "unknown(x)", Compiler::Visibility::PUBLIC);
+        compiler.compile();
+    } catch (const Exception&) {
+        return true;
+    }
+    return false;
+}
+
+/// Checks the counts of the runs of the executables and of the compilations.
+static void testRunsAndCompilations() {
+    printSection("Runs and Compilations");
+    const Metrics::Snapshot start   = Metrics::snapshot();
+    const Program           program = compileQuotient();
+    const bool              failed  = isFailedCompilation();
+
+    Executable<Program::Scalar> scalar = program.makeScalarExecutable();
+    for (int i = 0; i < 10; ++i) {
+        scalar.run();
+    }
+    Executable<Program::Vector> vector = program.makeVectorExecutable();
+    for (int i = 0; i < 3; ++i) {
+        vector.run();
+    }
+    PointExecutable point = program.makePointExecutable({ "x", "y" }, { "o" });
+    Real            inputs[2] = { 1.0, 2.0 };
+    Real            output    = 0.0;
+    point.eval(inputs, { &output, 1 });
+
+    const Metrics::Snapshot delta = Metrics::snapshot() - start;
+    check(delta.runs == 10 + 3 + 1, std::format("{} runs", delta.runs));
+    check(delta.points == 10 + 3 * Program::Vector::SIZE + 1, std::format("{} points", delta.points));
+    check(failed && delta.compilations == 2 && delta.failedCompilations == 1,
+          std::format("{} compilations, {} failed", delta.compilations, delta.failedCompilations));
+    check(delta.compileNanoseconds > 0 && delta.maxCompileNanoseconds > 0 &&
+              delta.maxCompileNanoseconds <= Metrics::snapshot().compileNanoseconds,
+          "Compile times measured");
+    check(delta.batches == 0 && delta.nanOutputs == 0 && delta.infinityOutputs == 0, "No batches");
+}
+
+/// Checks the counts of the batches (of the parallel evaluations), including their histogram and the
+/// non-finite outputs, both before and after the workers of the pool have exited.
+static void testBatches() {
+    printSection("Batches");
+    static constexpr Real   NaN        = std::numeric_limits<Real>::quiet_NaN();
+    static constexpr size_t WORD_SIZE  = Program::Vector::SIZE;
+    const Program           program    = compileQuotient();
+    const Metrics::Snapshot start      = Metrics::snapshot();
+    Metrics::Snapshot       beforeExit = {};
+    {
+        ThreadPool        pool(3, AffinityPolicy::NONE);
+        ParallelEvaluator evaluator(program, pool, 16);
+        for (const size_t pointCount : { 0, 1, 100, 101, 1000 }) {
+            // The points (0, 0), (1, 0) and (-1, 0) of each triple give NaN, +inf and -inf respectively.
+            std::vector<Real> x(pointCount, 1.0), y(pointCount, 2.0), o(pointCount);
+            for (size_t i = 0; i + 2 < pointCount; i += 50) {
+                x[i]     = 0.0;
+                y[i]     = 0.0;
+                x[i + 1] = 1.0;
+                y[i + 1] = 0.0;
+                x[i + 2] = -1.0;
+                y[i + 2] = 0.0;
+            }
+            if (pointCount == 1) {
+                x[0] = NaN;
+            }
+            const ParallelEvaluator::Columns columns{ .inputs     = { "x", "y" },
+                                                      .values     = { x.data(), y.data() },
+                                                      .pointCount = pointCount,
+                                                      .strides    = {} };
+            evaluator.evaluate(columns, { "o" }, std::vector<Real*>{ o.data() });
+        }
+        beforeExit = Metrics::snapshot() - start;
+    }
+    const Metrics::Snapshot afterExit = Metrics::snapshot() - start;
+
+    // Note: Each run evaluates a whole word, i.e. the runs of a batch are rounded up to whole words (the
+    //       chunks are multiples of the word).
+    size_t expectedRuns = 0;
+    for (const size_t pointCount : { 1, 100, 101, 1000 }) {
+        expectedRuns += (pointCount + WORD_SIZE - 1) / WORD_SIZE;
+    }
+    const auto checkBatches = [&](const Metrics::Snapshot& delta, StringView description) {
+        check(delta.batches == 4 && delta.batchPoints == 1 + 100 + 101 + 1000,
+              std::format("{} batches of {} points ({})", delta.batches, delta.batchPoints, description));
+        check(delta.batchSizes[0] == 1 && delta.batchSizes[6] == 2 && delta.batchSizes[9] == 1 &&
+                  delta.batches == std::accumulate(delta.batchSizes.begin(), delta.batchSizes.end(), 0ull),
+              std::format("Batch size histogram ({})", description));
+        check(delta.runs == expectedRuns && delta.points == expectedRuns * WORD_SIZE,
+              std::format("{} runs of {} points ({})", delta.runs, delta.points, description));
+        // Note: The batches of 100 and 101 points have two triples of the non-finite outputs, the batch of
+        //       1000 points twenty; the batch of a single point has a NaN input.
+        check(delta.nanOutputs == 1 + 2 + 2 + 20 && delta.infinityOutputs == 2 * (2 + 2 + 20),
+              std::format("{} NaN and {} infinite outputs ({})",
+                          delta.nanOutputs,
+                          delta.infinityOutputs,
+                          description));
+    };
+    checkBatches(beforeExit, "with the workers running");
+    checkBatches(afterExit, "after the workers exited");
+    check(afterExit.batchNanoseconds > 0 && Metrics::snapshot().pointsPerSecond(start) > 0.0,
+          "Batch times measured");
+}
+
+/// Checks that the counters of a thread are summed while it runs and kept after it has exited.
+static void testExitedThread() {
+    printSection("Exited Thread");
+    const Metrics::Snapshot start = Metrics::snapshot();
+    std::promise<void>      recorded;
+    std::promise<void>      exiting;
+
+    std::thread thread([&] {
+        const Program               program    = compileQuotient();
+        Executable<Program::Scalar> executable = program.makeScalarExecutable();
+        for (int i = 0; i < 7; ++i) {
+            executable.run();
+        }
+        recorded.set_value();
+        exiting.get_future().wait();
+    });
+    recorded.get_future().wait();
+    const Metrics::Snapshot running = Metrics::snapshot() - start;
+    exiting.set_value();
+    thread.join();
+    const Metrics::Snapshot exited = Metrics::snapshot() - start;
+    check(running.runs == 7 && running.compilations == 1, "Counters of the running thread");
+    check(exited.runs == 7 && exited.points == 7 && exited.compilations == 1,
+          "Counters of the exited thread");
+}
+
+int main() {
+    try {
+        testRunsAndCompilations();
+        testBatches();
+        testExitedThread();
+        return failureCount == 0 ? 0 : 1;
+    } catch (const Exception& exception) {
+        printSection("ERROR");
+        std::cerr << std::format("Unhandled exception: {}.", exception.message()) << std::endl;
+        return 1;
+    }
+}
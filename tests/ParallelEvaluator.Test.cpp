@@ -0,0 +1,282 @@
+#include "ParallelEvaluator.h"
+#include "Compiler.h"
+#include "Exception.h"
+#include "Program.h"
+#include "ThreadPool.h"
+#include "Topology.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+using namespace sixpack;
+
+static constexpr StringView SOURCE = R"SOURCE(
+input  x
+input  y
+output r = (x^2 + y^2)^0.5
+output s = sin(x)*y - x/3
+)SOURCE";
+
+static int failureCount = 0;
+
+static void check(bool condition, StringView description) {
+    std::cout << (condition ? "[ OK ] " : "[FAIL] ") << description << std::endl;
+    if (!condition) {
+        ++failureCount;
+    }
+}
+
+static void printSection(StringView title) {
+    std::cout << std::endl << "-- " << title << " " << std::string(120 - title.size(), '-') << std::endl;
+}
+
+static bool isSame(Real x, Real y) {
+    return x == y || (x != x && y != y);
+}
+
+/// Checks that each index of the loop is executed exactly once (by a valid worker).
+static void checkEveryIndex(ThreadPool& pool, size_t count) {
+    std::unique_ptr<std::atomic_int[]> executions(new std::atomic_int[count]{});
+    std::atomic_bool                   validWorkers = true;
+    pool.parallelFor(count, [&](size_t index, unsigned worker) {
+        executions[index].fetch_add(1, std::memory_order_relaxed);
+        if (worker >= pool.workerCount()) {
+            validWorkers = false;
+        }
+    });
+    bool once = true;
+    for (size_t i = 0; i < count; ++i) {
+        once = once && executions[i].load() == 1;
+    }
+    check(once && validWorkers, std::format("Each of {} indices executed once", count));
+}
+
+static void testThreadPool() {
+    printSection("Thread Pool");
+    ThreadPool pool(3, AffinityPolicy::NONE);
+    check(pool.workerCount() == 4, "Three background workers and the calling thread");
+    for (const size_t count : { 0, 1, 2, 3, 4, 5, 1000, 100003 }) {
+        checkEveryIndex(pool, count);
+    }
+
+    // The calling thread (the last worker) is blocked on its first index until all the other indices are
+    // done, i.e. the rest of its range must be stolen by the background worker. The background worker is
+    // blocked until then, so that it cannot take all the indices before the calling thread starts.
+    static constexpr size_t            COUNT = 1000;
+    ThreadPool                         pair(1, AffinityPolicy::NONE);
+    const unsigned                     callingWorker  = pair.workerCount() - 1;
+    std::atomic_bool                   callingStarted = false;
+    std::atomic_size_t                 done           = 0;
+    std::atomic_size_t                 callingCount   = 0;
+    std::atomic_size_t                 stolenCount    = 0;
+    std::atomic_bool                   timedOut       = false;
+    std::unique_ptr<std::atomic_int[]> executions(new std::atomic_int[COUNT]{});
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    const auto waitFor  = [&](const auto& condition) {
+        while (!condition() && !timedOut) {
+            timedOut = std::chrono::steady_clock::now() > deadline;
+            std::this_thread::yield();
+        }
+    };
+    pair.parallelFor(COUNT, [&](size_t index, unsigned worker) {
+        if (worker == callingWorker) {
+            callingStarted = true;
+            waitFor([&] { return callingCount > 0 || done.load() == COUNT - 1; });
+            ++callingCount;
+        } else {
+            waitFor([&] { return callingStarted.load(); });
+            if (index >= COUNT / 2) {
+                ++stolenCount;
+            }
+        }
+        executions[index].fetch_add(1, std::memory_order_relaxed);
+        ++done;
+    });
+    bool once = true;
+    for (size_t i = 0; i < COUNT; ++i) {
+        once = once && executions[i].load() == 1;
+    }
+    // Note: The calling thread takes the first index of its range, i.e. the rest (all but one) is stolen.
+    check(!timedOut && once && callingCount == 1 && stolenCount == COUNT / 2 - 1,
+          std::format("{} indices of the blocked worker stolen, each executed once", stolenCount.load()));
+
+    bool rethrown = false;
+    try {
+        pool.parallelFor(100, [](size_t index, unsigned) {
+            if (index == 42) {
+                throw Exception("Failed task");
+            }
+        });
+    } catch (const Exception& exception) {
+        rethrown = exception.message() == "Failed task";
+    }
+    check(rethrown, "The exception of a task is rethrown");
+    checkEveryIndex(pool, 100);
+}
+
+/// Checks the processors of the background threads mapped by the policy.
+static void checkMapping(const Topology&         topology,
+                         unsigned                threadCount,
+                         AffinityPolicy          policy,
+                         const std::vector<int>& expected,
+                         StringView              description) {
+    check(ThreadPool::mapProcessors(threadCount, policy, topology) == expected,
+          std::format("{} threads {}", threadCount, description));
+}
+
+/// Maps the threads on a synthetic machine of two nodes of unequal sizes.
+static void testAffinity() {
+    printSection("Affinity");
+    const Topology machine({ { .id = 0, .processors = { 0, 1, 2 } }, { .id = 1, .processors = { 4, 5 } } });
+    const Topology singleNode({ { .id = 0, .processors = { 0, 1, 2, 3 } } });
+    check(machine.processorCount() == 5 && machine.nodeOf(4) == 1 && machine.nodeOf(3) == -1,
+          "Processors of the synthetic topology");
+
+    checkMapping(machine, 4, AffinityPolicy::COMPACT, { 0, 1, 2, 4 }, "filling one node after another");
+    checkMapping(machine, 7, AffinityPolicy::COMPACT, { 0, 1, 2, 4, 5, 0, 1 }, "wrapped around (COMPACT)");
+    checkMapping(machine, 4, AffinityPolicy::SCATTER, { 0, 4, 1, 5 }, "alternating the nodes");
+    checkMapping(machine, 7, AffinityPolicy::SCATTER, { 0, 4, 1, 5, 2, 0, 4 }, "wrapped around (SCATTER)");
+    checkMapping(machine, 3, AffinityPolicy::AUTO, { 0, 4, 1 }, "scattered on two nodes (AUTO)");
+    checkMapping(singleNode, 3, AffinityPolicy::AUTO, { -1, -1, -1 }, "not pinned on a single node (AUTO)");
+    checkMapping(machine, 3, AffinityPolicy::NONE, { -1, -1, -1 }, "not pinned (NONE)");
+    checkMapping(machine, 0, AffinityPolicy::SCATTER, {}, "mapped to no processors");
+}
+
+/// Returns the outputs `r` and `s` of the points evaluated one by one by the scalar executable.
+static std::vector<Real> evaluateSerially(const Program& program, const std::vector<Real>& points) {
+    Executable<Program::Scalar> executable = program.makeScalarExecutable();
+    std::vector<Real>           outputs;
+    for (size_t i = 0; i < points.size(); i += 2) {
+        executable.memory()[program.getInputAddress("x")] = points[i];
+        executable.memory()[program.getInputAddress("y")] = points[i + 1];
+        executable.run();
+        outputs.push_back(executable.memory()[program.getOutputAddress("r")]);
+        outputs.push_back(executable.memory()[program.getOutputAddress("s")]);
+    }
+    return outputs;
+}
+
+/// Returns whether the row-major outputs (`r` and `s` of each point) are the same as the expected ones.
+static bool isSameOutputs(const std::vector<Real>& outputs, const std::vector<Real>& expected) {
+    bool result = outputs.size() == expected.size();
+    for (size_t i = 0; result && i < outputs.size(); ++i) {
+        result = isSame(outputs[i], expected[i]);
+    }
+    return result;
+}
+
+/// Evaluates the points by the sink and by the output columns, comparing them with the serial evaluation.
+template <typename TInput>
+static void checkEvaluation(const ParallelEvaluator& evaluator,
+                            const Program&           program,
+                            const TInput&            input,
+                            const std::vector<Real>& points,
+                            StringView               description) {
+    const size_t            pointCount = points.size() / 2;
+    const std::vector<Real> expected   = evaluateSerially(program, points);
+
+    std::vector<Real>                  bySink(2 * pointCount);
+    std::unique_ptr<std::atomic_int[]> deliveries(new std::atomic_int[pointCount]{});
+    std::atomic_bool                   outOfRange = false;
+    evaluator.evaluate(input, { "r", "s" }, [&](const ParallelEvaluator::Chunk& chunk) {
+        if (chunk.firstPoint + chunk.pointCount > pointCount) {
+            outOfRange = true;
+            return;
+        }
+        for (size_t i = 0; i < chunk.pointCount; ++i) {
+            const size_t point = chunk.firstPoint + i;
+            deliveries[point].fetch_add(1, std::memory_order_relaxed);
+            bySink[2 * point]     = chunk.outputs[0][i];
+            bySink[2 * point + 1] = chunk.outputs[1][i];
+        }
+    });
+    bool deliveredOnce = !outOfRange;
+    for (size_t i = 0; i < pointCount; ++i) {
+        deliveredOnce = deliveredOnce && deliveries[i].load() == 1;
+    }
+    check(deliveredOnce && isSameOutputs(bySink, expected),
+          std::format("{} points ({}) passed to the sink", pointCount, description));
+
+    std::vector<Real> r(pointCount), s(pointCount);
+    evaluator.evaluate(input, { "r", "s" }, std::vector<Real*>{ r.data(), s.data() });
+    std::vector<Real> byColumns;
+    for (size_t i = 0; i < pointCount; ++i) {
+        byColumns.push_back(r[i]);
+        byColumns.push_back(s[i]);
+    }
+    check(isSameOutputs(byColumns, expected),
+          std::format("{} points ({}) stored to the columns", pointCount, description));
+}
+
+static void testParallelEvaluator() {
+    printSection("Parallel Evaluator");
+    static constexpr size_t CHUNK_SIZE = 16;
+
+    Compiler compiler;
+    compiler.addFunction("sin", &std::sin);
+    compiler.addSourceScript(SOURCE);
+    const Program program = compiler.compile();
+
+    ThreadPool        pool(3, AffinityPolicy::NONE);
+    ParallelEvaluator evaluator(program, pool, CHUNK_SIZE);
+    for (const size_t pointCount : { size_t(0),
+                                     size_t(1),
+                                     size_t(Program::Vector::SIZE - 1),
+                                     size_t(Program::Vector::SIZE + 1),
+                                     CHUNK_SIZE - 1,
+                                     CHUNK_SIZE,
+                                     CHUNK_SIZE + 1,
+                                     5 * CHUNK_SIZE + 3 }) {
+        std::vector<Real> points;
+        for (size_t i = 0; i < pointCount; ++i) {
+            points.push_back(0.25 * Real(i) - 3.0);
+            points.push_back(Real(i % 7) - 2.5);
+        }
+        const ParallelEvaluator::Points pointSet{ .inputs = { "x", "y" }, .values = points };
+        checkEvaluation(evaluator, program, pointSet, points, "Points");
+
+        std::vector<Real> x, y;
+        for (size_t i = 0; i < pointCount; ++i) {
+            x.push_back(points[2 * i]);
+            y.push_back(points[2 * i + 1]);
+        }
+        const ParallelEvaluator::Columns columns{
+            .inputs = { "x", "y" }, .values = { x.data(), y.data() }, .pointCount = pointCount, .strides = {}
+        };
+        checkEvaluation(evaluator, program, columns, points, "Columns");
+    }
+
+    // The last axis varies the fastest.
+    for (const size_t yCount : { 0, 1, 3, 17 }) {
+        const ParallelEvaluator::Grid grid = {
+            { .input = "x", .start = -1.0, .step = 0.5, .count = 5 },
+            { .input = "y", .start = 2.0, .step = -0.25, .count = yCount },
+        };
+        std::vector<Real> points;
+        for (size_t i = 0; i < 5; ++i) {
+            for (size_t j = 0; j < yCount; ++j) {
+                points.push_back(-1.0 + 0.5 * Real(i));
+                points.push_back(2.0 - 0.25 * Real(j));
+            }
+        }
+        checkEvaluation(evaluator, program, grid, points, "Grid");
+    }
+}
+
+int main() {
+    try {
+        testThreadPool();
+        testAffinity();
+        testParallelEvaluator();
+        return failureCount == 0 ? 0 : 1;
+    } catch (const Exception& exception) {
+        printSection("ERROR");
+        std::cerr << std::format("Unhandled exception: {}.", exception.message()) << std::endl;
+        return 1;
+    }
+}
@@ -1,11 +1,160 @@
 #include "Parser.h"
+#include "Compiler.h"
+#include "Exception.h"
 #include "Expression.h"
+#include "Program.h"
 #include "Symbols.h"
 #include "Utilities.h"
+#include <algorithm>
 #include <cmath>
+#include <format>
 #include <iostream>
 using namespace sixpack;
 
+static int failureCount = 0;
+
+static void check(bool condition, StringView description) {
+    std::cout << (condition ? "[ OK ] " : "[FAIL] ") << description << std::endl;
+    if (!condition) {
+        ++failureCount;
+    }
+}
+
+/// Checks the prefix notation of the parsed expression.
+static void checkParse(const ExpressionParser& parser, StringView input, StringView expected) {
+    const Expression expression = parser.parseToExpression(input);
+    const String     prefix     = expression ? stringifyExpression(expression, Notation::PREFIX)
+                                             : std::format("error '{}'", expression.error());
+    check(prefix == expected, std::format("{:24} -> {}", input, prefix));
+}
+
+/// Checks the error (and its position) of the expression failing to parse.
+static void checkParseError(const ExpressionParser& parser,
+                            StringView              input,
+                            StringView              expected,
+                            StringPosition          position) {
+    const Expression expression = parser.parseToExpression(input);
+    check(!expression && expression.error() == expected && expression.errorPosition() == position,
+          std::format("{:24} -> error '{}' at {}",
+                      input,
+                      expression ? "" : expression.error(),
+                      expression ? 0 : expression.errorPosition()));
+}
+
+static void testComparisons(const Lexicon& lexicon) {
+    std::cout << std::endl << "Comparisons and if():" << std::endl;
+    ExpressionParser parser(lexicon);
+    // The comparisons have the lowest priority and are left-associative.
+    checkParse(parser, "x+y<z*2", "< + x y * z 2");
+    checkParse(parser, "-x^2 != x", "!= u- ^ x 2 x");
+    checkParse(parser, "x<y==y>=z", ">= == < x y y z");
+    checkParse(parser, "x <= (y > z)", "<= x > y z");
+    checkParse(parser, "if(x<y, x+1, sin(z))", "if < x y + x 1 sin z");
+    checkParse(parser, "if(x, if(y, 1, 2), 3) + 1", "+ if x if y 1 2 3 1");
+    checkParseError(parser, "x < < y", "Unexpected '<'", 4);
+    checkParseError(parser, "if(x, y)", "Expected ','", 7);
+    checkParseError(parser, "if x", "Expected '('", 3);
+
+    // A symbol named `if` shadows the built-in selection.
+    Lexicon shadowing = lexicon;
+    shadowing.add(std::make_shared<FunctionSymbol>("if", RealFunction(&std::cos)));
+    ExpressionParser shadowed(shadowing);
+    checkParse(shadowed, "if(x)", "if x");
+    checkParseError(shadowed, "if(x, y, z)", "Expected ')'", 4);
+    Lexicon hiding = lexicon;
+    hiding.add(std::make_shared<VariableSymbol>("if"));
+    checkParse(ExpressionParser(hiding), "if*2", "* if 2");
+}
+
+/// Returns the failure of the script (or an empty string), as "message on line N".
+static String parseScriptError(StringView script, Compiler& compiler) {
+    try {
+        compiler.addSourceScript(script);
+        return "";
+    } catch (const ParseException& exception) {
+        const StringView preceding = script.substr(0, std::min(exception.where(), script.size()));
+        return std::format("{} on line {}", exception.message(), std::ranges::count(preceding, '\n') + 1);
+    }
+}
+
+static String parseScriptError(StringView script) {
+    Compiler compiler;
+    return parseScriptError(script, compiler);
+}
+
+static void checkScriptError(StringView script, StringView expected, StringView description) {
+    const String error = parseScriptError(script);
+    check(error == expected, std::format("{} -> '{}'", description, error));
+}
+
+/// Makes the script of a chain of `count` expressions of the input `x`, each one using the previous one.
+static String makeChainScript(size_t count) {
+    String script = "input x\nv0 = x\n";
+    for (size_t i = 1; i < count; ++i) {
+        script += std::format("v{} = sin(v{}) + x/{}\n", i, i - 1, i);
+    }
+    script += std::format("output result = v{}\n", count - 1);
+    return script;
+}
+
+static Real evaluateChain(Compiler& compiler) {
+    const Program               program    = compiler.compile();
+    Executable<Program::Scalar> executable = program.makeScalarExecutable();
+    executable.memory()[program.getInputAddress("x")] = 0.75;
+    executable.run();
+    return executable.memory()[program.getOutputAddress("result")];
+}
+
+static void testScripts() {
+    std::cout << std::endl << "Scripts:" << std::endl;
+    // Each expression sees only the symbols of the preceding lines.
+    checkScriptError("input x\na = b + x\nb = 1", "Unknown symbol 'b' on line 2", "Forward reference");
+    checkScriptError("input x\na = a + x", "Unknown symbol 'a' on line 2", "Self reference");
+    checkScriptError("input x\na = x\nb = a*2", "", "Backward reference");
+
+    // The first failure in the order of the lines is reported, be it an expression or a declaration.
+    checkScriptError("input x\na = x\nb = x*)\nc = (x", "Unexpected ')' on line 3", "Expressions");
+    checkScriptError("input x\na = )\nparam = 1", "Unexpected ')' on line 2", "Expression first");
+    checkScriptError("input x\nparam = 1\na = )", "Unexpected '=' on line 2", "Declaration first");
+
+    // Note: The declarations go on after a failing expression (unlike when parsing line by line).
+    Compiler   compiler;
+    const bool failed = !parseScriptError("input x\na = )\nb = x", compiler).empty();
+    check(failed && compiler.publicSymbols().find("b"), "Symbols declared after a failing expression");
+
+    // The scripts of many expressions are parsed in parallel, with the same results.
+    const size_t count  = ScriptParser::PARALLEL_EXPRESSION_COUNT + 100;
+    const String script = makeChainScript(count);
+    Compiler     parallelCompiler;
+    parallelCompiler.addFunction("sin", &std::sin);
+    parallelCompiler.addSourceScript(script);
+    Compiler sequentialCompiler;
+    sequentialCompiler.addFunction("sin", &std::sin);
+    for (StringPosition start = 0; start < script.size(); start = script.find('\n', start) + 1) {
+        ScriptParser(sequentialCompiler)
+            .parseScriptLine(StringView(script).substr(start, script.find('\n', start) - start));
+    }
+    const Real parallelResult   = evaluateChain(parallelCompiler);
+    const Real sequentialResult = evaluateChain(sequentialCompiler);
+    check(parallelResult == sequentialResult,
+          std::format("{} expressions in parallel -> {} (line by line {})",
+                      count,
+                      parallelResult,
+                      sequentialResult));
+
+    // The first failure is reported also if parsed in parallel (the line of `vN` is N + 2).
+    String brokenScript = script;
+    for (const size_t index : { count - 10, count / 2, count / 3 }) {
+        const String name = std::format("\nv{} = ", index);
+        brokenScript.insert(brokenScript.find(name) + name.size(), "*");
+    }
+    Compiler brokenCompiler;
+    brokenCompiler.addFunction("sin", &std::sin);
+    const String error = parseScriptError(brokenScript, brokenCompiler);
+    check(error == std::format("Unexpected '*' on line {}", count / 3 + 2),
+          std::format("{} expressions in parallel -> '{}'", count, error));
+}
+
 int main() {
     Lexicon lexicon;
     lexicon.add(std::make_shared<FunctionSymbol>("sin", RealFunction(&std::sin)));
@@ -23,4 +172,14 @@ int main() {
     std::cout << "Postfix:  " << stringifyExpression(expr, Notation::POSTFIX) << std::endl;
     std::cout << std::endl;
     dumpSyntaxTree(expr, std::cout, true);
+
+    try {
+        testComparisons(lexicon);
+        testScripts();
+    } catch (const Exception& exception) {
+        std::cerr << std::format("Unhandled exception: {}.", exception.message()) << std::endl;
+        return 1;
+    }
+    std::cout << std::endl << std::format("{} failure(s).", failureCount) << std::endl;
+    return failureCount == 0 ? 0 : 1;
 }
@@ -0,0 +1,149 @@
+#include "Compiler.h"
+#include "Exception.h"
+#include "Pipeline.h"
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <format>
+#include <iostream>
+#include <mutex>
+#include <thread>
+using namespace sixpack;
+
+static constexpr StringView SOURCE = R"SOURCE(
+input  x
+input  y
+output r = sqrt(x^2 + y^2)
+)SOURCE";
+
+static int failureCount = 0;
+
+static void check(bool condition, StringView description) {
+    std::cout << (condition ? "[ OK ] " : "[FAIL] ") << description << std::endl;
+    if (!condition) {
+        ++failureCount;
+    }
+}
+
+static Pipeline::Block makeBlock(uint64_t sequence, size_t pointCount) {
+    Pipeline::Block block{
+        .sequence = sequence, .pointCount = pointCount, .version = 0, .inputs = {}, .outputs = {}
+    };
+    for (size_t i = 0; i < pointCount; ++i) {
+        block.inputs.push_back(Real(3 * (sequence + i)));
+        block.inputs.push_back(Real(4 * (sequence + i)));
+    }
+    return block;
+}
+
+static bool isEvaluated(const Pipeline::Block& block) {
+    bool result = block.outputs.size() == block.pointCount;
+    for (size_t i = 0; result && i < block.pointCount; ++i) {
+        result = block.outputs[i] == Real(5 * (block.sequence + i));
+    }
+    return result;
+}
+
+// Runs the action on another thread, reporting a failure if it does not finish in time (i.e. if it hangs).
+template <typename Action>
+static void checkFinishes(StringView description, Action action) {
+    std::mutex              mutex;
+    std::condition_variable finished;
+    bool                    done   = false;
+    std::thread             thread = std::thread([&] {
+        action();
+        std::lock_guard lock(mutex);
+        done = true;
+        finished.notify_one();
+    });
+    std::unique_lock lock(mutex);
+    const bool       inTime = finished.wait_for(lock, std::chrono::seconds(10), [&] { return done; });
+    check(inTime, description);
+    if (!inTime) {
+        std::cerr << "Hanging test, aborting." << std::endl;
+        std::abort();
+    }
+    lock.unlock();
+    thread.join();
+}
+
+static void test() {
+    Compiler compiler;
+    compiler.addFunction("sqrt", &std::sqrt);
+    compiler.addSourceScript(SOURCE);
+    const Program program = compiler.compile();
+
+    const Pipeline::Options options{ .workerCount = 1, .queueCapacity = 2, .affinity = AffinityPolicy::NONE };
+
+    // Note: With both the queues full, the worker waits for room in the output queue and the end-of-stream
+    //       marker does not fit the input queue.
+    checkFinishes("Destroying a full pipeline without a consumer", [&] {
+        Pipeline pipeline(program, { "x", "y" }, { "r" }, options);
+        for (uint64_t i = 0; i < 5; ++i) {
+            Pipeline::Block block = makeBlock(i, 3);
+            pipeline.tryPush(block);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10)); // letting the worker fill the outputs
+        }
+    });
+
+    checkFinishes("Popping all the blocks after closing a full pipeline", [&] {
+        Pipeline pipeline(program, { "x", "y" }, { "r" }, options);
+        size_t   pushedCount = 0;
+        for (uint64_t i = 0; i < 8; ++i) {
+            Pipeline::Block block = makeBlock(i, 3);
+            pushedCount += pipeline.tryPush(block) ? 1 : 0;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        pipeline.close();
+        Pipeline::Block block;
+        size_t          poppedCount = 0;
+        bool            evaluated   = true;
+        while (pipeline.pop(block)) {
+            ++poppedCount;
+            evaluated = evaluated && isEvaluated(block);
+        }
+        check(poppedCount == pushedCount && evaluated,
+              std::format("{} blocks pushed and popped", pushedCount));
+    });
+
+    checkFinishes("Destroying a pipeline with a consumer", [&] {
+        size_t consumedCount = 0;
+        bool   evaluated     = true;
+        {
+            Pipeline pipeline(
+                program,
+                { "x", "y" },
+                { "r" },
+                [&](Pipeline::Block&& block) {
+                    ++consumedCount;
+                    evaluated = evaluated && isEvaluated(block);
+                },
+                options);
+            for (uint64_t i = 0; i < 100; ++i) {
+                pipeline.push(makeBlock(i, 7));
+            }
+        }
+        check(consumedCount == 100 && evaluated, "100 blocks consumed");
+    });
+
+    bool thrown = false;
+    try {
+        Pipeline pipeline(program, { "x", "y" }, { "r" }, options);
+        pipeline.close();
+        pipeline.push(makeBlock(0, 1));
+    } catch (const Exception&) {
+        thrown = true;
+    }
+    check(thrown, "Pushing to a closed pipeline throws");
+}
+
+int main() {
+    try {
+        test();
+    } catch (const Exception& exception) {
+        std::cerr << std::format("Unhandled exception: {}.", exception.message()) << std::endl;
+        return 1;
+    }
+    std::cout << std::endl << std::format("{} failure(s).", failureCount) << std::endl;
+    return failureCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+#include "ProgramHandle.h"
+#include "Compiler.h"
+#include "Exception.h"
+#include "Expression.h"
+#include "FunctionTable.h"
+#include "Program.h"
+#include <atomic>
+#include <cmath>
+#include <format>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+using namespace sixpack;
+
+static int failureCount = 0;
+
+static void check(bool condition, StringView description) {
+    std::cout << (condition ? "[ OK ] " : "[FAIL] ") << description << std::endl;
+    if (!condition) {
+        ++failureCount;
+    }
+}
+
+static void printSection(StringView title) {
+    std::cout << std::endl << "-- " << title << " " << std::string(120 - title.size(), '-') << std::endl;
+}
+
+static Real bump(Real x) {
+    return 1.0 / (1.0 + x * x);
+}
+
+/// Compiles `o = value + bump(x)`, with `bump` tabulated. The table is owned by the program (and by its
+/// executables), i.e. it tells whether the program has been destroyed.
+static Program makeProgram(int value) {
+    Compiler compiler;
+    compiler.addFunction("bump", &bump, { -1.0, 1.0 }, 1e-9);
+    compiler.addVariable("x");
+    compiler.addExpression("o", std::format("{} + bump(x)", value), Compiler::Visibility::PUBLIC);
+    return compiler.compile();
+}
+
+static std::weak_ptr<const FunctionTable> tableOf(const Program& program) {
+    return program.tables().empty() ? std::weak_ptr<const FunctionTable>() : program.tables().front();
+}
+
+/// Returns the output of the program at `x = 0`, i.e. `value + 1`.
+static Real evaluate(const Program& program) {
+    Executable<Program::Scalar> executable = program.makeScalarExecutable();
+    executable.memory()[program.getInputAddress("x")] = 0.0;
+    executable.run();
+    return std::round(executable.memory()[program.getOutputAddress("o")]);
+}
+
+/// Checks that a reader keeps its version alive across a publish, and that the version is destroyed once the
+/// reader's epoch has ended.
+static void testRetirement() {
+    printSection("Retirement");
+    ProgramHandle                      handle(makeProgram(1));
+    std::weak_ptr<const FunctionTable> first;
+    {
+        const ProgramHandle::Snapshot snapshot = handle.acquire();
+        first                                  = tableOf(*snapshot);
+        check(snapshot.version() == 1 && evaluate(*snapshot) == 2.0, "Version 1 acquired");
+
+        check(handle.publish(makeProgram(2)) == 2 && handle.version() == 2, "Version 2 published");
+        handle.reclaim();
+        check(!first.expired() && snapshot.version() == 1 && evaluate(*snapshot) == 2.0,
+              "The reader keeps evaluating the version 1");
+
+        const ProgramHandle::Snapshot latest = handle.acquire();
+        check(latest.version() == 2 && evaluate(*latest) == 3.0, "A new reader acquires the version 2");
+    }
+    check(!first.expired(), "The version 1 is kept until reclaimed");
+    handle.reclaim();
+    check(first.expired(), "The version 1 is destroyed once its reader has left");
+
+    // The retired versions are reclaimed also by the next publish.
+    std::weak_ptr<const FunctionTable> second;
+    {
+        const ProgramHandle::Snapshot snapshot = handle.acquire();
+        second                                 = tableOf(*snapshot);
+        handle.publish(makeProgram(3));
+    }
+    check(!second.expired(), "The version 2 is kept after its reader has left");
+    handle.publish(makeProgram(4));
+    check(second.expired(), "The version 2 is destroyed by the next publish");
+
+    // A reader that entered after the publish does not hold the retired version.
+    std::weak_ptr<const FunctionTable> fourth = tableOf(*handle.acquire());
+    {
+        const ProgramHandle::Snapshot snapshot = handle.acquire();
+        handle.publish(makeProgram(5));
+        const ProgramHandle::Snapshot later = handle.acquire();
+        handle.reclaim();
+        check(!fourth.expired() && later.version() == 5, "The version 4 is kept by the earlier reader only");
+    }
+    handle.reclaim();
+    check(fourth.expired(), "The version 4 is destroyed once the earlier reader has left");
+}
+
+/// Publishes the versions (both directly and by recompiling) under the concurrent readers, checking that
+/// each snapshot is consistent and that all the replaced versions are destroyed in the end.
+static void testConcurrentReaders() {
+    printSection("Concurrent Readers");
+    static constexpr int VERSION_COUNT = 40;
+    static constexpr int READER_COUNT  = 4;
+
+    ProgramHandle                                   handle(makeProgram(1));
+    std::vector<std::weak_ptr<const FunctionTable>> tables = { tableOf(*handle.acquire()) };
+
+    std::atomic_bool         stopping     = false;
+    std::atomic_bool         consistent   = true;
+    std::atomic_int          acquisitions = 0;
+    std::vector<std::thread> readers;
+    for (int i = 0; i < READER_COUNT; ++i) {
+        readers.emplace_back([&] {
+            uint64_t lastVersion = 0;
+            while (!stopping) {
+                const ProgramHandle::Snapshot snapshot = handle.acquire();
+                if (evaluate(*snapshot) != Real(snapshot.version() + 1) || snapshot.version() < lastVersion) {
+                    consistent = false;
+                }
+                lastVersion = snapshot.version();
+                ++acquisitions;
+            }
+        });
+    }
+    bool numbered = true;
+    for (int version = 2; version <= VERSION_COUNT; ++version) {
+        Program program = makeProgram(version);
+        tables.push_back(tableOf(program));
+        if (version % 2 == 0) {
+            numbered = numbered && handle.publish(std::move(program)) == uint64_t(version);
+        } else {
+            auto shared = std::make_shared<Program>(std::move(program));
+            numbered = numbered && handle.recompile([shared] { return *shared; }).get() == uint64_t(version);
+        }
+    }
+    std::future<uint64_t> failed   = handle.recompile([]() -> Program { throw Exception("Failed"); });
+    bool                  rethrown = false;
+    try {
+        failed.get();
+    } catch (const Exception&) {
+        rethrown = true;
+    }
+    stopping = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    check(numbered && handle.version() == VERSION_COUNT, std::format("{} versions published", VERSION_COUNT));
+    check(rethrown, "A failed recompilation keeps the current version");
+    check(consistent, std::format("{} consistent snapshots", acquisitions.load()));
+
+    handle.reclaim();
+    size_t alive = 0;
+    for (const auto& table : tables) {
+        alive += table.expired() ? 0 : 1;
+    }
+    check(alive == 1 && !tables.back().expired(), "Only the current version is alive");
+}
+
+int main() {
+    try {
+        testRetirement();
+        testConcurrentReaders();
+        return failureCount == 0 ? 0 : 1;
+    } catch (const Exception& exception) {
+        printSection("ERROR");
+        std::cerr << std::format("Unhandled exception: {}.", exception.message()) << std::endl;
+        return 1;
+    }
+}
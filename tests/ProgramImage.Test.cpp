@@ -0,0 +1,192 @@
+#include "ProgramImage.h"
+#include "Compiler.h"
+#include "Exception.h"
+#include "FunctionRegistry.h"
+#include "Program.h"
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <vector>
+using namespace sixpack;
+
+static constexpr StringView SOURCE = R"SOURCE(
+input  x
+input  y
+param  k = 2.5
+output a = square(x) + sin(y)*cos(y)
+output b = table(x) + atan2(y, x)*mix(x, y)
+output c = if(x < y, x, y)*k + cube(y)
+)SOURCE";
+
+static int failureCount = 0;
+
+static void check(bool condition, StringView description) {
+    std::cout << (condition ? "[ OK ] " : "[FAIL] ") << description << std::endl;
+    if (!condition) {
+        ++failureCount;
+    }
+}
+
+static Real square(Real x) {
+    return x * x;
+}
+
+static Real cube(Real x) {
+    return x * x * x;
+}
+
+static void cubeBatch(const Real* input, Real* output, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        output[i] = cube(input[i]);
+    }
+}
+
+static Real mix(Real x, Real y) {
+    return 0.25 * x + 0.75 * y;
+}
+
+static Real smooth(Real x) {
+    return std::exp(-x * x);
+}
+
+/// The buffer of an image, aligned to `ProgramImage::ALIGNMENT`.
+class ImageBuffer {
+    struct alignas(ProgramImage::ALIGNMENT) Chunk {
+        std::byte bytes[ProgramImage::ALIGNMENT];
+    };
+
+    std::vector<Chunk> mChunks;
+    size_t             mSize;
+
+public:
+    explicit ImageBuffer(size_t size)
+        : mChunks((size + ProgramImage::ALIGNMENT - 1) / ProgramImage::ALIGNMENT), mSize(size) {}
+
+    std::span<std::byte>       bytes() { return { mChunks.front().bytes, mSize }; }
+    std::span<const std::byte> bytes() const { return { mChunks.front().bytes, mSize }; }
+};
+
+/// Checks that the image evaluates the same outputs as the program (bit by bit), by the scalar and the
+/// vector executables.
+static bool isSameEvaluation(const Program& program, const ProgramImage& image) {
+    static constexpr StringView OUTPUTS[] = { "a", "b", "c" };
+
+    Executable<Program::Scalar>      expectedScalar = program.makeScalarExecutable();
+    ImageExecutable<Program::Scalar> actualScalar   = image.makeScalarExecutable();
+    Executable<Program::Vector>      expectedVector = program.makeVectorExecutable();
+    ImageExecutable<Program::Vector> actualVector   = image.makeVectorExecutable();
+    bool                             same           = true;
+    for (int i = 0; i < 64; ++i) {
+        const Real x = -3.0 + 0.1 * i;
+        const Real y = 2.0 - 0.07 * i;
+        expectedScalar.memory()[program.getInputAddress("x")] = x;
+        expectedScalar.memory()[program.getInputAddress("y")] = y;
+        actualScalar.memory()[image.getInputAddress("x")]     = x;
+        actualScalar.memory()[image.getInputAddress("y")]     = y;
+        for (int lane = 0; lane < Program::Vector::SIZE; ++lane) {
+            const Real sign = lane % 2 == 0 ? 1.0 : -1.0;
+            expectedVector.memory()[program.getInputAddress("x")][lane] = sign * (lane < 2 ? x : y);
+            expectedVector.memory()[program.getInputAddress("y")][lane] = sign * (lane < 2 ? y : x);
+            actualVector.memory()[image.getInputAddress("x")][lane]     = sign * (lane < 2 ? x : y);
+            actualVector.memory()[image.getInputAddress("y")][lane]     = sign * (lane < 2 ? y : x);
+        }
+        expectedScalar.run();
+        actualScalar.run();
+        expectedVector.run();
+        actualVector.run();
+        for (StringView output : OUTPUTS) {
+            const Program::Address expectedAddress = program.getOutputAddress(output);
+            const Program::Address actualAddress   = image.getOutputAddress(output);
+            same = same && expectedScalar.memory()[expectedAddress] == actualScalar.memory()[actualAddress];
+            for (int lane = 0; lane < Program::Vector::SIZE; ++lane) {
+                same = same && expectedVector.memory()[expectedAddress][lane] ==
+                                   actualVector.memory()[actualAddress][lane];
+            }
+        }
+    }
+    return same;
+}
+
+/// Returns the message of the failure to make a view of the image (or an empty string). An image accepted
+/// is evaluated, which must not crash.
+static String viewError(std::span<const std::byte> bytes, const FunctionRegistry& functions) {
+    try {
+        const ProgramImage               image(bytes, functions);
+        ImageExecutable<Program::Scalar> executable = image.makeScalarExecutable();
+        executable.run();
+        return "";
+    } catch (const Exception& exception) {
+        return exception.message();
+    }
+}
+
+static void test() {
+    Compiler compiler;
+    compiler.addFunction("square", &square);
+    compiler.addFunction("cube", &cube, &cubeBatch);
+    compiler.addFunction("mix", &mix);
+    compiler.addFunction("atan2", &std::atan2);
+    compiler.addFunction("table", &smooth, Interval{ -4.0, 4.0 }, 1e-9);
+    compiler.addFunction("sin", &std::sin);
+    compiler.addFunction("cos", &std::cos);
+    compiler.addSourceScript(SOURCE);
+    const Program          program   = compiler.compile();
+    const FunctionRegistry functions = compiler.getFunctions();
+
+    ImageBuffer        buffer(ProgramImage::computeSize(program));
+    const ProgramImage formatted = ProgramImage::format(buffer.bytes(), program, functions);
+    const auto         bytes     = buffer.bytes().first(formatted.size());
+    const ProgramImage view(bytes, functions);
+    check(isSameEvaluation(program, formatted) && isSameEvaluation(program, view),
+          std::format("Image of {} bytes evaluated", formatted.size()));
+
+    // A copy of the image at another address is usable as well (i.e. the image is position-independent).
+    ImageBuffer copy(formatted.size());
+    std::memcpy(copy.bytes().data(), bytes.data(), bytes.size());
+    check(isSameEvaluation(program, ProgramImage(copy.bytes(), functions)), "Copy of the image evaluated");
+
+    bool allThrown = true;
+    for (size_t size = 0; size < bytes.size(); size += 8) {
+        allThrown = allThrown && !viewError(bytes.first(size), functions).empty();
+    }
+    check(allThrown, "All the truncations throw");
+
+    // Note: The corruptions of the constants and of the coefficients go undetected; none of them may crash
+    //       the view or the evaluation.
+    size_t detectedCount = 0;
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        std::byte& byte = copy.bytes()[i];
+        byte            = ~byte;
+        detectedCount += viewError(copy.bytes(), functions).empty() ? 0 : 1;
+        byte = ~byte;
+    }
+    check(detectedCount > 0, std::format("{} of {} corrupted bytes detected", detectedCount, bytes.size()));
+
+    copy.bytes()[0] = std::byte('X');
+    check(viewError(copy.bytes(), functions) == "Not a program image", "Wrong magic throws");
+
+    FunctionRegistry missing;
+    missing.add("square", &square);
+    check(viewError(bytes, missing).starts_with("Unknown function"), "Unknown function throws");
+
+    bool thrown = false;
+    try {
+        ImageBuffer unaligned(formatted.size());
+        ProgramImage::format(unaligned.bytes().subspan(8), program, functions);
+    } catch (const Exception&) {
+        thrown = true;
+    }
+    check(thrown, "Formatting into an unaligned buffer throws");
+}
+
+int main() {
+    try {
+        test();
+    } catch (const Exception& exception) {
+        std::cerr << std::format("Unhandled exception: {}.", exception.message()) << std::endl;
+        return 1;
+    }
+    std::cout << std::endl << std::format("{} failure(s).", failureCount) << std::endl;
+    return failureCount == 0 ? 0 : 1;
+}
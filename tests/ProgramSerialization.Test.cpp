@@ -0,0 +1,258 @@
+#include "Compiler.h"
+#include "Exception.h"
+#include "FunctionRegistry.h"
+#include "FunctionTable.h"
+#include "Program.h"
+#include "ProgramCache.h"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <sstream>
+using namespace sixpack;
+
+static constexpr StringView SOURCE = R"SOURCE(
+input  x
+input  y
+param  k = 2.5
+output a = square(x) + sin(y)*cos(y)           # CALL, SINCOS
+output b = table(x) + mix(y, x)                # TABLE_LOOKUP, CALL_BINARY
+output c = if(x < y, x, y)*k + cube(y)         # CMP_LT, SELECT, CALL_BATCH
+)SOURCE";
+
+static int failureCount = 0;
+
+static void check(bool condition, StringView description) {
+    std::cout << (condition ? "[ OK ] " : "[FAIL] ") << description << std::endl;
+    if (!condition) {
+        ++failureCount;
+    }
+}
+
+static Real square(Real x) {
+    return x * x;
+}
+
+static Real cube(Real x) {
+    return x * x * x;
+}
+
+static void cubeBatch(const Real* input, Real* output, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        output[i] = cube(input[i]);
+    }
+}
+
+static Real mix(Real x, Real y) {
+    return 0.25 * x + 0.75 * y;
+}
+
+static Real smooth(Real x) {
+    return std::exp(-x * x);
+}
+
+static Real sine(Real x) {
+    return std::sin(x);
+}
+
+static void addFunctions(Compiler& compiler) {
+    compiler.addFunction("square", &square);
+    compiler.addFunction("cube", &cube, &cubeBatch);
+    compiler.addFunction("mix", &mix);
+    compiler.addFunction("table", &smooth, Interval{ -4.0, 4.0 }, 1e-9);
+    compiler.addFunction("sin", &std::sin);
+    compiler.addFunction("cos", &std::cos);
+}
+
+/// Checks that both programs have the same instructions, the tables being compared by their coefficients.
+// Note: The NOPs are never equal (so that they are never merged), they are compared by their operand.
+static bool isSameInstructions(const Program& expected, const Program& actual) {
+    const auto& expectedInstructions = expected.instructions().instructions;
+    const auto& actualInstructions   = actual.instructions().instructions;
+    return std::ranges::equal(
+        expectedInstructions, actualInstructions, [](const auto& expectedOne, const auto& actualOne) {
+            if (expectedOne.opcode == Program::Opcode::NOP) {
+                return actualOne.opcode == Program::Opcode::NOP && expectedOne.operand == actualOne.operand;
+            }
+            if (expectedOne.opcode != Program::Opcode::TABLE_LOOKUP) {
+                return expectedOne == actualOne;
+            }
+            return actualOne.opcode == Program::Opcode::TABLE_LOOKUP &&
+                   expectedOne.operand == actualOne.operand &&
+                   std::ranges::equal(expectedOne.table->coefficients(), actualOne.table->coefficients());
+        });
+}
+
+/// Checks that both programs evaluate the same outputs (bit by bit) by the scalar and the vector executables.
+static bool isSameEvaluation(const Program& expected, const Program& actual) {
+    static constexpr StringView OUTPUTS[] = { "a", "b", "c" };
+
+    Executable<Program::Scalar> expectedScalar = expected.makeScalarExecutable();
+    Executable<Program::Scalar> actualScalar   = actual.makeScalarExecutable();
+    Executable<Program::Vector> expectedVector = expected.makeVectorExecutable();
+    Executable<Program::Vector> actualVector   = actual.makeVectorExecutable();
+    bool                        same           = true;
+    for (int i = 0; i < 64; ++i) {
+        const Real x = -3.0 + 0.1 * i;
+        const Real y = 2.0 - 0.07 * i;
+        expectedScalar.memory()[expected.getInputAddress("x")] = x;
+        expectedScalar.memory()[expected.getInputAddress("y")] = y;
+        actualScalar.memory()[actual.getInputAddress("x")]     = x;
+        actualScalar.memory()[actual.getInputAddress("y")]     = y;
+        for (int lane = 0; lane < Program::Vector::SIZE; ++lane) {
+            const Real sign = lane % 2 == 0 ? 1.0 : -1.0;
+            expectedVector.memory()[expected.getInputAddress("x")][lane] = sign * (lane < 2 ? x : y);
+            expectedVector.memory()[expected.getInputAddress("y")][lane] = sign * (lane < 2 ? y : x);
+            actualVector.memory()[actual.getInputAddress("x")][lane]     = sign * (lane < 2 ? x : y);
+            actualVector.memory()[actual.getInputAddress("y")][lane]     = sign * (lane < 2 ? y : x);
+        }
+        expectedScalar.run();
+        actualScalar.run();
+        expectedVector.run();
+        actualVector.run();
+        for (StringView output : OUTPUTS) {
+            const Program::Address expectedAddress = expected.getOutputAddress(output);
+            const Program::Address actualAddress   = actual.getOutputAddress(output);
+            same = same && expectedScalar.memory()[expectedAddress] == actualScalar.memory()[actualAddress];
+            for (int lane = 0; lane < Program::Vector::SIZE; ++lane) {
+                same = same && expectedVector.memory()[expectedAddress][lane] ==
+                                   actualVector.memory()[actualAddress][lane];
+            }
+        }
+    }
+    return same;
+}
+
+static Program deserialize(const String& bytes, const FunctionRegistry& functions) {
+    std::istringstream stream(bytes, std::ios::binary);
+    return Program::deserialize(stream, functions);
+}
+
+/// Returns the message of the failure to deserialize the bytes (or an empty string).
+static String deserializeError(const String& bytes, const FunctionRegistry& functions) {
+    try {
+        deserialize(bytes, functions);
+        return "";
+    } catch (const Exception& exception) {
+        return exception.message();
+    }
+}
+
+static void testRoundTrip(const Program& program, const FunctionRegistry& functions) {
+    for (const bool withComments : { false, true }) {
+        std::ostringstream stream(std::ios::binary);
+        program.serialize(stream, functions, withComments);
+        const Program deserialized = deserialize(stream.str(), functions);
+        check(isSameInstructions(program, deserialized) &&
+                  deserialized.comments().size() == (withComments ? program.comments().size() : 0) &&
+                  isSameEvaluation(program, deserialized),
+              std::format("Round trip {} comments ({} bytes)",
+                          withComments ? "with" : "without",
+                          stream.str().size()));
+    }
+}
+
+static void testCorruption(const Program& program, const FunctionRegistry& functions) {
+    std::ostringstream stream(std::ios::binary);
+    program.serialize(stream, functions, true);
+    const String bytes = stream.str();
+
+    bool allThrown = true;
+    for (size_t size = 0; size < bytes.size(); ++size) {
+        allThrown = allThrown && !deserializeError(bytes.substr(0, size), functions).empty();
+    }
+    check(allThrown, std::format("All {} truncations throw", bytes.size()));
+
+    // Note: Most of the corruptions (e.g. of the values or of the names) are detected, the others yield a
+    //       valid program; none of them may crash the deserialization.
+    size_t detectedCount = 0;
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        String corrupted = bytes;
+        corrupted[i]     = char(~corrupted[i]);
+        detectedCount += deserializeError(corrupted, functions).empty() ? 0 : 1;
+    }
+    check(detectedCount > 0, std::format("{} of {} corrupted bytes detected", detectedCount, bytes.size()));
+
+    String wrongMagic = bytes;
+    wrongMagic[0]     = 'X';
+    check(deserializeError(wrongMagic, functions) == "Not a serialized program", "Wrong magic throws");
+
+    FunctionRegistry missing;
+    missing.add("square", &square);
+    check(deserializeError(bytes, missing).starts_with("Unknown function"), "Unknown function throws");
+}
+
+static void testCache(const Compiler& compiler, const Program& program, const FunctionRegistry& functions) {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "sixpack-cache-test";
+    std::filesystem::remove_all(directory);
+    const ProgramCache cache(directory);
+
+    const Program compiled = cache.compile(compiler); // stores
+    const Program loaded   = cache.compile(compiler); // loads
+    check(std::distance(std::filesystem::directory_iterator(directory), {}) == 1 &&
+              isSameEvaluation(program, compiled) && isSameEvaluation(program, loaded),
+          "Program cache round trip");
+
+    // The entry stored under the fingerprint of another input (i.e. a collision) is not loaded.
+    const uint64_t fingerprint = compiler.fingerprint();
+    const String   input       = compiler.fingerprintInput();
+    cache.store(fingerprint, input + "#", program, functions);
+    check(!cache.load(fingerprint, input, functions), "Program cache collision missed");
+    check(cache.load(fingerprint, input + "#", functions).has_value(), "Program cache entry loaded");
+
+    // The same name bound to an intrinsic and to another function compiles differently, i.e. the programs
+    // must not share an entry.
+    Compiler intrinsicCompiler;
+    intrinsicCompiler.addFunction("sin", &std::sin);
+    intrinsicCompiler.addSourceScript("input x\noutput o = sin(x)");
+    Compiler userCompiler;
+    userCompiler.addFunction("sin", &sine);
+    userCompiler.addSourceScript("input x\noutput o = sin(x)");
+    const auto hasOpcode = [](const Program& program, Program::Opcode opcode) {
+        return std::ranges::any_of(program.instructions().instructions,
+                                   [&](const auto& instruction) { return instruction.opcode == opcode; });
+    };
+    const Program intrinsicProgram = cache.compile(intrinsicCompiler);
+    const Program userProgram      = cache.compile(userCompiler);
+    check(intrinsicCompiler.fingerprint() != userCompiler.fingerprint() &&
+              hasOpcode(intrinsicProgram, Program::Opcode::SIN) &&
+              hasOpcode(userProgram, Program::Opcode::CALL) && !hasOpcode(userProgram, Program::Opcode::SIN),
+          "Intrinsic and user functions of the same name cached apart");
+
+    std::filesystem::remove_all(directory);
+}
+
+static void test() {
+    Compiler compiler;
+    addFunctions(compiler);
+    compiler.addSourceScript(SOURCE);
+    const Program          program   = compiler.compile();
+    const FunctionRegistry functions = compiler.getFunctions();
+
+    for (const Program::Opcode opcode : { Program::Opcode::CALL,
+                                          Program::Opcode::CALL_BATCH,
+                                          Program::Opcode::CALL_BINARY,
+                                          Program::Opcode::SELECT,
+                                          Program::Opcode::SINCOS,
+                                          Program::Opcode::TABLE_LOOKUP }) {
+        const auto& instructions = program.instructions().instructions;
+        check(std::ranges::any_of(instructions,
+                                  [&](const auto& instruction) { return instruction.opcode == opcode; }),
+              std::format("Program uses opcode {}", int(opcode)));
+    }
+    testRoundTrip(program, functions);
+    testCorruption(program, functions);
+    testCache(compiler, program, functions);
+}
+
+int main() {
+    try {
+        test();
+    } catch (const Exception& exception) {
+        std::cerr << std::format("Unhandled exception: {}.", exception.message()) << std::endl;
+        return 1;
+    }
+    std::cout << std::endl << std::format("{} failure(s).", failureCount) << std::endl;
+    return failureCount == 0 ? 0 : 1;
+}
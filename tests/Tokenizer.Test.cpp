@@ -5,20 +5,27 @@ using namespace sixpack;
 std::ostream& operator<<(std::ostream& stream, const Token& token) {
     // clang-format off
     switch (token.type) {
-    case TokenType::NUMBER:            stream << "NUMBER            "; break;
-    case TokenType::IDENTIFIER:        stream << "IDENTIFIER        "; break;
-    case TokenType::OPERATOR_PLUS:     stream << "OPERATOR_PLUS     "; break;
-    case TokenType::OPERATOR_MINUS:    stream << "OPERATOR_MINUS    "; break;
-    case TokenType::OPERATOR_ASTERISK: stream << "OPERATOR_ASTERISK "; break;
-    case TokenType::OPERATOR_SLASH:    stream << "OPERATOR_SLASH    "; break;
-    case TokenType::OPERATOR_CARET:    stream << "OPERATOR_CARET    "; break;
-    case TokenType::PARENTHESIS_LEFT:  stream << "PARENTHESIS_LEFT  "; break;
-    case TokenType::PARENTHESIS_RIGHT: stream << "PARENTHESIS_RIGHT "; break;
-    case TokenType::BRACKET_LEFT:      stream << "BRACKET_LEFT      "; break;
-    case TokenType::BRACKET_RIGHT:     stream << "BRACKET_RIGHT     "; break;
-    case TokenType::UNKNOWN:           stream << "UNKNOWN           "; break;
-    case TokenType::END_OF_INPUT:      stream << "END_OF_INPUT      "; break;
-    default:                           stream << "???               "; break;
+    case TokenType::NUMBER:                  stream << "NUMBER                  "; break;
+    case TokenType::IDENTIFIER:              stream << "IDENTIFIER              "; break;
+    case TokenType::OPERATOR_PLUS:           stream << "OPERATOR_PLUS           "; break;
+    case TokenType::OPERATOR_MINUS:          stream << "OPERATOR_MINUS          "; break;
+    case TokenType::OPERATOR_ASTERISK:       stream << "OPERATOR_ASTERISK       "; break;
+    case TokenType::OPERATOR_SLASH:          stream << "OPERATOR_SLASH          "; break;
+    case TokenType::OPERATOR_CARET:          stream << "OPERATOR_CARET          "; break;
+    case TokenType::OPERATOR_LESS:           stream << "OPERATOR_LESS           "; break;
+    case TokenType::OPERATOR_LESS_EQUALS:    stream << "OPERATOR_LESS_EQUALS    "; break;
+    case TokenType::OPERATOR_GREATER:        stream << "OPERATOR_GREATER        "; break;
+    case TokenType::OPERATOR_GREATER_EQUALS: stream << "OPERATOR_GREATER_EQUALS "; break;
+    case TokenType::OPERATOR_DOUBLE_EQUALS:  stream << "OPERATOR_DOUBLE_EQUALS  "; break;
+    case TokenType::OPERATOR_NOT_EQUALS:     stream << "OPERATOR_NOT_EQUALS     "; break;
+    case TokenType::PARENTHESIS_LEFT:        stream << "PARENTHESIS_LEFT        "; break;
+    case TokenType::PARENTHESIS_RIGHT:       stream << "PARENTHESIS_RIGHT       "; break;
+    case TokenType::BRACKET_LEFT:            stream << "BRACKET_LEFT            "; break;
+    case TokenType::BRACKET_RIGHT:           stream << "BRACKET_RIGHT           "; break;
+    case TokenType::COMMA:                   stream << "COMMA                   "; break;
+    case TokenType::UNKNOWN:                 stream << "UNKNOWN                 "; break;
+    case TokenType::END_OF_INPUT:            stream << "END_OF_INPUT            "; break;
+    default:                                 stream << "???                     "; break;
     }
     // clang-format on
     stream << "'" << token.text << "'";
@@ -62,5 +69,7 @@ int main() {
     printTokens("123abc");
     printTokens("123_abc");
     printTokens("_123abc");
+    printTokens("atan2(y, x)");
+    printTokens("if(a<=b, a>b, a==b != !a)");
     printTokens("sin(theta)^2*(a^2+r^2+(2*a^2*M*r*sin(theta)^2)/(r^2+a^2*cos(theta)^2))");
 }
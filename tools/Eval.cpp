@@ -0,0 +1,347 @@
+#include "ColumnarBatch.h"
+#include "Compiler.h"
+#include "Exception.h"
+#include "Expression.h"
+#include "MappedFile.h"
+#include "ParallelEvaluator.h"
+#include "Program.h"
+#include "ProgramCache.h"
+#include "ThreadPool.h"
+#include "Utilities.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <thread>
+using namespace sixpack;
+
+static constexpr StringView USAGE = R"USAGE(Usage: sixpack-eval <script> --in <file> --out <file> [options]
+
+Evaluates the outputs of the script for all the points of the input file.
+
+The files are raw arrays of (native-endian) 64-bit floating-point values, stored column-wise: the input file
+holds a column of N values per each input, the output file (created or overwritten) a column of N values per
+each output. If the input file is a columnar batch (see ColumnarBatch.h), its columns are matched to the
+inputs by name and the output file is written as a columnar batch, too.
+
+Options:
+  --inputs  <a,b,...>  The inputs in the order of the columns (by default all the inputs, sorted by name;
+                       a batch must then have a column for each of them).
+  --outputs <x,y,...>  The outputs in the order of the columns (by default all the outputs of the script).
+  --threads <count>    The number of the worker threads (by default one per logical processor).
+  --slice   <points>   The number of the points per progress report (by default 1048576).
+  --accuracy <name>    The accuracy of the intrinsic functions: ULP_1 (default), REL_1E6 or REL_1E3.
+  --cache   <dir>      The directory of the compiled programs, reused while the script is unchanged.
+  --profile <points>   Profiles the evaluation of the first points (on a single thread) and prints the cost
+                       by opcode, by instruction and by source expression.
+  --trace   <file>     Prints the cost of each compilation pass and writes it as Chrome trace events (JSON);
+                       the cache is not used.
+)USAGE";
+
+struct Options {
+    String              script;
+    String              inputFile;
+    String              outputFile;
+    String              cacheDirectory;
+    String              traceFile;
+    std::vector<String> inputs;
+    std::vector<String> outputs;
+    unsigned            threadCount  = std::thread::hardware_concurrency();
+    size_t              sliceSize    = size_t(1) << 20;
+    size_t              profileSize  = 0;
+    MathAccuracy        mathAccuracy = MathAccuracy::ULP_1;
+};
+
+static std::vector<String> splitList(StringView list) {
+    std::vector<String> items;
+    while (!list.empty()) {
+        const StringPosition comma = std::min(list.find(','), list.size());
+        if (comma > 0) {
+            items.emplace_back(list.substr(0, comma));
+        }
+        list.remove_prefix(std::min(comma + 1, list.size()));
+    }
+    return items;
+}
+
+static String joinList(const std::vector<String>& items) {
+    String list;
+    for (const String& item : items) {
+        list += list.empty() ? item : ", " + item;
+    }
+    return list;
+}
+
+static size_t parseCount(StringView option, StringView value) {
+    size_t     count = 0;
+    const auto end   = value.data() + value.size();
+    if (const auto [pointer, error] = std::from_chars(value.data(), end, count);
+        error != std::errc() || pointer != end || count == 0) {
+        throw Exception(std::format("Invalid value of {}: '{}'", option, value));
+    }
+    return count;
+}
+
+static Options parseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const StringView argument = argv[i];
+        if (!argument.starts_with("--")) {
+            if (!options.script.empty()) {
+                throw Exception(std::format("Unexpected argument '{}'", argument));
+            }
+            options.script = argument;
+            continue;
+        }
+        if (i + 1 == argc) {
+            throw Exception(std::format("Missing value of {}", argument));
+        }
+        const StringView value = argv[++i];
+        if (argument == "--in") {
+            options.inputFile = value;
+        } else if (argument == "--out") {
+            options.outputFile = value;
+        } else if (argument == "--inputs") {
+            options.inputs = splitList(value);
+        } else if (argument == "--outputs") {
+            options.outputs = splitList(value);
+        } else if (argument == "--threads") {
+            options.threadCount = unsigned(parseCount(argument, value));
+        } else if (argument == "--slice") {
+            options.sliceSize = parseCount(argument, value);
+        } else if (argument == "--profile") {
+            options.profileSize = parseCount(argument, value);
+        } else if (argument == "--cache") {
+            options.cacheDirectory = value;
+        } else if (argument == "--trace") {
+            options.traceFile = value;
+        } else if (argument == "--accuracy") {
+            if (value == "ULP_1") {
+                options.mathAccuracy = MathAccuracy::ULP_1;
+            } else if (value == "REL_1E6") {
+                options.mathAccuracy = MathAccuracy::REL_1E6;
+            } else if (value == "REL_1E3") {
+                options.mathAccuracy = MathAccuracy::REL_1E3;
+            } else {
+                throw Exception(std::format("Unknown accuracy '{}'", value));
+            }
+        } else {
+            throw Exception(std::format("Unknown option '{}'", argument));
+        }
+    }
+    if (options.script.empty() || options.inputFile.empty() || options.outputFile.empty()) {
+        throw Exception("The script, the input file and the output file are required");
+    }
+    return options;
+}
+
+static String readScript(const String& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw Exception(std::format("Cannot open '{}'", path));
+    }
+    std::ostringstream script;
+    script << file.rdbuf();
+    return script.str();
+}
+
+static void addStandardFunctions(Compiler& compiler) {
+    // Note: The functions recognized by the compiler as intrinsics are identified by their addresses.
+    compiler.addFunction("sin", RealFunction(&std::sin));
+    compiler.addFunction("cos", RealFunction(&std::cos));
+    compiler.addFunction("tan", RealFunction(&std::tan));
+    compiler.addFunction("asin", RealFunction(&std::asin));
+    compiler.addFunction("acos", RealFunction(&std::acos));
+    compiler.addFunction("atan", RealFunction(&std::atan));
+    compiler.addFunction("exp", RealFunction(&std::exp));
+    compiler.addFunction("log", RealFunction(&std::log));
+    compiler.addFunction("sqrt", RealFunction(&std::sqrt));
+    compiler.addFunction("abs", RealFunction(&std::fabs));
+    compiler.addFunction("atan2", BinaryRealFunction(&std::atan2));
+    compiler.addFunction("hypot", BinaryRealFunction(&std::hypot));
+    compiler.addFunction("min", BinaryRealFunction(&std::fmin));
+    compiler.addFunction("max", BinaryRealFunction(&std::fmax));
+    compiler.addFunction("fmod", BinaryRealFunction(&std::fmod));
+    compiler.addFunction("copysign", BinaryRealFunction(&std::copysign));
+}
+
+static bool isColumnarBatch(const MappedFile& file) {
+    return file.size() >= sizeof(ColumnarBatch::MAGIC) &&
+           std::equal(std::begin(ColumnarBatch::MAGIC),
+                      std::end(ColumnarBatch::MAGIC),
+                      reinterpret_cast<const char*>(file.data().data()));
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void profile(const Program&                  program,
+                    const Options&                  options,
+                    const std::vector<const Real*>& inputColumns,
+                    size_t                          pointCount) {
+    ProfilingExecutable<Program::Vector> executable = program.makeProfilingExecutable<Program::Vector>();
+    std::vector<Program::Address>        addresses;
+    for (const String& name : options.inputs) {
+        addresses.push_back(program.getInputAddress(name));
+    }
+    const size_t profileSize = std::min(options.profileSize, pointCount);
+    for (size_t first = 0; first < profileSize; first += Program::Vector::SIZE) {
+        for (size_t i = 0; i < addresses.size(); ++i) {
+            Program::Vector& word = executable.memory()[addresses[i]];
+            for (int lane = 0; lane < Program::Vector::SIZE; ++lane) {
+                word[lane] = inputColumns[i][std::min(first + lane, profileSize - 1)];
+            }
+        }
+        executable.run();
+    }
+    std::cerr << std::format("Profile of {} points:", profileSize) << std::endl;
+    dumpProfile(program, executable.profile(), std::cerr);
+}
+
+static void run(Options options) {
+    Compiler compiler;
+    addStandardFunctions(compiler);
+    compiler.setMathAccuracy(options.mathAccuracy);
+    compiler.addSourceScript(readScript(options.script));
+    if (options.inputs.empty()) {
+        for (StringView input : compiler.getInputs()) {
+            options.inputs.emplace_back(input);
+        }
+        std::sort(options.inputs.begin(), options.inputs.end());
+    }
+    if (options.outputs.empty()) {
+        for (const auto& [output, expression] : compiler.getOutputs()) {
+            options.outputs.emplace_back(output);
+        }
+    }
+    const auto    compileStart = std::chrono::steady_clock::now();
+    CompileStats  compileStats;
+    const Program program = [&] {
+        // Note: The traced compilation bypasses the cache, i.e. all its passes are run.
+        if (!options.traceFile.empty()) {
+            return compiler.compile(compileStats);
+        }
+        return options.cacheDirectory.empty() ? compiler.compile()
+                                              : ProgramCache(options.cacheDirectory).compile(compiler);
+    }();
+    std::cerr << std::format("Compiled in {:.3f} s.", secondsSince(compileStart)) << std::endl;
+    if (!options.traceFile.empty()) {
+        dumpCompileStats(compileStats, std::cerr);
+        std::ofstream trace(options.traceFile, std::ios::binary | std::ios::trunc);
+        writeCompileTrace(compileStats, trace);
+        if (!trace.flush()) {
+            throw Exception(std::format("Cannot write '{}'", options.traceFile));
+        }
+    }
+
+    const MappedFile          input(options.inputFile);
+    std::vector<const Real*>  inputColumns;
+    size_t                    pointCount = 0;
+    std::optional<MappedFile> output;
+    std::vector<Real*>        outputColumns;
+    if (isColumnarBatch(input)) {
+        // The inputs are matched to the columns by name, the outputs are stored as a batch, too.
+        // Note: Without `--inputs`, each input of the script needs its column (rather than evaluate as zero).
+        const ColumnarBatch inputBatch(input.data());
+        for (const String& name : options.inputs) {
+            const ptrdiff_t column = inputBatch.findColumn(name);
+            if (column < 0) {
+                throw Exception(std::format("The input batch has no column '{}'", name));
+            }
+            inputColumns.push_back(inputBatch.column(size_t(column)));
+        }
+        pointCount = inputBatch.rowCount();
+        output.emplace(options.outputFile, ColumnarBatch::computeSize(options.outputs.size(), pointCount));
+        const ColumnarBatch outputBatch =
+            ColumnarBatch::format(output->writableData(), options.outputs, pointCount);
+        for (size_t i = 0; i < options.outputs.size(); ++i) {
+            outputColumns.push_back(outputBatch.writableColumn(i));
+        }
+    } else {
+        const size_t columnBytes = sizeof(Real) * std::max(options.inputs.size(), size_t(1));
+        if (input.size() % columnBytes != 0) {
+            throw Exception(std::format("The size of '{}' ({} bytes) does not match {} input columns",
+                                        options.inputFile,
+                                        input.size(),
+                                        options.inputs.size()));
+        }
+        pointCount = options.inputs.empty() ? 0 : input.size() / columnBytes;
+        for (size_t i = 0; i < options.inputs.size(); ++i) {
+            inputColumns.push_back(reinterpret_cast<const Real*>(input.data().data()) + i * pointCount);
+        }
+        output.emplace(options.outputFile, pointCount * options.outputs.size() * sizeof(Real));
+        for (size_t i = 0; i < options.outputs.size(); ++i) {
+            outputColumns.push_back(reinterpret_cast<Real*>(output->writableData().data()) + i * pointCount);
+        }
+    }
+    input.adviseSequential();
+
+    // Note: The columns are used in place, i.e. the values are read from (and written to) the mapped pages.
+    ThreadPool         threadPool(std::max(options.threadCount, 1u) - 1);
+    ParallelEvaluator  evaluator(program, threadPool);
+    std::vector<Real*> sliceColumns(options.outputs.size());
+
+    std::cerr << std::format("Evaluating {} points of [{}] to [{}] on {} workers...",
+                             pointCount,
+                             joinList(options.inputs),
+                             joinList(options.outputs),
+                             threadPool.workerCount())
+              << std::endl;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t first = 0; first < pointCount; first += options.sliceSize) {
+        ParallelEvaluator::Columns columns{ .inputs     = options.inputs,
+                                            .values     = {},
+                                            .pointCount = std::min(options.sliceSize, pointCount - first),
+                                            .strides    = {} };
+        for (const Real* column : inputColumns) {
+            columns.values.push_back(column + first);
+        }
+        for (size_t i = 0; i < outputColumns.size(); ++i) {
+            sliceColumns[i] = outputColumns[i] + first;
+        }
+        evaluator.evaluate(columns, options.outputs, sliceColumns);
+
+        const size_t done    = first + columns.pointCount;
+        const double seconds = secondsSince(start);
+        std::cerr << std::format("\r{:6.2f}% ({:.2f} Mpoints/s)",
+                                 100.0 * double(done) / double(pointCount),
+                                 double(done) / seconds * 1e-6)
+                  << std::flush;
+    }
+    output->flush();
+
+    const double seconds = secondsSince(start);
+    const double bytes   = double(input.size() + output->size());
+    std::cerr << std::format("\rEvaluated {} points in {:.3f} s ({:.2f} Mpoints/s, {:.1f} MB/s).",
+                             pointCount,
+                             seconds,
+                             double(pointCount) / seconds * 1e-6,
+                             bytes / seconds * 1e-6)
+              << std::endl;
+    if (options.profileSize > 0) {
+        profile(program, options, inputColumns, pointCount);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        if (argc == 1) {
+            std::cerr << USAGE;
+            return 2;
+        }
+        run(parseOptions(argc, argv));
+        return 0;
+    } catch (const ParseException& exception) {
+        std::cerr << std::format("Error: {} (at {}).", exception.message(), exception.where()) << std::endl;
+        return 1;
+    } catch (const Exception& exception) {
+        std::cerr << std::format("Error: {}.", exception.message()) << std::endl;
+        return 1;
+    }
+}